@@ -46,6 +46,17 @@ template<typename T, int N> void TestBasics()
         a = ConvolveWithGGX(b, T(0.5));
         v = SH::CalculateIrradiance(a, vector<T, 3>(0.0, 1.0, 0.0));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, vector<T, 4>(0.0, 0.0, 0.0, 1.0));
+        SH::L1_Generic<T, N> probes[8] = { a, b, a, b, a, b, a, b };
+        T weights[8] = { T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::Multiply(a, b);
+        a = SH::MultiplyZonal(a, vector<T, 2>(1.0, 0.5));
+        a = SH::ConvolveWithCosineLobe(a, SH::HannWindowL1ZH(T(2.0)));
+        a = SH::ConvolveWithCosineLobe(a, (vector<T, 2>)SH::LanczosWindowL1);
+        a = SH::ConvolveWithGGX(b, T(0.5), SH::DeringingWindowL1ZH(T(0.1)));
+        a = SH::ConvolveWithGGX(b, T(0.5), SH::LanczosWindowL1ZH(T(2.0)) * (vector<T, 2>)SH::HannWindowL1);
         SH::L1_Generic<T, 3> rgb = SH::ToRGB(SH::L1_Generic<T, 1>::Zero());
     }
 
@@ -60,6 +71,18 @@ template<typename T, int N> void TestBasics()
         a = ConvolveWithGGX(b, T(0.5));
         v = SH::CalculateIrradiance(a, vector<T, 3>(0.0, 1.0, 0.0));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, vector<T, 4>(0.0, 0.0, 0.0, 1.0));
+        SH::L2_Generic<T, N> probes[8] = { a, b, a, b, a, b, a, b };
+        T weights[8] = { T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::Rotate(a, SH::QuaternionToRotationMatrix(vector<T, 4>(0.0, 0.0, 0.0, 1.0)));
+        a = SH::Multiply(a, b);
+        a = SH::MultiplyZonal(a, vector<T, 3>(1.0, 0.5, 0.25));
+        a = SH::ConvolveWithCosineLobe(a, SH::HannWindowL2ZH(T(3.0)));
+        a = SH::ConvolveWithCosineLobe(a, (vector<T, 3>)SH::LanczosWindowL2);
+        a = SH::ConvolveWithGGX(b, T(0.5), SH::DeringingWindowL2ZH(T(0.1)));
+        a = SH::ConvolveWithGGX(b, T(0.5), SH::LanczosWindowL2ZH(T(3.0)) * (vector<T, 3>)SH::HannWindowL2);
         SH::L2_Generic<T, 3> rgb = SH::ToRGB(SH::L2_Generic<T, 1>::Zero());
     }
 }
@@ -75,6 +98,8 @@ template<typename T, int N> void TestL1Specifics()
     vector<T, 2> zh = SH::ApproximateGGXAsL1ZH(T(0.5));
     T s = T(0.0);
     SH::ExtractSpecularDirLight(sh, T(0.5), d, v, s);
+    v = SH::CalculatePrefilteredSpecular(sh, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5));
+    v = SH::CalculatePrefilteredSpecular(sh, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5), SH::ApproximateGGXEnvironmentBRDF(T(1.0), T(0.5)));
 }
 
 template<typename T, int N> void TestL2Specifics()
@@ -82,6 +107,262 @@ template<typename T, int N> void TestL2Specifics()
     SH::L2_Generic<T, N> sh = SH::ProjectOntoL2(vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(1.0));
     SH::L1_Generic<T, N> l1 = SH::L2toL1(sh);
     vector<T, 3> zh = SH::ApproximateGGXAsL2ZH(T(0.5));
+    vector<T, 4> zh4 = SH::ApproximateGGXAsZHBands1To4(T(0.5));
+    vector<T, N> v = SH::CalculatePrefilteredSpecular(sh, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5));
+    v = SH::CalculatePrefilteredSpecular(sh, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5), SH::ApproximateGGXEnvironmentBRDF(T(1.0), T(0.5)));
+}
+
+template<typename T, int N> void TestAccumulator()
+{
+    {
+        SH::L1_Generic<T, N> sh = SH::Cast<T>(SH::L1_Generic<float, N>::Zero());
+        SH::L1_Generic<float, N> sh32 = SH::Cast<float>(sh);
+        SH::L1Planar_Generic<T, N> planar = SH::Cast<T>(SH::ToPlanar(sh32));
+
+        SH::Accumulator<T, N, 1> accumulator = SH::Accumulator<T, N, 1>::Zero();
+        accumulator.Add(SH::ProjectOntoL1(float3(0.0, 1.0, 0.0), (vector<float, N>)(1.0)));
+        sh = accumulator.Result();
+
+        SH::Accumulator<T, N, 1, true> compensated = SH::Accumulator<T, N, 1, true>::Zero();
+        compensated.Add(SH::ProjectOntoL1(float3(0.0, 1.0, 0.0), (vector<float, N>)(1.0)));
+        sh = compensated.Result((vector<float, N>)(0.5));
+    }
+
+    {
+        SH::L2_Generic<T, N> sh = SH::Cast<T>(SH::L2_Generic<float, N>::Zero());
+        SH::L2_Generic<float, N> sh32 = SH::Cast<float>(sh);
+        SH::L2Planar_Generic<T, N> planar = SH::Cast<T>(SH::ToPlanar(sh32));
+
+        SH::Accumulator<T, N, 2> accumulator = SH::Accumulator<T, N, 2>::Zero();
+        accumulator.Add(SH::ProjectOntoL2(float3(0.0, 1.0, 0.0), (vector<float, N>)(1.0)));
+        sh = accumulator.Result();
+
+        SH::Accumulator<T, N, 2, true> compensated = SH::Accumulator<T, N, 2, true>::Zero();
+        compensated.Add(SH::ProjectOntoL2(float3(0.0, 1.0, 0.0), (vector<float, N>)(1.0)));
+        sh = compensated.Result((vector<float, N>)(0.5));
+    }
+}
+
+template<typename T, int N> void TestLights()
+{
+    {
+        SH::L1_Generic<T, N> sh = SH::ProjectConeOntoL1(vector<T, 3>(0.0, 1.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectSphereOntoL1(vector<T, 3>(0.0, 2.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectSphereOntoL1(vector<T, 3>(0.0, 2.0, 0.0), T(0.5), (vector<T, N>)(1.0), T(4.0));
+        sh = SH::ProjectDiskOntoL1(vector<T, 3>(0.0, 2.0, 0.0), vector<T, 3>(0.0, -1.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectDiskOntoL1(vector<T, 3>(0.0, 2.0, 0.0), vector<T, 3>(0.0, -1.0, 0.0), T(0.5), (vector<T, N>)(1.0), T(4.0));
+        vector<T, 2> zh = SH::ConeAsL1ZH(T(0.5));
+    }
+
+    {
+        SH::L2_Generic<T, N> sh = SH::ProjectConeOntoL2(vector<T, 3>(0.0, 1.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectSphereOntoL2(vector<T, 3>(0.0, 2.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectSphereOntoL2(vector<T, 3>(0.0, 2.0, 0.0), T(0.5), (vector<T, N>)(1.0), T(4.0));
+        sh = SH::ProjectDiskOntoL2(vector<T, 3>(0.0, 2.0, 0.0), vector<T, 3>(0.0, -1.0, 0.0), T(0.5), (vector<T, N>)(1.0));
+        sh = SH::ProjectDiskOntoL2(vector<T, 3>(0.0, 2.0, 0.0), vector<T, 3>(0.0, -1.0, 0.0), T(0.5), (vector<T, N>)(1.0), T(4.0));
+        vector<T, 3> zh = SH::ConeAsL2ZH(T(0.5));
+    }
+
+    {
+        vector<T, 3> vertices[SH::MaxPolygonVertices];
+        for(int i = 0; i < SH::MaxPolygonVertices; ++i)
+            vertices[i] = vector<T, 3>(T(i % 2), T(i / 2), 1.0);
+        SH::L2_Generic<T, N> sh = SH::ProjectPolygonOntoL2(vertices, 5, (vector<T, N>)(1.0));
+        sh = SH::ProjectQuadOntoL2(vector<T, 3>(-1.0, -1.0, 1.0), vector<T, 3>(1.0, -1.0, 1.0), vector<T, 3>(1.0, 1.0, 1.0), vector<T, 3>(-1.0, 1.0, 1.0), (vector<T, N>)(1.0));
+    }
+}
+
+void TestPackedF16()
+{
+    SH::L1_F16_RGB l1 = SH::UnpackF16RGB(SH::PackF16RGB(SH::L1_F16_RGB::Zero()));
+    SH::L2_F16_RGB l2 = SH::UnpackF16RGB(SH::PackF16RGB(SH::L2_F16_RGB::Zero()));
+}
+
+template<typename T, int N> void TestPlanar()
+{
+    {
+        SH::L1Planar_Generic<T, N> a = SH::ToPlanar(SH::L1_Generic<T, N>::Zero());
+        SH::L1Planar_Generic<T, N> b = SH::ProjectOntoL1Planar(vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(1.0));
+        a = a + b;
+        a = a - b;
+        a = a * T(1.0);
+        a = a / (vector<T, N>)(1.0);
+        a = SH::Lerp(a, b, T(0.5));
+        vector<T, N> v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::ConvolveWithZH(b, vector<T, 2>(1.0, 1.0));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, T(0.5));
+        v = SH::CalculateIrradiance(a, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, vector<T, 4>(0.0, 0.0, 0.0, 1.0));
+        SH::L1Planar_Generic<T, N> probes[8] = { a, b, a, b, a, b, a, b };
+        T weights[8] = { T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, vector<T, 3>(0.0, 1.0, 0.0));
+        vector<T, 3> d = SH::OptimalLinearDirection(a);
+        SH::ApproximateDirectionalLight(a, d, v);
+        v = SH::CalculateIrradianceGeomerics(a, vector<T, 3>(0.0, 1.0, 0.0));
+        T s = T(0.0);
+        SH::ExtractSpecularDirLight(a, T(0.5), d, v, s);
+        v = SH::CalculatePrefilteredSpecular(a, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5));
+        SH::L1_Generic<T, N> sh = SH::FromPlanar(a);
+        SH::L1Planar_Generic<T, 3> rgb = SH::ToRGB(SH::L1Planar_Generic<T, 1>::Zero());
+    }
+
+    {
+        SH::L2Planar_Generic<T, N> a = SH::ToPlanar(SH::L2_Generic<T, N>::Zero());
+        SH::L2Planar_Generic<T, N> b = SH::ProjectOntoL2Planar(vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(1.0));
+        a = a + b;
+        a = a - b;
+        a = a * T(1.0);
+        a = a / (vector<T, N>)(1.0);
+        a = SH::Lerp(a, b, T(0.5));
+        vector<T, N> v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::ConvolveWithZH(b, vector<T, 3>(1.0, 1.0, 1.0));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, T(0.5));
+        v = SH::CalculateIrradiance(a, vector<T, 3>(0.0, 1.0, 0.0));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, vector<T, 4>(0.0, 0.0, 0.0, 1.0));
+        SH::L2Planar_Generic<T, N> probes[8] = { a, b, a, b, a, b, a, b };
+        T weights[8] = { T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125), T(0.125) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, vector<T, 3>(0.0, 1.0, 0.0));
+        SH::L1Planar_Generic<T, N> l1 = SH::L2toL1(a);
+        v = SH::CalculatePrefilteredSpecular(a, vector<T, 3>(0.0, 1.0, 0.0), vector<T, 3>(0.0, 1.0, 0.0), (vector<T, N>)(0.04), T(0.5), SH::ApproximateGGXEnvironmentBRDF(T(1.0), T(0.5)));
+        SH::L2_Generic<T, N> sh = SH::FromPlanar(a);
+        SH::L2Planar_Generic<T, 3> rgb = SH::ToRGB(SH::L2Planar_Generic<T, 1>::Zero());
+    }
+}
+
+template<typename T, int N> void TestHBasis()
+{
+    {
+        SH::H4_Generic<T, N> a = SH::ProjectOntoH4(vector<T, 3>(0.0, 0.0, 1.0), (vector<T, N>)(1.0));
+        SH::H4_Generic<T, N> b = SH::ConvertToH4(SH::L1_Generic<T, N>::Zero());
+        a = a + b;
+        a = a - b;
+        a = a * T(1.0);
+        a = a / (vector<T, N>)(1.0);
+        a = SH::Lerp(a, b, T(0.5));
+        a = SH::ConvertToH4(SH::L2_Generic<T, N>::Zero());
+        a = SH::ConvertToH4Irradiance(SH::L1_Generic<T, N>::Zero());
+        a = SH::ConvertToH4Irradiance(SH::L2_Generic<T, N>::Zero());
+        a = SH::Cast<T>(SH::Cast<float>(a));
+        vector<T, N> v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, vector<T, 3>(0.0, 0.0, 1.0));
+    }
+
+    {
+        SH::H6_Generic<T, N> a = SH::ProjectOntoH6(vector<T, 3>(0.0, 0.0, 1.0), (vector<T, N>)(1.0));
+        SH::H6_Generic<T, N> b = SH::ConvertToH6(SH::L2_Generic<T, N>::Zero());
+        a = a + b;
+        a = SH::Lerp(a, b, T(0.5));
+        a = SH::ConvertToH6Irradiance(SH::L2_Generic<T, N>::Zero());
+        a = SH::Cast<T>(SH::Cast<float>(a));
+        vector<T, N> v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, vector<T, 3>(0.0, 0.0, 1.0));
+        SH::H4_Generic<T, N> h4 = SH::H6toH4(a);
+    }
+}
+
+StructuredBuffer<uint32_t> ProbeOctreeNodes : register(t0);
+StructuredBuffer<uint32_t> ProbeOctreeLeafProbes : register(t1);
+StructuredBuffer<SH::L2_RGB> ProbeOctreeProbes : register(t2);
+StructuredBuffer<SH::L2_F16_RGB> ProbeOctreeProbesF16 : register(t3);
+
+void TestProbeOctree()
+{
+    SH::ProbeOctreeLookup lookup = SH::LookupProbeOctree(ProbeOctreeNodes, ProbeOctreeLeafProbes, float3(-1.0f, -1.0f, -1.0f),
+                                                         float3(1.0f, 1.0f, 1.0f), float3(0.0f, 0.0f, 0.0f));
+    SH::L2_RGB sh = SH::SampleProbeOctree(ProbeOctreeProbes, lookup);
+    SH::L2_F16_RGB shF16 = SH::SampleProbeOctree(ProbeOctreeProbesF16, lookup);
+}
+
+StructuredBuffer<SH::L2_RGB> PCABasis : register(t4);
+StructuredBuffer<float2> PCAWeightScaleBias : register(t5);
+ByteAddressBuffer PCAWeights : register(t6);
+
+void TestPCA()
+{
+    SH::L2_RGB components[8];
+    float weights[8];
+    for(int i = 0; i < 8; ++i)
+    {
+        components[i] = PCABasis[1 + i];
+        weights[i] = 0.125f;
+    }
+    SH::L2_RGB sh = SH::DecodePCAProbe(PCABasis[0], components, weights);
+    sh = SH::DecodePCAProbe(PCABasis, PCAWeightScaleBias, PCAWeights, 5, 8, 4096, false);
+    sh = SH::DecodePCAProbe(PCABasis, PCAWeightScaleBias, PCAWeights, 5, 8, 4096, true);
+}
+
+StructuredBuffer<uint32_t> PaletteIndices : register(t7);
+
+void TestProbePalette()
+{
+    SH::L2_RGB sh = SH::LookupProbePalette(ProbeOctreeProbes, PaletteIndices, 5, false);
+    SH::L2_F16_RGB shF16 = SH::LookupProbePalette(ProbeOctreeProbesF16, PaletteIndices, 5, true);
+}
+
+Texture2D<float3> LightmapL0 : register(t8);
+Texture2D<float4> LightmapL1 : register(t9);
+SamplerState LightmapSampler : register(s0);
+
+void TestL1Lightmap()
+{
+    SH::L1_RGB sh = SH::DecodeL1FromTextures(LightmapL0, LightmapL1, LightmapSampler, float2(0.5f, 0.5f));
+    sh = SH::DecodeL1(LightmapL0[uint2(0, 0)], LightmapL1[uint2(0, 0)]);
+}
+
+StructuredBuffer<uint32_t> MixedLODHeaders : register(t10);
+StructuredBuffer<float3> MixedLODCoefficients : register(t11);
+
+void TestMixedLOD()
+{
+    float3 irradiance = SH::CalculateIrradianceMixedLOD(MixedLODHeaders, MixedLODCoefficients, 0, float3(0.0f, 0.0f, 1.0f));
+}
+
+StructuredBuffer<SH::L2_RGB> GradientProbes : register(t12);
+StructuredBuffer<SH::GradientL2_RGB> ProbeGradients : register(t13);
+
+template<typename T, int32_t N> void TestGradients()
+{
+    SH::L1_Generic<T, N> l1 = (SH::L1_Generic<T, N>)0;
+    SH::GradientL1_Generic<T, N> l1Gradient = (SH::GradientL1_Generic<T, N>)0;
+    l1 = SH::Extrapolate(l1, l1Gradient, vector<T, 3>(0.5, 0.0, -0.5));
+
+    SH::L2_Generic<T, N> l2 = (SH::L2_Generic<T, N>)0;
+    SH::GradientL2_Generic<T, N> l2Gradient = (SH::GradientL2_Generic<T, N>)0;
+    l2 = SH::Extrapolate(l2, l2Gradient, vector<T, 3>(0.5, 0.0, -0.5));
+}
+
+void TestProbeGradients()
+{
+    SH::L2_RGB sh = SH::SampleProbeWithGradient(GradientProbes, ProbeGradients, 0, float3(1.0f, 2.0f, 3.0f), float3(1.5f, 2.0f, 2.5f));
+}
+
+StructuredBuffer<float> LeastSquaresPatterns : register(t14);
+
+template<typename T, int32_t N> void TestLeastSquares()
+{
+    vector<T, 3> directions[16];
+    vector<T, N> samples[16];
+    for(int32_t i = 0; i < 16; ++i)
+    {
+        directions[i] = normalize(vector<T, 3>(T(i), T(1.0), T(-1.0)));
+        samples[i] = T(i);
+    }
+
+    SH::L1_Generic<T, N> l1 = (SH::L1_Generic<T, N>)0;
+    l1 = SH::LeastSquaresProjectL1(directions, samples, l1, T(0.1));
+    l1 = SH::LeastSquaresProjectL1(LeastSquaresPatterns, 1, samples, l1);
+
+    SH::L2_Generic<T, N> l2 = (SH::L2_Generic<T, N>)0;
+    l2 = SH::LeastSquaresProjectL2(directions, samples, l2, T(0.1));
+    l2 = SH::LeastSquaresProjectL2(LeastSquaresPatterns, 1, samples, l2);
 }
 
 [numthreads(1, 1, 1)]
@@ -106,4 +387,43 @@ void CompileTest()
     TestL2Specifics<float, 3>();
     TestL2Specifics<half, 1>();
     TestL2Specifics<half, 3>();
+
+    TestPlanar<float, 1>();
+    TestPlanar<float, 3>();
+    TestPlanar<half, 1>();
+    TestPlanar<half, 3>();
+
+    TestAccumulator<float, 1>();
+    TestAccumulator<float, 3>();
+    TestAccumulator<half, 1>();
+    TestAccumulator<half, 3>();
+
+    TestLights<float, 1>();
+    TestLights<float, 3>();
+    TestLights<half, 1>();
+    TestLights<half, 3>();
+
+    TestHBasis<float, 1>();
+    TestHBasis<float, 3>();
+    TestHBasis<half, 1>();
+    TestHBasis<half, 3>();
+
+    TestPackedF16();
+
+    TestProbeOctree();
+    TestPCA();
+    TestProbePalette();
+    TestL1Lightmap();
+    TestMixedLOD();
+
+    TestGradients<float, 1>();
+    TestGradients<float, 3>();
+    TestGradients<half, 1>();
+    TestGradients<half, 3>();
+    TestProbeGradients();
+
+    TestLeastSquares<float, 1>();
+    TestLeastSquares<float, 3>();
+    TestLeastSquares<half, 1>();
+    TestLeastSquares<half, 3>();
 }
\ No newline at end of file
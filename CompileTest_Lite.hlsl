@@ -43,6 +43,38 @@ void TestOperatorOverloads()
         sh = SH::Multiply(sh, 1.0f);
         sh = SH::Divide(sh, 1.0f);
     }
+
+    {
+        SH::L1_F16 sh = SH::L1_F16::Zero();
+        sh = SH::Add(sh, SH::L1_F16::Zero());
+        sh = SH::Subtract(sh, SH::L1_F16::Zero());
+        sh = SH::Multiply(sh, SH::Half(1.0f));
+        sh = SH::Divide(sh, SH::Half(1.0f));
+    }
+
+    {
+        SH::L1_F16_RGB sh = SH::L1_F16_RGB::Zero();
+        sh = SH::Add(sh, SH::L1_F16_RGB::Zero());
+        sh = SH::Subtract(sh, SH::L1_F16_RGB::Zero());
+        sh = SH::Multiply(sh, SH::Half(1.0f));
+        sh = SH::Divide(sh, SH::Half(1.0f));
+    }
+
+    {
+        SH::L2_F16 sh = SH::L2_F16::Zero();
+        sh = SH::Add(sh, SH::L2_F16::Zero());
+        sh = SH::Subtract(sh, SH::L2_F16::Zero());
+        sh = SH::Multiply(sh, SH::Half(1.0f));
+        sh = SH::Divide(sh, SH::Half(1.0f));
+    }
+
+    {
+        SH::L2_F16_RGB sh = SH::L2_F16_RGB::Zero();
+        sh = SH::Add(sh, SH::L2_F16_RGB::Zero());
+        sh = SH::Subtract(sh, SH::L2_F16_RGB::Zero());
+        sh = SH::Multiply(sh, SH::Half(1.0f));
+        sh = SH::Divide(sh, SH::Half(1.0f));
+    }
 }
 
 void TestBasics()
@@ -58,6 +90,11 @@ void TestBasics()
         a = SH::ConvolveWithGGX(b, 0.5f);
         v = SH::CalculateIrradiance(a, float3(0.0f, 1.0f, 0.0f));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, float4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L1 probes[8] = { a, b, a, b, a, b, a, b };
+        float weights[8] = { 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, float3(0.0f, 1.0f, 0.0f));
         SH::L1_RGB rgb = SH::ToRGB(SH::L1::Zero());
     }
 
@@ -72,6 +109,11 @@ void TestBasics()
         a = SH::ConvolveWithGGX(b, 0.5f);
         v = SH::CalculateIrradiance(a, float3(0.0f, 1.0f, 0.0f));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, float4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L1_RGB probes[8] = { a, b, a, b, a, b, a, b };
+        float weights[8] = { 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, float3(0.0f, 1.0f, 0.0f));
     }
 
     {
@@ -85,6 +127,11 @@ void TestBasics()
         a = SH::ConvolveWithGGX(b, 0.5f);
         v = SH::CalculateIrradiance(a, float3(0.0f, 1.0f, 0.0f));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, float4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L2 probes[8] = { a, b, a, b, a, b, a, b };
+        float weights[8] = { 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, float3(0.0f, 1.0f, 0.0f));
         SH::L2_RGB rgb = SH::ToRGB(SH::L2::Zero());
     }
 
@@ -99,6 +146,87 @@ void TestBasics()
         a = SH::ConvolveWithGGX(b, 0.5f);
         v = SH::CalculateIrradiance(a, float3(0.0f, 1.0f, 0.0f));
         a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, float4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L2_RGB probes[8] = { a, b, a, b, a, b, a, b };
+        float weights[8] = { 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, float3(0.0f, 1.0f, 0.0f));
+    }
+
+    {
+        SH::L1_F16 a = SH::L1_F16::Zero();
+        SH::L1_F16 b = SH::L1_F16::Zero();
+        a = SH::Lerp(a, b, SH::Half(0.5f));
+        SH::Half v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::ConvolveWithZH(b, SH::Half2(1.0f, 1.0f));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, SH::Half(0.5f));
+        v = SH::CalculateIrradiance(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, SH::Half4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L1_F16 probes[8] = { a, b, a, b, a, b, a, b };
+        SH::Half weights[8] = { SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, SH::Half3(0.0f, 1.0f, 0.0f));
+        SH::L1_F16_RGB rgb = SH::ToRGB(SH::L1_F16::Zero());
+    }
+
+    {
+        SH::L1_F16_RGB a = SH::L1_F16_RGB::Zero();
+        SH::L1_F16_RGB b = SH::L1_F16_RGB::Zero();
+        a = SH::Lerp(a, b, SH::Half(0.5f));
+        SH::Half3 v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::ConvolveWithZH(b, SH::Half2(1.0f, 1.0f));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, SH::Half(0.5f));
+        v = SH::CalculateIrradiance(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, SH::Half4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L1_F16_RGB probes[8] = { a, b, a, b, a, b, a, b };
+        SH::Half weights[8] = { SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, SH::Half3(0.0f, 1.0f, 0.0f));
+    }
+
+    {
+        SH::L2_F16 a = SH::L2_F16::Zero();
+        SH::L2_F16 b = SH::L2_F16::Zero();
+        a = SH::Lerp(a, b, SH::Half(0.5f));
+        SH::Half v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::ConvolveWithZH(b, SH::Half3(1.0f, 1.0f, 1.0f));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, SH::Half(0.5f));
+        v = SH::CalculateIrradiance(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, SH::Half4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L2_F16 probes[8] = { a, b, a, b, a, b, a, b };
+        SH::Half weights[8] = { SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, SH::QuaternionToRotationMatrix_F16(SH::Half4(0.0f, 0.0f, 0.0f, 1.0f)));
+        SH::L2_F16_RGB rgb = SH::ToRGB(SH::L2_F16::Zero());
+    }
+
+    {
+        SH::L2_F16_RGB a = SH::L2_F16_RGB::Zero();
+        SH::L2_F16_RGB b = SH::L2_F16_RGB::Zero();
+        a = SH::Lerp(a, b, SH::Half(0.5f));
+        SH::Half3 v = SH::DotProduct(a, b);
+        v = SH::Evaluate(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::ConvolveWithZH(b, SH::Half3(1.0f, 1.0f, 1.0f));
+        a = SH::ConvolveWithCosineLobe(a);
+        a = SH::ConvolveWithGGX(b, SH::Half(0.5f));
+        v = SH::CalculateIrradiance(a, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, float3x3(1, 0, 0, 0, 1, 0, 0, 0, 1));
+        a = SH::Rotate(a, SH::Half4(0.0f, 0.0f, 0.0f, 1.0f));
+        SH::L2_F16_RGB probes[8] = { a, b, a, b, a, b, a, b };
+        SH::Half weights[8] = { SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f), SH::Half(0.125f) };
+        a = SH::WeightedSum(probes, weights);
+        v = SH::WeightedEvaluate(probes, weights, SH::Half3(0.0f, 1.0f, 0.0f));
+        a = SH::Rotate(a, SH::QuaternionToRotationMatrix_F16(SH::Half4(0.0f, 0.0f, 0.0f, 1.0f)));
     }
 }
 
@@ -126,6 +254,29 @@ void TestL1Specifics()
         float s = 0.0f;
         SH::ExtractSpecularDirLight(sh, 0.5f, d, v, s);
     }
+
+    {
+        SH::L1_F16 sh = SH::ProjectOntoL1_F16(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(1.0f));
+        SH::Half3 d = SH::OptimalLinearDirection(sh);
+        SH::Half v = SH::Half(0.0f);
+        SH::ApproximateDirectionalLight(sh, d, v);
+        v = SH::CalculateIrradianceGeomerics(sh, SH::Half3(0.0f, 1.0f, 0.0f));
+        v = SH::CalculateIrradianceL1ZH3Hallucinate(sh, SH::Half3(0.0f, 1.0f, 0.0f));
+        SH::Half2 zh = SH::ApproximateGGXAsL1ZH_F16(SH::Half(0.5f));
+        SH::Half s = SH::Half(0.0f);
+        SH::ExtractSpecularDirLight(sh, SH::Half(0.5f), d, v, s);
+    }
+
+    {
+        SH::L1_F16_RGB sh = SH::ProjectOntoL1_F16_RGB(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half3(1.0f, 1.0f, 1.0f));
+        SH::Half3 d = SH::OptimalLinearDirection(sh);
+        SH::Half3 v = SH::Half(0.0f);
+        SH::ApproximateDirectionalLight(sh, d, v);
+        v = SH::CalculateIrradianceGeomerics(sh, SH::Half3(0.0f, 1.0f, 0.0f));
+        v = SH::CalculateIrradianceL1ZH3Hallucinate(sh, SH::Half3(0.0f, 1.0f, 0.0f));
+        SH::Half s = SH::Half(0.0f);
+        SH::ExtractSpecularDirLight(sh, SH::Half(0.5f), d, v, s);
+    }
 }
 
 void TestL2Specifics()
@@ -140,6 +291,84 @@ void TestL2Specifics()
         SH::L2_RGB sh = SH::ProjectOntoL2_RGB(float3(0.0f, 1.0f, 0.0f), 1.0f);
         SH::L1_RGB l1 = SH::L2toL1(sh);
     }
+
+    {
+        SH::L2_F16 sh = SH::ProjectOntoL2_F16(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(1.0f));
+        SH::L1_F16 l1 = SH::L2toL1(sh);
+        SH::Half3 zh = SH::ApproximateGGXAsL2ZH_F16(SH::Half(0.5f));
+    }
+
+    {
+        SH::L2_F16_RGB sh = SH::ProjectOntoL2_F16_RGB(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(1.0f));
+        SH::L1_F16_RGB l1 = SH::L2toL1(sh);
+    }
+}
+
+void TestLights()
+{
+    {
+        SH::L1 sh = SH::ProjectConeOntoL1(float3(0.0f, 1.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectSphereOntoL1(float3(0.0f, 2.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectSphereOntoL1(float3(0.0f, 2.0f, 0.0f), 0.5f, 1.0f, 4.0f);
+        sh = SH::ProjectDiskOntoL1(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectDiskOntoL1(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, 1.0f, 4.0f);
+    }
+
+    {
+        SH::L1_RGB sh = SH::ProjectConeOntoL1_RGB(float3(0.0f, 1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL1_RGB(float3(0.0f, 2.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL1_RGB(float3(0.0f, 2.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f), 4.0f);
+        sh = SH::ProjectDiskOntoL1_RGB(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectDiskOntoL1_RGB(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f), 4.0f);
+    }
+
+    {
+        SH::L1_F16 sh = SH::ProjectConeOntoL1_F16(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectSphereOntoL1_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectSphereOntoL1_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f), SH::Half(4.0f));
+        sh = SH::ProjectDiskOntoL1_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectDiskOntoL1_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f), SH::Half(4.0f));
+    }
+
+    {
+        SH::L1_F16_RGB sh = SH::ProjectConeOntoL1_F16_RGB(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL1_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL1_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f), SH::Half(4.0f));
+        sh = SH::ProjectDiskOntoL1_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectDiskOntoL1_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f), SH::Half(4.0f));
+    }
+
+    {
+        SH::L2 sh = SH::ProjectConeOntoL2(float3(0.0f, 1.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectSphereOntoL2(float3(0.0f, 2.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectSphereOntoL2(float3(0.0f, 2.0f, 0.0f), 0.5f, 1.0f, 4.0f);
+        sh = SH::ProjectDiskOntoL2(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, 1.0f);
+        sh = SH::ProjectDiskOntoL2(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, 1.0f, 4.0f);
+    }
+
+    {
+        SH::L2_RGB sh = SH::ProjectConeOntoL2_RGB(float3(0.0f, 1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL2_RGB(float3(0.0f, 2.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL2_RGB(float3(0.0f, 2.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f), 4.0f);
+        sh = SH::ProjectDiskOntoL2_RGB(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectDiskOntoL2_RGB(float3(0.0f, 2.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), 0.5f, float3(1.0f, 1.0f, 1.0f), 4.0f);
+    }
+
+    {
+        SH::L2_F16 sh = SH::ProjectConeOntoL2_F16(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectSphereOntoL2_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectSphereOntoL2_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f), SH::Half(4.0f));
+        sh = SH::ProjectDiskOntoL2_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f));
+        sh = SH::ProjectDiskOntoL2_F16(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half(1.0f), SH::Half(4.0f));
+    }
+
+    {
+        SH::L2_F16_RGB sh = SH::ProjectConeOntoL2_F16_RGB(SH::Half3(0.0f, 1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL2_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectSphereOntoL2_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f), SH::Half(4.0f));
+        sh = SH::ProjectDiskOntoL2_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f));
+        sh = SH::ProjectDiskOntoL2_F16_RGB(SH::Half3(0.0f, 2.0f, 0.0f), SH::Half3(0.0f, -1.0f, 0.0f), SH::Half(0.5f), SH::Half3(1.0f, 1.0f, 1.0f), SH::Half(4.0f));
+    }
 }
 
 [numthreads(1, 1, 1)]
@@ -152,4 +381,6 @@ void CompileTest()
     TestL1Specifics();
 
     TestL2Specifics();
+
+    TestLights();
 }
\ No newline at end of file
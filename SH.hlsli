@@ -158,6 +158,70 @@ template<typename T, int32_t N> L1_Generic<T, N> L2toL1(L2_Generic<T, N> sh)
     return result;
 }
 
+// Converts a set of SH coefficients to a different primitive scalar type, for example from L2_RGB to L2_F16_RGB:
+// SH::L2_F16_RGB sh16 = SH::Cast<float16_t>(sh32);
+template<typename TDst, typename T, int32_t N, int32_t L> SH<TDst, N, L> Cast(SH<T, N, L> sh)
+{
+    SH<TDst, N, L> result;
+    [unroll]
+    for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+        result.C[i] = vector<TDst, N>(sh.C[i]);
+    return result;
+}
+
+// Accumulates SH coefficients in fp32 regardless of the storage type T, and converts to T once the sum
+// is finished. Summing many projected samples directly into fp16 coefficients loses precision quickly, so this
+// allows fp16 to be used for storage and evaluation while keeping the integration accurate. When Compensated is
+// true the sum uses Kahan summation to further reduce the error from adding many small values to a large sum.
+//
+// SH::Accumulator<float16_t, 3, 2> accumulator = SH::Accumulator<float16_t, 3, 2>::Zero();
+// for(int32_t sampleIndex = 0; sampleIndex < NumSamples; ++sampleIndex)
+//     accumulator.Add(SH::ProjectOntoL2(sampleDirection, sampleRadiance));
+// SH::L2_F16_RGB radianceSH = accumulator.Result(1.0f / (NumSamples * SampleDirectionSphere_PDF()));
+template<typename T, int32_t N, int32_t L, bool Compensated = false> struct Accumulator
+{
+    SH<float32_t, N, L> Sum;
+    SH<float32_t, N, L> Compensation;
+
+    static Accumulator<T, N, L, Compensated> Zero()
+    {
+        return (Accumulator<T, N, L, Compensated>)0;
+    }
+
+    void Add(SH<float32_t, N, L> sh)
+    {
+        [unroll]
+        for(int32_t i = 0; i < SH<float32_t, N, L>::NumCoefficients; ++i)
+        {
+            if(Compensated)
+            {
+                // precise keeps the compiler from re-associating the compensation terms away
+                precise vector<float32_t, N> y = sh.C[i] - Compensation.C[i];
+                precise vector<float32_t, N> t = Sum.C[i] + y;
+                precise vector<float32_t, N> c = (t - Sum.C[i]) - y;
+                Compensation.C[i] = c;
+                Sum.C[i] = t;
+            }
+            else
+            {
+                Sum.C[i] += sh.C[i];
+            }
+        }
+    }
+
+    SH<T, N, L> Result()
+    {
+        return Cast<T>(Sum);
+    }
+
+    // Scales the fp32 sum before converting, which avoids overflow when T is fp16 and the
+    // un-normalized sum is larger than the fp16 range
+    SH<T, N, L> Result(vector<float32_t, N> scale)
+    {
+        return Cast<T>(Sum * scale);
+    }
+};
+
 template<typename T, int32_t N> L1_Generic<T, N> Lerp(L1_Generic<T, N> x, L1_Generic<T, N> y, T s)
 {
     return x * (T(1.0) - s) + y * s;
@@ -168,6 +232,55 @@ template<typename T, int32_t N> L2_Generic<T, N> Lerp(L2_Generic<T, N> x, L2_Gen
     return x * (T(1.0) - s) + y * s;
 }
 
+// First-order spatial gradient of a set of SH coefficients: the derivative of every coefficient along world-space
+// X, Y and Z. Stored alongside a probe, it lets a lookup extrapolate the probe to nearby positions, which holds up
+// better than interpolating between sparse probes. SampleFramework12's ProbeVolume can compute these with finite
+// differences, or they can be accumulated during the bake with ProjectOntoSH9ColorGradient.
+template<typename T, int32_t N, int32_t L> struct SHGradient
+{
+    SH<T, N, L> D[3];
+};
+
+template<typename T, int32_t N = 1> using GradientL1_Generic = SHGradient<T, N, 1>;
+using GradientL1 = GradientL1_Generic<float32_t, 1>;
+using GradientL1_F16 = GradientL1_Generic<float16_t, 1>;
+using GradientL1_RGB = GradientL1_Generic<float32_t, 3>;
+using GradientL1_F16_RGB = GradientL1_Generic<float16_t, 3>;
+
+template<typename T, int32_t N = 1> using GradientL2_Generic = SHGradient<T, N, 2>;
+using GradientL2 = GradientL2_Generic<float32_t, 1>;
+using GradientL2_F16 = GradientL2_Generic<float16_t, 1>;
+using GradientL2_RGB = GradientL2_Generic<float32_t, 3>;
+using GradientL2_F16_RGB = GradientL2_Generic<float16_t, 3>;
+
+// Extrapolates SH coefficients by a world-space offset from the point where they were computed
+template<typename T, int32_t N, int32_t L> SH<T, N, L> Extrapolate(SH<T, N, L> sh, SHGradient<T, N, L> gradient, vector<T, 3> offset)
+{
+    [unroll]
+    for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+        sh.C[i] += gradient.D[0].C[i] * offset.x + gradient.D[1].C[i] * offset.y + gradient.D[2].C[i] * offset.z;
+    return sh;
+}
+
+// Blends K sets of SH coefficients with per-set weights in a single pass, for example the 8 probes
+// surrounding a point in a probe grid with trilinear weights. Each coefficient is accumulated with
+// one multiply-add per set instead of chaining Lerp or operator calls through temporaries.
+// The weights are used as-is, so they should already sum to 1 if the result needs to be normalized.
+template<typename T, int32_t N, int32_t L, int32_t K> SH<T, N, L> WeightedSum(SH<T, N, L> sh[K], T weights[K])
+{
+    SH<T, N, L> result;
+    [unroll]
+    for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(int32_t k = 1; k < K; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
 // Projects a value in a single direction onto a set of L1 SH coefficients
 template<typename T, int32_t N> L1_Generic<T, N> ProjectOntoL1(vector<T, 3> direction, vector<T, N> value)
 {
@@ -217,6 +330,265 @@ template<typename T> L2_Generic<T, 1> ProjectOntoL2(vector<T, 3> direction, T va
     return ProjectOntoL2<T, 1>(direction, value);
 }
 
+// Regularized least-squares projection, for when there are too few samples for Monte Carlo integration
+// (Example #1) to converge, such as a real-time probe update that traces 16-64 rays per probe per frame.
+// Instead of integrating, this finds the coefficients that best fit the samples by minimizing
+//
+//   (4 * Pi / K) * sum_k (Evaluate(sh, directions[k]) - samples[k])^2 + lambda * |sh - prevSH|^2
+//
+// The 4 * Pi / K factor makes the normal equations close to (1 + lambda) * I for well-distributed directions,
+// so lambda is roughly the weight of the previous frame's coefficients relative to the new samples. The
+// regularization also keeps the system well-conditioned when the directions don't cover the sphere evenly.
+// With fewer directions than coefficients (K < M) the system is singular without it, so lambda is clamped to
+// LeastSquaresMinLambda (SHLeastSquaresMinLambda in SampleFramework12's SHLeastSquares.h, which needs to match).
+// The normal equations are built and solved in fp32 with a Cholesky factorization.
+static const float32_t LeastSquaresMinLambda = 1e-4f;
+
+template<int32_t N, int32_t L> struct LeastSquaresSystem
+{
+    static const int32_t NumCoefficients = (L + 1) * (L + 1);
+
+    // Only the lower triangle of A is used
+    float32_t A[NumCoefficients][NumCoefficients];
+    vector<float32_t, N> B[NumCoefficients];
+
+    void AddSample(SH<float32_t, 1, L> basis, vector<float32_t, N> value, float32_t weight)
+    {
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+        {
+            B[i] += basis.C[i].x * weight * value;
+
+            [unroll]
+            for(int32_t j = 0; j <= i; ++j)
+                A[i][j] += basis.C[i].x * basis.C[j].x * weight;
+        }
+    }
+
+    // Solves A * x = B, leaving x in B and the Cholesky factor of A in A
+    void Solve()
+    {
+        [unroll]
+        for(int32_t j = 0; j < NumCoefficients; ++j)
+        {
+            float32_t diagonal = A[j][j];
+            [unroll]
+            for(int32_t k = 0; k < j; ++k)
+                diagonal -= A[j][k] * A[j][k];
+            A[j][j] = sqrt(max(diagonal, 1e-12f));
+
+            [unroll]
+            for(int32_t i = j + 1; i < NumCoefficients; ++i)
+            {
+                float32_t value = A[i][j];
+                [unroll]
+                for(int32_t k = 0; k < j; ++k)
+                    value -= A[i][k] * A[j][k];
+                A[i][j] = value / A[j][j];
+            }
+        }
+
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+        {
+            [unroll]
+            for(int32_t k = 0; k < i; ++k)
+                B[i] -= A[i][k] * B[k];
+            B[i] /= A[i][i];
+        }
+
+        [unroll]
+        for(int32_t i = NumCoefficients - 1; i >= 0; --i)
+        {
+            [unroll]
+            for(int32_t k = i + 1; k < NumCoefficients; ++k)
+                B[i] -= A[k][i] * B[k];
+            B[i] /= A[i][i];
+        }
+    }
+};
+
+// Adds the Tikhonov term pulling the solution towards prevSH and solves the system
+template<typename T, int32_t N, int32_t L> SH<T, N, L> SolveRegularized(LeastSquaresSystem<N, L> system, SH<T, N, L> prevSH, T lambda)
+{
+    const float32_t clampedLambda = max(float32_t(lambda), LeastSquaresMinLambda);
+
+    [unroll]
+    for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+    {
+        system.A[i][i] += clampedLambda;
+        system.B[i] += clampedLambda * vector<float32_t, N>(prevSH.C[i]);
+    }
+
+    system.Solve();
+
+    SH<T, N, L> result;
+    [unroll]
+    for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+        result.C[i] = vector<T, N>(system.B[i]);
+    return result;
+}
+
+template<typename T, int32_t N, int32_t K> L1_Generic<T, N> LeastSquaresProjectL1(vector<T, 3> directions[K], vector<T, N> samples[K], L1_Generic<T, N> prevSH, T lambda)
+{
+    LeastSquaresSystem<N, 1> system = (LeastSquaresSystem<N, 1>)0;
+    [loop]
+    for(int32_t k = 0; k < K; ++k)
+        system.AddSample(ProjectOntoL1(float32_t3(directions[k]), 1.0f), vector<float32_t, N>(samples[k]), 4.0f * Pi / K);
+
+    return SolveRegularized(system, prevSH, lambda);
+}
+
+template<typename T, int32_t N, int32_t K> L2_Generic<T, N> LeastSquaresProjectL2(vector<T, 3> directions[K], vector<T, N> samples[K], L2_Generic<T, N> prevSH, T lambda)
+{
+    LeastSquaresSystem<N, 2> system = (LeastSquaresSystem<N, 2>)0;
+    [loop]
+    for(int32_t k = 0; k < K; ++k)
+        system.AddSample(ProjectOntoL2(float32_t3(directions[k]), 1.0f), vector<float32_t, N>(samples[k]), 4.0f * Pi / K);
+
+    return SolveRegularized(system, prevSH, lambda);
+}
+
+// Least-squares projection for fixed ray patterns, using the matrices precomputed by BuildSHLeastSquaresPattern
+// in SampleFramework12's SHLeastSquares.h. The inverse of the regularized normal equations is folded into an
+// M x K projection matrix applied to the samples and an M x M prior matrix applied to the previous coefficients
+// (M = 4 for L1 and 9 for L2), so lambda is baked in. Each pattern's matrices are stored row-major, one after
+// the other, so that several rotated patterns can be cycled through from frame to frame. Patterns are addressed
+// as patternIdx * (M * K + M * M), so one buffer can't mix L1 and L2 patterns or different direction counts.
+template<typename T, int32_t N, int32_t L, int32_t K> SH<T, N, L> ApplyLeastSquaresPattern(StructuredBuffer<float32_t> patternMatrices, uint32_t patternIdx,
+                                                                                          vector<T, N> samples[K], SH<T, N, L> prevSH)
+{
+    const int32_t M = SH<T, N, L>::NumCoefficients;
+    const uint32_t projectionStart = patternIdx * (M * K + M * M);
+    const uint32_t priorStart = projectionStart + M * K;
+
+    SH<T, N, L> result;
+    [unroll]
+    for(int32_t i = 0; i < M; ++i)
+    {
+        vector<float32_t, N> sum = 0.0f;
+
+        [loop]
+        for(int32_t k = 0; k < K; ++k)
+            sum += patternMatrices[projectionStart + i * K + k] * vector<float32_t, N>(samples[k]);
+
+        [unroll]
+        for(int32_t j = 0; j < M; ++j)
+            sum += patternMatrices[priorStart + i * M + j] * vector<float32_t, N>(prevSH.C[j]);
+
+        result.C[i] = vector<T, N>(sum);
+    }
+
+    return result;
+}
+
+template<typename T, int32_t N, int32_t K> L1_Generic<T, N> LeastSquaresProjectL1(StructuredBuffer<float32_t> patternMatrices, uint32_t patternIdx,
+                                                                                 vector<T, N> samples[K], L1_Generic<T, N> prevSH)
+{
+    return ApplyLeastSquaresPattern(patternMatrices, patternIdx, samples, prevSH);
+}
+
+template<typename T, int32_t N, int32_t K> L2_Generic<T, N> LeastSquaresProjectL2(StructuredBuffer<float32_t> patternMatrices, uint32_t patternIdx,
+                                                                                 vector<T, N> samples[K], L2_Generic<T, N> prevSH)
+{
+    return ApplyLeastSquaresPattern(patternMatrices, patternIdx, samples, prevSH);
+}
+
+// Internal layout used by the packed fp16 paths for L1_F16_RGB and L2_F16_RGB. The red and green
+// channels of each coefficient stay together in a float16_t2, and the blue channels of neighboring
+// coefficients are paired up into a second set of float16_t2 values. This lets DotProduct,
+// Evaluate, ConvolveWithZH, and CalculateIrradiance run on 2-wide packed fp16 ALUs instead of
+// doing scalar-by-vector3 math for every coefficient: for L2 a weighted sum of the coefficients
+// takes 9 + 5 packed FMAs instead of 27 scalar FMAs.
+struct PackedL1_F16_RGB
+{
+    float16_t2 RG[4];
+    float16_t2 B[2];
+};
+
+struct PackedL2_F16_RGB
+{
+    float16_t2 RG[9];
+    float16_t2 B[5];
+};
+
+PackedL1_F16_RGB PackF16RGB(L1_F16_RGB sh)
+{
+    PackedL1_F16_RGB packed;
+    [unroll]
+    for(int32_t i = 0; i < 4; ++i)
+        packed.RG[i] = sh.C[i].rg;
+
+    packed.B[0] = float16_t2(sh.C[0].b, sh.C[1].b);
+    packed.B[1] = float16_t2(sh.C[2].b, sh.C[3].b);
+
+    return packed;
+}
+
+PackedL2_F16_RGB PackF16RGB(L2_F16_RGB sh)
+{
+    PackedL2_F16_RGB packed;
+    [unroll]
+    for(int32_t i = 0; i < 9; ++i)
+        packed.RG[i] = sh.C[i].rg;
+
+    packed.B[0] = float16_t2(sh.C[0].b, sh.C[1].b);
+    packed.B[1] = float16_t2(sh.C[2].b, sh.C[3].b);
+    packed.B[2] = float16_t2(sh.C[4].b, sh.C[5].b);
+    packed.B[3] = float16_t2(sh.C[6].b, sh.C[7].b);
+    packed.B[4] = float16_t2(sh.C[8].b, 0.0);
+
+    return packed;
+}
+
+L1_F16_RGB UnpackF16RGB(PackedL1_F16_RGB packed)
+{
+    L1_F16_RGB sh;
+    [unroll]
+    for(int32_t i = 0; i < 4; ++i)
+        sh.C[i] = float16_t3(packed.RG[i], packed.B[i / 2][i % 2]);
+    return sh;
+}
+
+L2_F16_RGB UnpackF16RGB(PackedL2_F16_RGB packed)
+{
+    L2_F16_RGB sh;
+    [unroll]
+    for(int32_t i = 0; i < 9; ++i)
+        sh.C[i] = float16_t3(packed.RG[i], packed.B[i / 2][i % 2]);
+    return sh;
+}
+
+// Computes the sum of each packed coefficient multiplied by a scalar weight, using packed math
+float16_t3 PackedWeightedSum(PackedL1_F16_RGB packed, float16_t weights[4])
+{
+    float16_t2 rg = weights[0] * packed.RG[0];
+    [unroll]
+    for(int32_t i = 1; i < 4; ++i)
+        rg += weights[i] * packed.RG[i];
+
+    float16_t2 b = float16_t2(weights[0], weights[1]) * packed.B[0];
+    b += float16_t2(weights[2], weights[3]) * packed.B[1];
+
+    return float16_t3(rg, b.x + b.y);
+}
+
+float16_t3 PackedWeightedSum(PackedL2_F16_RGB packed, float16_t weights[9])
+{
+    float16_t2 rg = weights[0] * packed.RG[0];
+    [unroll]
+    for(int32_t i = 1; i < 9; ++i)
+        rg += weights[i] * packed.RG[i];
+
+    float16_t2 b = float16_t2(weights[0], weights[1]) * packed.B[0];
+    b += float16_t2(weights[2], weights[3]) * packed.B[1];
+    b += float16_t2(weights[4], weights[5]) * packed.B[2];
+    b += float16_t2(weights[6], weights[7]) * packed.B[3];
+    b += float16_t2(weights[8], 0.0) * packed.B[4];
+
+    return float16_t3(rg, b.x + b.y);
+}
+
 // Calculates the dot product of two sets of L1 SH coefficients
 template<typename T, int32_t N> vector<T, N> DotProduct(L1_Generic<T, N> a, L1_Generic<T, N> b)
 {
@@ -227,6 +599,22 @@ template<typename T, int32_t N> vector<T, N> DotProduct(L1_Generic<T, N> a, L1_G
     return result;
 }
 
+float16_t3 DotProduct(L1_F16_RGB a, L1_F16_RGB b)
+{
+    const PackedL1_F16_RGB pa = PackF16RGB(a);
+    const PackedL1_F16_RGB pb = PackF16RGB(b);
+
+    float16_t2 rg = pa.RG[0] * pb.RG[0];
+    [unroll]
+    for(int32_t i = 1; i < 4; ++i)
+        rg += pa.RG[i] * pb.RG[i];
+
+    float16_t2 blue = pa.B[0] * pb.B[0];
+    blue += pa.B[1] * pb.B[1];
+
+    return float16_t3(rg, blue.x + blue.y);
+}
+
 // Calculates the dot product of two sets of L2 SH coefficients
 template<typename T, int32_t N> vector<T, N> DotProduct(L2_Generic<T, N> a, L2_Generic<T, N> b)
 {
@@ -237,6 +625,129 @@ template<typename T, int32_t N> vector<T, N> DotProduct(L2_Generic<T, N> a, L2_G
     return result;
 }
 
+float16_t3 DotProduct(L2_F16_RGB a, L2_F16_RGB b)
+{
+    const PackedL2_F16_RGB pa = PackF16RGB(a);
+    const PackedL2_F16_RGB pb = PackF16RGB(b);
+
+    float16_t2 rg = pa.RG[0] * pb.RG[0];
+    [unroll]
+    for(int32_t i = 1; i < 9; ++i)
+        rg += pa.RG[i] * pb.RG[i];
+
+    float16_t2 blue = pa.B[0] * pb.B[0];
+    [unroll]
+    for(int32_t p = 1; p < 5; ++p)
+        blue += pa.B[p] * pb.B[p];
+
+    return float16_t3(rg, blue.x + blue.y);
+}
+
+// Multiplies two sets of L1 SH coefficients, and returns the product projected back onto L1 SH (the L2 part
+// of the product is discarded). Can be used to shadow radiance by a visibility function, for example.
+// Only the non-zero Clebsch-Gordan (Gaunt) coefficients of the real SH basis are evaluated, which takes
+// 14 multiplies/MADs per component.
+template<typename T, int32_t N> L1_Generic<T, N> Multiply(L1_Generic<T, N> a, L1_Generic<T, N> b)
+{
+    L1_Generic<T, N> result;
+    result.C[0] = T(0.282094792) * (a.C[0] * b.C[0] + a.C[1] * b.C[1] + a.C[2] * b.C[2] + a.C[3] * b.C[3]);
+    result.C[1] = T(0.282094792) * (a.C[0] * b.C[1] + a.C[1] * b.C[0]);
+    result.C[2] = T(0.282094792) * (a.C[0] * b.C[2] + a.C[2] * b.C[0]);
+    result.C[3] = T(0.282094792) * (a.C[0] * b.C[3] + a.C[3] * b.C[0]);
+    return result;
+}
+
+// Multiplies two sets of L2 SH coefficients, and returns the product projected back onto L2 SH (the L3 and L4
+// parts of the product are discarded). Only the non-zero Clebsch-Gordan (Gaunt) coefficients of the real SH
+// basis are evaluated, which takes 119 multiplies/MADs per component instead of the 729 needed
+// for a dense triple product.
+template<typename T, int32_t N> L2_Generic<T, N> Multiply(L2_Generic<T, N> a, L2_Generic<T, N> b)
+{
+    L2_Generic<T, N> result;
+    result.C[0] = T(0.282094792) * (a.C[0] * b.C[0] + a.C[1] * b.C[1] + a.C[2] * b.C[2] + a.C[3] * b.C[3] + a.C[4] * b.C[4] + a.C[5] * b.C[5] + a.C[6] * b.C[6] + a.C[7] * b.C[7] + a.C[8] * b.C[8]);
+    result.C[1] = T(0.282094792) * (a.C[0] * b.C[1] + a.C[1] * b.C[0]) +
+                  T(-0.126156626) * (a.C[1] * b.C[6] + a.C[6] * b.C[1]) +
+                  T(-0.218509686) * (a.C[1] * b.C[8] + a.C[8] * b.C[1]) +
+                  T(0.218509686) * (a.C[2] * b.C[5] + a.C[5] * b.C[2] + a.C[3] * b.C[4] + a.C[4] * b.C[3]);
+    result.C[2] = T(0.282094792) * (a.C[0] * b.C[2] + a.C[2] * b.C[0]) +
+                  T(0.218509686) * (a.C[1] * b.C[5] + a.C[5] * b.C[1] + a.C[3] * b.C[7] + a.C[7] * b.C[3]) +
+                  T(0.252313252) * (a.C[2] * b.C[6] + a.C[6] * b.C[2]);
+    result.C[3] = T(0.282094792) * (a.C[0] * b.C[3] + a.C[3] * b.C[0]) +
+                  T(0.218509686) * (a.C[1] * b.C[4] + a.C[4] * b.C[1] + a.C[2] * b.C[7] + a.C[7] * b.C[2] + a.C[3] * b.C[8] + a.C[8] * b.C[3]) +
+                  T(-0.126156626) * (a.C[3] * b.C[6] + a.C[6] * b.C[3]);
+    result.C[4] = T(0.282094792) * (a.C[0] * b.C[4] + a.C[4] * b.C[0]) +
+                  T(0.218509686) * (a.C[1] * b.C[3] + a.C[3] * b.C[1]) +
+                  T(-0.180223752) * (a.C[4] * b.C[6] + a.C[6] * b.C[4]) +
+                  T(0.156078347) * (a.C[5] * b.C[7] + a.C[7] * b.C[5]);
+    result.C[5] = T(0.282094792) * (a.C[0] * b.C[5] + a.C[5] * b.C[0]) +
+                  T(0.218509686) * (a.C[1] * b.C[2] + a.C[2] * b.C[1]) +
+                  T(0.156078347) * (a.C[4] * b.C[7] + a.C[7] * b.C[4]) +
+                  T(0.090111876) * (a.C[5] * b.C[6] + a.C[6] * b.C[5]) +
+                  T(-0.156078347) * (a.C[5] * b.C[8] + a.C[8] * b.C[5]);
+    result.C[6] = T(0.282094792) * (a.C[0] * b.C[6] + a.C[6] * b.C[0]) +
+                  T(-0.126156626) * (a.C[1] * b.C[1] + a.C[3] * b.C[3]) +
+                  T(0.252313252) * (a.C[2] * b.C[2]) +
+                  T(-0.180223752) * (a.C[4] * b.C[4] + a.C[8] * b.C[8]) +
+                  T(0.090111876) * (a.C[5] * b.C[5] + a.C[7] * b.C[7]) +
+                  T(0.180223752) * (a.C[6] * b.C[6]);
+    result.C[7] = T(0.282094792) * (a.C[0] * b.C[7] + a.C[7] * b.C[0]) +
+                  T(0.218509686) * (a.C[2] * b.C[3] + a.C[3] * b.C[2]) +
+                  T(0.156078347) * (a.C[4] * b.C[5] + a.C[5] * b.C[4] + a.C[7] * b.C[8] + a.C[8] * b.C[7]) +
+                  T(0.090111876) * (a.C[6] * b.C[7] + a.C[7] * b.C[6]);
+    result.C[8] = T(0.282094792) * (a.C[0] * b.C[8] + a.C[8] * b.C[0]) +
+                  T(-0.218509686) * (a.C[1] * b.C[1]) +
+                  T(0.218509686) * (a.C[3] * b.C[3]) +
+                  T(-0.156078347) * (a.C[5] * b.C[5]) +
+                  T(-0.180223752) * (a.C[6] * b.C[8] + a.C[8] * b.C[6]) +
+                  T(0.156078347) * (a.C[7] * b.C[7]);
+    return result;
+}
+
+// Multiplies a set of L1 SH coefficients with a zonal function that's rotationally symmetric around +Z,
+// such as a visibility or AO lobe in a local frame. The zonal function is given by its m = 0 SH
+// coefficients (C[0] and C[2]) and applies to all components. Takes 10 multiplies/MADs per component.
+template<typename T, int32_t N> L1_Generic<T, N> MultiplyZonal(L1_Generic<T, N> sh, vector<T, 2> zonal)
+{
+    L1_Generic<T, N> result;
+    result.C[0] = T(0.282094792) * (sh.C[0] * zonal.x + sh.C[2] * zonal.y);
+    result.C[1] = T(0.282094792) * (sh.C[1] * zonal.x);
+    result.C[2] = T(0.282094792) * (sh.C[0] * zonal.y + sh.C[2] * zonal.x);
+    result.C[3] = T(0.282094792) * (sh.C[3] * zonal.x);
+    return result;
+}
+
+// Multiplies a set of L2 SH coefficients with a zonal function that's rotationally symmetric around +Z,
+// such as a visibility or AO lobe in a local frame. The zonal function is given by its m = 0 SH
+// coefficients (C[0], C[2], and C[6]) and applies to all components. Takes 49 multiplies/MADs
+// per component.
+template<typename T, int32_t N> L2_Generic<T, N> MultiplyZonal(L2_Generic<T, N> sh, vector<T, 3> zonal)
+{
+    L2_Generic<T, N> result;
+    result.C[0] = T(0.282094792) * (sh.C[0] * zonal.x + sh.C[2] * zonal.y + sh.C[6] * zonal.z);
+    result.C[1] = T(0.282094792) * (sh.C[1] * zonal.x) +
+                  T(-0.126156626) * (sh.C[1] * zonal.z) +
+                  T(0.218509686) * (sh.C[5] * zonal.y);
+    result.C[2] = T(0.282094792) * (sh.C[0] * zonal.y + sh.C[2] * zonal.x) +
+                  T(0.252313252) * (sh.C[2] * zonal.z + sh.C[6] * zonal.y);
+    result.C[3] = T(0.282094792) * (sh.C[3] * zonal.x) +
+                  T(-0.126156626) * (sh.C[3] * zonal.z) +
+                  T(0.218509686) * (sh.C[7] * zonal.y);
+    result.C[4] = T(0.282094792) * (sh.C[4] * zonal.x) +
+                  T(-0.180223752) * (sh.C[4] * zonal.z);
+    result.C[5] = T(0.218509686) * (sh.C[1] * zonal.y) +
+                  T(0.282094792) * (sh.C[5] * zonal.x) +
+                  T(0.090111876) * (sh.C[5] * zonal.z);
+    result.C[6] = T(0.282094792) * (sh.C[0] * zonal.z + sh.C[6] * zonal.x) +
+                  T(0.252313252) * (sh.C[2] * zonal.y) +
+                  T(0.180223752) * (sh.C[6] * zonal.z);
+    result.C[7] = T(0.218509686) * (sh.C[3] * zonal.y) +
+                  T(0.282094792) * (sh.C[7] * zonal.x) +
+                  T(0.090111876) * (sh.C[7] * zonal.z);
+    result.C[8] = T(0.282094792) * (sh.C[8] * zonal.x) +
+                  T(-0.180223752) * (sh.C[8] * zonal.z);
+    return result;
+}
+
 // Projects a delta in a direction onto SH and calculates the dot product with a set of L1 SH coefficients.
 // Can be used to "look up" a value from SH coefficients in a particular direction.
 template<typename T, int32_t N> vector<T, N> Evaluate(L1_Generic<T, N> sh, vector<T, 3> direction)
@@ -245,6 +756,12 @@ template<typename T, int32_t N> vector<T, N> Evaluate(L1_Generic<T, N> sh, vecto
     return DotProduct(projectedDelta, sh);
 }
 
+float16_t3 Evaluate(L1_F16_RGB sh, float16_t3 direction)
+{
+    L1_F16 basis = ProjectOntoL1(direction, float16_t(1.0));
+    return PackedWeightedSum(PackF16RGB(sh), basis.C);
+}
+
 // Projects a delta in a direction onto SH and calculates the dot product with a set of L2 SH coefficients.
 // Can be used to "look up" a value from SH coefficients in a particular direction.
 template<typename T, int32_t N> vector<T, N> Evaluate(L2_Generic<T, N> sh, vector<T, 3> direction)
@@ -253,6 +770,40 @@ template<typename T, int32_t N> vector<T, N> Evaluate(L2_Generic<T, N> sh, vecto
     return DotProduct(projectedDelta, sh);
 }
 
+float16_t3 Evaluate(L2_F16_RGB sh, float16_t3 direction)
+{
+    L2_F16 basis = ProjectOntoL2(direction, float16_t(1.0));
+    return PackedWeightedSum(PackF16RGB(sh), basis.C);
+}
+
+// Evaluates the weighted blend of K sets of L1 SH coefficients in a direction, without blending the
+// coefficients themselves. The basis for the direction is projected once and each set then costs a
+// single weighted dot product, which is cheaper than WeightedSum followed by Evaluate when the blended
+// coefficients aren't needed for anything else.
+template<typename T, int32_t N, int32_t K> vector<T, N> WeightedEvaluate(L1_Generic<T, N> sh[K], T weights[K], vector<T, 3> direction)
+{
+    const L1_Generic<T, N> projectedDelta = ProjectOntoL1(direction, (vector<T, N>)(1.0));
+    vector<T, N> result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(int32_t k = 1; k < K; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+// Evaluates the weighted blend of K sets of L2 SH coefficients in a direction, without blending the
+// coefficients themselves. See the L1 version above.
+template<typename T, int32_t N, int32_t K> vector<T, N> WeightedEvaluate(L2_Generic<T, N> sh[K], T weights[K], vector<T, 3> direction)
+{
+    const L2_Generic<T, N> projectedDelta = ProjectOntoL2(direction, (vector<T, N>)(1.0));
+    vector<T, N> result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(int32_t k = 1; k < K; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
 // Convolves a set of L1 SH coefficients with a set of L1 zonal harmonics
 template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithZH(L1_Generic<T, N> sh, vector<T, 2> zh)
 {
@@ -267,6 +818,24 @@ template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithZH(L1_Generic<T, N>
     return sh;
 }
 
+L1_F16_RGB ConvolveWithZH(L1_F16_RGB sh, float16_t2 zh)
+{
+    PackedL1_F16_RGB packed = PackF16RGB(sh);
+
+    // L0
+    packed.RG[0] *= zh.x;
+
+    // L1
+    packed.RG[1] *= zh.y;
+    packed.RG[2] *= zh.y;
+    packed.RG[3] *= zh.y;
+
+    packed.B[0] *= zh.xy;
+    packed.B[1] *= zh.y;
+
+    return UnpackF16RGB(packed);
+}
+
 // Convolves a set of L2 SH coefficients with a set of L2 zonal harmonics
 template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithZH(L2_Generic<T, N> sh, vector<T, 3> zh)
 {
@@ -288,18 +857,109 @@ template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithZH(L2_Generic<T, N>
     return sh;
 }
 
+L2_F16_RGB ConvolveWithZH(L2_F16_RGB sh, float16_t3 zh)
+{
+    PackedL2_F16_RGB packed = PackF16RGB(sh);
+
+    // L0
+    packed.RG[0] *= zh.x;
+
+    // L1
+    packed.RG[1] *= zh.y;
+    packed.RG[2] *= zh.y;
+    packed.RG[3] *= zh.y;
+
+    // L2
+    packed.RG[4] *= zh.z;
+    packed.RG[5] *= zh.z;
+    packed.RG[6] *= zh.z;
+    packed.RG[7] *= zh.z;
+    packed.RG[8] *= zh.z;
+
+    packed.B[0] *= zh.xy;
+    packed.B[1] *= zh.y;
+    packed.B[2] *= zh.z;
+    packed.B[3] *= zh.z;
+    packed.B[4] *= zh.z;
+
+    return UnpackF16RGB(packed);
+}
+
+// Windowing functions for reducing ringing in SH, such as the negative lobes that show up opposite of a bright
+// light source. These are expressed as per-band ZH scale factors, and can be passed to ConvolveWithZH or to the
+// ConvolveWithCosineLobe/ConvolveWithGGX overloads that take a window, which fuse the window into the convolution
+// so that both are applied with a single ZH multiply. See [0] and [8].
+//
+// The presets below use a window width of L + 1, so that the window reaches zero at the first band
+// that isn't stored.
+static const float32_t2 HannWindowL1 = float32_t2(1.0f, 0.5f);
+static const float32_t3 HannWindowL2 = float32_t3(1.0f, 0.75f, 0.25f);
+static const float32_t2 LanczosWindowL1 = float32_t2(1.0f, 0.636619772f);
+static const float32_t3 LanczosWindowL2 = float32_t3(1.0f, 0.826993343f, 0.413496672f);
+
+// Hann (raised cosine) window with the given width in bands
+template<typename T> vector<T, 2> HannWindowL1ZH(T width)
+{
+    return vector<T, 2>(1.0, T(0.5) + T(0.5) * cos(T(Pi) / width));
+}
+
+template<typename T> vector<T, 3> HannWindowL2ZH(T width)
+{
+    return vector<T, 3>(1.0, T(0.5) + T(0.5) * cos(T(Pi) / width), T(0.5) + T(0.5) * cos(T(2.0 * Pi) / width));
+}
+
+// Lanczos (sinc) window with the given width in bands
+template<typename T> vector<T, 2> LanczosWindowL1ZH(T width)
+{
+    const T x1 = T(Pi) / width;
+    return vector<T, 2>(1.0, sin(x1) / x1);
+}
+
+template<typename T> vector<T, 3> LanczosWindowL2ZH(T width)
+{
+    const T x1 = T(Pi) / width;
+    const T x2 = T(2.0 * Pi) / width;
+    return vector<T, 3>(1.0, sin(x1) / x1, sin(x2) / x2);
+}
+
+// Sloan's deringing window, which minimizes the squared Laplacian of the windowed function for a given
+// strength: 1 / (1 + strength * l^2 * (l + 1)^2). See [8]. A strength of 0 leaves the coefficients
+// unchanged, and the minimal strength that makes a probe's irradiance non-negative can be computed at
+// bake time (see CalculateDeringingStrength in SampleFramework12's Graphics/SH.h).
+template<typename T> vector<T, 2> DeringingWindowL1ZH(T strength)
+{
+    return vector<T, 2>(1.0, T(1.0) / (T(1.0) + T(4.0) * strength));
+}
+
+template<typename T> vector<T, 3> DeringingWindowL2ZH(T strength)
+{
+    return vector<T, 3>(1.0, T(1.0) / (T(1.0) + T(4.0) * strength), T(1.0) / (T(1.0) + T(36.0) * strength));
+}
+
 // Convolves a set of L1 SH coefficients with a cosine lobe. See [2]
 template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithCosineLobe(L1_Generic<T, N> sh)
 {
     return ConvolveWithZH(sh, vector<T, 2>(CosineA0, CosineA1));
 }
 
+// Convolves a set of L1 SH coefficients with a cosine lobe and applies a window, with a single ZH multiply
+template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithCosineLobe(L1_Generic<T, N> sh, vector<T, 2> window)
+{
+    return ConvolveWithZH(sh, vector<T, 2>(CosineA0, CosineA1) * window);
+}
+
 // Convolves a set of L2 SH coefficients with a cosine lobe. See [2]
 template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithCosineLobe(L2_Generic<T, N> sh)
 {
     return ConvolveWithZH(sh, vector<T, 3>(CosineA0, CosineA1, CosineA2));
 }
 
+// Convolves a set of L2 SH coefficients with a cosine lobe and applies a window, with a single ZH multiply
+template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithCosineLobe(L2_Generic<T, N> sh, vector<T, 3> window)
+{
+    return ConvolveWithZH(sh, vector<T, 3>(CosineA0, CosineA1, CosineA2) * window);
+}
+
 // Computes the "optimal linear direction" for a set of SH coefficients, AKA the "dominant" direction. See [0].
 template<typename T, int32_t N> vector<T, 3> OptimalLinearDirection(L1_Generic<T, N> sh)
 {
@@ -333,6 +993,14 @@ template<typename T, int32_t N> vector<T, N> CalculateIrradiance(L1_Generic<T, N
     return Evaluate(convolved, normal);
 }
 
+// The packed fp16 path folds the cosine lobe into the scalar basis instead of convolving all of the
+// RGB coefficients, which is equivalent since the convolution is diagonal.
+float16_t3 CalculateIrradiance(L1_F16_RGB sh, float16_t3 normal)
+{
+    L1_F16 basis = ConvolveWithCosineLobe(ProjectOntoL1(normal, float16_t(1.0)));
+    return PackedWeightedSum(PackF16RGB(sh), basis.C);
+}
+
 // Calculates the irradiance from a set of SH coefficients containing projected radiance.
 // Convolves the radiance with a cosine lobe, and then evaluates the result in the given normal direction.
 // Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
@@ -344,6 +1012,12 @@ template<typename T, int32_t N> vector<T, N> CalculateIrradiance(L2_Generic<T, N
     return Evaluate(convolved, normal);
 }
 
+float16_t3 CalculateIrradiance(L2_F16_RGB sh, float16_t3 normal)
+{
+    L2_F16 basis = ConvolveWithCosineLobe(ProjectOntoL2(normal, float16_t(1.0)));
+    return PackedWeightedSum(PackF16RGB(sh), basis.C);
+}
+
 // Calculates the irradiance from a set of L1 SH coeffecients using the non-linear fit from [1]
 // Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
 // you will want to include the divide-by-pi that's part of the Lambertian BRDF.
@@ -405,33 +1079,350 @@ template<typename T> vector<T, 3> ApproximateGGXAsL2ZH(T ggxAlpha)
     return vector<T, 3>(1.0, l1Scale, l2Scale);
 }
 
+// Rational fits of a GGX lobe at normal incidence as zonal harmonics for bands 1 through 4, of the form
+// (1 + B * alpha + C * alpha^2) / (1 + D * alpha + E * alpha^2). FitGGXZonalHarmonics in SampleFramework12
+// can regenerate these, including view-dependent variants.
+// Generated by FitGGXZonalHarmonics with nDotV = 1.000000, max error per band = (0.001880, 0.004740, 0.007640, 0.010170)
+static const float32_t4 GGXZHFitB = float32_t4(1.28078655f, 0.945101731f, 0.320913301f, -0.984520576f);
+static const float32_t4 GGXZHFitC = float32_t4(6.31756943f, 0.970247081f, -2.48382357f, -1.57792174f);
+static const float32_t4 GGXZHFitD = float32_t4(1.53288419f, 1.64343249f, 1.57508101f, 0.901643281f);
+static const float32_t4 GGXZHFitE = float32_t4(11.1736787f, 13.5192486f, 18.2017438f, 24.9344885f);
+
+// Approximates a GGX lobe with a given roughness/alpha as zonal harmonics for bands 1 through 4 (band 0 is
+// always 1), so that convolving higher-order SH with GGX is still a single multiply per band
+template<typename T> vector<T, 4> ApproximateGGXAsZHBands1To4(T ggxAlpha)
+{
+    const vector<T, 4> numerator = T(1.0) + ggxAlpha * ((vector<T, 4>)GGXZHFitB + ggxAlpha * (vector<T, 4>)GGXZHFitC);
+    const vector<T, 4> denominator = T(1.0) + ggxAlpha * ((vector<T, 4>)GGXZHFitD + ggxAlpha * (vector<T, 4>)GGXZHFitE);
+    return numerator / denominator;
+}
+
 // Convolves a set of L1 SH coefficients with a GGX lobe for a given roughness/alpha
 template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithGGX(L1_Generic<T, N> sh, T ggxAlpha)
 {
     return ConvolveWithZH(sh, ApproximateGGXAsL1ZH(ggxAlpha));
 }
 
+// Convolves a set of L1 SH coefficients with a GGX lobe and applies a window, with a single ZH multiply
+template<typename T, int32_t N> L1_Generic<T, N> ConvolveWithGGX(L1_Generic<T, N> sh, T ggxAlpha, vector<T, 2> window)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL1ZH(ggxAlpha) * window);
+}
+
 // Convolves a set of L2 SH coefficients with a GGX lobe for a given roughness/alpha
 template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithGGX(L2_Generic<T, N> sh, T ggxAlpha)
 {
     return ConvolveWithZH(sh, ApproximateGGXAsL2ZH(ggxAlpha));
 }
 
-// Given a set of L1 SH coefficients represnting incoming radiance, determines a directional light
-// direction, color, and modified roughness value that can be used to compute an approximate specular term. See [5]
-template<typename T, int32_t N> void ExtractSpecularDirLight(L1_Generic<T, N> shRadiance, T sqrtRoughness, out vector<T, 3> lightDir, out vector<T, N> lightColor, out T modifiedSqrtRoughness)
+// Convolves a set of L2 SH coefficients with a GGX lobe and applies a window, with a single ZH multiply
+template<typename T, int32_t N> L2_Generic<T, N> ConvolveWithGGX(L2_Generic<T, N> sh, T ggxAlpha, vector<T, 3> window)
 {
-    vector<T, 3> avgL1 = vector<T, 3>(dot(shRadiance.C[3] / shRadiance.C[0], 0.333f), dot(shRadiance.C[1] / shRadiance.C[0], 0.333f), dot(shRadiance.C[2] / shRadiance.C[0], 0.333f));
-    avgL1 *= T(0.5);
-    T avgL1len = length(avgL1);
+    return ConvolveWithZH(sh, ApproximateGGXAsL2ZH(ggxAlpha) * window);
+}
+
+// Computes the zonal harmonics for a cone of constant unit radiance with the given half-angle, including the
+// sqrt(4 * Pi / (2l + 1)) factor for rotating ZH. The result can be passed to ConvolveWithZH along with
+// the radiance projected in the direction of the cone's axis. See [0]
+template<typename T> vector<T, 2> ConeAsL1ZH(T cosHalfAngle, T sinSqHalfAngle)
+{
+    const T oneMinusCos = sinSqHalfAngle / (T(1.0) + cosHalfAngle);
+    return vector<T, 2>(T(2.0 * Pi) * oneMinusCos, T(Pi) * sinSqHalfAngle);
+}
+
+template<typename T> vector<T, 2> ConeAsL1ZH(T cosHalfAngle)
+{
+    return ConeAsL1ZH(cosHalfAngle, saturate(T(1.0) - cosHalfAngle * cosHalfAngle));
+}
+
+template<typename T> vector<T, 3> ConeAsL2ZH(T cosHalfAngle, T sinSqHalfAngle)
+{
+    const T oneMinusCos = sinSqHalfAngle / (T(1.0) + cosHalfAngle);
+    return vector<T, 3>(T(2.0 * Pi) * oneMinusCos, T(Pi) * sinSqHalfAngle, T(Pi) * cosHalfAngle * sinSqHalfAngle);
+}
+
+template<typename T> vector<T, 3> ConeAsL2ZH(T cosHalfAngle)
+{
+    return ConeAsL2ZH(cosHalfAngle, saturate(T(1.0) - cosHalfAngle * cosHalfAngle));
+}
+
+// Computes a windowed falloff factor that smoothly reaches zero at the given range
+template<typename T> T DistanceFalloffWindow(T distanceSq, T falloffRange)
+{
+    const T ratio = distanceSq / (falloffRange * falloffRange);
+    const T window = saturate(T(1.0) - ratio * ratio);
+    return window * window;
+}
+
+// Squared distances overflow fp16 past 256 units, so the light projections below compute them, and the
+// ratios derived from them, in fp32 and only convert the resulting direction and ZH back to T
+template<typename T> float32_t DistanceSquaredF32(vector<T, 3> offset)
+{
+    const float32_t3 offsetF32 = float32_t3(offset);
+    return dot(offsetF32, offsetF32);
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of L1 SH coefficients
+template<typename T, int32_t N> L1_Generic<T, N> ProjectConeOntoL1(vector<T, 3> axis, T cosHalfAngle, vector<T, N> radiance)
+{
+    return ConvolveWithZH(ProjectOntoL1(axis, radiance), ConeAsL1ZH(cosHalfAngle));
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of L2 SH coefficients
+template<typename T, int32_t N> L2_Generic<T, N> ProjectConeOntoL2(vector<T, 3> axis, T cosHalfAngle, vector<T, N> radiance)
+{
+    return ConvolveWithZH(ProjectOntoL2(axis, radiance), ConeAsL2ZH(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of L1 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies DistanceFalloffWindow.
+template<typename T, int32_t N> L1_Generic<T, N> ProjectSphereOntoL1(vector<T, 3> offset, T radius, vector<T, N> radiance)
+{
+    const float32_t distanceSq = DistanceSquaredF32(offset);
+    const float32_t sinSqHalfAngle = min(float32_t(radius) * float32_t(radius) / distanceSq, 1.0f);
+    const float32_t cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const vector<T, 3> axis = vector<T, 3>(float32_t3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL1(axis, radiance), vector<T, 2>(ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+template<typename T, int32_t N> L1_Generic<T, N> ProjectSphereOntoL1(vector<T, 3> offset, T radius, vector<T, N> radiance, T falloffRange)
+{
+    return ProjectSphereOntoL1(offset, radius, radiance * T(DistanceFalloffWindow(DistanceSquaredF32(offset), float32_t(falloffRange))));
+}
+
+// Projects a sphere light with constant radiance onto a set of L2 SH coefficients, see ProjectSphereOntoL1
+template<typename T, int32_t N> L2_Generic<T, N> ProjectSphereOntoL2(vector<T, 3> offset, T radius, vector<T, N> radiance)
+{
+    const float32_t distanceSq = DistanceSquaredF32(offset);
+    const float32_t sinSqHalfAngle = min(float32_t(radius) * float32_t(radius) / distanceSq, 1.0f);
+    const float32_t cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const vector<T, 3> axis = vector<T, 3>(float32_t3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL2(axis, radiance), vector<T, 3>(ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+template<typename T, int32_t N> L2_Generic<T, N> ProjectSphereOntoL2(vector<T, 3> offset, T radius, vector<T, N> radiance, T falloffRange)
+{
+    return ProjectSphereOntoL2(offset, radius, radiance * T(DistanceFalloffWindow(DistanceSquaredF32(offset), float32_t(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of L1 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+template<typename T, int32_t N> L1_Generic<T, N> ProjectDiskOntoL1(vector<T, 3> offset, vector<T, 3> diskNormal, T radius, vector<T, N> radiance)
+{
+    const float32_t distanceSq = DistanceSquaredF32(offset);
+    const float32_t3 axis = float32_t3(offset) * rsqrt(distanceSq);
+    const float32_t cosTheta = saturate(-dot(axis, float32_t3(diskNormal)));
+    const float32_t oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float32_t(radius) * float32_t(radius)))) * cosTheta;
+    return ProjectConeOntoL1(vector<T, 3>(axis), T(1.0f - oneMinusCos), radiance);
+}
+
+template<typename T, int32_t N> L1_Generic<T, N> ProjectDiskOntoL1(vector<T, 3> offset, vector<T, 3> diskNormal, T radius, vector<T, N> radiance, T falloffRange)
+{
+    return ProjectDiskOntoL1(offset, diskNormal, radius, radiance * T(DistanceFalloffWindow(DistanceSquaredF32(offset), float32_t(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of L2 SH coefficients, see ProjectDiskOntoL1
+template<typename T, int32_t N> L2_Generic<T, N> ProjectDiskOntoL2(vector<T, 3> offset, vector<T, 3> diskNormal, T radius, vector<T, N> radiance)
+{
+    const float32_t distanceSq = DistanceSquaredF32(offset);
+    const float32_t3 axis = float32_t3(offset) * rsqrt(distanceSq);
+    const float32_t cosTheta = saturate(-dot(axis, float32_t3(diskNormal)));
+    const float32_t oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float32_t(radius) * float32_t(radius)))) * cosTheta;
+    return ProjectConeOntoL2(vector<T, 3>(axis), T(1.0f - oneMinusCos), radiance);
+}
+
+template<typename T, int32_t N> L2_Generic<T, N> ProjectDiskOntoL2(vector<T, 3> offset, vector<T, 3> diskNormal, T radius, vector<T, N> radiance, T falloffRange)
+{
+    return ProjectDiskOntoL2(offset, diskNormal, radius, radiance * T(DistanceFalloffWindow(DistanceSquaredF32(offset), float32_t(falloffRange))));
+}
+
+// Maximum number of vertices supported by ProjectPolygonOntoL2
+static const int32_t MaxPolygonVertices = 8;
+
+// Projects a polygonal light with constant radiance onto a set of L2 SH coefficients. The vertices are the
+// positions of the polygon's corners relative to the shading point, and do not need to be normalized.
+// Either winding order can be used. The projection is exact: the solid angle gives L0, and the first and
+// second moments of the spherical polygon give L1 and L2, all of which reduce to a sum over the polygon's
+// edges (see [6] and [7]). The cost is a normalize, a cross product, and two atan2 per edge.
+template<typename T, int32_t N> L2_Generic<T, N> ProjectPolygonOntoL2(vector<T, 3> vertices[MaxPolygonVertices], uint32_t count, vector<T, N> radiance)
+{
+    T solidAngle = T(0.0);
+    vector<T, 3> firstMoment = T(0.0);
+    vector<T, 3> secondMomentDiag = T(0.0);         // xx, yy, zz
+    vector<T, 3> secondMomentOffDiag = T(0.0);      // xy, yz, xz
+
+    const vector<T, 3> v0 = normalize(vertices[0]);
+    vector<T, 3> vi = v0;
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        vector<T, 3> vj = v0;
+        if(i + 1 < count)
+            vj = normalize(vertices[i + 1]);
+
+        const vector<T, 3> edgeCross = cross(vi, vj);
+        const T cosTheta = dot(vi, vj);
+        const T sinTheta = length(edgeCross);
+
+        // Signed solid angle of the triangle fan (v0, vi, vj), see [6]. The first and last edges
+        // contribute zero since their triple product is zero.
+        solidAngle += T(2.0) * atan2(dot(v0, edgeCross), T(1.0) + dot(v0, vi) + cosTheta + dot(vj, v0));
+
+        // Integral of the arc between vi and vj weighted by the edge plane normal
+        firstMoment += edgeCross * (atan2(sinTheta, cosTheta) / max(sinTheta, T(0.0001)));
+
+        // Outer product of the integrated arc direction with the edge plane normal
+        const vector<T, 3> arc = (vi + vj) / (T(1.0) + cosTheta);
+        secondMomentDiag += arc * edgeCross;
+        secondMomentOffDiag += vector<T, 3>(arc.x * edgeCross.y + arc.y * edgeCross.x,
+                                            arc.y * edgeCross.z + arc.z * edgeCross.y,
+                                            arc.x * edgeCross.z + arc.z * edgeCross.x);
+
+        vi = vj;
+    }
+
+    // The edge sums flip sign with the winding order, which the sign of the solid angle tells us
+    const T windingSign = solidAngle < T(0.0) ? T(-1.0) : T(1.0);
+    solidAngle = abs(solidAngle);
+    firstMoment *= T(0.5) * windingSign;
+    secondMomentDiag = (solidAngle + windingSign * secondMomentDiag) / T(3.0);
+    secondMomentOffDiag *= windingSign / T(6.0);
+
+    L2_Generic<T, N> sh;
+
+    // L0
+    sh.C[0] = T(BasisL0) * solidAngle * radiance;
+
+    // L1
+    sh.C[1] = T(BasisL1) * firstMoment.y * radiance;
+    sh.C[2] = T(BasisL1) * firstMoment.z * radiance;
+    sh.C[3] = T(BasisL1) * firstMoment.x * radiance;
+
+    // L2
+    sh.C[4] = T(BasisL2_MN2) * secondMomentOffDiag.x * radiance;
+    sh.C[5] = T(BasisL2_MN1) * secondMomentOffDiag.y * radiance;
+    sh.C[6] = T(BasisL2_M0) * (T(3.0) * secondMomentDiag.z - solidAngle) * radiance;
+    sh.C[7] = T(BasisL2_M1) * secondMomentOffDiag.z * radiance;
+    sh.C[8] = T(BasisL2_M2) * (secondMomentDiag.x - secondMomentDiag.y) * radiance;
+
+    return sh;
+}
+
+// Projects a quad light with constant radiance onto a set of L2 SH coefficients, see ProjectPolygonOntoL2
+template<typename T, int32_t N> L2_Generic<T, N> ProjectQuadOntoL2(vector<T, 3> v0, vector<T, 3> v1, vector<T, 3> v2, vector<T, 3> v3, vector<T, N> radiance)
+{
+    vector<T, 3> vertices[MaxPolygonVertices];
+    vertices[0] = v0;
+    vertices[1] = v1;
+    vertices[2] = v2;
+    vertices[3] = v3;
+    [unroll]
+    for(int32_t i = 4; i < MaxPolygonVertices; ++i)
+        vertices[i] = v0;
+
+    return ProjectPolygonOntoL2(vertices, 4, radiance);
+}
+
+// Given a set of L1 SH coefficients represnting incoming radiance, determines a directional light
+// direction, color, and modified roughness value that can be used to compute an approximate specular term. See [5]
+template<typename T, int32_t N> void ExtractSpecularDirLight(L1_Generic<T, N> shRadiance, T sqrtRoughness, out vector<T, 3> lightDir, out vector<T, N> lightColor, out T modifiedSqrtRoughness)
+{
+    vector<T, 3> avgL1 = vector<T, 3>(dot(shRadiance.C[3] / shRadiance.C[0], 0.333f), dot(shRadiance.C[1] / shRadiance.C[0], 0.333f), dot(shRadiance.C[2] / shRadiance.C[0], 0.333f));
+    avgL1 *= T(0.5);
+    T avgL1len = length(avgL1);
 
     lightDir = avgL1 / avgL1len;
     lightColor = Evaluate(shRadiance, lightDir) * T(Pi);
     modifiedSqrtRoughness = saturate(sqrtRoughness / sqrt(avgL1len));
 }
 
+// Returns the scale and bias to apply to the specular albedo (F0) for the environment BRDF term of the
+// split-sum approximation with a GGX specular lobe, using curves fitted to Monte Carlo integration.
+// A table generated offline (see GenerateEnvironmentBRDFTable in SampleFramework12) can be sampled
+// instead and passed to CalculatePrefilteredSpecular for a more accurate result.
+template<typename T> vector<T, 2> ApproximateGGXEnvironmentBRDF(T nDotV, T sqrtRoughness)
+{
+    const T nDotV2 = nDotV * nDotV;
+    const T sqrtRoughness2 = sqrtRoughness * sqrtRoughness;
+    const T sqrtRoughness3 = sqrtRoughness2 * sqrtRoughness;
+
+    const T delta = T(0.991086418474895) + (T(0.412367709802119) * sqrtRoughness * nDotV2) -
+                    (T(0.363848256078895) * sqrtRoughness2) -
+                    (T(0.758634385642633) * nDotV * sqrtRoughness2);
+    const T bias = saturate((T(0.0306613448029984) * sqrtRoughness) + T(0.0238299731830387) /
+                            (T(0.0272458171384516) + sqrtRoughness3 + nDotV2) -
+                            T(0.0454747751719356));
+
+    const T scale = saturate(delta - bias);
+    return vector<T, 2>(scale, bias);
+}
+
+// Returns the direction to evaluate pre-filtered specular in, which bends the reflection vector towards
+// the normal as roughness increases to account for the lobe becoming off-specular
+template<typename T> vector<T, 3> PrefilteredSpecularDirection(vector<T, 3> view, vector<T, 3> normal, T ggxAlpha)
+{
+    const vector<T, 3> reflectDir = reflect(-view, normal);
+    return normalize(lerp(reflectDir, normal, saturate(ggxAlpha - T(0.25))));
+}
+
+// Computes approximate specular from radiance encoded as L1 SH, by treating the SH radiance as an
+// environment map pre-filtered with a GGX lobe and combining it with the environment BRDF term of the
+// split-sum approximation. envBRDF is the (scale, bias) pair for the current view angle and roughness,
+// from either ApproximateGGXEnvironmentBRDF or a pre-computed table.
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L1_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness, vector<T, 2> envBRDF)
+{
+    const T ggxAlpha = sqrtRoughness * sqrtRoughness;
+    const vector<T, 3> lookupDir = PrefilteredSpecularDirection(view, normal, ggxAlpha);
+    const vector<T, N> specLightColor = max(Evaluate(ConvolveWithGGX(shRadiance, ggxAlpha), lookupDir), T(0.0));
+    return (specularAlbedo * envBRDF.x + envBRDF.y) * specLightColor;
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L1_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness)
+{
+    const vector<T, 2> envBRDF = ApproximateGGXEnvironmentBRDF(saturate(dot(normal, view)), sqrtRoughness);
+    return CalculatePrefilteredSpecular(shRadiance, view, normal, specularAlbedo, sqrtRoughness, envBRDF);
+}
+
+// Computes approximate specular from radiance encoded as L2 SH, see the L1 version above
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L2_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness, vector<T, 2> envBRDF)
+{
+    const T ggxAlpha = sqrtRoughness * sqrtRoughness;
+    const vector<T, 3> lookupDir = PrefilteredSpecularDirection(view, normal, ggxAlpha);
+    const vector<T, N> specLightColor = max(Evaluate(ConvolveWithGGX(shRadiance, ggxAlpha), lookupDir), T(0.0));
+    return (specularAlbedo * envBRDF.x + envBRDF.y) * specLightColor;
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L2_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness)
+{
+    const vector<T, 2> envBRDF = ApproximateGGXEnvironmentBRDF(saturate(dot(normal, view)), sqrtRoughness);
+    return CalculatePrefilteredSpecular(shRadiance, view, normal, specularAlbedo, sqrtRoughness, envBRDF);
+}
+
+// Converts a unit quaternion (xyz = axis * sin(angle / 2), w = cos(angle / 2)) to a rotation matrix in the
+// convention used by Rotate, matching QuatTo3x3 from SampleFramework12's Quaternion.hlsl
+template<typename TQ> matrix<TQ, 3, 3> QuaternionToRotationMatrix(vector<TQ, 4> quaternion)
+{
+    const vector<TQ, 3> q2 = quaternion.xyz * TQ(2.0);
+    const TQ xx = quaternion.x * q2.x;
+    const TQ yy = quaternion.y * q2.y;
+    const TQ zz = quaternion.z * q2.z;
+    const TQ xy = quaternion.x * q2.y;
+    const TQ xz = quaternion.x * q2.z;
+    const TQ yz = quaternion.y * q2.z;
+    const TQ wx = quaternion.w * q2.x;
+    const TQ wy = quaternion.w * q2.y;
+    const TQ wz = quaternion.w * q2.z;
+
+    return matrix<TQ, 3, 3>(TQ(1.0) - yy - zz, xy + wz, xz - wy,
+                            xy - wz, TQ(1.0) - xx - zz, yz + wx,
+                            xz + wy, yz - wx, TQ(1.0) - xx - yy);
+}
+
 // Rotates a set of L1 coefficients by a rotation matrix. Adapted from DirectX::XMSHRotate [3]
-template<typename T, int32_t N> L1_Generic<T, N> Rotate(L1_Generic<T, N> sh, float3x3 rotation)
+// The rotation is performed in the precision of the matrix, so a float16_t3x3 can be used with fp16 SH.
+template<typename T, int32_t N, typename TR> L1_Generic<T, N> Rotate(L1_Generic<T, N> sh, matrix<TR, 3, 3> rotation)
 {
     L1_Generic<T, N> result;
 
@@ -442,33 +1433,59 @@ template<typename T, int32_t N> L1_Generic<T, N> Rotate(L1_Generic<T, N> sh, flo
     [unroll]
     for(uint i = 0; i < N; ++i)
     {
-        vector<T, 3> dir = vector<T, 3>(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
-        dir = vector<T, 3>(mul(dir, rotation));
-        result.C[3][i] = dir.x;
-        result.C[1][i] = dir.y;
-        result.C[2][i] = dir.z;
+        vector<TR, 3> dir = vector<TR, 3>(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        dir = mul(dir, rotation);
+        result.C[3][i] = T(dir.x);
+        result.C[1][i] = T(dir.y);
+        result.C[2][i] = T(dir.z);
+    }
+
+    return result;
+}
+
+// Rotates a set of L1 coefficients by a unit quaternion. Band 1 rotates like a vector, so the quaternion is
+// applied directly without expanding it to a matrix. The rotation is performed in the precision of the
+// quaternion, so a float16_t4 gives an fp16 rotation path.
+template<typename T, int32_t N, typename TQ> L1_Generic<T, N> Rotate(L1_Generic<T, N> sh, vector<TQ, 4> quaternion)
+{
+    L1_Generic<T, N> result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    [unroll]
+    for(uint i = 0; i < N; ++i)
+    {
+        vector<TQ, 3> dir = vector<TQ, 3>(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        const vector<TQ, 3> t = TQ(2.0) * cross(quaternion.xyz, dir);
+        dir += quaternion.w * t + cross(quaternion.xyz, t);
+        result.C[3][i] = T(dir.x);
+        result.C[1][i] = T(dir.y);
+        result.C[2][i] = T(dir.z);
     }
 
     return result;
 }
 
 // Rotates a set of L2 coefficients by a rotation matrix. Adapted from DirectX::XMSHRotate [3]
-template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, float3x3 rotation)
+// The rotation is performed in the precision of the matrix, so a float16_t3x3 can be used with fp16 SH.
+template<typename T, int32_t N, typename TR> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, matrix<TR, 3, 3> rotation)
 {
     // The basis vectors used in DXSH are slightly different than ours,
     // the X and Z are flipped relative to what's used above in ProjectOntoL1/L2.
     // Hence there are several negations here to adapt the code work for us.
-    const float32_t r00 = rotation._m00;
-    const float32_t r10 = rotation._m01;
-    const float32_t r20 = -rotation._m02;
+    const TR r00 = rotation._m00;
+    const TR r10 = rotation._m01;
+    const TR r20 = -rotation._m02;
 
-    const float32_t r01 = rotation._m10;
-    const float32_t r11 = rotation._m11;
-    const float32_t r21 = -rotation._m12;
+    const TR r01 = rotation._m10;
+    const TR r11 = rotation._m11;
+    const TR r21 = -rotation._m12;
 
-    const float32_t r02 = -rotation._m20;
-    const float32_t r12 = -rotation._m21;
-    const float32_t r22 = rotation._m22;
+    const TR r02 = -rotation._m20;
+    const TR r12 = -rotation._m21;
+    const TR r22 = rotation._m22;
 
     L2_Generic<T, N> result;
 
@@ -481,29 +1498,29 @@ template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, flo
     result.C[3] = vector<T, N>(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
 
     // L2
-    const float32_t t41 = r01 * r00;
-    const float32_t t43 = r11 * r10;
-    const float32_t t48 = r11 * r12;
-    const float32_t t50 = r01 * r02;
-    const float32_t t55 = r02 * r02;
-    const float32_t t57 = r22 * r22;
-    const float32_t t58 = r12 * r12;
-    const float32_t t61 = r00 * r02;
-    const float32_t t63 = r10 * r12;
-    const float32_t t68 = r10 * r10;
-    const float32_t t70 = r01 * r01;
-    const float32_t t72 = r11 * r11;
-    const float32_t t74 = r00 * r00;
-    const float32_t t76 = r21 * r21;
-    const float32_t t78 = r20 * r20;
-
-    const float32_t v173 = 0.1732050808e1f;
-    const float32_t v577 = 0.5773502693e0f;
-    const float32_t v115 = 0.1154700539e1f;
-    const float32_t v288 = 0.2886751347e0f;
-    const float32_t v866 = 0.8660254040e0f;
-
-    float32_t r[25];
+    const TR t41 = r01 * r00;
+    const TR t43 = r11 * r10;
+    const TR t48 = r11 * r12;
+    const TR t50 = r01 * r02;
+    const TR t55 = r02 * r02;
+    const TR t57 = r22 * r22;
+    const TR t58 = r12 * r12;
+    const TR t61 = r00 * r02;
+    const TR t63 = r10 * r12;
+    const TR t68 = r10 * r10;
+    const TR t70 = r01 * r01;
+    const TR t72 = r11 * r11;
+    const TR t74 = r00 * r00;
+    const TR t76 = r21 * r21;
+    const TR t78 = r20 * r20;
+
+    const TR v173 = TR(0.1732050808e1);
+    const TR v577 = TR(0.5773502693e0);
+    const TR v115 = TR(0.1154700539e1);
+    const TR v288 = TR(0.2886751347e0);
+    const TR v866 = TR(0.8660254040e0);
+
+    TR r[25];
     r[0] = r11 * r00 + r01 * r10;
     r[1] = -r01 * r12 - r11 * r02;
     r[2] =  v173 * r02 * r12;
@@ -516,7 +1533,7 @@ template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, flo
     r[9] = -r10 * r20 + r11 * r21;
     r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
     r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
-    r[12] = -0.5f * (t55 + t58) + t57;
+    r[12] = TR(-0.5) * (t55 + t58) + t57;
     r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
     r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
     r[15] = -r01 * r20 -  r21 * r00;
@@ -528,7 +1545,7 @@ template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, flo
     r[21] = -t50 + t48;
     r[22] =  v866 * (t55 - t58);
     r[23] = t63 - t61;
-    r[24] = 0.5f * (t74 - t68 - t70 +  t72);
+    r[24] = TR(0.5) * (t74 - t68 - t70 +  t72);
 
     for(int32_t i = 0; i < 5; ++i)
     {
@@ -541,6 +1558,820 @@ template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, flo
     return result;
 }
 
+// Rotates a set of L2 coefficients by a unit quaternion. Unlike band 1, band 2 needs the quadratic terms of
+// the rotation matrix, so the matrix is built once directly from the quaternion in its precision.
+template<typename T, int32_t N, typename TQ> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, vector<TQ, 4> quaternion)
+{
+    return Rotate(sh, QuaternionToRotationMatrix(quaternion));
+}
+
+// Channel-major ("planar") storage for SH coefficients. Instead of storing NumCoefficients vectors
+// with N components, this stores N arrays of NumCoefficients scalars so that all of the coefficients
+// for a single channel are contiguous. Depending on the hardware and how the data is fetched this
+// layout can load and evaluate more efficiently than the coefficient-major SH type, so shaders can
+// use ToPlanar/FromPlanar to pick whichever layout works best. The functions that are naturally
+// per-channel (dot products, evaluation, convolution, irradiance) operate directly on the planar
+// layout, the remaining ones convert to the coefficient-major layout and back.
+template<typename T, int32_t N, int32_t L> struct SHPlanar
+{
+    static const int32_t NumCoefficients = (L + 1) * (L + 1);
+
+    T C[N][NumCoefficients];
+
+    static SHPlanar<T, N, L> Zero()
+    {
+        return (SHPlanar<T, N, L>)0;
+    }
+
+    SHPlanar<T, N, L> operator+(SHPlanar<T, N, L> other)
+    {
+        SHPlanar<T, N, L> result;
+        [unroll]
+        for(int32_t c = 0; c < N; ++c)
+            [unroll]
+            for(int32_t i = 0; i < NumCoefficients; ++i)
+                result.C[c][i] = C[c][i] + other.C[c][i];
+        return result;
+    }
+
+    SHPlanar<T, N, L> operator-(SHPlanar<T, N, L> other)
+    {
+        SHPlanar<T, N, L> result;
+        [unroll]
+        for(int32_t c = 0; c < N; ++c)
+            [unroll]
+            for(int32_t i = 0; i < NumCoefficients; ++i)
+                result.C[c][i] = C[c][i] - other.C[c][i];
+        return result;
+    }
+
+    SHPlanar<T, N, L> operator*(vector<T, N> value)
+    {
+        SHPlanar<T, N, L> result;
+        [unroll]
+        for(int32_t c = 0; c < N; ++c)
+            [unroll]
+            for(int32_t i = 0; i < NumCoefficients; ++i)
+                result.C[c][i] = C[c][i] * value[c];
+        return result;
+    }
+
+    SHPlanar<T, N, L> operator/(vector<T, N> value)
+    {
+        SHPlanar<T, N, L> result;
+        [unroll]
+        for(int32_t c = 0; c < N; ++c)
+            [unroll]
+            for(int32_t i = 0; i < NumCoefficients; ++i)
+                result.C[c][i] = C[c][i] / value[c];
+        return result;
+    }
+};
+
+template<typename T, int32_t N = 1> using L1Planar_Generic = SHPlanar<T, N, 1>;
+using L1_RGB_Planar = L1Planar_Generic<float32_t, 3>;
+using L1_F16_RGB_Planar = L1Planar_Generic<float16_t, 3>;
+
+template<typename T, int32_t N = 1> using L2Planar_Generic = SHPlanar<T, N, 2>;
+using L2_RGB_Planar = L2Planar_Generic<float32_t, 3>;
+using L2_F16_RGB_Planar = L2Planar_Generic<float16_t, 3>;
+
+// Converts a set of SH coefficients from coefficient-major to channel-major storage
+template<typename T, int32_t N, int32_t L> SHPlanar<T, N, L> ToPlanar(SH<T, N, L> sh)
+{
+    SHPlanar<T, N, L> result;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+            result.C[c][i] = sh.C[i][c];
+    return result;
+}
+
+// Converts a set of SH coefficients from channel-major to coefficient-major storage
+template<typename T, int32_t N, int32_t L> SH<T, N, L> FromPlanar(SHPlanar<T, N, L> sh)
+{
+    SH<T, N, L> result;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < SH<T, N, L>::NumCoefficients; ++i)
+            result.C[i][c] = sh.C[c][i];
+    return result;
+}
+
+// Projects a value in a single direction onto a set of channel-major L1 SH coefficients
+template<typename T, int32_t N> L1Planar_Generic<T, N> ProjectOntoL1Planar(vector<T, 3> direction, vector<T, N> value)
+{
+    L1_Generic<T, 1> basis = ProjectOntoL1(direction, T(1.0));
+
+    L1Planar_Generic<T, N> sh;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < L1_Generic<T, 1>::NumCoefficients; ++i)
+            sh.C[c][i] = basis.C[i].x * value[c];
+    return sh;
+}
+
+// Projects a value in a single direction onto a set of channel-major L2 SH coefficients
+template<typename T, int32_t N> L2Planar_Generic<T, N> ProjectOntoL2Planar(vector<T, 3> direction, vector<T, N> value)
+{
+    L2_Generic<T, 1> basis = ProjectOntoL2(direction, T(1.0));
+
+    L2Planar_Generic<T, N> sh;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < L2_Generic<T, 1>::NumCoefficients; ++i)
+            sh.C[c][i] = basis.C[i].x * value[c];
+    return sh;
+}
+
+template<typename T> L1Planar_Generic<T, 3> ToRGB(L1Planar_Generic<T, 1> sh)
+{
+    return ToPlanar(ToRGB(FromPlanar(sh)));
+}
+
+template<typename T> L2Planar_Generic<T, 3> ToRGB(L2Planar_Generic<T, 1> sh)
+{
+    return ToPlanar(ToRGB(FromPlanar(sh)));
+}
+
+template<typename T, int32_t N> L1Planar_Generic<T, N> L2toL1(L2Planar_Generic<T, N> sh)
+{
+    L1Planar_Generic<T, N> result;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < L1Planar_Generic<T, N>::NumCoefficients; ++i)
+            result.C[c][i] = sh.C[c][i];
+    return result;
+}
+
+template<typename TDst, typename T, int32_t N, int32_t L> SHPlanar<TDst, N, L> Cast(SHPlanar<T, N, L> sh)
+{
+    SHPlanar<TDst, N, L> result;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < SHPlanar<T, N, L>::NumCoefficients; ++i)
+            result.C[c][i] = TDst(sh.C[c][i]);
+    return result;
+}
+
+template<typename T, int32_t N, int32_t L> SHPlanar<T, N, L> Lerp(SHPlanar<T, N, L> x, SHPlanar<T, N, L> y, T s)
+{
+    return x * (T(1.0) - s) + y * s;
+}
+
+template<typename T, int32_t N, int32_t L, int32_t K> SHPlanar<T, N, L> WeightedSum(SHPlanar<T, N, L> sh[K], T weights[K])
+{
+    SHPlanar<T, N, L> result;
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+    {
+        [unroll]
+        for(int32_t i = 0; i < SHPlanar<T, N, L>::NumCoefficients; ++i)
+        {
+            result.C[c][i] = sh[0].C[c][i] * weights[0];
+            [unroll]
+            for(int32_t k = 1; k < K; ++k)
+                result.C[c][i] += sh[k].C[c][i] * weights[k];
+        }
+    }
+
+    return result;
+}
+
+// Calculates the per-channel dot product of two sets of channel-major SH coefficients
+template<typename T, int32_t N, int32_t L> vector<T, N> DotProduct(SHPlanar<T, N, L> a, SHPlanar<T, N, L> b)
+{
+    vector<T, N> result = T(0.0);
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < SHPlanar<T, N, L>::NumCoefficients; ++i)
+            result[c] += a.C[c][i] * b.C[c][i];
+    return result;
+}
+
+// Calculates the dot product of each channel of a set of channel-major SH coefficients with a
+// single set of scalar SH coefficients, such as a projected direction
+template<typename T, int32_t N, int32_t L> vector<T, N> DotProduct(SHPlanar<T, N, L> sh, SH<T, 1, L> weights)
+{
+    vector<T, N> result = T(0.0);
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        [unroll]
+        for(int32_t i = 0; i < SHPlanar<T, N, L>::NumCoefficients; ++i)
+            result[c] += sh.C[c][i] * weights.C[i].x;
+    return result;
+}
+
+template<typename T, int32_t N> vector<T, N> Evaluate(L1Planar_Generic<T, N> sh, vector<T, 3> direction)
+{
+    return DotProduct(sh, ProjectOntoL1(direction, T(1.0)));
+}
+
+template<typename T, int32_t N> vector<T, N> Evaluate(L2Planar_Generic<T, N> sh, vector<T, 3> direction)
+{
+    return DotProduct(sh, ProjectOntoL2(direction, T(1.0)));
+}
+
+template<typename T, int32_t N, int32_t K> vector<T, N> WeightedEvaluate(L1Planar_Generic<T, N> sh[K], T weights[K], vector<T, 3> direction)
+{
+    const L1_Generic<T, 1> basis = ProjectOntoL1(direction, T(1.0));
+    vector<T, N> result = DotProduct(sh[0], basis) * weights[0];
+    [unroll]
+    for(int32_t k = 1; k < K; ++k)
+        result += DotProduct(sh[k], basis) * weights[k];
+
+    return result;
+}
+
+template<typename T, int32_t N, int32_t K> vector<T, N> WeightedEvaluate(L2Planar_Generic<T, N> sh[K], T weights[K], vector<T, 3> direction)
+{
+    const L2_Generic<T, 1> basis = ProjectOntoL2(direction, T(1.0));
+    vector<T, N> result = DotProduct(sh[0], basis) * weights[0];
+    [unroll]
+    for(int32_t k = 1; k < K; ++k)
+        result += DotProduct(sh[k], basis) * weights[k];
+
+    return result;
+}
+
+template<typename T, int32_t N> L1Planar_Generic<T, N> ConvolveWithZH(L1Planar_Generic<T, N> sh, vector<T, 2> zh)
+{
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+    {
+        // L0
+        sh.C[c][0] *= zh.x;
+
+        // L1
+        sh.C[c][1] *= zh.y;
+        sh.C[c][2] *= zh.y;
+        sh.C[c][3] *= zh.y;
+    }
+
+    return sh;
+}
+
+template<typename T, int32_t N> L2Planar_Generic<T, N> ConvolveWithZH(L2Planar_Generic<T, N> sh, vector<T, 3> zh)
+{
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+    {
+        // L0
+        sh.C[c][0] *= zh.x;
+
+        // L1
+        sh.C[c][1] *= zh.y;
+        sh.C[c][2] *= zh.y;
+        sh.C[c][3] *= zh.y;
+
+        // L2
+        sh.C[c][4] *= zh.z;
+        sh.C[c][5] *= zh.z;
+        sh.C[c][6] *= zh.z;
+        sh.C[c][7] *= zh.z;
+        sh.C[c][8] *= zh.z;
+    }
+
+    return sh;
+}
+
+template<typename T, int32_t N> L1Planar_Generic<T, N> ConvolveWithCosineLobe(L1Planar_Generic<T, N> sh)
+{
+    return ConvolveWithZH(sh, vector<T, 2>(CosineA0, CosineA1));
+}
+
+template<typename T, int32_t N> L2Planar_Generic<T, N> ConvolveWithCosineLobe(L2Planar_Generic<T, N> sh)
+{
+    return ConvolveWithZH(sh, vector<T, 3>(CosineA0, CosineA1, CosineA2));
+}
+
+template<typename T, int32_t N> L1Planar_Generic<T, N> ConvolveWithGGX(L1Planar_Generic<T, N> sh, T ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL1ZH(ggxAlpha));
+}
+
+template<typename T, int32_t N> L2Planar_Generic<T, N> ConvolveWithGGX(L2Planar_Generic<T, N> sh, T ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL2ZH(ggxAlpha));
+}
+
+// As with the packed fp16 path, the cosine lobe is folded into the scalar basis instead of convolving
+// every channel of the coefficients.
+template<typename T, int32_t N> vector<T, N> CalculateIrradiance(L1Planar_Generic<T, N> sh, vector<T, 3> normal)
+{
+    return DotProduct(sh, ConvolveWithCosineLobe(ProjectOntoL1(normal, T(1.0))));
+}
+
+template<typename T, int32_t N> vector<T, N> CalculateIrradiance(L2Planar_Generic<T, N> sh, vector<T, 3> normal)
+{
+    return DotProduct(sh, ConvolveWithCosineLobe(ProjectOntoL2(normal, T(1.0))));
+}
+
+template<typename T, int32_t N> vector<T, 3> OptimalLinearDirection(L1Planar_Generic<T, N> sh)
+{
+    vector<T, 3> direction = T(0.0);
+    [unroll]
+    for(int32_t c = 0; c < N; ++c)
+        direction += vector<T, 3>(sh.C[c][3], sh.C[c][1], sh.C[c][2]);
+    return normalize(direction);
+}
+
+template<typename T, int32_t N> void ApproximateDirectionalLight(L1Planar_Generic<T, N> sh, out vector<T, 3> direction, out vector<T, N> color)
+{
+    ApproximateDirectionalLight(FromPlanar(sh), direction, color);
+}
+
+template<typename T, int32_t N> vector<T, N> CalculateIrradianceGeomerics(L1Planar_Generic<T, N> sh, vector<T, 3> normal)
+{
+    return CalculateIrradianceGeomerics(FromPlanar(sh), normal);
+}
+
+template<typename T, int32_t N> vector<T, N> CalculateIrradianceL1ZH3Hallucinate(L1Planar_Generic<T, N> sh, vector<T, 3> normal)
+{
+    return CalculateIrradianceL1ZH3Hallucinate(FromPlanar(sh), normal);
+}
+
+template<typename T, int32_t N> void ExtractSpecularDirLight(L1Planar_Generic<T, N> shRadiance, T sqrtRoughness, out vector<T, 3> lightDir, out vector<T, N> lightColor, out T modifiedSqrtRoughness)
+{
+    ExtractSpecularDirLight(FromPlanar(shRadiance), sqrtRoughness, lightDir, lightColor, modifiedSqrtRoughness);
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L1Planar_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness, vector<T, 2> envBRDF)
+{
+    const T ggxAlpha = sqrtRoughness * sqrtRoughness;
+    const vector<T, 3> lookupDir = PrefilteredSpecularDirection(view, normal, ggxAlpha);
+    const vector<T, N> specLightColor = max(Evaluate(ConvolveWithGGX(shRadiance, ggxAlpha), lookupDir), T(0.0));
+    return (specularAlbedo * envBRDF.x + envBRDF.y) * specLightColor;
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L1Planar_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness)
+{
+    const vector<T, 2> envBRDF = ApproximateGGXEnvironmentBRDF(saturate(dot(normal, view)), sqrtRoughness);
+    return CalculatePrefilteredSpecular(shRadiance, view, normal, specularAlbedo, sqrtRoughness, envBRDF);
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L2Planar_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness, vector<T, 2> envBRDF)
+{
+    const T ggxAlpha = sqrtRoughness * sqrtRoughness;
+    const vector<T, 3> lookupDir = PrefilteredSpecularDirection(view, normal, ggxAlpha);
+    const vector<T, N> specLightColor = max(Evaluate(ConvolveWithGGX(shRadiance, ggxAlpha), lookupDir), T(0.0));
+    return (specularAlbedo * envBRDF.x + envBRDF.y) * specLightColor;
+}
+
+template<typename T, int32_t N> vector<T, N> CalculatePrefilteredSpecular(L2Planar_Generic<T, N> shRadiance, vector<T, 3> view, vector<T, 3> normal, vector<T, N> specularAlbedo, T sqrtRoughness)
+{
+    const vector<T, 2> envBRDF = ApproximateGGXEnvironmentBRDF(saturate(dot(normal, view)), sqrtRoughness);
+    return CalculatePrefilteredSpecular(shRadiance, view, normal, specularAlbedo, sqrtRoughness, envBRDF);
+}
+
+template<typename T, int32_t N, typename TR> L1Planar_Generic<T, N> Rotate(L1Planar_Generic<T, N> sh, matrix<TR, 3, 3> rotation)
+{
+    return ToPlanar(Rotate(FromPlanar(sh), rotation));
+}
+
+template<typename T, int32_t N, typename TQ> L1Planar_Generic<T, N> Rotate(L1Planar_Generic<T, N> sh, vector<TQ, 4> quaternion)
+{
+    return ToPlanar(Rotate(FromPlanar(sh), quaternion));
+}
+
+template<typename T, int32_t N, typename TR> L2Planar_Generic<T, N> Rotate(L2Planar_Generic<T, N> sh, matrix<TR, 3, 3> rotation)
+{
+    return ToPlanar(Rotate(FromPlanar(sh), rotation));
+}
+
+template<typename T, int32_t N, typename TQ> L2Planar_Generic<T, N> Rotate(L2Planar_Generic<T, N> sh, vector<TQ, 4> quaternion)
+{
+    return ToPlanar(Rotate(FromPlanar(sh), quaternion));
+}
+
+// H-basis: an orthonormal basis over the hemisphere around +Z, built from shifted and
+// renormalized SH basis functions [9]. Since lightmaps only ever need to be evaluated for normals
+// in the hemisphere around the surface normal, H4 can stand in for L1 and H6 keeps most of the
+// quality of L2 with 6 coefficients instead of 9. Directions are expected to be in tangent space,
+// with Z along the surface normal. The signs match the SH basis used in the rest of this file,
+// so the conversions from L1/L2 only need to be applied after the SH is rotated to tangent space.
+static const float32_t BasisH0 = 1 / sqrt(2 * Pi);
+static const float32_t BasisH1 = sqrt(3 / (2 * Pi));
+static const float32_t BasisH2_MN2 = sqrt(15 / (2 * Pi));
+static const float32_t BasisH2_M2 = sqrt(15 / (2 * Pi)) / 2;
+
+template<typename T, int32_t N, int32_t Count> struct HBasis
+{
+    static const int32_t NumCoefficients = Count;
+
+    vector<T, N> C[NumCoefficients];
+
+    static HBasis<T, N, Count> Zero()
+    {
+        return (HBasis<T, N, Count>)0;
+    }
+
+    HBasis<T, N, Count> operator+(HBasis<T, N, Count> other)
+    {
+        HBasis<T, N, Count> result;
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+            result.C[i] = C[i] + other.C[i];
+        return result;
+    }
+
+    HBasis<T, N, Count> operator-(HBasis<T, N, Count> other)
+    {
+        HBasis<T, N, Count> result;
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+            result.C[i] = C[i] - other.C[i];
+        return result;
+    }
+
+    HBasis<T, N, Count> operator*(vector<T, N> value)
+    {
+        HBasis<T, N, Count> result;
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+            result.C[i] = C[i] * value;
+        return result;
+    }
+
+    HBasis<T, N, Count> operator/(vector<T, N> value)
+    {
+        HBasis<T, N, Count> result;
+        [unroll]
+        for(int32_t i = 0; i < NumCoefficients; ++i)
+            result.C[i] = C[i] / value;
+        return result;
+    }
+};
+
+template<typename T, int32_t N = 1> using H4_Generic = HBasis<T, N, 4>;
+using H4 = H4_Generic<float32_t, 1>;
+using H4_F16 = H4_Generic<float16_t, 1>;
+using H4_RGB = H4_Generic<float32_t, 3>;
+using H4_F16_RGB = H4_Generic<float16_t, 3>;
+
+template<typename T, int32_t N = 1> using H6_Generic = HBasis<T, N, 6>;
+using H6 = H6_Generic<float32_t, 1>;
+using H6_F16 = H6_Generic<float16_t, 1>;
+using H6_RGB = H6_Generic<float32_t, 3>;
+using H6_F16_RGB = H6_Generic<float16_t, 3>;
+
+// Projects a value in a single tangent-space direction onto a set of H4 coefficients
+template<typename T, int32_t N> H4_Generic<T, N> ProjectOntoH4(vector<T, 3> direction, vector<T, N> value)
+{
+    H4_Generic<T, N> h;
+
+    // Band 0
+    h.C[0] = T(BasisH0) * value;
+
+    // Band 1
+    h.C[1] = T(BasisH1) * direction.y * value;
+    h.C[2] = T(BasisH1) * (T(2.0) * direction.z - T(1.0)) * value;
+    h.C[3] = T(BasisH1) * direction.x * value;
+
+    return h;
+}
+
+template<typename T> H4_Generic<T, 1> ProjectOntoH4(vector<T, 3> direction, T value)
+{
+    return ProjectOntoH4<T, 1>(direction, value);
+}
+
+// Projects a value in a single tangent-space direction onto a set of H6 coefficients
+template<typename T, int32_t N> H6_Generic<T, N> ProjectOntoH6(vector<T, 3> direction, vector<T, N> value)
+{
+    H6_Generic<T, N> h;
+
+    // Band 0
+    h.C[0] = T(BasisH0) * value;
+
+    // Band 1
+    h.C[1] = T(BasisH1) * direction.y * value;
+    h.C[2] = T(BasisH1) * (T(2.0) * direction.z - T(1.0)) * value;
+    h.C[3] = T(BasisH1) * direction.x * value;
+
+    // Band 2
+    h.C[4] = T(BasisH2_MN2) * direction.x * direction.y * value;
+    h.C[5] = T(BasisH2_M2) * (direction.x * direction.x - direction.y * direction.y) * value;
+
+    return h;
+}
+
+template<typename T> H6_Generic<T, 1> ProjectOntoH6(vector<T, 3> direction, T value)
+{
+    return ProjectOntoH6<T, 1>(direction, value);
+}
+
+// Converts from tangent-space L1 SH to H4 by projecting the SH onto the H-basis over the upper hemisphere.
+template<typename T, int32_t N> H4_Generic<T, N> ConvertToH4(L1_Generic<T, N> sh)
+{
+    const T rt2 = T(0.707106781);       // 1 / sqrt(2)
+    const T rt32 = T(0.612372436);      // sqrt(3 / 2) / 2
+    const T rt2Half = T(0.353553391);   // 1 / (2 * sqrt(2))
+
+    H4_Generic<T, N> h;
+    h.C[0] = rt2 * sh.C[0] + rt32 * sh.C[2];
+    h.C[1] = rt2 * sh.C[1];
+    h.C[2] = rt2Half * sh.C[2];
+    h.C[3] = rt2 * sh.C[3];
+    return h;
+}
+
+// Converts from tangent-space L2 SH to H4 using the matrix from [9], which folds the
+// hemispherical parts of the L2 band into the L1-like H-basis functions
+template<typename T, int32_t N> H4_Generic<T, N> ConvertToH4(L2_Generic<T, N> sh)
+{
+    const T rt52 = T(0.592927061);      // (3 / 8) * sqrt(5 / 2)
+    const T rt152 = T(0.684653197);     // sqrt(15 / 2) / 4
+
+    H4_Generic<T, N> h = ConvertToH4(L2toL1(sh));
+    h.C[1] += rt52 * sh.C[5];
+    h.C[2] += rt152 * sh.C[6];
+    h.C[3] += rt52 * sh.C[7];
+    return h;
+}
+
+// Converts from tangent-space L2 SH to H6 using the matrix from [9]
+template<typename T, int32_t N> H6_Generic<T, N> ConvertToH6(L2_Generic<T, N> sh)
+{
+    const T rt2 = T(0.707106781);       // 1 / sqrt(2)
+
+    H4_Generic<T, N> h4 = ConvertToH4(sh);
+
+    H6_Generic<T, N> h;
+    h.C[0] = h4.C[0];
+    h.C[1] = h4.C[1];
+    h.C[2] = h4.C[2];
+    h.C[3] = h4.C[3];
+    h.C[4] = rt2 * sh.C[4];
+    h.C[5] = rt2 * sh.C[8];
+    return h;
+}
+
+// Converts tangent-space radiance to H-basis coefficients for irradiance, which is what a lightmap
+// typically stores. The cosine lobe can't be applied after the conversion since the H-basis isn't closed
+// under rotation, so it's applied to the SH before converting. Evaluate() then returns irradiance.
+template<typename T, int32_t N> H4_Generic<T, N> ConvertToH4Irradiance(L1_Generic<T, N> radiance)
+{
+    return ConvertToH4(ConvolveWithCosineLobe(radiance));
+}
+
+template<typename T, int32_t N> H4_Generic<T, N> ConvertToH4Irradiance(L2_Generic<T, N> radiance)
+{
+    return ConvertToH4(ConvolveWithCosineLobe(radiance));
+}
+
+template<typename T, int32_t N> H6_Generic<T, N> ConvertToH6Irradiance(L2_Generic<T, N> radiance)
+{
+    return ConvertToH6(ConvolveWithCosineLobe(radiance));
+}
+
+// Truncates a set of H6 coefficients to produce a set of H4 coefficients
+template<typename T, int32_t N> H4_Generic<T, N> H6toH4(H6_Generic<T, N> h)
+{
+    H4_Generic<T, N> result;
+    for(int32_t i = 0; i < H4_Generic<T, N>::NumCoefficients; ++i)
+        result.C[i] = h.C[i];
+    return result;
+}
+
+template<typename TDst, typename T, int32_t N, int32_t Count> HBasis<TDst, N, Count> Cast(HBasis<T, N, Count> h)
+{
+    HBasis<TDst, N, Count> result;
+    [unroll]
+    for(int32_t i = 0; i < Count; ++i)
+        result.C[i] = vector<TDst, N>(h.C[i]);
+    return result;
+}
+
+template<typename T, int32_t N, int32_t Count> HBasis<T, N, Count> Lerp(HBasis<T, N, Count> x, HBasis<T, N, Count> y, T s)
+{
+    return x * (T(1.0) - s) + y * s;
+}
+
+template<typename T, int32_t N, int32_t Count> vector<T, N> DotProduct(HBasis<T, N, Count> a, HBasis<T, N, Count> b)
+{
+    vector<T, N> result = T(0.0);
+    [unroll]
+    for(int32_t i = 0; i < Count; ++i)
+        result += a.C[i] * b.C[i];
+    return result;
+}
+
+// Evaluates a set of H-basis coefficients in a tangent-space direction. The result is only meaningful
+// in the upper hemisphere (direction.z >= 0).
+template<typename T, int32_t N> vector<T, N> Evaluate(H4_Generic<T, N> h, vector<T, 3> direction)
+{
+    return DotProduct(h, ProjectOntoH4(direction, (vector<T, N>)(1.0)));
+}
+
+template<typename T, int32_t N> vector<T, N> Evaluate(H6_Generic<T, N> h, vector<T, 3> direction)
+{
+    return DotProduct(h, ProjectOntoH6(direction, (vector<T, N>)(1.0)));
+}
+
+// Sparse probe octree lookup, for octrees built by BuildProbeOctree in SampleFramework12's ProbeOctree.h.
+// The node buffer stores one uint per node with the root at index 0: interior nodes store the index of
+// their first child (children are contiguous and ordered by octant, x | y << 1 | z << 2), and leaves have
+// ProbeOctreeLeafFlag set and store their leaf index. Each leaf has 8 corner probe indices in the leaf
+// probe buffer, in the same order as the children. Positions outside of the bounds are clamped. The builder
+// balances the octree and snaps T-junction probes, so plain trilinear weights are continuous across leaves.
+static const uint32_t ProbeOctreeLeafFlag = 0x80000000;
+
+struct ProbeOctreeLookup
+{
+    uint32_t ProbeIndices[8];
+    float32_t Weights[8];
+};
+
+ProbeOctreeLookup LookupProbeOctree(StructuredBuffer<uint32_t> nodes, StructuredBuffer<uint32_t> leafProbes,
+                                    float32_t3 boundsMin, float32_t3 boundsMax, float32_t3 position)
+{
+    float32_t3 uvw = saturate((position - boundsMin) / (boundsMax - boundsMin));
+    uint32_t node = nodes[0];
+
+    [loop]
+    while((node & ProbeOctreeLeafFlag) == 0)
+    {
+        uvw *= 2.0f;
+        const uint32_t3 octant = uint32_t3(uvw >= 1.0f);
+        uvw -= float32_t3(octant);
+        node = nodes[node + (octant.x | (octant.y << 1) | (octant.z << 2))];
+    }
+
+    const uint32_t leafIdx = node & ~ProbeOctreeLeafFlag;
+
+    ProbeOctreeLookup lookup;
+    [unroll]
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        lookup.ProbeIndices[i] = leafProbes[leafIdx * 8 + i];
+        lookup.Weights[i] = ((i & 1) != 0 ? uvw.x : 1.0f - uvw.x) *
+                            (((i >> 1) & 1) != 0 ? uvw.y : 1.0f - uvw.y) *
+                            ((i >> 2) != 0 ? uvw.z : 1.0f - uvw.z);
+    }
+
+    return lookup;
+}
+
+// Fetches the 8 probes from a lookup and blends them with WeightedSum. The probe buffer's element type
+// needs to match the probes that were uploaded, for example L2_RGB for SampleFramework12's SH9Color.
+template<typename T, int32_t N, int32_t L> SH<T, N, L> SampleProbeOctree(StructuredBuffer<SH<T, N, L> > probes, ProbeOctreeLookup lookup)
+{
+    SH<T, N, L> cornerProbes[8];
+    T weights[8];
+    [unroll]
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        cornerProbes[i] = probes[lookup.ProbeIndices[i]];
+        weights[i] = T(lookup.Weights[i]);
+    }
+
+    return WeightedSum(cornerProbes, weights);
+}
+
+// Gradient-aware probe lookup: fetches a single probe (typically the nearest one) and extrapolates it to the
+// shading position using its gradient, instead of blending the surrounding probes
+template<typename T, int32_t N, int32_t L> SH<T, N, L> SampleProbeWithGradient(StructuredBuffer<SH<T, N, L> > probes, StructuredBuffer<SHGradient<T, N, L> > gradients,
+                                                                              uint32_t probeIdx, vector<T, 3> probePosition, vector<T, 3> position)
+{
+    return Extrapolate(probes[probeIdx], gradients[probeIdx], position - probePosition);
+}
+
+// Gradient-corrected trilinear lookup: extrapolates each of the 8 probes of a grid cell towards the shading
+// position with its gradient, and then blends them with the trilinear weights. Each probe is moved halfway to the
+// shading position, which makes the result exact for quadratic lighting (a full step only flips the sign of the
+// trilinear error). Corners are ordered with x varying fastest, the same as ProbeOctreeLookup, and
+// cellMin/cellSize give the positions of the corner probes. Matches ProbeVolume::SampleTrilinearWithGradient.
+template<typename T, int32_t N, int32_t L> SH<T, N, L> SampleProbesTrilinearWithGradient(StructuredBuffer<SH<T, N, L> > probes, StructuredBuffer<SHGradient<T, N, L> > gradients,
+                                                                                         uint32_t probeIndices[8], T weights[8], vector<T, 3> cellMin,
+                                                                                         vector<T, 3> cellSize, vector<T, 3> position)
+{
+    SH<T, N, L> cornerProbes[8];
+    [unroll]
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        const vector<T, 3> corner = vector<T, 3>(T(i & 1), T((i >> 1) & 1), T(i >> 2));
+        const vector<T, 3> probePosition = cellMin + corner * cellSize;
+        cornerProbes[i] = Extrapolate(probes[probeIndices[i]], gradients[probeIndices[i]], (position - probePosition) * T(0.5));
+    }
+
+    return WeightedSum(cornerProbes, weights);
+}
+
+// PCA-compressed probe decode, for probe sets compressed by CompressProbesPCA in SampleFramework12's
+// ProbePCA.h. A probe is reconstructed as the mean of its block plus a weighted sum of the block's
+// principal components.
+template<typename T, int32_t N, int32_t K> L2_Generic<T, N> DecodePCAProbe(L2_Generic<T, N> mean, L2_Generic<T, N> components[K], T weights[K])
+{
+    return mean + WeightedSum(components, weights);
+}
+
+// Fetches and decodes a probe directly from the buffers of a PCACompressedProbes. The basis buffer holds
+// (1 + numComponents) probes per block (the mean followed by the components), the scale/bias buffer holds
+// numComponents float2 per block, and each probe has its weights packed into the byte address buffer as
+// either fp16 or 8-bit UNORM values, padded to a multiple of 4 bytes.
+L2_RGB DecodePCAProbe(StructuredBuffer<L2_RGB> basis, StructuredBuffer<float32_t2> weightScaleBias, ByteAddressBuffer weights,
+                      uint32_t probeIdx, uint32_t numComponents, uint32_t blockSize, bool unorm8Weights)
+{
+    const uint32_t blockIdx = probeIdx / blockSize;
+    const uint32_t basisStart = blockIdx * (numComponents + 1);
+    const uint32_t bytesPerWeight = unorm8Weights ? 1 : 2;
+    const uint32_t weightStart = probeIdx * ((numComponents * bytesPerWeight + 3) & ~3);
+
+    L2_RGB result = basis[basisStart];
+
+    [loop]
+    for(uint32_t i = 0; i < numComponents; ++i)
+    {
+        const uint32_t byteOffset = weightStart + i * bytesPerWeight;
+        const uint32_t packed = weights.Load(byteOffset & ~3) >> ((byteOffset & 3) * 8);
+        const float32_t raw = unorm8Weights ? (packed & 0xFF) / 255.0f : f16tof32(packed);
+        const float32_t2 scaleBias = weightScaleBias[blockIdx * numComponents + i];
+
+        result = result + basis[basisStart + 1 + i] * (raw * scaleBias.x + scaleBias.y);
+    }
+
+    return result;
+}
+
+// Vector-quantized probe lookup, for probe sets built by BuildProbePalette in SampleFramework12's
+// ProbeVQ.h. Each probe stores a uint index into the palette. With l0Scale the low 16 bits are the index
+// and the high 16 bits are an fp16 scale that's applied to the palette entry.
+template<typename T, int32_t N, int32_t L> SH<T, N, L> LookupProbePalette(StructuredBuffer<SH<T, N, L> > palette, StructuredBuffer<uint32_t> indices,
+                                                                         uint32_t probeIdx, bool l0Scale)
+{
+    const uint32_t packed = indices[probeIdx];
+    if(l0Scale == false)
+        return palette[packed];
+
+    return palette[packed & 0xFFFF] * T(f16tof32(packed >> 16));
+}
+
+// Compact L1 lightmap decode, for lightmaps encoded by EncodeL1LightmapToDDS in SampleFramework12's
+// L1Lightmap.h. The L0 texture (BC6H) holds the L0 color, and the L1 texture (BC7) holds the direction of
+// the luminance L1 vector in RGB (remapped to [0, 1]) and its length relative to the luminance of L0 in A,
+// divided by MaxL1Ratio. Each channel's L1 coefficients are rebuilt by scaling that channel's L0.
+static const float32_t MaxL1Ratio = 1.7320508f;
+
+L1_RGB DecodeL1(float32_t3 l0, float32_t4 encodedL1)
+{
+    const float32_t3 l1 = (encodedL1.xyz * 2.0f - 1.0f) * (encodedL1.w * MaxL1Ratio);
+
+    L1_RGB sh;
+    sh.C[0] = l0;
+    sh.C[1] = l0 * l1.x;
+    sh.C[2] = l0 * l1.y;
+    sh.C[3] = l0 * l1.z;
+    return sh;
+}
+
+L1_RGB DecodeL1FromTextures(Texture2D<float32_t3> l0Texture, Texture2D<float32_t4> l1Texture, SamplerState samplerState, float32_t2 uv)
+{
+    return DecodeL1(l0Texture.SampleLevel(samplerState, uv, 0.0f), l1Texture.SampleLevel(samplerState, uv, 0.0f));
+}
+
+// Mixed-LOD probe fetch, for probe sets built by BuildMixedLODProbes in SampleFramework12's ProbeBandLOD.h.
+// The low 2 bits of each probe's header are its LOD tag and the upper 30 bits are the index of its first
+// coefficient, followed by 9 (L2), 4 (L1, evaluated with ZH3 hallucination) or 1 (L0) RGB coefficients.
+static const uint32_t MixedLODTagL2 = 0;
+static const uint32_t MixedLODTagL1 = 1;
+static const uint32_t MixedLODTagL0 = 2;
+
+float32_t3 CalculateIrradianceMixedLOD(StructuredBuffer<uint32_t> headers, StructuredBuffer<float32_t3> coefficients,
+                                       uint32_t probeIdx, float32_t3 normal)
+{
+    const uint32_t header = headers[probeIdx];
+    const uint32_t tag = header & 0x3;
+    const uint32_t offset = header >> 2;
+
+    [branch]
+    if(tag == MixedLODTagL2)
+    {
+        L2_RGB sh;
+        [unroll]
+        for(uint32_t i = 0; i < 9; ++i)
+            sh.C[i] = coefficients[offset + i];
+        return CalculateIrradiance(sh, normal);
+    }
+    else if(tag == MixedLODTagL1)
+    {
+        L1_RGB sh;
+        [unroll]
+        for(uint32_t i = 0; i < 4; ++i)
+            sh.C[i] = coefficients[offset + i];
+        return CalculateIrradianceL1ZH3Hallucinate(sh, normal);
+    }
+
+    return coefficients[offset] * (BasisL0 * CosineA0);
+}
+
 } // namespace SH
 
 // References:
@@ -551,5 +2382,9 @@ template<typename T, int32_t N> L2_Generic<T, N> Rotate(L2_Generic<T, N> sh, flo
 // [3] SHMath by Chuck Walbourn (originally written by Peter-Pike Sloan) - https://walbourn.github.io/spherical-harmonics-math/
 // [4] ZH3: Quadratic Zonal Harmonics by Thomas Roughton, Peter-Pike Sloan, Ari Silvennoinen, Michal Iwanicki, and Peter Shirley - https://torust.me/ZH3.pdf
 // [5] Precomputed Global Illumination in Frostbite by Yuriy O'Donnell - https://www.ea.com/frostbite/news/precomputed-global-illumination-in-frostbite
+// [6] The Solid Angle of a Plane Triangle by A. van Oosterom and J. Strackee - IEEE Transactions on Biomedical Engineering, 1983
+// [7] Applications of Irradiance Tensors to the Simulation of Non-Lambertian Phenomena by James Arvo - SIGGRAPH 1995
+// [8] Deringing Spherical Harmonics by Peter-Pike Sloan - SIGGRAPH Asia 2017 Technical Briefs
+// [9] Efficient Irradiance Normal Mapping by Ralf Habel and Michael Wimmer - I3D 2010
 
 #endif // SH_HLSLI_
\ No newline at end of file
@@ -0,0 +1,277 @@
+//=================================================================================================
+//
+//  SHTest
+//  by MJP
+//  https://therealmjp.github.io/
+//
+//  All code and content licensed under the MIT license
+//
+//=================================================================================================
+
+#include <PCH.h>
+
+#include <Utility.h>
+#include <Exceptions.h>
+#include <FileIO.h>
+#include <EnkiTS/TaskScheduler.h>
+#include <Graphics/SH.h>
+#include <Graphics/ProbeOctree.h>
+#include <Graphics/ProbeVolume.h>
+#include <Graphics/ProbePCA.h>
+#include <Graphics/ProbeVQ.h>
+#include <Graphics/ProbeBandLOD.h>
+#include <Graphics/KeyframedSH.h>
+#include <Graphics/SHLeastSquares.h>
+#include <Graphics/L1Lightmap.h>
+#include <Graphics/SHProbeFile.h>
+#include <Graphics/ProbeStreaming.h>
+
+#include "ProbeReports.h"
+
+using namespace SampleFramework12;
+
+// Files written by the reports go in this directory, relative to the working directory
+static const wchar* ReportDir = L"ProbeReports";
+
+static const wchar* ReportDirectory()
+{
+    if(DirectoryExists(ReportDir) == false)
+        Win32Call(CreateDirectory(ReportDir, nullptr));
+
+    return ReportDir;
+}
+
+// The synthetic scene is a 16m cube with a dim constant sky and a few colored point lights. The lights are
+// kept off the probe lattices used below, since the direction to a light at a probe's position is undefined.
+static const float SceneSize = 16.0f;
+
+struct ScenePointLight
+{
+    Float3 Position;
+    Float3 Intensity;
+};
+
+static const ScenePointLight SceneLights[] =
+{
+    { Float3(4.3f, 3.1f, 5.4f), Float3(8.0f, 6.0f, 4.0f) },
+    { Float3(11.7f, 2.2f, 10.1f), Float3(2.0f, 4.0f, 9.0f) },
+    { Float3(7.1f, 12.2f, 13.7f), Float3(6.0f, 6.0f, 6.0f) },
+};
+
+static const uint64 NumSceneLights = ArraySize_(SceneLights);
+static const Float3 SceneSkyRadiance = Float3(0.05f, 0.07f, 0.1f);
+
+static SH9Color EvaluateProbe(const Float3& position, const ScenePointLight* lights, const Float3& skyRadiance)
+{
+    SH9Color sh;
+    sh.Coefficients[0] = skyRadiance * (2.0f * std::sqrt(Pi));
+    for(uint64 i = 0; i < NumSceneLights; ++i)
+    {
+        const Float3 toLight = lights[i].Position - position;
+        const float distanceSq = Float3::Dot(toLight, toLight);
+        sh += ProjectOntoSH9Color(Float3::Normalize(toLight), lights[i].Intensity / (distanceSq + 1.0f));
+    }
+
+    return sh;
+}
+
+static SH9Color EvaluateSceneProbe(const Float3& position)
+{
+    return EvaluateProbe(position, SceneLights, SceneSkyRadiance);
+}
+
+// Fills a dense grid of probes covering the scene, in x-major order
+static void EvaluateGridProbes(uint32 probesPerAxis, const ScenePointLight* lights, const Float3& skyRadiance, SH9Color* probes)
+{
+    const float spacing = SceneSize / (probesPerAxis - 1);
+    for(uint32 z = 0; z < probesPerAxis; ++z)
+        for(uint32 y = 0; y < probesPerAxis; ++y)
+            for(uint32 x = 0; x < probesPerAxis; ++x)
+                probes[(uint64(z) * probesPerAxis + y) * probesPerAxis + x] = EvaluateProbe(Float3(float(x), float(y), float(z)) * spacing, lights, skyRadiance);
+}
+
+static void GenerateGridProbes(uint32 probesPerAxis, Array<SH9Color>& probes)
+{
+    probes.Init(uint64(probesPerAxis) * probesPerAxis * probesPerAxis);
+    EvaluateGridProbes(probesPerAxis, SceneLights, SceneSkyRadiance, probes.Data());
+}
+
+static void SHMultiplyReport()
+{
+    WriteLog("%s", SHMultiplyErrorStatsToString(ValidateSHMultiply()).c_str());
+}
+
+static void PolygonProjectionReport()
+{
+    WriteLog("%s", PolygonProjectionStatsToString(CompareProjectPolygonOntoSH9()).c_str());
+}
+
+static void ProbeOctreeReport()
+{
+    ProbeOctree octree;
+    BuildProbeOctree(octree, Float3(0.0f), Float3(SceneSize), EvaluateSceneProbe);
+
+    WriteLog("%s", ProbeOctreeStatsToString(CalculateProbeOctreeStats(octree)).c_str());
+}
+
+// Compares trilinear sampling against nearest probe + gradient extrapolation and gradient-corrected trilinear
+// sampling, for grids 2x, 4x and 8x sparser than a 33^3 reference
+static void ProbeGradientReport()
+{
+    const uint32 probesPerAxis = 33;
+
+    SH9ColorProbeVolume reference;
+    reference.Init(Float3(0.0f), Float3(SceneSize), Uint3(probesPerAxis, probesPerAxis, probesPerAxis));
+    for(uint32 z = 0; z < probesPerAxis; ++z)
+        for(uint32 y = 0; y < probesPerAxis; ++y)
+            for(uint32 x = 0; x < probesPerAxis; ++x)
+                reference.Probe(x, y, z) = EvaluateSceneProbe(reference.ProbePosition(x, y, z));
+    reference.ComputeGradients();
+
+    for(uint32 sparseFactor = 2; sparseFactor <= 8; sparseFactor *= 2)
+        WriteLog("%s", ProbeGradientStatsToString(CompareGradientSampling(reference, sparseFactor)).c_str());
+}
+
+static void ProbePCAReport(const Array<SH9Color>& probes, enki::TaskScheduler* taskScheduler)
+{
+    PCACompressionSettings settings;
+    PCACompressedProbes compressed;
+    WriteLog("%s", PCACompressionStatsToString(CompressProbesPCA(probes.Data(), probes.Size(), compressed, settings, taskScheduler)).c_str());
+
+    settings.WeightFormat = PCAWeightFormat::UNorm8;
+    WriteLog("%s", PCACompressionStatsToString(CompressProbesPCA(probes.Data(), probes.Size(), compressed, settings, taskScheduler)).c_str());
+}
+
+static void ProbeVQReport(const Array<SH9Color>& probes, enki::TaskScheduler* taskScheduler)
+{
+    VQPaletteSettings settings;
+    VQCompressedProbes compressed;
+    WriteLog("%s", VQPaletteStatsToString(BuildProbePalette(probes.Data(), probes.Size(), compressed, settings, taskScheduler)).c_str());
+
+    settings.L0Scale = true;
+    WriteLog("%s", VQPaletteStatsToString(BuildProbePalette(probes.Data(), probes.Size(), compressed, settings, taskScheduler)).c_str());
+}
+
+// Compares the default 10% budget against a strict 2% budget. Every probe in the scene sees the point lights
+// unoccluded, so the 2% budget keeps them all at L2.
+static void ProbeBandLODReport(const Array<SH9Color>& probes, enki::TaskScheduler* taskScheduler)
+{
+    ProbeBandLODSettings settings;
+    MixedLODProbes mixedProbes;
+    WriteLog("%s", ProbeBandLODStatsToString(BuildMixedLODProbes(probes.Data(), probes.Size(), mixedProbes, settings, taskScheduler)).c_str());
+
+    settings.RelativeErrorBudget = 0.02f;
+    WriteLog("%s", ProbeBandLODStatsToString(BuildMixedLODProbes(probes.Data(), probes.Size(), mixedProbes, settings, taskScheduler)).c_str());
+}
+
+// Bakes a day cycle for a 16^3 probe grid at 120 frames, with the sky and the first light brightening and dimming
+static void KeyframedSHReport(enki::TaskScheduler* taskScheduler)
+{
+    const uint32 probesPerAxis = 16;
+    const uint64 numProbes = uint64(probesPerAxis) * probesPerAxis * probesPerAxis;
+    const uint64 numFrames = 120;
+
+    Array<SH9Color> frames(numProbes * numFrames);
+    for(uint64 frameIdx = 0; frameIdx < numFrames; ++frameIdx)
+    {
+        const float daylight = 0.5f - 0.5f * std::cos(2.0f * Pi * frameIdx / numFrames);
+
+        ScenePointLight lights[NumSceneLights];
+        for(uint64 i = 0; i < NumSceneLights; ++i)
+            lights[i] = SceneLights[i];
+        lights[0].Intensity *= daylight;
+        const Float3 skyRadiance = SceneSkyRadiance * (0.2f + 0.8f * daylight);
+
+        EvaluateGridProbes(probesPerAxis, lights, skyRadiance, &frames[frameIdx * numProbes]);
+    }
+
+    KeyframedSHSettings settings;
+    KeyframedSH keyframes;
+    WriteLog("%s", KeyframedSHStatsToString(CompressKeyframedSH(frames.Data(), numProbes, numFrames, nullptr, keyframes, settings, taskScheduler)).c_str());
+
+    settings.PruneTolerance = 0.01f;
+    WriteLog("%s", KeyframedSHStatsToString(CompressKeyframedSH(frames.Data(), numProbes, numFrames, nullptr, keyframes, settings, taskScheduler)).c_str());
+
+    WriteLog("%s", KeyframedSHDecodeBenchmarkToString(BenchmarkKeyframedSHDecode(keyframes, 4, 480)).c_str());
+}
+
+// Least-squares vs Monte Carlo projection for the 16-64 rays a probe can trace per frame. 8 rays is fewer than
+// the 9 L2 coefficients, so that pattern needs a lambda above 0.
+static void SHLeastSquaresReport()
+{
+    WriteLog("%s", SHLeastSquaresErrorStatsToString(CompareSHLeastSquaresProjection(8, 0.05f)).c_str());
+    for(uint64 numDirections = 16; numDirections <= 64; numDirections *= 2)
+        WriteLog("%s", SHLeastSquaresErrorStatsToString(CompareSHLeastSquaresProjection(numDirections, 0.0f)).c_str());
+}
+
+// Bakes an L1 lightmap for a floor across the scene, and encodes it to BC6H + BC7
+static void L1LightmapReport()
+{
+    const uint32 lightmapSize = 512;
+
+    TextureData<Float4> coefficientPlanes[4];
+    for(TextureData<Float4>& plane : coefficientPlanes)
+        plane.Init(lightmapSize, lightmapSize, 1);
+
+    for(uint32 y = 0; y < lightmapSize; ++y)
+    {
+        for(uint32 x = 0; x < lightmapSize; ++x)
+        {
+            const Float3 position = Float3((x + 0.5f) / lightmapSize, 0.0f, (y + 0.5f) / lightmapSize) * SceneSize;
+            const SH9Color sh = EvaluateSceneProbe(position);
+            for(uint64 i = 0; i < 4; ++i)
+                coefficientPlanes[i].Texels[y * lightmapSize + x] = Float4(sh.Coefficients[i], 1.0f);
+        }
+    }
+
+    const std::wstring l0Path = MakeString(L"%ls\\L1Lightmap_L0.dds", ReportDirectory());
+    const std::wstring l1Path = MakeString(L"%ls\\L1Lightmap_L1.dds", ReportDirectory());
+    WriteLog("%s", L1LightmapEncodeStatsToString(EncodeL1LightmapToDDS(coefficientPlanes, l0Path.c_str(), l1Path.c_str())).c_str());
+}
+
+// Uses a denser grid than the compression reports, so that loading takes long enough to time
+static void SHProbeLoadReport()
+{
+    Array<SH9Color> probes;
+    GenerateGridProbes(64, probes);
+
+    WriteLog("%s", SHProbeLoadBenchmarkToString(BenchmarkSHProbeLoad(probes.Data(), probes.Size(), ReportDirectory())).c_str());
+}
+
+// 512 regions of 2048 L2 probes (108 MB decoded) streamed through a 32 MB budget, so that about a quarter
+// of the regions fit in memory at once
+static void ProbeStreamingReport()
+{
+    ProbeStreamingSettings settings;
+    settings.CacheBudget = 32 * 1024 * 1024;
+    settings.PrefetchRadius = 15.0f;
+
+    const std::wstring filePath = MakeString(L"%ls\\Flythrough.shprobe", ReportDirectory());
+    WriteLog("%s", ProbeStreamingBenchmarkToString(RunProbeStreamingFlythrough(filePath.c_str(), 8, 2048, 600, 4, settings)).c_str());
+}
+
+void RunProbeReports()
+{
+    WriteLog("Running probe reports");
+
+    enki::TaskScheduler taskScheduler;
+    taskScheduler.Initialize();
+
+    SHMultiplyReport();
+    PolygonProjectionReport();
+    ProbeOctreeReport();
+    ProbeGradientReport();
+    L1LightmapReport();
+
+    Array<SH9Color> gridProbes;
+    GenerateGridProbes(32, gridProbes);
+
+    ProbePCAReport(gridProbes, &taskScheduler);
+    ProbeVQReport(gridProbes, &taskScheduler);
+    ProbeBandLODReport(gridProbes, &taskScheduler);
+    KeyframedSHReport(&taskScheduler);
+    SHLeastSquaresReport();
+
+    SHProbeLoadReport();
+    ProbeStreamingReport();
+}
@@ -0,0 +1,17 @@
+//=================================================================================================
+//
+//  SHTest
+//  by MJP
+//  https://therealmjp.github.io/
+//
+//  All code and content licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include <PCH.h>
+
+// Runs the CPU-side probe builders, compressors and benchmarks from SampleFramework12 on synthetic probes
+// lit by a few point lights, and writes their stats to the log. Enabled with --probe-reports.
+void RunProbeReports();
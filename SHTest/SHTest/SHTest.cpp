@@ -24,12 +24,15 @@
 #include "SHTest.h"
 #include "SharedTypes.h"
 #include "AppSettings.h"
+#include "ProbeReports.h"
 
 using namespace SampleFramework12;
 
 SHTest::SHTest(const wchar* cmdLine) : App(L"SHforHLSL Test", cmdLine)
 {
     swapChain.SetFormat(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+
+    runProbeReports = cmdLine != nullptr && wcsstr(cmdLine, L"--probe-reports") != nullptr;
 }
 
 void SHTest::BeforeReset()
@@ -51,6 +54,9 @@ void SHTest::Initialize()
     opts.Reset();
     opts.Add("UseLite_", 1);
     testPSLite = CompileFromFile(L"SHTest.hlsl", "SHTestPS", ShaderType::Pixel, opts);
+
+    if(runProbeReports)
+        RunProbeReports();
 }
 
 void SHTest::Shutdown()
@@ -192,6 +198,30 @@ void SHTest::Render(const Timer& timer)
             .Name = L"L2_RGB (Lite)",
         },
 
+        {
+            .PSO = testPSOLite,
+            .TestMode = TestMode_L1_FP16,
+            .Name = L"L1_FP16 (Lite)",
+        },
+
+        {
+            .PSO = testPSOLite,
+            .TestMode = TestMode_L1_RGB_FP16,
+            .Name = L"L1_RGB_FP16 (Lite)",
+        },
+
+        {
+            .PSO = testPSOLite,
+            .TestMode = TestMode_L2_FP16,
+            .Name = L"L2_FP16 (Lite)",
+        },
+
+        {
+            .PSO = testPSOLite,
+            .TestMode = TestMode_L2_RGB_FP16,
+            .Name = L"L2_RGB_FP16 (Lite)",
+        },
+
     };
 
     const uint32 numTests = ArraySize_(tests);
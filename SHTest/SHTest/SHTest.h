@@ -29,6 +29,8 @@ protected:
     ID3D12PipelineState* testPSO = nullptr;
     ID3D12PipelineState* testPSOLite = nullptr;
 
+    bool runProbeReports = false;
+
     virtual void Initialize() override;
     virtual void Shutdown() override;
 
@@ -97,6 +97,36 @@ float3 DoTest(float3 normal)
         sh = SH::Rotate(sh, rotation);
         return SH::CalculateIrradiance(sh, normal);
     }
+    else if(CB.TestMode == TestMode_L1_FP16)
+    {
+        SH::L1_F16 sh = SH::ProjectOntoL1_F16(SH::Half3(lightDir), SH::Half(monoLightColor));
+        sh = SH::Rotate(sh, rotation);
+        if (normal.y > 0.0f)
+            return SH::CalculateIrradianceL1ZH3Hallucinate(sh, SH::Half3(normal));
+        else
+            return SH::CalculateIrradianceGeomerics(sh, SH::Half3(normal));
+    }
+    else if(CB.TestMode == TestMode_L1_RGB_FP16)
+    {
+        SH::L1_F16_RGB sh = SH::ProjectOntoL1_F16_RGB(SH::Half3(lightDir), SH::Half3(lightColor));
+        sh = SH::Rotate(sh, rotation);
+        if (normal.y > 0.0f)
+            return SH::CalculateIrradianceL1ZH3Hallucinate(sh, SH::Half3(normal));
+        else
+            return SH::CalculateIrradianceGeomerics(sh, SH::Half3(normal));
+    }
+    else if(CB.TestMode == TestMode_L2_FP16)
+    {
+        SH::L2_F16 sh = SH::ProjectOntoL2_F16(SH::Half3(lightDir), SH::Half(monoLightColor));
+        sh = SH::Rotate(sh, rotation);
+        return SH::CalculateIrradiance(sh, SH::Half3(normal));
+    }
+    else if(CB.TestMode == TestMode_L2_RGB_FP16)
+    {
+        SH::L2_F16_RGB sh = SH::ProjectOntoL2_F16_RGB(SH::Half3(lightDir), SH::Half3(lightColor));
+        sh = SH::Rotate(sh, rotation);
+        return SH::CalculateIrradiance(sh, SH::Half3(normal));
+    }
 
     return 0.0f;
 }
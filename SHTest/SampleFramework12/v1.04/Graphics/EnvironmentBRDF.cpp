@@ -0,0 +1,159 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "EnvironmentBRDF.h"
+#include "Sampling.h"
+#include "..\\FileIO.h"
+#include "TaskHelpers.h"
+
+namespace SampleFramework12
+{
+
+// Integrates the scale and bias for a single view angle and roughness, with the view direction
+// and normal in tangent space so that the GGX half vectors don't need to be transformed
+static Float2 IntegrateEnvironmentBRDF(float nDotV, float sqrtRoughness, uint32 numSamples)
+{
+    const float roughness = sqrtRoughness * sqrtRoughness;
+    const float m2 = roughness * roughness;
+    const Float3 v = Float3(std::sqrt(1.0f - nDotV * nDotV), 0.0f, nDotV);
+
+    // Matches GGX_V1 from BRDF.h
+    auto ggxV1 = [m2](float nDotX)
+    {
+        return 1.0f / (nDotX + std::sqrt(m2 + (1 - m2) * nDotX * nDotX));
+    };
+
+    float scale = 0.0f;
+    float bias = 0.0f;
+    for(uint32 i = 0; i < numSamples; ++i)
+    {
+        const Float2 u1u2 = Hammersley2D(i, numSamples);
+        const float cosTheta = std::sqrt((1.0f - u1u2.x) / (1.0f + (m2 - 1.0f) * u1u2.x));
+        const float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+        const float phi = 2.0f * Pi * u1u2.y;
+        const Float3 h = Float3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+
+        const float vDotH = Float3::Dot(v, h);
+        const Float3 l = 2.0f * vDotH * h - v;
+        const float nDotL = l.z;
+        if(nDotL <= 0.0f || vDotH <= 0.0f)
+            continue;
+
+        // The D term cancels with the PDF of the sampled half vector, D * nDotH / (4 * vDotH)
+        const float vis = ggxV1(nDotL) * ggxV1(nDotV);
+        const float weight = vis * nDotL * 4.0f * vDotH / h.z;
+        const float fresnel = std::pow(1.0f - vDotH, 5.0f);
+
+        scale += weight * (1.0f - fresnel);
+        bias += weight * fresnel;
+    }
+
+    return Float2(scale, bias) / float(numSamples);
+}
+
+void GenerateEnvironmentBRDFTable(EnvironmentBRDFTable& table, uint32 numNDotV, uint32 numRoughness,
+                                  uint32 numSamples, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(numNDotV > 0 && numRoughness > 0 && numSamples > 0);
+
+    table.NumNDotV = numNDotV;
+    table.NumRoughness = numRoughness;
+    table.Texels.Init(uint64(numNDotV) * numRoughness);
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    enki::TaskSet taskSet(numRoughness, [&](enki::TaskSetPartition range, uint32)
+    {
+        for(uint32 y = range.start; y < range.end; ++y)
+        {
+            const float sqrtRoughness = (y + 0.5f) / numRoughness;
+            for(uint32 x = 0; x < numNDotV; ++x)
+            {
+                const float nDotV = (x + 0.5f) / numNDotV;
+                table.Texels[y * numNDotV + x] = IntegrateEnvironmentBRDF(nDotV, sqrtRoughness, numSamples);
+            }
+        }
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+}
+
+Float2 EnvironmentBRDFTable::Sample(float nDotV, float sqrtRoughness) const
+{
+    Assert_(Texels.Size() == uint64(NumNDotV) * NumRoughness);
+
+    const float x = Clamp(nDotV * NumNDotV - 0.5f, 0.0f, NumNDotV - 1.0f);
+    const float y = Clamp(sqrtRoughness * NumRoughness - 0.5f, 0.0f, NumRoughness - 1.0f);
+    const uint32 x0 = uint32(x);
+    const uint32 y0 = uint32(y);
+    const uint32 x1 = std::min(x0 + 1, NumNDotV - 1);
+    const uint32 y1 = std::min(y0 + 1, NumRoughness - 1);
+
+    const Float2 row0 = Lerp(Texels[y0 * NumNDotV + x0], Texels[y0 * NumNDotV + x1], x - x0);
+    const Float2 row1 = Lerp(Texels[y1 * NumNDotV + x0], Texels[y1 * NumNDotV + x1], x - x0);
+    return Lerp(row0, row1, y - y0);
+}
+
+void SaveEnvironmentBRDFTable(const wchar* filePath, const EnvironmentBRDFTable& table, EnvironmentBRDFFormat format)
+{
+    Assert_(table.Texels.Size() == uint64(table.NumNDotV) * table.NumRoughness);
+
+    EnvironmentBRDFFileHeader header;
+    header.NumNDotV = table.NumNDotV;
+    header.NumRoughness = table.NumRoughness;
+    header.Format = format;
+
+    File file(filePath, FileOpenMode::Write);
+    file.Write(header);
+
+    if(format == EnvironmentBRDFFormat::Float16)
+    {
+        Array<Half2> halfTexels(table.Texels.Size());
+        for(uint64 i = 0; i < table.Texels.Size(); ++i)
+            halfTexels[i] = Half2(table.Texels[i]);
+        file.Write(halfTexels.MemorySize(), halfTexels.Data());
+    }
+    else
+    {
+        file.Write(table.Texels.MemorySize(), table.Texels.Data());
+    }
+}
+
+void LoadEnvironmentBRDFTable(const wchar* filePath, EnvironmentBRDFTable& table)
+{
+    File file(filePath, FileOpenMode::Read);
+
+    EnvironmentBRDFFileHeader header;
+    file.Read(header);
+    if(header.Magic != EnvironmentBRDFFileHeader::ExpectedMagic)
+        throw Exception(L"Invalid environment BRDF table file: " + std::wstring(filePath));
+    if(header.Version != EnvironmentBRDFFileHeader::CurrentVersion)
+        throw Exception(L"Unsupported environment BRDF table version: " + std::wstring(filePath));
+
+    table.NumNDotV = header.NumNDotV;
+    table.NumRoughness = header.NumRoughness;
+    table.Texels.Init(uint64(header.NumNDotV) * header.NumRoughness);
+
+    if(header.Format == EnvironmentBRDFFormat::Float16)
+    {
+        Array<Half2> halfTexels(table.Texels.Size());
+        file.Read(halfTexels.MemorySize(), halfTexels.Data());
+        for(uint64 i = 0; i < table.Texels.Size(); ++i)
+            table.Texels[i] = halfTexels[i].ToFloat2();
+    }
+    else
+    {
+        file.Read(table.Texels.MemorySize(), table.Texels.Data());
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+// Pre-integrated environment BRDF term of the split-sum approximation for a GGX specular lobe. Each
+// texel stores the (scale, bias) to apply to the specular albedo, with nDotV along X and
+// sqrt(roughness) along Y, sampled at texel centers. This matches the layout expected by
+// SH::CalculatePrefilteredSpecular when the table is uploaded as an R32G32/R16G16 texture.
+struct EnvironmentBRDFTable
+{
+    uint32 NumNDotV = 0;
+    uint32 NumRoughness = 0;
+    Array<Float2> Texels;
+
+    // Bilinearly samples the table, clamping to the edges
+    Float2 Sample(float nDotV, float sqrtRoughness) const;
+};
+
+enum class EnvironmentBRDFFormat : uint32
+{
+    Float32 = 0,
+    Float16 = 1,
+};
+
+// Binary file layout: this header followed by NumNDotV * NumRoughness texels, stored as either
+// Float2 or Half2 depending on Format. Rows are stored in order of increasing roughness.
+struct EnvironmentBRDFFileHeader
+{
+    static const uint32 ExpectedMagic = 0x46445242;     // "BRDF"
+    static const uint32 CurrentVersion = 1;
+
+    uint32 Magic = ExpectedMagic;
+    uint32 Version = CurrentVersion;
+    uint32 NumNDotV = 0;
+    uint32 NumRoughness = 0;
+    EnvironmentBRDFFormat Format = EnvironmentBRDFFormat::Float32;
+    uint32 Padding = 0;
+};
+
+// Integrates the table with importance-sampled GGX, using all cores through the given task scheduler
+void GenerateEnvironmentBRDFTable(EnvironmentBRDFTable& table, uint32 numNDotV = 32, uint32 numRoughness = 32,
+                                  uint32 numSamples = 1024, enki::TaskScheduler* taskScheduler = nullptr);
+
+void SaveEnvironmentBRDFTable(const wchar* filePath, const EnvironmentBRDFTable& table,
+                              EnvironmentBRDFFormat format = EnvironmentBRDFFormat::Float16);
+void LoadEnvironmentBRDFTable(const wchar* filePath, EnvironmentBRDFTable& table);
+
+}
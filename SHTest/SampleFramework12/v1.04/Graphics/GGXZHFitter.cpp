@@ -0,0 +1,217 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "GGXZHFitter.h"
+#include "Sampling.h"
+#include "..\\Containers.h"
+#include "..\\Utility.h"
+#include "TaskHelpers.h"
+
+namespace SampleFramework12
+{
+
+static const uint64 NumZHBands = GGXZHFit::NumBands + 1;
+
+struct GGXZHSample
+{
+    double Alpha = 0.0;
+    double ZH[NumZHBands] = { };
+};
+
+// Integrates the GGX lobe for one roughness using importance-sampled half vectors, and projects it
+// onto Legendre polynomials around the reflection vector. The normal is +Z in tangent space.
+static void IntegrateGGXZH(GGXZHSample& sample, double nDotV, uint32 numSamples)
+{
+    const double m2 = sample.Alpha * sample.Alpha;
+    const double vx = std::sqrt(1.0 - nDotV * nDotV);
+    const double vz = nDotV;
+
+    // Matches GGX_V1 from BRDF.h
+    auto ggxV1 = [m2](double nDotX)
+    {
+        return 1.0 / (nDotX + std::sqrt(m2 + (1 - m2) * nDotX * nDotX));
+    };
+
+    double sums[NumZHBands] = { };
+    for(uint32 i = 0; i < numSamples; ++i)
+    {
+        const Float2 u1u2 = Hammersley2D(i, numSamples);
+        const double cosTheta = std::sqrt((1.0 - u1u2.x) / (1.0 + (m2 - 1.0) * u1u2.x));
+        const double sinTheta = std::sqrt(std::max(1.0 - cosTheta * cosTheta, 0.0));
+        const double phi = 2.0 * Pi * u1u2.y;
+        const double hx = sinTheta * std::cos(phi);
+        const double hy = sinTheta * std::sin(phi);
+        const double hz = cosTheta;
+
+        const double vDotH = vx * hx + vz * hz;
+        const double lx = 2.0 * vDotH * hx - vx;
+        const double lz = 2.0 * vDotH * hz - vz;
+        if(lz <= 0.0 || vDotH <= 0.0)
+            continue;
+
+        // The D term cancels with the PDF of the sampled half vector, D * nDotH / (4 * vDotH)
+        const double weight = ggxV1(lz) * ggxV1(nDotV) * lz * 4.0 * vDotH / hz;
+
+        // Cosine of the angle to the reflection vector, which is (-vx, 0, vz)
+        const double x = vz * lz - vx * lx;
+        const double x2 = x * x;
+        sums[0] += weight;
+        sums[1] += weight * x;
+        sums[2] += weight * 0.5 * (3.0 * x2 - 1.0);
+        sums[3] += weight * 0.5 * (5.0 * x2 - 3.0) * x;
+        sums[4] += weight * (35.0 * x2 * x2 - 30.0 * x2 + 3.0) / 8.0;
+    }
+
+    for(uint64 band = 0; band < NumZHBands; ++band)
+        sample.ZH[band] = sums[0] > 0.0 ? sums[band] / sums[0] : 1.0;
+}
+
+// Solves a 4x4 linear system in place with Gauss-Jordan elimination and partial pivoting.
+// The last column of the augmented matrix holds the right-hand side, and receives the solution.
+static bool Solve4x4(double m[4][5])
+{
+    for(uint64 col = 0; col < 4; ++col)
+    {
+        uint64 pivot = col;
+        for(uint64 row = col + 1; row < 4; ++row)
+            if(std::abs(m[row][col]) > std::abs(m[pivot][col]))
+                pivot = row;
+
+        if(std::abs(m[pivot][col]) < 1e-20)
+            return false;
+
+        for(uint64 i = 0; i < 5; ++i)
+            std::swap(m[col][i], m[pivot][i]);
+
+        for(uint64 row = 0; row < 4; ++row)
+        {
+            if(row == col)
+                continue;
+
+            const double factor = m[row][col] / m[col][col];
+            for(uint64 i = col; i < 5; ++i)
+                m[row][i] -= factor * m[col][i];
+        }
+    }
+
+    for(uint64 row = 0; row < 4; ++row)
+        m[row][4] /= m[row][row];
+
+    return true;
+}
+
+float GGXZHFit::Evaluate(float ggxAlpha, uint64 band) const
+{
+    Assert_(band >= 1 && band <= NumBands);
+    const float* c = Coefficients[band - 1];
+    return (1.0f + ggxAlpha * (c[0] + ggxAlpha * c[1])) / (1.0f + ggxAlpha * (c[2] + ggxAlpha * c[3]));
+}
+
+GGXZHFit FitGGXZonalHarmonics(const GGXZHFitSettings& settings, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(settings.NumRoughnessSamples >= 4 && settings.NumIntegrationSamples > 0);
+    Assert_(settings.NDotV > 0.0f && settings.NDotV <= 1.0f);
+
+    // Distribute the sweep evenly in sqrt(alpha) so that there are more samples for low roughness,
+    // where the lobe changes the fastest
+    Array<GGXZHSample> samples(settings.NumRoughnessSamples);
+    for(uint64 i = 0; i < samples.Size(); ++i)
+    {
+        const double sqrtAlpha = (double(i) + 0.5) / double(samples.Size());
+        samples[i].Alpha = sqrtAlpha * sqrtAlpha;
+    }
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    enki::TaskSet taskSet(settings.NumRoughnessSamples, [&](enki::TaskSetPartition range, uint32)
+    {
+        for(uint32 i = range.start; i < range.end; ++i)
+            IntegrateGGXZH(samples[i], settings.NDotV, settings.NumIntegrationSamples);
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+
+    GGXZHFit fit;
+    fit.NDotV = settings.NDotV;
+
+    for(uint64 band = 1; band < NumZHBands; ++band)
+    {
+        // Linearize the rational function as b * a + c * a^2 - g * d * a - g * e * a^2 = g - 1, and
+        // iteratively re-weight by the previous denominator so that the least squares solution
+        // minimizes the actual error instead of the linearized one (Sanathanan-Koerner iteration)
+        double coefficients[4] = { };
+        for(uint64 iteration = 0; iteration < 8; ++iteration)
+        {
+            double system[4][5] = { };
+            for(uint64 i = 0; i < samples.Size(); ++i)
+            {
+                const double a = samples[i].Alpha;
+                const double g = samples[i].ZH[band];
+                const double denominator = 1.0 + a * (coefficients[2] + a * coefficients[3]);
+                const double weight = 1.0 / (denominator * denominator);
+                const double row[4] = { a, a * a, -g * a, -g * a * a };
+                for(uint64 r = 0; r < 4; ++r)
+                {
+                    for(uint64 c = 0; c < 4; ++c)
+                        system[r][c] += weight * row[r] * row[c];
+                    system[r][4] += weight * row[r] * (g - 1.0);
+                }
+            }
+
+            if(Solve4x4(system) == false)
+                break;
+
+            for(uint64 i = 0; i < 4; ++i)
+                coefficients[i] = system[i][4];
+        }
+
+        for(uint64 i = 0; i < 4; ++i)
+            fit.Coefficients[band - 1][i] = float(coefficients[i]);
+
+        for(uint64 i = 0; i < samples.Size(); ++i)
+        {
+            const float error = std::abs(fit.Evaluate(float(samples[i].Alpha), band) - float(samples[i].ZH[band]));
+            fit.MaxError[band - 1] = std::max(fit.MaxError[band - 1], error);
+        }
+    }
+
+    return fit;
+}
+
+std::string GGXZHFitToHLSL(const GGXZHFit& fit)
+{
+    std::string result = MakeString("// Generated by FitGGXZonalHarmonics with nDotV = %f, max error per band = (%f, %f, %f, %f)\n",
+                                    fit.NDotV, fit.MaxError[0], fit.MaxError[1], fit.MaxError[2], fit.MaxError[3]);
+
+    const char* names[4] = { "GGXZHFitB", "GGXZHFitC", "GGXZHFitD", "GGXZHFitE" };
+    for(uint64 i = 0; i < 4; ++i)
+        result += MakeString("static const float32_t4 %s = float32_t4(%.9gf, %.9gf, %.9gf, %.9gf);\n", names[i],
+                             fit.Coefficients[0][i], fit.Coefficients[1][i], fit.Coefficients[2][i], fit.Coefficients[3][i]);
+
+    return result;
+}
+
+std::string GGXZHFitToCPP(const GGXZHFit& fit)
+{
+    std::string result = MakeString("// Generated by FitGGXZonalHarmonics with nDotV = %f, max error per band = (%f, %f, %f, %f)\n",
+                                    fit.NDotV, fit.MaxError[0], fit.MaxError[1], fit.MaxError[2], fit.MaxError[3]);
+
+    result += "static const float GGXZHFitTable[4][4] =\n{\n";
+    for(uint64 band = 0; band < GGXZHFit::NumBands; ++band)
+        result += MakeString("    { %.9gf, %.9gf, %.9gf, %.9gf },\n", fit.Coefficients[band][0], fit.Coefficients[band][1],
+                             fit.Coefficients[band][2], fit.Coefficients[band][3]);
+    result += "};\n";
+
+    return result;
+}
+
+}
@@ -0,0 +1,56 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+// Offline fitter for approximating a GGX specular lobe as zonal harmonics. For each roughness in the
+// sweep the lobe (D * G * nDotL with Fresnel omitted) is integrated around the reflection vector to get
+// a scale for each band relative to band 0, and each band is then fit with a rational function of the
+// form (1 + b * alpha + c * alpha^2) / (1 + d * alpha + e * alpha^2), which is exact for a mirror.
+struct GGXZHFitSettings
+{
+    uint32 NumRoughnessSamples = 64;
+    uint32 NumIntegrationSamples = 65536;
+
+    // 1.0 integrates the lobe at normal incidence, lower values produce a view-dependent fit
+    float NDotV = 1.0f;
+};
+
+struct GGXZHFit
+{
+    // L1 through L4, L0 is always 1
+    static const uint64 NumBands = 4;
+
+    float Coefficients[NumBands][4] = { };     // (b, c, d, e) for each band
+    float MaxError[NumBands] = { };            // Largest difference from the integrated values
+    float NDotV = 1.0f;
+
+    float Evaluate(float ggxAlpha, uint64 band) const;
+};
+
+// Integrates the roughness sweep in parallel using the given task scheduler
+GGXZHFit FitGGXZonalHarmonics(const GGXZHFitSettings& settings = GGXZHFitSettings(),
+                              enki::TaskScheduler* taskScheduler = nullptr);
+
+// Emits the fit as constants in the layout used by SH.hlsli and SH.cpp
+std::string GGXZHFitToHLSL(const GGXZHFit& fit);
+std::string GGXZHFitToCPP(const GGXZHFit& fit);
+
+}
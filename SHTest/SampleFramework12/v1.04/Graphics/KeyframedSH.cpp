@@ -0,0 +1,384 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "KeyframedSH.h"
+#include "..\\Utility.h"
+#include "..\\Timer.h"
+#include "TaskHelpers.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace SampleFramework12
+{
+
+static const uint64 FloatsPerProbe = SH9ColorNumFloats;
+
+// 4 probes are exactly 27 SIMD vectors, so the SIMD paths work on groups of 4 probes
+static const uint64 ProbesPerGroup = 4;
+static const uint64 VectorsPerGroup = FloatsPerProbe;
+
+static float FrameTime(const float* frameTimes, uint64 frameIdx)
+{
+    return frameTimes != nullptr ? frameTimes[frameIdx] : float(frameIdx);
+}
+
+// Returns true if every frame between keyA and keyB is reproduced within the tolerance by lerping the two
+static bool SpanFitsTolerance(const SH9Color* frames, uint64 numProbes, const float* frameTimes, uint64 keyA, uint64 keyB,
+                              float tolerance, enki::TaskScheduler* taskScheduler)
+{
+    const float* floatsA = &frames[keyA * numProbes].Coefficients[0].x;
+    const float* floatsB = &frames[keyB * numProbes].Coefficients[0].x;
+    const float timeA = FrameTime(frameTimes, keyA);
+    const float timeB = FrameTime(frameTimes, keyB);
+
+    std::atomic<bool> exceeded(false);
+    enki::TaskSet taskSet(uint32(numProbes), [&](enki::TaskSetPartition range, uint32)
+    {
+        for(uint64 frameIdx = keyA + 1; frameIdx < keyB && exceeded == false; ++frameIdx)
+        {
+            const float s = (FrameTime(frameTimes, frameIdx) - timeA) / (timeB - timeA);
+            const float* floats = &frames[frameIdx * numProbes].Coefficients[0].x;
+            for(uint64 i = range.start * FloatsPerProbe; i < range.end * FloatsPerProbe; ++i)
+            {
+                const float interpolated = floatsA[i] * (1.0f - s) + floatsB[i] * s;
+                if(std::abs(interpolated - floats[i]) > tolerance)
+                {
+                    exceeded = true;
+                    return;
+                }
+            }
+        }
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+
+    return exceeded == false;
+}
+
+uint64 KeyframedSH::DeltaStride() const
+{
+    return AlignTo(NumProbes * FloatsPerProbe * (DeltaBits / 8), uint64(4));
+}
+
+uint64 KeyframedSH::MemorySize() const
+{
+    return KeyTimes.MemorySize() + BaseFrame.MemorySize() + DeltaScales.MemorySize() + DeltaData.MemorySize();
+}
+
+KeyframedSHStats CompressKeyframedSH(const SH9Color* frames, uint64 numProbes, uint64 numFrames, const float* frameTimes,
+                                     KeyframedSH& output, const KeyframedSHSettings& settings, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(frames != nullptr && numProbes > 0 && numFrames > 0 && numProbes <= UINT32_MAX);
+    Assert_(settings.DeltaBits == 8 || settings.DeltaBits == 16);
+    for(uint64 frameIdx = 1; frameIdx < numFrames; ++frameIdx)
+        Assert_(FrameTime(frameTimes, frameIdx) > FrameTime(frameTimes, frameIdx - 1));
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    // Greedily extend each span between keyframes for as long as lerping across it stays within the tolerance
+    List<uint64> keptFrames;
+    keptFrames.Add(0);
+    if(settings.PruneTolerance > 0.0f)
+    {
+        uint64 lastKey = 0;
+        for(uint64 frameIdx = 2; frameIdx < numFrames; ++frameIdx)
+        {
+            if(SpanFitsTolerance(frames, numProbes, frameTimes, lastKey, frameIdx, settings.PruneTolerance, taskScheduler) == false)
+            {
+                lastKey = frameIdx - 1;
+                keptFrames.Add(lastKey);
+            }
+        }
+        if(numFrames > 1)
+            keptFrames.Add(numFrames - 1);
+    }
+    else
+    {
+        for(uint64 frameIdx = 1; frameIdx < numFrames; ++frameIdx)
+            keptFrames.Add(frameIdx);
+    }
+
+    const uint64 numKeyframes = keptFrames.Count();
+    const uint64 numFloats = numProbes * FloatsPerProbe;
+
+    output.NumProbes = numProbes;
+    output.NumSourceFrames = numFrames;
+    output.DeltaBits = settings.DeltaBits;
+    output.KeyTimes.Init(numKeyframes);
+    for(uint64 keyIdx = 0; keyIdx < numKeyframes; ++keyIdx)
+        output.KeyTimes[keyIdx] = FrameTime(frameTimes, keptFrames[keyIdx]);
+
+    output.BaseFrame.Init(numProbes);
+    memcpy(output.BaseFrame.Data(), frames, numProbes * sizeof(SH9Color));
+
+    const uint64 deltaStride = output.DeltaStride();
+    output.DeltaScales.Init((numKeyframes - 1) * FloatsPerProbe, 0.0f);
+    output.DeltaData.Init((numKeyframes - 1) * deltaStride, 0);
+
+    // Quantize each keyframe's delta against the reconstruction of the previous keyframe
+    const float maxQuantized = settings.DeltaBits == 8 ? 127.0f : 32767.0f;
+    Array<float> reconstructed(numFloats);
+    memcpy(reconstructed.Data(), frames, numFloats * sizeof(float));
+
+    for(uint64 keyIdx = 1; keyIdx < numKeyframes; ++keyIdx)
+    {
+        const float* target = &frames[keptFrames[keyIdx] * numProbes].Coefficients[0].x;
+        float* scales = &output.DeltaScales[(keyIdx - 1) * FloatsPerProbe];
+        uint8* deltaData = &output.DeltaData[(keyIdx - 1) * deltaStride];
+
+        for(uint64 i = 0; i < numFloats; ++i)
+        {
+            float& scale = scales[i % FloatsPerProbe];
+            scale = Max(scale, std::abs(target[i] - reconstructed[i]));
+        }
+
+        for(uint64 c = 0; c < FloatsPerProbe; ++c)
+            scales[c] /= maxQuantized;
+
+        for(uint64 i = 0; i < numFloats; ++i)
+        {
+            const float scale = scales[i % FloatsPerProbe];
+            const float delta = target[i] - reconstructed[i];
+            const float quantized = scale > 0.0f ? Clamp(std::round(delta / scale), -maxQuantized, maxQuantized) : 0.0f;
+            if(settings.DeltaBits == 8)
+                reinterpret_cast<int8*>(deltaData)[i] = int8(quantized);
+            else
+                reinterpret_cast<int16*>(deltaData)[i] = int16(quantized);
+
+            reconstructed[i] += quantized * scale;
+        }
+    }
+
+    KeyframedSHStats stats;
+    stats.NumSourceFrames = numFrames;
+    stats.NumKeyframes = numKeyframes;
+    stats.UncompressedSize = numFrames * numProbes * sizeof(SH9Color);
+    stats.CompressedSize = output.MemorySize();
+    stats.CompressionRatio = float(double(stats.UncompressedSize) / double(stats.CompressedSize));
+
+    // Play back the compressed sequence to measure the error at every source frame
+    KeyframedSHDecoder decoder;
+    decoder.Initialize(&output);
+    Array<SH9Color> decoded(numProbes);
+    double errorSqSum = 0.0;
+    for(uint64 frameIdx = 0; frameIdx < numFrames; ++frameIdx)
+    {
+        decoder.Decode(FrameTime(frameTimes, frameIdx), decoded.Data());
+
+        const float* source = &frames[frameIdx * numProbes].Coefficients[0].x;
+        const float* result = &decoded[0].Coefficients[0].x;
+        for(uint64 i = 0; i < numFloats; ++i)
+        {
+            const float error = std::abs(result[i] - source[i]);
+            errorSqSum += double(error) * error;
+            stats.MaxError = Max(stats.MaxError, error);
+        }
+    }
+
+    stats.RMSError = float(std::sqrt(errorSqSum / double(numFrames * numFloats)));
+
+    return stats;
+}
+
+std::string KeyframedSHStatsToString(const KeyframedSHStats& stats)
+{
+    return MakeString("Keyframed SH: %llu frames -> %llu keyframes, %s\n"
+                      "Coefficient error: RMS %f, max %f\n",
+                      stats.NumSourceFrames, stats.NumKeyframes,
+                      SizeReductionString(stats.UncompressedSize, stats.CompressedSize).c_str(), stats.RMSError, stats.MaxError);
+}
+
+// == KeyframedSHDecoder ==========================================================================
+
+void KeyframedSHDecoder::Initialize(const KeyframedSH* keyframes_, bool useSIMD_)
+{
+    Assert_(keyframes_ != nullptr && keyframes_->NumKeyframes() > 0);
+
+    keyframes = keyframes_;
+    useSIMD = useSIMD_;
+    keyA.Init(keyframes->NumProbes * FloatsPerProbe);
+    keyB.Init(keyframes->NumProbes * FloatsPerProbe);
+    currKey = UINT64_MAX;
+}
+
+void KeyframedSHDecoder::ApplyDelta(uint64 keyIdx, const float* src, float* dst) const
+{
+    const float* scales = &keyframes->DeltaScales[(keyIdx - 1) * FloatsPerProbe];
+    const uint8* deltaData = &keyframes->DeltaData[(keyIdx - 1) * keyframes->DeltaStride()];
+    const int8* deltas8 = reinterpret_cast<const int8*>(deltaData);
+    const int16* deltas16 = reinterpret_cast<const int16*>(deltaData);
+
+    const uint64 numFloats = keyframes->NumProbes * FloatsPerProbe;
+    for(uint64 i = 0; i < numFloats; ++i)
+    {
+        const float quantized = keyframes->DeltaBits == 8 ? float(deltas8[i]) : float(deltas16[i]);
+        dst[i] = src[i] + quantized * scales[i % FloatsPerProbe];
+    }
+}
+
+void KeyframedSHDecoder::ApplyDeltaSIMD(uint64 keyIdx, const float* src, float* dst) const
+{
+    using namespace DirectX;
+    using namespace DirectX::PackedVector;
+
+    const float* scales = &keyframes->DeltaScales[(keyIdx - 1) * FloatsPerProbe];
+    const uint8* deltaData = &keyframes->DeltaData[(keyIdx - 1) * keyframes->DeltaStride()];
+
+    // The 27 scales repeat every probe, so they line up with the same vectors in every group of 4 probes
+    XMVECTOR groupScales[VectorsPerGroup];
+    for(uint64 v = 0; v < VectorsPerGroup; ++v)
+        groupScales[v] = XMVectorSet(scales[(v * 4 + 0) % FloatsPerProbe], scales[(v * 4 + 1) % FloatsPerProbe],
+                                     scales[(v * 4 + 2) % FloatsPerProbe], scales[(v * 4 + 3) % FloatsPerProbe]);
+
+    const uint64 numGroups = keyframes->NumProbes / ProbesPerGroup;
+    const uint64 groupFloats = ProbesPerGroup * FloatsPerProbe;
+    if(keyframes->DeltaBits == 8)
+    {
+        const XMBYTE4* deltas = reinterpret_cast<const XMBYTE4*>(deltaData);
+        for(uint64 g = 0; g < numGroups; ++g)
+        {
+            for(uint64 v = 0; v < VectorsPerGroup; ++v)
+            {
+                const uint64 idx = g * VectorsPerGroup + v;
+                const XMVECTOR result = XMVectorMultiplyAdd(XMLoadByte4(&deltas[idx]), groupScales[v], XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src) + idx));
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dst) + idx, result);
+            }
+        }
+    }
+    else
+    {
+        const XMSHORT4* deltas = reinterpret_cast<const XMSHORT4*>(deltaData);
+        for(uint64 g = 0; g < numGroups; ++g)
+        {
+            for(uint64 v = 0; v < VectorsPerGroup; ++v)
+            {
+                const uint64 idx = g * VectorsPerGroup + v;
+                const XMVECTOR result = XMVectorMultiplyAdd(XMLoadShort4(&deltas[idx]), groupScales[v], XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src) + idx));
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dst) + idx, result);
+            }
+        }
+    }
+
+    // Leftover probes that don't fill a group
+    const uint64 numFloats = keyframes->NumProbes * FloatsPerProbe;
+    for(uint64 i = numGroups * groupFloats; i < numFloats; ++i)
+    {
+        const float quantized = keyframes->DeltaBits == 8 ? float(reinterpret_cast<const int8*>(deltaData)[i])
+                                                          : float(reinterpret_cast<const int16*>(deltaData)[i]);
+        dst[i] = src[i] + quantized * scales[i % FloatsPerProbe];
+    }
+}
+
+void KeyframedSHDecoder::Decode(float time, SH9Color* output)
+{
+    Assert_(keyframes != nullptr && output != nullptr);
+
+    const uint64 numKeyframes = keyframes->NumKeyframes();
+    const uint64 numFloats = keyframes->NumProbes * FloatsPerProbe;
+    float* outputFloats = &output[0].Coefficients[0].x;
+    if(numKeyframes == 1)
+    {
+        memcpy(outputFloats, keyframes->BaseFrame.Data(), numFloats * sizeof(float));
+        return;
+    }
+
+    time = Clamp(time, keyframes->KeyTimes[0], keyframes->KeyTimes[numKeyframes - 1]);
+    const float* keyTimesEnd = keyframes->KeyTimes.Data() + numKeyframes;
+    const uint64 key = Min<uint64>(std::upper_bound(keyframes->KeyTimes.Data(), keyTimesEnd, time) - keyframes->KeyTimes.Data() - 1, numKeyframes - 2);
+
+    if(currKey == UINT64_MAX || key < currKey)
+    {
+        memcpy(keyA.Data(), keyframes->BaseFrame.Data(), numFloats * sizeof(float));
+        if(useSIMD)
+            ApplyDeltaSIMD(1, keyA.Data(), keyB.Data());
+        else
+            ApplyDelta(1, keyA.Data(), keyB.Data());
+        currKey = 0;
+    }
+
+    while(currKey < key)
+    {
+        std::swap(keyA, keyB);
+        if(useSIMD)
+            ApplyDeltaSIMD(currKey + 2, keyA.Data(), keyB.Data());
+        else
+            ApplyDelta(currKey + 2, keyA.Data(), keyB.Data());
+        ++currKey;
+    }
+
+    const float s = (time - keyframes->KeyTimes[key]) / (keyframes->KeyTimes[key + 1] - keyframes->KeyTimes[key]);
+    const float* a = keyA.Data();
+    const float* b = keyB.Data();
+    uint64 i = 0;
+    if(useSIMD)
+    {
+        const DirectX::XMVECTOR sVec = DirectX::XMVectorReplicate(s);
+        const DirectX::XMVECTOR oneMinusS = DirectX::XMVectorReplicate(1.0f - s);
+        for(; i + 4 <= numFloats; i += 4)
+        {
+            const DirectX::XMVECTOR va = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(a + i));
+            const DirectX::XMVECTOR vb = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(b + i));
+            const DirectX::XMVECTOR result = DirectX::XMVectorMultiplyAdd(vb, sVec, DirectX::XMVectorMultiply(va, oneMinusS));
+            DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(outputFloats + i), result);
+        }
+    }
+
+    for(; i < numFloats; ++i)
+        outputFloats[i] = a[i] * (1.0f - s) + b[i] * s;
+}
+
+// == Benchmark ===================================================================================
+
+static double TimeDecode(const KeyframedSH& keyframes, bool useSIMD, uint32 numLoops, uint32 numStepsPerLoop, SH9Color* output)
+{
+    KeyframedSHDecoder decoder;
+    decoder.Initialize(&keyframes, useSIMD);
+
+    const float startTime = keyframes.KeyTimes[0];
+    const float endTime = keyframes.KeyTimes[keyframes.NumKeyframes() - 1];
+
+    Timer timer;
+    for(uint32 loop = 0; loop < numLoops; ++loop)
+        for(uint32 step = 0; step < numStepsPerLoop; ++step)
+            decoder.Decode(Lerp(startTime, endTime, step / float(Max(numStepsPerLoop - 1, 1u))), output);
+
+    timer.Update();
+    return timer.ElapsedMillisecondsD();
+}
+
+KeyframedSHDecodeBenchmark BenchmarkKeyframedSHDecode(const KeyframedSH& keyframes, uint32 numLoops, uint32 numStepsPerLoop)
+{
+    Assert_(numLoops > 0 && numStepsPerLoop > 0);
+
+    Array<SH9Color> output(keyframes.NumProbes);
+
+    KeyframedSHDecodeBenchmark benchmark;
+    benchmark.NumProbes = keyframes.NumProbes;
+    benchmark.NumDecodes = uint64(numLoops) * numStepsPerLoop;
+    benchmark.ScalarMilliseconds = TimeDecode(keyframes, false, numLoops, numStepsPerLoop, output.Data());
+    benchmark.SIMDMilliseconds = TimeDecode(keyframes, true, numLoops, numStepsPerLoop, output.Data());
+
+    return benchmark;
+}
+
+std::string KeyframedSHDecodeBenchmarkToString(const KeyframedSHDecodeBenchmark& benchmark)
+{
+    return MakeString("Keyframed SH decode: %llu probes x %llu decodes\n"
+                      "Scalar: %.2f ms (%.2f M probes/s)\n"
+                      "SIMD: %.2f ms (%.2f M probes/s)\n",
+                      benchmark.NumProbes, benchmark.NumDecodes,
+                      benchmark.ScalarMilliseconds, benchmark.ScalarProbesPerSecond() / 1000000.0,
+                      benchmark.SIMDMilliseconds, benchmark.SIMDProbesPerSecond() / 1000000.0);
+}
+
+}
@@ -0,0 +1,135 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+struct KeyframedSHSettings
+{
+    // Interior frames are dropped when linearly interpolating between the surrounding keyframes reproduces
+    // them with a max coefficient error at or below this tolerance. 0 keeps every frame as a keyframe.
+    float PruneTolerance = 0.0f;
+
+    // Bits per quantized delta coefficient, either 8 or 16
+    uint32 DeltaBits = 16;
+};
+
+// A time-varying probe set (for example a time-of-day or animated light bake) stored as a full-precision base
+// frame followed by quantized deltas for each subsequent keyframe. Deltas are taken against the previously
+// decoded keyframe rather than the source data, so quantization error doesn't accumulate over the sequence.
+//
+//  DeltaScales:    27 floats per delta keyframe, one per coefficient and color channel
+//  DeltaData:      NumProbes * 27 signed 8 or 16-bit values per delta keyframe, padded to a multiple of 4 bytes
+struct KeyframedSH
+{
+    uint64 NumProbes = 0;
+    uint64 NumSourceFrames = 0;
+    uint32 DeltaBits = 16;
+
+    Array<float> KeyTimes;
+    Array<SH9Color> BaseFrame;
+    Array<float> DeltaScales;
+    Array<uint8> DeltaData;
+
+    uint64 NumKeyframes() const { return KeyTimes.Size(); }
+    uint64 DeltaStride() const;
+    uint64 MemorySize() const;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, NumProbes);
+        SerializeItem(serializer, NumSourceFrames);
+        SerializeItem(serializer, DeltaBits);
+        BulkSerializeItem(serializer, KeyTimes);
+        BulkSerializeItem(serializer, BaseFrame);
+        BulkSerializeItem(serializer, DeltaScales);
+        BulkSerializeItem(serializer, DeltaData);
+    }
+};
+
+struct KeyframedSHStats
+{
+    uint64 NumSourceFrames = 0;
+    uint64 NumKeyframes = 0;
+
+    uint64 UncompressedSize = 0;
+    uint64 CompressedSize = 0;
+    float CompressionRatio = 0.0f;
+
+    // Coefficient error of the decoded sequence at every source frame
+    float RMSError = 0.0f;
+    float MaxError = 0.0f;
+};
+
+// Compresses numFrames probe sets of numProbes probes each, stored frame-major. frameTimes must be strictly
+// increasing, or null to use the frame indices as times. Pruning runs on the given task scheduler.
+KeyframedSHStats CompressKeyframedSH(const SH9Color* frames, uint64 numProbes, uint64 numFrames, const float* frameTimes,
+                                     KeyframedSH& output, const KeyframedSHSettings& settings = KeyframedSHSettings(),
+                                     enki::TaskScheduler* taskScheduler = nullptr);
+
+std::string KeyframedSHStatsToString(const KeyframedSHStats& stats);
+
+// Plays back a KeyframedSH by keeping the two keyframes surrounding the current time decoded, and blending
+// them with the same x * (1 - s) + y * s as SH::Lerp. Moving forward in time applies one delta per keyframe
+// that's passed, while moving backwards restarts from the base frame.
+class KeyframedSHDecoder
+{
+
+public:
+
+    void Initialize(const KeyframedSH* keyframes, bool useSIMD = true);
+
+    // Writes the interpolated probe set for the given time, clamped to the time range of the keyframes
+    void Decode(float time, SH9Color* output);
+
+    uint64 CurrentKeyframe() const { return currKey; }
+
+private:
+
+    void ApplyDelta(uint64 keyIdx, const float* src, float* dst) const;
+    void ApplyDeltaSIMD(uint64 keyIdx, const float* src, float* dst) const;
+
+    const KeyframedSH* keyframes = nullptr;
+    bool useSIMD = true;
+    Array<float> keyA;
+    Array<float> keyB;
+    uint64 currKey = UINT64_MAX;
+};
+
+struct KeyframedSHDecodeBenchmark
+{
+    uint64 NumProbes = 0;
+    uint64 NumDecodes = 0;
+    double ScalarMilliseconds = 0.0;
+    double SIMDMilliseconds = 0.0;
+
+    double ScalarProbesPerSecond() const { return ScalarMilliseconds > 0.0 ? NumProbes * NumDecodes / (ScalarMilliseconds / 1000.0) : 0.0; }
+    double SIMDProbesPerSecond() const { return SIMDMilliseconds > 0.0 ? NumProbes * NumDecodes / (SIMDMilliseconds / 1000.0) : 0.0; }
+};
+
+// Plays the full sequence numLoops times with numStepsPerLoop evenly spaced decodes, using both decoder paths
+KeyframedSHDecodeBenchmark BenchmarkKeyframedSHDecode(const KeyframedSH& keyframes, uint32 numLoops, uint32 numStepsPerLoop);
+
+std::string KeyframedSHDecodeBenchmarkToString(const KeyframedSHDecodeBenchmark& benchmark);
+
+}
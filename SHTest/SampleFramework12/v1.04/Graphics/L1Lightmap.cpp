@@ -0,0 +1,160 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "L1Lightmap.h"
+#include "..\\Utility.h"
+#include "..\\Exceptions.h"
+
+namespace SampleFramework12
+{
+
+void EncodeL1LightmapTexel(const SH4Color& sh, Float4& l0Texel, Float4& l1Texel)
+{
+    const Float3 l0 = Float3(Max(sh.Coefficients[0].x, 0.0f), Max(sh.Coefficients[0].y, 0.0f), Max(sh.Coefficients[0].z, 0.0f));
+    l0Texel = Float4(l0, 1.0f);
+
+    const float l0Luminance = ComputeLuminance(l0);
+    const Float3 l1Luminance = Float3(ComputeLuminance(sh.Coefficients[1]), ComputeLuminance(sh.Coefficients[2]),
+                                      ComputeLuminance(sh.Coefficients[3]));
+    const float l1Length = Float3::Length(l1Luminance);
+    if(l0Luminance <= 0.0f || l1Length <= 0.0f)
+    {
+        l1Texel = Float4(0.5f, 0.5f, 0.5f, 0.0f);
+        return;
+    }
+
+    const Float3 direction = l1Luminance / l1Length;
+    const float ratio = Saturate(l1Length / (l0Luminance * MaxL1Ratio));
+    l1Texel = Float4(direction * 0.5f + 0.5f, ratio);
+}
+
+SH4Color DecodeL1LightmapTexel(const Float4& l0Texel, const Float4& l1Texel)
+{
+    const Float3 l0 = l0Texel.To3D();
+    const Float3 l1 = (l1Texel.To3D() * 2.0f - 1.0f) * (l1Texel.w * MaxL1Ratio);
+
+    SH4Color sh;
+    sh.Coefficients[0] = l0;
+    sh.Coefficients[1] = l0 * l1.x;
+    sh.Coefficients[2] = l0 * l1.y;
+    sh.Coefficients[3] = l0 * l1.z;
+    return sh;
+}
+
+// RMS over all directions and color channels of the irradiance from a set of L1 radiance coefficients
+static float IrradianceRMS(const SH4Color& sh)
+{
+    float sum = CosineA0 * CosineA0 * Float3::Dot(sh.Coefficients[0], sh.Coefficients[0]);
+    for(uint64 i = 1; i < 4; ++i)
+        sum += CosineA1 * CosineA1 * Float3::Dot(sh.Coefficients[i], sh.Coefficients[i]);
+
+    return std::sqrt(sum / (4.0f * Pi * 3.0f));
+}
+
+static void CompressAndSave(const TextureData<Float4>& texels, DXGI_FORMAT format, const wchar* filePath,
+                            DirectX::ScratchImage& decompressed, uint64& compressedSize)
+{
+    WriteLog("Saving DDS file '%ls'", filePath);
+
+    DirectX::ScratchImage scratchImage;
+    DXCall(scratchImage.Initialize2D(DXGI_FORMAT_R32G32B32A32_FLOAT, texels.Width, texels.Height, 1, 1));
+    memcpy(scratchImage.GetPixels(), texels.Texels.Data(), texels.Texels.MemorySize());
+
+    DirectX::ScratchImage compressed;
+    DXCall(DirectX::Compress(*scratchImage.GetImage(0, 0, 0), format, DirectX::TEX_COMPRESS_PARALLEL,
+                             DirectX::TEX_THRESHOLD_DEFAULT, compressed));
+
+    DXCall(SaveToDDSFile(compressed.GetImages(), compressed.GetImageCount(),
+                         compressed.GetMetadata(), DirectX::DDS_FLAGS_FORCE_DX10_EXT, filePath));
+
+    DXCall(DirectX::Decompress(*compressed.GetImage(0, 0, 0), DXGI_FORMAT_R32G32B32A32_FLOAT, decompressed));
+    compressedSize = compressed.GetPixelsSize();
+}
+
+L1LightmapEncodeStats EncodeL1LightmapToDDS(const TextureData<Float4> coefficientPlanes[4], const wchar* l0FilePath,
+                                            const wchar* l1FilePath)
+{
+    const uint32 width = coefficientPlanes[0].Width;
+    const uint32 height = coefficientPlanes[0].Height;
+    for(uint64 i = 0; i < 4; ++i)
+    {
+        Assert_(coefficientPlanes[i].Width == width && coefficientPlanes[i].Height == height);
+        Assert_(coefficientPlanes[i].NumSlices == 1);
+    }
+
+    const uint64 numTexels = uint64(width) * height;
+
+    TextureData<Float4> l0Texels;
+    TextureData<Float4> l1Texels;
+    l0Texels.Init(width, height, 1);
+    l1Texels.Init(width, height, 1);
+
+    for(uint64 texelIdx = 0; texelIdx < numTexels; ++texelIdx)
+    {
+        SH4Color sh;
+        for(uint64 i = 0; i < 4; ++i)
+            sh.Coefficients[i] = coefficientPlanes[i].Texels[texelIdx].To3D();
+
+        EncodeL1LightmapTexel(sh, l0Texels.Texels[texelIdx], l1Texels.Texels[texelIdx]);
+    }
+
+    L1LightmapEncodeStats stats;
+    DirectX::ScratchImage l0Decompressed;
+    DirectX::ScratchImage l1Decompressed;
+    uint64 l0Size = 0;
+    uint64 l1Size = 0;
+    CompressAndSave(l0Texels, DXGI_FORMAT_BC6H_UF16, l0FilePath, l0Decompressed, l0Size);
+    CompressAndSave(l1Texels, DXGI_FORMAT_BC7_UNORM, l1FilePath, l1Decompressed, l1Size);
+
+    // Measure the error of the decoded result, after BC compression
+    const DirectX::Image* l0Image = l0Decompressed.GetImage(0, 0, 0);
+    const DirectX::Image* l1Image = l1Decompressed.GetImage(0, 0, 0);
+    double errorSum = 0.0;
+    double irradianceSqSum = 0.0;
+    for(uint32 y = 0; y < height; ++y)
+    {
+        const Float4* l0Row = reinterpret_cast<const Float4*>(l0Image->pixels + y * l0Image->rowPitch);
+        const Float4* l1Row = reinterpret_cast<const Float4*>(l1Image->pixels + y * l1Image->rowPitch);
+        for(uint32 x = 0; x < width; ++x)
+        {
+            const uint64 texelIdx = uint64(y) * width + x;
+            SH4Color original;
+            for(uint64 i = 0; i < 4; ++i)
+                original.Coefficients[i] = coefficientPlanes[i].Texels[texelIdx].To3D();
+
+            const float error = IrradianceRMS(original - DecodeL1LightmapTexel(l0Row[x], l1Row[x]));
+            const float irradiance = IrradianceRMS(original);
+            errorSum += error;
+            irradianceSqSum += irradiance * irradiance;
+            stats.MaxIrradianceError = Max(stats.MaxIrradianceError, error);
+        }
+    }
+
+    const double rmsIrradiance = std::sqrt(irradianceSqSum / double(numTexels));
+    stats.AvgIrradianceError = float(errorSum / double(numTexels));
+    stats.RelativeIrradianceError = rmsIrradiance > 0.0 ? float(stats.AvgIrradianceError / rmsIrradiance) : 0.0f;
+
+    // The uncompressed size is for the usual layout of four RGBA16F textures
+    stats.UncompressedSize = numTexels * 4 * sizeof(Half4);
+    stats.CompressedSize = l0Size + l1Size;
+    stats.CompressionRatio = float(double(stats.UncompressedSize) / double(stats.CompressedSize));
+
+    return stats;
+}
+
+std::string L1LightmapEncodeStatsToString(const L1LightmapEncodeStats& stats)
+{
+    return MakeString("L1 lightmap encoding: %s\n"
+                      "Irradiance error: avg %f, max %f, relative %.3f%%\n",
+                      SizeReductionString(stats.UncompressedSize, stats.CompressedSize).c_str(),
+                      stats.AvgIrradianceError, stats.MaxIrradianceError, stats.RelativeIrradianceError * 100.0f);
+}
+
+}
@@ -0,0 +1,58 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "Textures.h"
+#include "SH.h"
+
+namespace SampleFramework12
+{
+
+// Compact encoding for L1 RGB lightmaps, decoded with SH::DecodeL1FromTextures from SH.hlsli:
+//
+//  L0 texture (BC6H_UF16):     the L0 coefficient's RGB color, clamped to be non-negative.
+//  L1 texture (BC7_UNORM):     RGB is the direction of the luminance L1 vector, remapped from [-1, 1] to
+//                              [0, 1], and A is the length of that vector relative to the luminance of L0,
+//                              divided by MaxL1Ratio.
+//
+// The L1 coefficients of each color channel are rebuilt by scaling the channel's L0 by the shared luminance
+// ratio, so the directional part of the lighting takes on the color of the L0 term. The textures cost 2 bytes
+// per texel, compared to 32 for four RGBA16F textures.
+//
+// For non-negative radiance the length of L1 is at most sqrt(3) times L0 (reached by a single delta light).
+static const float MaxL1Ratio = 1.7320508f;
+
+void EncodeL1LightmapTexel(const SH4Color& sh, Float4& l0Texel, Float4& l1Texel);
+SH4Color DecodeL1LightmapTexel(const Float4& l0Texel, const Float4& l1Texel);
+
+struct L1LightmapEncodeStats
+{
+    uint64 UncompressedSize = 0;
+    uint64 CompressedSize = 0;
+    float CompressionRatio = 0.0f;
+
+    // Irradiance errors are the RMS over all directions and color channels of the difference between the
+    // irradiance from the original and the decoded texels, including the BC compression. The relative error
+    // is the average error divided by the RMS irradiance of the original texels.
+    float AvgIrradianceError = 0.0f;
+    float MaxIrradianceError = 0.0f;
+    float RelativeIrradianceError = 0.0f;
+};
+
+// Encodes a lightmap stored as 4 planes (coefficient i's RGB in the xyz of plane i), compresses the
+// result to BC6H and BC7, and writes both textures to DDS files
+L1LightmapEncodeStats EncodeL1LightmapToDDS(const TextureData<Float4> coefficientPlanes[4], const wchar* l0FilePath,
+                                            const wchar* l1FilePath);
+
+std::string L1LightmapEncodeStatsToString(const L1LightmapEncodeStats& stats);
+
+}
@@ -0,0 +1,222 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbeBandLOD.h"
+#include "..\\Utility.h"
+#include "TaskHelpers.h"
+
+namespace SampleFramework12
+{
+
+// Number of directions on a Fibonacci sphere used to measure the irradiance error of each LOD
+static const uint64 NumErrorDirections = 256;
+
+static Float3 ErrorDirection(uint64 idx)
+{
+    const float z = 1.0f - (2.0f * idx + 1.0f) / float(NumErrorDirections);
+    const float r = std::sqrt(Max(1.0f - z * z, 0.0f));
+    const float phi = idx * Pi * (3.0f - std::sqrt(5.0f));
+    return Float3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+// ZH3 hallucination needs a non-zero luminance L1 vector for its axis and a positive L0 in every channel to
+// compute the ratio, the shader doesn't guard against either so probes that fail this are never stored as L1
+static bool CanUseZH3(const Float3* coefficients, Float3& zonalAxis)
+{
+    const Float3 lumCoefficients = Float3(0.2126f, 0.7152f, 0.0722f);
+    zonalAxis = Float3(Float3::Dot(coefficients[3], lumCoefficients), Float3::Dot(coefficients[1], lumCoefficients),
+                       Float3::Dot(coefficients[2], lumCoefficients));
+    const float axisLength = zonalAxis.Length();
+    if(axisLength <= 1e-8f || coefficients[0].x <= 0.0f || coefficients[0].y <= 0.0f || coefficients[0].z <= 0.0f)
+        return false;
+
+    zonalAxis /= axisLength;
+    return true;
+}
+
+// Matches CalculateIrradianceL1ZH3Hallucinate from SH.hlsli
+static Float3 EvalL1ZH3Irradiance(const Float3& dir, const Float3* coefficients, const Float3& zonalAxis)
+{
+    const Float3 projected = coefficients[3] * zonalAxis.x + coefficients[1] * zonalAxis.y + coefficients[2] * zonalAxis.z;
+    const Float3 ratio = Float3(std::abs(projected.x), std::abs(projected.y), std::abs(projected.z)) / coefficients[0];
+    const Float3 zonalL2Coeff = coefficients[0] * (0.08f * ratio + 0.6f * ratio * ratio);
+
+    const float fZ = Float3::Dot(zonalAxis, dir);
+    const float zhDir = std::sqrt(5.0f / (16.0f * Pi)) * (3.0f * fZ * fZ - 1.0f);
+
+    const Float3 baseIrradiance = coefficients[0] * (CosineA0 * 0.282095f) +
+                                  (coefficients[1] * dir.y + coefficients[2] * dir.z + coefficients[3] * dir.x) * (CosineA1 * 0.488603f);
+
+    return baseIrradiance + zonalL2Coeff * zhDir * (Pi * 0.25f);
+}
+
+static Float3 EvalL0Irradiance(const Float3* coefficients)
+{
+    return coefficients[0] * (CosineA0 * 0.282095f);
+}
+
+struct ProbeAnalysis
+{
+    SHProbeLOD LOD = SHProbeLOD::L2;
+    float L2Energy = 0.0f;
+    float Error = 0.0f;
+};
+
+static ProbeAnalysis AnalyzeProbe(const SH9Color& sh, const ProbeBandLODSettings& settings)
+{
+    ProbeAnalysis analysis;
+    for(uint64 i = 4; i < 9; ++i)
+        analysis.L2Energy += Float3::Dot(sh.Coefficients[i], sh.Coefficients[i]);
+
+    Float3 zonalAxis;
+    const bool canUseL1 = CanUseZH3(sh.Coefficients, zonalAxis);
+
+    double referenceSq = 0.0;
+    double l1ErrorSq = 0.0;
+    double l0ErrorSq = 0.0;
+    for(uint64 i = 0; i < NumErrorDirections; ++i)
+    {
+        const Float3 dir = ErrorDirection(i);
+        const Float3 reference = EvalSH9Irradiance(dir, sh);
+        referenceSq += Float3::Dot(reference, reference);
+
+        if(canUseL1)
+        {
+            const Float3 diff = EvalL1ZH3Irradiance(dir, sh.Coefficients, zonalAxis) - reference;
+            l1ErrorSq += Float3::Dot(diff, diff);
+        }
+
+        const Float3 diff = EvalL0Irradiance(sh.Coefficients) - reference;
+        l0ErrorSq += Float3::Dot(diff, diff);
+    }
+
+    const double numSamples = double(NumErrorDirections * 3);
+    const float referenceRMS = float(std::sqrt(referenceSq / numSamples));
+    const float l1Error = float(std::sqrt(l1ErrorSq / numSamples));
+    const float l0Error = float(std::sqrt(l0ErrorSq / numSamples));
+    const float budget = Max(settings.RelativeErrorBudget * referenceRMS, settings.AbsoluteErrorBudget);
+
+    if(settings.AllowL0 && l0Error <= budget)
+    {
+        analysis.LOD = SHProbeLOD::L0;
+        analysis.Error = l0Error;
+    }
+    else if(canUseL1 && l1Error <= budget)
+    {
+        analysis.LOD = SHProbeLOD::L1;
+        analysis.Error = l1Error;
+    }
+
+    return analysis;
+}
+
+uint64 MixedLODProbes::MemorySize() const
+{
+    return Headers.MemorySize() + Coefficients.MemorySize();
+}
+
+Float3 MixedLODProbes::CalculateIrradiance(uint64 probeIdx, const Float3& normal) const
+{
+    const uint32 header = Headers[probeIdx];
+    const SHProbeLOD lod = SHProbeLOD(header & LODMask);
+    const Float3* coefficients = &Coefficients[header >> OffsetShift];
+
+    if(lod == SHProbeLOD::L2)
+    {
+        SH9Color sh;
+        for(uint64 i = 0; i < 9; ++i)
+            sh.Coefficients[i] = coefficients[i];
+        return EvalSH9Irradiance(normal, sh);
+    }
+    else if(lod == SHProbeLOD::L1)
+    {
+        Float3 zonalAxis;
+        const bool canUseZH3 = CanUseZH3(coefficients, zonalAxis);
+        Assert_(canUseZH3);
+        return EvalL1ZH3Irradiance(normal, coefficients, zonalAxis);
+    }
+
+    return EvalL0Irradiance(coefficients);
+}
+
+ProbeBandLODStats BuildMixedLODProbes(const SH9Color* probes, uint64 numProbes, MixedLODProbes& output,
+                                      const ProbeBandLODSettings& settings, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(probes != nullptr && numProbes > 0 && numProbes <= UINT32_MAX);
+    Assert_(settings.RelativeErrorBudget >= 0.0f && settings.AbsoluteErrorBudget >= 0.0f);
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    Array<ProbeAnalysis> analysis(numProbes);
+    enki::TaskSet taskSet(uint32(numProbes), [&](enki::TaskSetPartition range, uint32)
+    {
+        for(uint64 p = range.start; p < range.end; ++p)
+            analysis[p] = AnalyzeProbe(probes[p], settings);
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+
+    ProbeBandLODStats stats;
+    uint64 numCoefficients = 0;
+    for(uint64 p = 0; p < numProbes; ++p)
+    {
+        stats.NumProbes[uint64(analysis[p].LOD)] += 1;
+        numCoefficients += SHProbeLODNumCoefficients(analysis[p].LOD);
+    }
+
+    // The offset has to fit in the upper 30 bits of the header
+    Assert_(numCoefficients <= (UINT32_MAX >> MixedLODProbes::OffsetShift));
+
+    output.Headers.Init(numProbes);
+    output.Coefficients.Init(numCoefficients);
+
+    uint64 offset = 0;
+    double errorSum = 0.0;
+    double l2EnergySum = 0.0;
+    for(uint64 p = 0; p < numProbes; ++p)
+    {
+        const SHProbeLOD lod = analysis[p].LOD;
+        output.Headers[p] = (uint32(offset) << MixedLODProbes::OffsetShift) | uint32(lod);
+
+        const uint64 probeCoefficients = SHProbeLODNumCoefficients(lod);
+        for(uint64 i = 0; i < probeCoefficients; ++i)
+            output.Coefficients[offset + i] = probes[p].Coefficients[i];
+        offset += probeCoefficients;
+
+        errorSum += analysis[p].Error;
+        l2EnergySum += analysis[p].L2Energy;
+        stats.MaxIrradianceError = Max(stats.MaxIrradianceError, analysis[p].Error);
+    }
+
+    stats.UncompressedSize = numProbes * sizeof(SH9Color);
+    stats.MixedSize = output.MemorySize();
+    stats.AvgL2Energy = float(l2EnergySum / double(numProbes));
+    stats.AvgIrradianceError = float(errorSum / double(numProbes));
+
+    return stats;
+}
+
+std::string ProbeBandLODStatsToString(const ProbeBandLODStats& stats)
+{
+    const uint64 numProbes = stats.NumProbes[0] + stats.NumProbes[1] + stats.NumProbes[2];
+    const double toPercent = numProbes > 0 ? 100.0 / double(numProbes) : 0.0;
+    return MakeString("Probe band LOD: %s\n"
+                      "L2: %llu (%.1f%%), L1: %llu (%.1f%%), L0: %llu (%.1f%%)\n"
+                      "Average L2 band energy: %f\n"
+                      "Irradiance error: avg %f, max %f\n",
+                      SizeReductionString(stats.UncompressedSize, stats.MixedSize).c_str(),
+                      stats.NumProbes[0], stats.NumProbes[0] * toPercent, stats.NumProbes[1], stats.NumProbes[1] * toPercent,
+                      stats.NumProbes[2], stats.NumProbes[2] * toPercent, stats.AvgL2Energy,
+                      stats.AvgIrradianceError, stats.MaxIrradianceError);
+}
+
+}
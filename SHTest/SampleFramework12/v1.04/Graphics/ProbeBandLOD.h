@@ -0,0 +1,93 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+#include "SHProbeFile.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+struct ProbeBandLODSettings
+{
+    // A probe is stored at a lower LOD if the RMS irradiance error of doing so is within the larger of
+    // the two budgets. The relative budget is a fraction of the probe's own RMS irradiance, and the
+    // absolute budget keeps dark probes (where any error is a large fraction) from staying at L2. At the
+    // default 10%, about three quarters of the SHTest scene's probes are stored as L1. A 2% budget keeps all
+    // of them at L2, since every probe there sees unoccluded point lights.
+    float RelativeErrorBudget = 0.1f;
+    float AbsoluteErrorBudget = 0.0f;
+
+    bool AllowL0 = true;
+};
+
+// A set of L2 RGB probes where each probe is stored with only as many bands as it needs, for evaluation
+// with SH::CalculateIrradianceMixedLOD from SH.hlsli. L1 probes are evaluated with ZH3 hallucination
+// (CalculateIrradianceL1ZH3Hallucinate), which is also what the error analysis measures.
+//
+//  Headers:        one uint32 per probe. The low 2 bits are the probe's SHProbeLOD, and the upper 30 bits
+//                  are the index of its first coefficient.
+//  Coefficients:   9, 4 or 1 RGB coefficients per probe depending on its LOD, tightly packed.
+struct MixedLODProbes
+{
+    static const uint32 LODMask = 0x3;
+    static const uint32 OffsetShift = 2;
+
+    Array<uint32> Headers;
+    Array<Float3> Coefficients;
+
+    uint64 NumProbes() const { return Headers.Size(); }
+    SHProbeLOD ProbeLOD(uint64 probeIdx) const { return SHProbeLOD(Headers[probeIdx] & LODMask); }
+    uint64 MemorySize() const;
+
+    // CPU version of the shader evaluation
+    Float3 CalculateIrradiance(uint64 probeIdx, const Float3& normal) const;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        BulkSerializeItem(serializer, Headers);
+        BulkSerializeItem(serializer, Coefficients);
+    }
+};
+
+struct ProbeBandLODStats
+{
+    uint64 NumProbes[uint64(SHProbeLOD::NumValues)] = { };
+
+    uint64 UncompressedSize = 0;
+    uint64 MixedSize = 0;
+
+    // Energy of the L2 band (sum of the squared L2 coefficients over all channels), averaged over all probes
+    float AvgL2Energy = 0.0f;
+
+    // RMS irradiance error over all directions and color channels of the selected LOD for each probe
+    float AvgIrradianceError = 0.0f;
+    float MaxIrradianceError = 0.0f;
+};
+
+// Analyzes each probe in parallel using the given task scheduler, and picks the cheapest LOD that fits the
+// error budget
+ProbeBandLODStats BuildMixedLODProbes(const SH9Color* probes, uint64 numProbes, MixedLODProbes& output,
+                                      const ProbeBandLODSettings& settings = ProbeBandLODSettings(),
+                                      enki::TaskScheduler* taskScheduler = nullptr);
+
+std::string ProbeBandLODStatsToString(const ProbeBandLODStats& stats);
+
+}
@@ -0,0 +1,403 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbeOctree.h"
+#include "..\\Utility.h"
+
+#include <unordered_map>
+
+namespace SampleFramework12
+{
+
+// Probe positions are stored as integer coordinates in units of the finest possible cell,
+// packed into 21 bits per axis
+static const uint32 MaxOctreeDepth = 20;
+
+struct OctreeBuildCell
+{
+    uint32 NodeIdx = 0;
+    uint32 Depth = 0;
+    uint32 X = 0;
+    uint32 Y = 0;
+    uint32 Z = 0;
+};
+
+struct OctreeBuildContext
+{
+    ProbeOctree& Octree;
+    const ProbeOctreeEvaluator& Evaluator;
+    Float3 UnitSize;
+
+    // Every probe that's been evaluated, including cell centers that were only used for the subdivision test
+    std::unordered_map<uint64, SH9Color> EvaluatedProbes;
+
+    // Maps probe positions to their index in the octree's probe list, for probes that are used by a leaf
+    std::unordered_map<uint64, uint32> LeafProbeIndices;
+
+    OctreeBuildContext(ProbeOctree& octree, const ProbeOctreeEvaluator& evaluator) : Octree(octree), Evaluator(evaluator)
+    {
+    }
+};
+
+static uint64 ProbeKey(uint32 x, uint32 y, uint32 z)
+{
+    return uint64(x) | (uint64(y) << 21) | (uint64(z) << 42);
+}
+
+static const SH9Color& EvaluateProbe(OctreeBuildContext& context, uint32 x, uint32 y, uint32 z)
+{
+    const uint64 key = ProbeKey(x, y, z);
+    auto existing = context.EvaluatedProbes.find(key);
+    if(existing != context.EvaluatedProbes.end())
+        return existing->second;
+
+    const Float3 position = context.Octree.BoundsMin + Float3(float(x), float(y), float(z)) * context.UnitSize;
+    return context.EvaluatedProbes.emplace(key, context.Evaluator(position)).first->second;
+}
+
+static uint32 LeafProbeIndex(OctreeBuildContext& context, uint32 x, uint32 y, uint32 z)
+{
+    const uint64 key = ProbeKey(x, y, z);
+    auto existing = context.LeafProbeIndices.find(key);
+    if(existing != context.LeafProbeIndices.end())
+        return existing->second;
+
+    const uint32 probeIdx = uint32(context.Octree.Probes.Add(EvaluateProbe(context, x, y, z)));
+    context.LeafProbeIndices.emplace(key, probeIdx);
+    return probeIdx;
+}
+
+// L2 distance between two sets of coefficients, which is also the L2 distance between the functions
+// over the sphere since the SH basis is orthonormal
+static float ProbeDistance(const SH9Color& a, const SH9Color& b)
+{
+    const SH9Color diff = a - b;
+    const Float3 distSq = SH9Color::Dot(diff, diff);
+    return std::sqrt(distSq.x + distSq.y + distSq.z);
+}
+
+static bool NeedsSubdivision(OctreeBuildContext& context, const OctreeBuildCell& cell, uint32 cellSize, float threshold)
+{
+    SH9Color corners[8];
+    for(uint32 i = 0; i < 8; ++i)
+        corners[i] = EvaluateProbe(context, cell.X + (i & 1) * cellSize, cell.Y + ((i >> 1) & 1) * cellSize, cell.Z + (i >> 2) * cellSize);
+
+    // Corners that differ in exactly one bit share an edge
+    for(uint32 i = 0; i < 8; ++i)
+        for(uint32 axis = 0; axis < 3; ++axis)
+            if((i & (1 << axis)) == 0 && ProbeDistance(corners[i], corners[i | (1 << axis)]) > threshold)
+                return true;
+
+    // Catches features that are entirely inside the cell and don't show up on any of the edges
+    SH9Color average;
+    for(uint32 i = 0; i < 8; ++i)
+        average += corners[i];
+    average *= Float3(0.125f);
+
+    const uint32 halfSize = cellSize / 2;
+    const SH9Color& center = EvaluateProbe(context, cell.X + halfSize, cell.Y + halfSize, cell.Z + halfSize);
+    return ProbeDistance(center, average) > threshold;
+}
+
+// Leaves are tracked by the probe key of their minimum corner, which is unique since leaves don't overlap
+typedef std::unordered_map<uint64, uint32> LeafDepthMap;
+
+// Returns the depth of the leaf containing the cell with the given minimum corner, searching from the finest depth
+static uint32 FindLeafDepth(const LeafDepthMap& leafDepths, uint32 x, uint32 y, uint32 z, uint32 maxDepth)
+{
+    for(int32 depth = int32(maxDepth); depth >= 0; --depth)
+    {
+        const uint32 mask = ~((1u << (maxDepth - depth)) - 1);
+        auto leaf = leafDepths.find(ProbeKey(x & mask, y & mask, z & mask));
+        if(leaf != leafDepths.end() && leaf->second == uint32(depth))
+            return uint32(depth);
+    }
+
+    Assert_(false);
+    return 0;
+}
+
+// Splits leaves until every leaf is at most one level coarser than the leaves that share a face, edge or corner
+// with it. This limits T-junctions to the midpoints of a coarse leaf's edges and faces.
+static void BalanceLeaves(LeafDepthMap& leafDepths, uint32 maxDepth)
+{
+    const uint32 numUnits = 1u << maxDepth;
+
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+
+        List<uint64> leafKeys;
+        for(const auto& leaf : leafDepths)
+            if(leaf.second >= 2)
+                leafKeys.Add(leaf.first);
+
+        for(uint64 i = 0; i < leafKeys.Count(); ++i)
+        {
+            auto leaf = leafDepths.find(leafKeys[i]);
+            if(leaf == leafDepths.end())
+                continue;
+
+            const uint32 depth = leaf->second;
+            const int32 cellSize = int32(numUnits >> depth);
+            const int32 x = int32(leafKeys[i] & 0x1FFFFF);
+            const int32 y = int32((leafKeys[i] >> 21) & 0x1FFFFF);
+            const int32 z = int32(leafKeys[i] >> 42);
+
+            for(int32 n = 0; n < 27; ++n)
+            {
+                const int32 nx = x + (n % 3 - 1) * cellSize;
+                const int32 ny = y + ((n / 3) % 3 - 1) * cellSize;
+                const int32 nz = z + (n / 9 - 1) * cellSize;
+                if(n == 13 || nx < 0 || ny < 0 || nz < 0 || nx >= int32(numUnits) || ny >= int32(numUnits) || nz >= int32(numUnits))
+                    continue;
+
+                // Split the neighbor one level at a time until it's fine enough. Its new children get balanced
+                // against their own neighbors on the next pass.
+                uint32 neighborDepth = FindLeafDepth(leafDepths, uint32(nx), uint32(ny), uint32(nz), maxDepth);
+                while(neighborDepth + 1 < depth)
+                {
+                    const uint32 neighborSize = numUnits >> neighborDepth;
+                    const uint32 childSize = neighborSize / 2;
+                    const uint32 mask = ~(neighborSize - 1);
+                    const uint32 ox = uint32(nx) & mask;
+                    const uint32 oy = uint32(ny) & mask;
+                    const uint32 oz = uint32(nz) & mask;
+
+                    leafDepths.erase(ProbeKey(ox, oy, oz));
+                    for(uint32 c = 0; c < 8; ++c)
+                        leafDepths[ProbeKey(ox + (c & 1) * childSize, oy + ((c >> 1) & 1) * childSize, oz + (c >> 2) * childSize)] = neighborDepth + 1;
+
+                    neighborDepth += 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// Replaces the probes at T-junctions with the value that the coarse leaf interpolates there, so that lighting is
+// continuous across leaves of different depths. With balanced leaves, T-junctions can only be at the midpoint of
+// a coarse leaf's edge (linear interpolation of the 2 endpoints) or the center of a face (bilinear interpolation
+// of the 4 face corners, which is their average). Leaves are processed from coarse to fine, so the corners used
+// for interpolation have already been snapped if they're T-junctions themselves.
+static void SnapTJunctionProbes(OctreeBuildContext& context, const List<OctreeBuildCell>& leafCells, uint32 maxDepth)
+{
+    ProbeOctree& octree = context.Octree;
+    const uint32 numUnits = 1u << maxDepth;
+
+    for(uint64 leafIdx = 0; leafIdx < leafCells.Count(); ++leafIdx)
+    {
+        const OctreeBuildCell& cell = leafCells[leafIdx];
+        const uint32 cellSize = numUnits >> cell.Depth;
+        if(cellSize < 2)
+            continue;
+
+        const uint32 halfSize = cellSize / 2;
+        const uint32* cornerProbes = &octree.LeafProbes[leafIdx * 8];
+
+        // Edges connect corners that differ in one bit, and faces are the 4 corners that share one bit
+        for(uint32 i = 0; i < 8; ++i)
+        {
+            const uint32 corner[3] = { cell.X + (i & 1) * cellSize, cell.Y + ((i >> 1) & 1) * cellSize, cell.Z + (i >> 2) * cellSize };
+            for(uint32 axis = 0; axis < 3; ++axis)
+            {
+                if((i & (1 << axis)) != 0)
+                    continue;
+
+                uint32 midpoint[3] = { corner[0], corner[1], corner[2] };
+                midpoint[axis] += halfSize;
+                auto probe = context.LeafProbeIndices.find(ProbeKey(midpoint[0], midpoint[1], midpoint[2]));
+                if(probe != context.LeafProbeIndices.end())
+                    octree.Probes[probe->second] = (octree.Probes[cornerProbes[i]] + octree.Probes[cornerProbes[i | (1 << axis)]]) * Float3(0.5f);
+            }
+        }
+
+        for(uint32 axis = 0; axis < 3; ++axis)
+        {
+            for(uint32 side = 0; side < 2; ++side)
+            {
+                uint32 center[3] = { cell.X + halfSize, cell.Y + halfSize, cell.Z + halfSize };
+                center[axis] = (axis == 0 ? cell.X : (axis == 1 ? cell.Y : cell.Z)) + side * cellSize;
+                auto probe = context.LeafProbeIndices.find(ProbeKey(center[0], center[1], center[2]));
+                if(probe == context.LeafProbeIndices.end())
+                    continue;
+
+                SH9Color average;
+                for(uint32 i = 0; i < 8; ++i)
+                    if(((i >> axis) & 1) == side)
+                        average += octree.Probes[cornerProbes[i]];
+                octree.Probes[probe->second] = average * Float3(0.25f);
+            }
+        }
+    }
+}
+
+void BuildProbeOctree(ProbeOctree& octree, const Float3& boundsMin, const Float3& boundsMax,
+                      const ProbeOctreeEvaluator& evaluator, const ProbeOctreeSettings& settings)
+{
+    Assert_(settings.MaxDepth <= MaxOctreeDepth);
+    Assert_(settings.MinDepth <= settings.MaxDepth);
+    Assert_(boundsMax.x > boundsMin.x && boundsMax.y > boundsMin.y && boundsMax.z > boundsMin.z);
+
+    octree.BoundsMin = boundsMin;
+    octree.BoundsMax = boundsMax;
+    octree.MaxDepth = 0;
+    octree.Nodes.Shutdown();
+    octree.LeafProbes.Shutdown();
+    octree.Probes.Shutdown();
+
+    OctreeBuildContext context(octree, evaluator);
+    const uint32 numUnits = 1u << settings.MaxDepth;
+    context.UnitSize = (boundsMax - boundsMin) / float(numUnits);
+
+    // Find the leaves with the adaptive subdivision test, and then balance them
+    LeafDepthMap leafDepths;
+    List<OctreeBuildCell> cells;
+    cells.Add(OctreeBuildCell());
+    for(uint64 cellIdx = 0; cellIdx < cells.Count(); ++cellIdx)
+    {
+        const OctreeBuildCell cell = cells[cellIdx];
+        const uint32 cellSize = numUnits >> cell.Depth;
+
+        bool subdivide = cell.Depth < settings.MinDepth;
+        if(subdivide == false && cell.Depth < settings.MaxDepth)
+            subdivide = NeedsSubdivision(context, cell, cellSize, settings.Threshold);
+
+        if(subdivide)
+        {
+            const uint32 childSize = cellSize / 2;
+            for(uint32 i = 0; i < 8; ++i)
+            {
+                OctreeBuildCell child;
+                child.Depth = cell.Depth + 1;
+                child.X = cell.X + (i & 1) * childSize;
+                child.Y = cell.Y + ((i >> 1) & 1) * childSize;
+                child.Z = cell.Z + (i >> 2) * childSize;
+                cells.Add(child);
+            }
+        }
+        else
+        {
+            leafDepths[ProbeKey(cell.X, cell.Y, cell.Z)] = cell.Depth;
+        }
+    }
+
+    BalanceLeaves(leafDepths, settings.MaxDepth);
+
+    // Flatten the balanced tree breadth-first, which keeps the 8 children of a node contiguous and puts
+    // the upper levels of the tree next to each other at the start of the node buffer
+    List<OctreeBuildCell> leafCells;
+    cells.Shutdown();
+    cells.Add(OctreeBuildCell());
+    octree.Nodes.Add(0);
+
+    for(uint64 cellIdx = 0; cellIdx < cells.Count(); ++cellIdx)
+    {
+        const OctreeBuildCell cell = cells[cellIdx];
+        const uint32 cellSize = numUnits >> cell.Depth;
+
+        if(leafDepths.at(ProbeKey(cell.X, cell.Y, cell.Z)) > cell.Depth)
+        {
+            const uint32 firstChild = uint32(octree.Nodes.Count());
+            const uint32 childSize = cellSize / 2;
+            for(uint32 i = 0; i < 8; ++i)
+            {
+                octree.Nodes.Add(0);
+
+                OctreeBuildCell child;
+                child.NodeIdx = firstChild + i;
+                child.Depth = cell.Depth + 1;
+                child.X = cell.X + (i & 1) * childSize;
+                child.Y = cell.Y + ((i >> 1) & 1) * childSize;
+                child.Z = cell.Z + (i >> 2) * childSize;
+                cells.Add(child);
+            }
+
+            octree.Nodes[cell.NodeIdx] = firstChild;
+        }
+        else
+        {
+            const uint32 leafIdx = uint32(octree.LeafProbes.Count() / 8);
+            for(uint32 i = 0; i < 8; ++i)
+                octree.LeafProbes.Add(LeafProbeIndex(context, cell.X + (i & 1) * cellSize, cell.Y + ((i >> 1) & 1) * cellSize, cell.Z + (i >> 2) * cellSize));
+
+            octree.Nodes[cell.NodeIdx] = ProbeOctree::LeafFlag | leafIdx;
+            octree.MaxDepth = Max(octree.MaxDepth, cell.Depth);
+            leafCells.Add(cell);
+        }
+    }
+
+    SnapTJunctionProbes(context, leafCells, settings.MaxDepth);
+}
+
+SH9Color ProbeOctree::Sample(const Float3& position) const
+{
+    Assert_(Nodes.Count() > 0);
+
+    Float3 uvw = Saturate((position - BoundsMin) / (BoundsMax - BoundsMin));
+    uint32 node = Nodes[0];
+    while((node & LeafFlag) == 0)
+    {
+        uvw *= 2.0f;
+        const uint32 cx = uvw.x >= 1.0f ? 1 : 0;
+        const uint32 cy = uvw.y >= 1.0f ? 1 : 0;
+        const uint32 cz = uvw.z >= 1.0f ? 1 : 0;
+        uvw -= Float3(float(cx), float(cy), float(cz));
+        node = Nodes[node + (cx | (cy << 1) | (cz << 2))];
+    }
+
+    const uint64 leafIdx = node & ~LeafFlag;
+    SH9Color result;
+    for(uint64 i = 0; i < 8; ++i)
+    {
+        const float weight = ((i & 1) ? uvw.x : 1.0f - uvw.x) *
+                             (((i >> 1) & 1) ? uvw.y : 1.0f - uvw.y) *
+                             ((i >> 2) ? uvw.z : 1.0f - uvw.z);
+        result += Probes[LeafProbes[leafIdx * 8 + i]] * Float3(weight);
+    }
+
+    return result;
+}
+
+uint64 ProbeOctree::MemorySize() const
+{
+    return Nodes.Count() * sizeof(uint32) + LeafProbes.Count() * sizeof(uint32) + Probes.Count() * sizeof(SH9Color);
+}
+
+ProbeOctreeStats CalculateProbeOctreeStats(const ProbeOctree& octree)
+{
+    ProbeOctreeStats stats;
+    stats.NumNodes = octree.Nodes.Count();
+    stats.NumLeaves = octree.LeafProbes.Count() / 8;
+    stats.NumProbes = octree.Probes.Count();
+    stats.MemorySize = octree.MemorySize();
+
+    const uint64 numProbesPerAxis = (1ull << octree.MaxDepth) + 1;
+    stats.DenseGridDepth = octree.MaxDepth;
+    stats.DenseGridNumProbes = numProbesPerAxis * numProbesPerAxis * numProbesPerAxis;
+    stats.DenseGridMemorySize = stats.DenseGridNumProbes * sizeof(SH9Color);
+
+    return stats;
+}
+
+std::string ProbeOctreeStatsToString(const ProbeOctreeStats& stats)
+{
+    const double ratio = stats.DenseGridMemorySize > 0 ? double(stats.MemorySize) / double(stats.DenseGridMemorySize) : 0.0;
+    return MakeString("Probe octree: %llu nodes, %llu leaves, %llu probes, %.2f MB\n"
+                      "Dense grid at depth %u: %llu probes, %.2f MB\n"
+                      "Octree size relative to dense grid: %.1f%%\n",
+                      stats.NumNodes, stats.NumLeaves, stats.NumProbes, BytesToMB(stats.MemorySize),
+                      stats.DenseGridDepth, stats.DenseGridNumProbes, BytesToMB(stats.DenseGridMemorySize),
+                      ratio * 100.0);
+}
+
+}
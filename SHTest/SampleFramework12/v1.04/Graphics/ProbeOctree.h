@@ -0,0 +1,102 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+#include <functional>
+
+namespace SampleFramework12
+{
+
+// Sparse octree of L2 probes over an axis-aligned box. Each leaf is a cell with a probe on each of its
+// 8 corners, and lighting inside the cell is trilinearly interpolated from those corners. Cells are only
+// subdivided where the lighting changes, so flat or empty regions are covered by a few large leaves
+// instead of a dense grid. Leaves are then split until neighboring leaves differ by at most one depth,
+// and the probes at T-junctions (the edge midpoints and face centers of a coarser neighbor) are set to
+// the value the coarser leaf interpolates there, so lighting is continuous across leaf boundaries.
+//
+// The flattened layout is meant to be uploaded as-is to 3 structured buffers and read with
+// SH::LookupProbeOctree and SH::SampleProbeOctree from SH.hlsli:
+//
+//  Nodes:          one uint32 per node, with the root at index 0. Interior nodes store the index of
+//                  the first of their 8 children, which are contiguous and ordered by the child's octant
+//                  (x | y << 1 | z << 2). Leaves have LeafFlag set and store their leaf index.
+//  LeafProbes:     8 probe indices per leaf, in the same corner order as the children.
+//  Probes:         the probes, shared between neighboring leaves. SH9Color matches SH::L2_RGB.
+struct ProbeOctree
+{
+    static const uint32 LeafFlag = 0x80000000;
+
+    Float3 BoundsMin;
+    Float3 BoundsMax;
+    uint32 MaxDepth = 0;
+    List<uint32> Nodes;
+    List<uint32> LeafProbes;
+    List<SH9Color> Probes;
+
+    // CPU version of the shader lookup, positions outside the bounds are clamped
+    SH9Color Sample(const Float3& position) const;
+
+    uint64 MemorySize() const;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, BoundsMin);
+        SerializeItem(serializer, BoundsMax);
+        SerializeItem(serializer, MaxDepth);
+        BulkSerializeItem(serializer, Nodes);
+        BulkSerializeItem(serializer, LeafProbes);
+        BulkSerializeItem(serializer, Probes);
+    }
+};
+
+struct ProbeOctreeSettings
+{
+    // Cells are always subdivided down to MinDepth, and never past MaxDepth
+    uint32 MinDepth = 2;
+    uint32 MaxDepth = 6;
+
+    // A cell is subdivided when any two probes on one of its edges, or the probe at its center and the
+    // average of its corners, differ by more than this. The distance between two probes is the L2 norm
+    // of their coefficient difference (computed with SH::Dot), in the same units as the probes.
+    float Threshold = 0.05f;
+};
+
+struct ProbeOctreeStats
+{
+    uint64 NumNodes = 0;
+    uint64 NumLeaves = 0;
+    uint64 NumProbes = 0;
+    uint64 MemorySize = 0;
+
+    // The finest leaf depth is the coarsest uniform subdivision that meets the threshold in every cell,
+    // so a dense grid at that depth is the smallest grid with the same error bound as the octree
+    uint32 DenseGridDepth = 0;
+    uint64 DenseGridNumProbes = 0;
+    uint64 DenseGridMemorySize = 0;
+};
+
+// Computes the probe at a world-space position, for example by ray tracing or rendering a cubemap.
+// Each probe position is only evaluated once.
+typedef std::function<SH9Color(const Float3& position)> ProbeOctreeEvaluator;
+
+void BuildProbeOctree(ProbeOctree& octree, const Float3& boundsMin, const Float3& boundsMax,
+                      const ProbeOctreeEvaluator& evaluator, const ProbeOctreeSettings& settings = ProbeOctreeSettings());
+
+ProbeOctreeStats CalculateProbeOctreeStats(const ProbeOctree& octree);
+std::string ProbeOctreeStatsToString(const ProbeOctreeStats& stats);
+
+}
@@ -0,0 +1,346 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbePCA.h"
+#include "..\\Utility.h"
+#include "TaskHelpers.h"
+
+namespace SampleFramework12
+{
+
+// Each probe is treated as a 27-dimensional vector of its coefficients
+static const uint64 ProbeDimension = SH9ColorNumFloats;
+
+static const float* ProbeData(const SH9Color& sh)
+{
+    return &sh.Coefficients[0].x;
+}
+
+static float* ProbeData(SH9Color& sh)
+{
+    return &sh.Coefficients[0].x;
+}
+
+// Cyclic Jacobi eigenvalue iteration for a symmetric matrix. On return the diagonal of the matrix holds
+// the eigenvalues, and the columns of the eigenvector matrix hold the corresponding unit eigenvectors.
+static void SymmetricEigen(double matrix[ProbeDimension][ProbeDimension], double eigenvectors[ProbeDimension][ProbeDimension])
+{
+    const uint64 n = ProbeDimension;
+    for(uint64 r = 0; r < n; ++r)
+        for(uint64 c = 0; c < n; ++c)
+            eigenvectors[r][c] = r == c ? 1.0 : 0.0;
+
+    double diagSq = 0.0;
+    for(uint64 i = 0; i < n; ++i)
+        diagSq += matrix[i][i] * matrix[i][i];
+
+    for(uint64 sweep = 0; sweep < 64; ++sweep)
+    {
+        double offDiagSq = 0.0;
+        for(uint64 p = 0; p < n; ++p)
+            for(uint64 q = p + 1; q < n; ++q)
+                offDiagSq += matrix[p][q] * matrix[p][q];
+
+        if(offDiagSq <= 1e-24 * diagSq || offDiagSq == 0.0)
+            break;
+
+        for(uint64 p = 0; p < n; ++p)
+        {
+            for(uint64 q = p + 1; q < n; ++q)
+            {
+                if(matrix[p][q] == 0.0)
+                    continue;
+
+                const double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for(uint64 k = 0; k < n; ++k)
+                {
+                    const double akp = matrix[k][p];
+                    const double akq = matrix[k][q];
+                    matrix[k][p] = c * akp - s * akq;
+                    matrix[k][q] = s * akp + c * akq;
+                }
+
+                for(uint64 k = 0; k < n; ++k)
+                {
+                    const double apk = matrix[p][k];
+                    const double aqk = matrix[q][k];
+                    matrix[p][k] = c * apk - s * aqk;
+                    matrix[q][k] = s * apk + c * aqk;
+                }
+
+                for(uint64 k = 0; k < n; ++k)
+                {
+                    const double vkp = eigenvectors[k][p];
+                    const double vkq = eigenvectors[k][q];
+                    eigenvectors[k][p] = c * vkp - s * vkq;
+                    eigenvectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+static float DecodeWeight(const PCACompressedProbes& compressed, uint64 probeIdx, uint64 componentIdx)
+{
+    const uint64 blockIdx = probeIdx / compressed.BlockSize;
+    const Float2 scaleBias = compressed.WeightScaleBias[blockIdx * compressed.NumComponents + componentIdx];
+    const uint8* probeWeights = &compressed.Weights[probeIdx * compressed.WeightStride()];
+
+    float raw = 0.0f;
+    if(compressed.WeightFormat == PCAWeightFormat::UNorm8)
+    {
+        raw = probeWeights[componentIdx] / 255.0f;
+    }
+    else
+    {
+        uint16 half = 0;
+        memcpy(&half, probeWeights + componentIdx * sizeof(uint16), sizeof(uint16));
+        raw = DirectX::PackedVector::XMConvertHalfToFloat(half);
+    }
+
+    return raw * scaleBias.x + scaleBias.y;
+}
+
+// RMS over all directions and color channels of the irradiance from a set of radiance coefficients
+static double IrradianceRMS(const float* coefficients)
+{
+    static const double bandScales[3] = { CosineA0, CosineA1, CosineA2 };
+
+    double sum = 0.0;
+    for(uint64 i = 0; i < ProbeDimension; ++i)
+    {
+        const uint64 coefficientIdx = i / 3;
+        const double scale = bandScales[coefficientIdx == 0 ? 0 : (coefficientIdx < 4 ? 1 : 2)];
+        sum += scale * scale * coefficients[i] * coefficients[i];
+    }
+
+    return std::sqrt(sum / (4.0 * Pi * 3.0));
+}
+
+struct PCABlockStats
+{
+    double ErrorSum = 0.0;
+    double IrradianceSqSum = 0.0;
+    float MaxError = 0.0f;
+};
+
+static void CompressBlock(const SH9Color* probes, uint64 blockIdx, PCACompressedProbes& output, PCABlockStats& stats)
+{
+    const uint64 numComponents = output.NumComponents;
+    const uint64 firstProbe = blockIdx * output.BlockSize;
+    const uint64 numBlockProbes = Min<uint64>(output.BlockSize, output.NumProbes - firstProbe);
+
+    // Mean and covariance
+    double mean[ProbeDimension] = { };
+    for(uint64 p = 0; p < numBlockProbes; ++p)
+    {
+        const float* data = ProbeData(probes[firstProbe + p]);
+        for(uint64 i = 0; i < ProbeDimension; ++i)
+            mean[i] += data[i];
+    }
+
+    for(uint64 i = 0; i < ProbeDimension; ++i)
+        mean[i] /= double(numBlockProbes);
+
+    double covariance[ProbeDimension][ProbeDimension] = { };
+    for(uint64 p = 0; p < numBlockProbes; ++p)
+    {
+        const float* data = ProbeData(probes[firstProbe + p]);
+        double centered[ProbeDimension];
+        for(uint64 i = 0; i < ProbeDimension; ++i)
+            centered[i] = data[i] - mean[i];
+
+        for(uint64 r = 0; r < ProbeDimension; ++r)
+            for(uint64 c = r; c < ProbeDimension; ++c)
+                covariance[r][c] += centered[r] * centered[c];
+    }
+
+    for(uint64 r = 0; r < ProbeDimension; ++r)
+        for(uint64 c = 0; c < r; ++c)
+            covariance[r][c] = covariance[c][r];
+
+    // The principal components are the eigenvectors with the largest eigenvalues
+    double eigenvectors[ProbeDimension][ProbeDimension];
+    SymmetricEigen(covariance, eigenvectors);
+
+    uint64 order[ProbeDimension];
+    for(uint64 i = 0; i < ProbeDimension; ++i)
+        order[i] = i;
+    std::sort(order, order + ProbeDimension, [&](uint64 a, uint64 b) { return covariance[a][a] > covariance[b][b]; });
+
+    const uint64 basisStart = blockIdx * (numComponents + 1);
+    float* meanData = ProbeData(output.Basis[basisStart]);
+    for(uint64 i = 0; i < ProbeDimension; ++i)
+        meanData[i] = float(mean[i]);
+
+    for(uint64 c = 0; c < numComponents; ++c)
+    {
+        float* componentData = ProbeData(output.Basis[basisStart + 1 + c]);
+        for(uint64 i = 0; i < ProbeDimension; ++i)
+            componentData[i] = float(eigenvectors[i][order[c]]);
+    }
+
+    // Project onto the components to get the weights, and find their range for 8-bit quantization
+    Array<float> weights(numBlockProbes * numComponents);
+    float minWeights[ProbeDimension];
+    float maxWeights[ProbeDimension];
+    for(uint64 c = 0; c < numComponents; ++c)
+    {
+        minWeights[c] = FloatMax;
+        maxWeights[c] = -FloatMax;
+    }
+
+    for(uint64 p = 0; p < numBlockProbes; ++p)
+    {
+        const float* data = ProbeData(probes[firstProbe + p]);
+        for(uint64 c = 0; c < numComponents; ++c)
+        {
+            const float* componentData = ProbeData(output.Basis[basisStart + 1 + c]);
+            float weight = 0.0f;
+            for(uint64 i = 0; i < ProbeDimension; ++i)
+                weight += (data[i] - meanData[i]) * componentData[i];
+
+            weights[p * numComponents + c] = weight;
+            minWeights[c] = Min(minWeights[c], weight);
+            maxWeights[c] = Max(maxWeights[c], weight);
+        }
+    }
+
+    const uint64 stride = output.WeightStride();
+    for(uint64 c = 0; c < numComponents; ++c)
+    {
+        Float2& scaleBias = output.WeightScaleBias[blockIdx * numComponents + c];
+        if(output.WeightFormat == PCAWeightFormat::UNorm8)
+            scaleBias = Float2(maxWeights[c] - minWeights[c], minWeights[c]);
+        else
+            scaleBias = Float2(1.0f, 0.0f);
+
+        for(uint64 p = 0; p < numBlockProbes; ++p)
+        {
+            const float weight = weights[p * numComponents + c];
+            uint8* probeWeights = &output.Weights[(firstProbe + p) * stride];
+            if(output.WeightFormat == PCAWeightFormat::UNorm8)
+            {
+                const float normalized = scaleBias.x > 0.0f ? (weight - scaleBias.y) / scaleBias.x : 0.0f;
+                probeWeights[c] = uint8(Clamp(normalized * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+            else
+            {
+                const uint16 half = DirectX::PackedVector::XMConvertFloatToHalf(weight);
+                memcpy(probeWeights + c * sizeof(uint16), &half, sizeof(uint16));
+            }
+        }
+    }
+
+    // Measure the error of the quantized result
+    for(uint64 p = 0; p < numBlockProbes; ++p)
+    {
+        const SH9Color decoded = output.Decode(firstProbe + p);
+        const float* original = ProbeData(probes[firstProbe + p]);
+        const float* decodedData = ProbeData(decoded);
+
+        float diff[ProbeDimension];
+        for(uint64 i = 0; i < ProbeDimension; ++i)
+            diff[i] = original[i] - decodedData[i];
+
+        const double error = IrradianceRMS(diff);
+        const double irradiance = IrradianceRMS(original);
+        stats.ErrorSum += error;
+        stats.IrradianceSqSum += irradiance * irradiance;
+        stats.MaxError = Max(stats.MaxError, float(error));
+    }
+}
+
+PCACompressionStats CompressProbesPCA(const SH9Color* probes, uint64 numProbes, PCACompressedProbes& output,
+                                      const PCACompressionSettings& settings, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(probes != nullptr && numProbes > 0 && numProbes <= UINT32_MAX);
+    Assert_(settings.NumComponents > 0 && settings.NumComponents <= ProbeDimension);
+    Assert_(settings.BlockSize > 0);
+
+    output.NumProbes = uint32(numProbes);
+    output.NumComponents = settings.NumComponents;
+    output.BlockSize = settings.BlockSize;
+    output.WeightFormat = settings.WeightFormat;
+
+    const uint32 numBlocks = output.NumBlocks();
+    output.Basis.Init(uint64(numBlocks) * (settings.NumComponents + 1));
+    output.WeightScaleBias.Init(uint64(numBlocks) * settings.NumComponents);
+    output.Weights.Init(numProbes * output.WeightStride(), 0);
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    Array<PCABlockStats> blockStats(numBlocks);
+    enki::TaskSet taskSet(numBlocks, [&](enki::TaskSetPartition range, uint32)
+    {
+        for(uint32 blockIdx = range.start; blockIdx < range.end; ++blockIdx)
+            CompressBlock(probes, blockIdx, output, blockStats[blockIdx]);
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+
+    PCACompressionStats stats;
+    double errorSum = 0.0;
+    double irradianceSqSum = 0.0;
+    for(uint64 i = 0; i < numBlocks; ++i)
+    {
+        errorSum += blockStats[i].ErrorSum;
+        irradianceSqSum += blockStats[i].IrradianceSqSum;
+        stats.MaxIrradianceError = Max(stats.MaxIrradianceError, blockStats[i].MaxError);
+    }
+
+    const double rmsIrradiance = std::sqrt(irradianceSqSum / double(numProbes));
+    stats.AvgIrradianceError = float(errorSum / double(numProbes));
+    stats.RelativeIrradianceError = rmsIrradiance > 0.0 ? float(stats.AvgIrradianceError / rmsIrradiance) : 0.0f;
+    stats.UncompressedSize = numProbes * sizeof(SH9Color);
+    stats.CompressedSize = output.MemorySize();
+    stats.CompressionRatio = float(double(stats.UncompressedSize) / double(stats.CompressedSize));
+
+    return stats;
+}
+
+uint32 PCACompressedProbes::WeightStride() const
+{
+    const uint32 bytesPerWeight = WeightFormat == PCAWeightFormat::UNorm8 ? 1 : 2;
+    return (NumComponents * bytesPerWeight + 3) & ~3u;
+}
+
+uint64 PCACompressedProbes::MemorySize() const
+{
+    return Basis.MemorySize() + WeightScaleBias.MemorySize() + Weights.MemorySize();
+}
+
+SH9Color PCACompressedProbes::Decode(uint64 probeIdx) const
+{
+    Assert_(probeIdx < NumProbes);
+
+    const uint64 basisStart = (probeIdx / BlockSize) * (NumComponents + 1);
+    SH9Color result = Basis[basisStart];
+    for(uint64 c = 0; c < NumComponents; ++c)
+        result += Basis[basisStart + 1 + c] * Float3(DecodeWeight(*this, probeIdx, c));
+
+    return result;
+}
+
+std::string PCACompressionStatsToString(const PCACompressionStats& stats)
+{
+    return MakeString("PCA compression: %s\n"
+                      "Irradiance error: avg %f, max %f, relative %.3f%%\n",
+                      SizeReductionString(stats.UncompressedSize, stats.CompressedSize).c_str(),
+                      stats.AvgIrradianceError, stats.MaxIrradianceError, stats.RelativeIrradianceError * 100.0f);
+}
+
+}
@@ -0,0 +1,107 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+enum class PCAWeightFormat : uint32
+{
+    Float16 = 0,
+    UNorm8 = 1,
+};
+
+struct PCACompressionSettings
+{
+    // Number of principal components kept per block, at most 27 (the dimension of an SH9Color)
+    uint32 NumComponents = 8;
+
+    // Probes are compressed in blocks of consecutive probes, each with their own mean and basis. Sorting
+    // the input by region (or using the order from a ProbeVolume/ProbeOctree) keeps similar probes together.
+    uint32 BlockSize = 4096;
+
+    PCAWeightFormat WeightFormat = PCAWeightFormat::Float16;
+};
+
+// A set of L2 RGB probes compressed to a per-block mean plus NumComponents principal components, with
+// NumComponents quantized weights per probe. The arrays are meant to be uploaded as-is and decoded with
+// SH::DecodePCAProbe from SH.hlsli:
+//
+//  Basis:              (1 + NumComponents) SH9Color per block, the mean followed by the components.
+//                      SH9Color matches SH::L2_RGB in a structured buffer.
+//  WeightScaleBias:    NumComponents Float2 per block. The decoded weight is raw * scale + bias, where raw
+//                      is the fp16 value or the 8-bit value divided by 255. fp16 weights use (1, 0).
+//  Weights:            WeightStride() bytes per probe for a ByteAddressBuffer, with weight i at byte
+//                      i * 2 for fp16 or i for 8-bit.
+struct PCACompressedProbes
+{
+    uint32 NumProbes = 0;
+    uint32 NumComponents = 0;
+    uint32 BlockSize = 0;
+    PCAWeightFormat WeightFormat = PCAWeightFormat::Float16;
+    Array<SH9Color> Basis;
+    Array<Float2> WeightScaleBias;
+    Array<uint8> Weights;
+
+    uint32 NumBlocks() const { return BlockSize > 0 ? (NumProbes + BlockSize - 1) / BlockSize : 0; }
+    uint32 WeightStride() const;
+    uint64 MemorySize() const;
+
+    // CPU version of the shader decode
+    SH9Color Decode(uint64 probeIdx) const;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, NumProbes);
+        SerializeItem(serializer, NumComponents);
+        SerializeItem(serializer, BlockSize);
+        uint32 weightFormat = uint32(WeightFormat);
+        SerializeItem(serializer, weightFormat);
+        WeightFormat = PCAWeightFormat(weightFormat);
+        BulkSerializeItem(serializer, Basis);
+        BulkSerializeItem(serializer, WeightScaleBias);
+        BulkSerializeItem(serializer, Weights);
+    }
+};
+
+struct PCACompressionStats
+{
+    uint64 UncompressedSize = 0;
+    uint64 CompressedSize = 0;
+    float CompressionRatio = 0.0f;
+
+    // Irradiance errors are the RMS over all directions and color channels of the difference between the
+    // irradiance from the original and the decoded probes, averaged or maximized over the probe set.
+    // The relative error is the average error divided by the RMS irradiance of the original probes.
+    float AvgIrradianceError = 0.0f;
+    float MaxIrradianceError = 0.0f;
+    float RelativeIrradianceError = 0.0f;
+};
+
+// Compresses the probes one block at a time, in parallel using the given task scheduler
+PCACompressionStats CompressProbesPCA(const SH9Color* probes, uint64 numProbes, PCACompressedProbes& output,
+                                      const PCACompressionSettings& settings = PCACompressionSettings(),
+                                      enki::TaskScheduler* taskScheduler = nullptr);
+
+std::string PCACompressionStatsToString(const PCACompressionStats& stats);
+
+}
@@ -0,0 +1,404 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbeStreaming.h"
+#include "..\\Utility.h"
+#include "..\\Exceptions.h"
+#include "..\\Timer.h"
+
+#include <algorithm>
+
+namespace SampleFramework12
+{
+
+static float DistanceToBounds(const Float3& position, const Float3& boundsMin, const Float3& boundsMax)
+{
+    const Float3 closest = Float3::Clamp(position, boundsMin, boundsMax);
+    return Float3::Distance(position, closest);
+}
+
+ProbeStreamer::~ProbeStreamer()
+{
+    Shutdown();
+}
+
+void ProbeStreamer::Initialize(const wchar* filePath, const ProbeStreamingSettings& settings_)
+{
+    Assert_(ioThreads.size() == 0);
+    Assert_(settings_.NumIOThreads > 0);
+
+    settings = settings_;
+    probeFile.Open(filePath);
+
+    for(uint32 regionIdx = 0; regionIdx < probeFile.NumRegions(); ++regionIdx)
+    {
+        if(probeFile.FindChunk(regionIdx, settings.LOD) == nullptr)
+        {
+            probeFile.Close();
+            throw Exception(MakeString(L"Probe file %ls is missing LOD %u for region %u", filePath, uint32(settings.LOD), regionIdx));
+        }
+    }
+
+    regions.Init(probeFile.NumRegions());
+    shuttingDown = false;
+    useCounter = 0;
+    stats = ProbeStreamingStats();
+
+    for(uint32 i = 0; i < settings.NumIOThreads; ++i)
+        ioThreads.emplace_back([this]() { IOThreadMain(); });
+}
+
+void ProbeStreamer::Shutdown()
+{
+    if(probeFile.IsOpen() == false)
+        return;
+
+    AcquireSRWLockExclusive(&lock);
+    shuttingDown = true;
+    ReleaseSRWLockExclusive(&lock);
+    WakeAllConditionVariable(&requestAvailable);
+
+    for(std::thread& thread : ioThreads)
+        thread.join();
+    ioThreads.clear();
+
+    demandQueue.clear();
+    prefetchQueue.clear();
+    events.clear();
+    pendingFrees.clear();
+    regions.Shutdown();
+    probeFile.Close();
+}
+
+void ProbeStreamer::SetCallbacks(const ProbeRegionResidentCallback& onResident_, const ProbeRegionEvictedCallback& onEvicted_)
+{
+    onResident = onResident_;
+    onEvicted = onEvicted_;
+}
+
+const SH9Color* ProbeStreamer::RequestRegion(uint32 regionIdx)
+{
+    AcquireSRWLockExclusive(&lock);
+    const SH9Color* probes = RequestRegionLocked(regionIdx, true);
+    ReleaseSRWLockExclusive(&lock);
+
+    return probes;
+}
+
+const SH9Color* ProbeStreamer::WaitForRegion(uint32 regionIdx)
+{
+    AcquireSRWLockExclusive(&lock);
+
+    const SH9Color* probes = RequestRegionLocked(regionIdx, true);
+    if(probes == nullptr)
+    {
+        ++stats.NumStalls;
+
+        // The region can be evicted again before this thread wakes up if the budget is too small for
+        // everything that's in flight, in which case RequestRegionLocked puts it back in the queue
+        while(probes == nullptr)
+        {
+            SleepConditionVariableSRW(&regionLoaded, &lock, INFINITE, 0);
+            probes = RequestRegionLocked(regionIdx, false);
+        }
+    }
+
+    ReleaseSRWLockExclusive(&lock);
+
+    return probes;
+}
+
+const SH9Color* ProbeStreamer::RequestRegionLocked(uint32 regionIdx, bool countStats)
+{
+    Assert_(regionIdx < regions.Size());
+
+    if(countStats)
+        ++stats.NumRequests;
+
+    RegionEntry& entry = regions[regionIdx];
+    if(entry.State == RegionState::Resident)
+    {
+        if(countStats)
+            ++stats.NumHits;
+
+        entry.LastUsed = ++useCounter;
+        return entry.Probes.Data();
+    }
+
+    // Regions that are only queued as a prefetch are promoted to the demand queue
+    if(entry.State == RegionState::NotResident || (entry.State == RegionState::Queued && entry.Prefetched))
+    {
+        entry.State = RegionState::Queued;
+        entry.Prefetched = false;
+        demandQueue.push_back(regionIdx);
+        WakeConditionVariable(&requestAvailable);
+    }
+
+    return nullptr;
+}
+
+void ProbeStreamer::Prefetch(const Float3& cameraPosition)
+{
+    AcquireSRWLockExclusive(&lock);
+
+    for(uint32 regionIdx : prefetchQueue)
+    {
+        RegionEntry& entry = regions[regionIdx];
+        if(entry.State == RegionState::Queued && entry.Prefetched)
+        {
+            entry.State = RegionState::NotResident;
+            entry.Prefetched = false;
+        }
+    }
+    prefetchQueue.clear();
+
+    std::vector<std::pair<float, uint32>> nearbyRegions;
+    for(uint32 regionIdx = 0; regionIdx < regions.Size(); ++regionIdx)
+    {
+        const SHProbeRegionDesc& desc = probeFile.Region(regionIdx);
+        const float distance = DistanceToBounds(cameraPosition, desc.BoundsMin, desc.BoundsMax);
+        if(distance > settings.PrefetchRadius)
+            continue;
+
+        // Nearby regions that are already resident are kept warm in the LRU order
+        RegionEntry& entry = regions[regionIdx];
+        if(entry.State == RegionState::Resident)
+            entry.LastUsed = ++useCounter;
+        else if(entry.State == RegionState::NotResident)
+            nearbyRegions.push_back(std::make_pair(distance, regionIdx));
+    }
+
+    // Closest regions are loaded first
+    std::sort(nearbyRegions.begin(), nearbyRegions.end());
+    for(const auto& nearbyRegion : nearbyRegions)
+    {
+        RegionEntry& entry = regions[nearbyRegion.second];
+        entry.State = RegionState::Queued;
+        entry.Prefetched = true;
+        prefetchQueue.push_back(nearbyRegion.second);
+        ++stats.NumPrefetches;
+    }
+
+    ReleaseSRWLockExclusive(&lock);
+
+    if(nearbyRegions.size() > 0)
+        WakeAllConditionVariable(&requestAvailable);
+}
+
+void ProbeStreamer::Update()
+{
+    std::vector<ResidencyEvent> updateEvents;
+    std::vector<Array<SH9Color>> updateFrees;
+
+    AcquireSRWLockExclusive(&lock);
+    updateEvents.swap(events);
+    updateFrees.swap(pendingFrees);
+    ReleaseSRWLockExclusive(&lock);
+
+    for(const ResidencyEvent& event : updateEvents)
+    {
+        if(event.Resident && onResident)
+            onResident(event.RegionIdx, event.Probes, event.NumProbes);
+        else if(event.Resident == false && onEvicted)
+            onEvicted(event.RegionIdx);
+    }
+
+    // The evicted probe memory is freed when updateFrees goes out of scope
+}
+
+ProbeStreamingStats ProbeStreamer::Stats() const
+{
+    AcquireSRWLockShared(&lock);
+    ProbeStreamingStats result = stats;
+    ReleaseSRWLockShared(&lock);
+
+    return result;
+}
+
+// Must be called with the lock held. The evicted memory is kept alive until the next Update(), since
+// pointers to it may have been handed out during the current frame.
+void ProbeStreamer::EvictUntilFits(uint64 newBytes)
+{
+    while(stats.ResidentBytes + newBytes > settings.CacheBudget)
+    {
+        RegionEntry* oldest = nullptr;
+        uint32 oldestIdx = 0;
+        for(uint32 regionIdx = 0; regionIdx < regions.Size(); ++regionIdx)
+        {
+            RegionEntry& entry = regions[regionIdx];
+            if(entry.State == RegionState::Resident && (oldest == nullptr || entry.LastUsed < oldest->LastUsed))
+            {
+                oldest = &entry;
+                oldestIdx = regionIdx;
+            }
+        }
+
+        // A single region that's larger than the budget is allowed to exceed it
+        if(oldest == nullptr)
+            return;
+
+        stats.ResidentBytes -= oldest->Probes.MemorySize();
+        ++stats.NumEvictions;
+
+        ResidencyEvent event;
+        event.RegionIdx = oldestIdx;
+        event.Resident = false;
+        events.push_back(event);
+
+        pendingFrees.push_back(std::move(oldest->Probes));
+        oldest->State = RegionState::NotResident;
+    }
+}
+
+void ProbeStreamer::IOThreadMain()
+{
+    AcquireSRWLockExclusive(&lock);
+
+    while(true)
+    {
+        while(shuttingDown == false && demandQueue.empty() && prefetchQueue.empty())
+            SleepConditionVariableSRW(&requestAvailable, &lock, INFINITE, 0);
+
+        if(shuttingDown)
+            break;
+
+        std::deque<uint32>& queue = demandQueue.empty() ? prefetchQueue : demandQueue;
+        const uint32 regionIdx = queue.front();
+        queue.pop_front();
+
+        // Skip cancelled prefetches, and regions that were queued twice after being promoted
+        RegionEntry& entry = regions[regionIdx];
+        if(entry.State != RegionState::Queued)
+            continue;
+
+        entry.State = RegionState::Loading;
+        ReleaseSRWLockExclusive(&lock);
+
+        // Reading from the mapping is what actually pulls the chunk in from disk
+        const SHProbeChunkDesc* chunk = probeFile.FindChunk(regionIdx, settings.LOD);
+        Array<SH9Color> probes(chunk->NumProbes);
+        probeFile.DecodeChunk(*chunk, probes.Data());
+
+        AcquireSRWLockExclusive(&lock);
+
+        EvictUntilFits(probes.MemorySize());
+        stats.ResidentBytes += probes.MemorySize();
+        stats.BytesRead += chunk->Size;
+
+        entry.Probes = std::move(probes);
+        entry.State = RegionState::Resident;
+        entry.Prefetched = false;
+        entry.LastUsed = ++useCounter;
+
+        ResidencyEvent event;
+        event.RegionIdx = regionIdx;
+        event.Resident = true;
+        event.Probes = entry.Probes.Data();
+        event.NumProbes = entry.Probes.Size();
+        events.push_back(event);
+
+        WakeAllConditionVariable(&regionLoaded);
+    }
+
+    ReleaseSRWLockExclusive(&lock);
+}
+
+// == Benchmark ===================================================================================
+
+static Float3 FlythroughPosition(float t, const Float3& center, const Float3& extent)
+{
+    return center + extent * Float3(std::sin(t), std::sin(0.7f * t + 1.0f), std::sin(1.3f * t + 2.0f));
+}
+
+ProbeStreamingBenchmark RunProbeStreamingFlythrough(const wchar* filePath, uint32 regionsPerAxis, uint32 probesPerRegion,
+                                                    uint32 numFrames, uint32 frameMilliseconds,
+                                                    const ProbeStreamingSettings& settings)
+{
+    Assert_(regionsPerAxis > 0 && probesPerRegion > 0 && numFrames > 0);
+
+    const float regionSize = 10.0f;
+    const uint32 numRegions = regionsPerAxis * regionsPerAxis * regionsPerAxis;
+
+    // All regions share the same synthetic probes, since only the amount of data matters here
+    Array<SH9Color> probes(probesPerRegion);
+    for(uint32 i = 0; i < probesPerRegion; ++i)
+        for(uint32 c = 0; c < 9; ++c)
+            probes[i].Coefficients[c] = Float3(std::sin(i * 0.01f + c), std::cos(i * 0.02f + c), 0.5f) * (c == 0 ? 1.0f : 0.25f);
+
+    Array<SHProbeRegionData> regionData(numRegions);
+    for(uint32 regionIdx = 0; regionIdx < numRegions; ++regionIdx)
+    {
+        const uint32 x = regionIdx % regionsPerAxis;
+        const uint32 y = (regionIdx / regionsPerAxis) % regionsPerAxis;
+        const uint32 z = regionIdx / (regionsPerAxis * regionsPerAxis);
+
+        SHProbeRegionData& region = regionData[regionIdx];
+        region.BoundsMin = Float3(float(x), float(y), float(z)) * regionSize;
+        region.BoundsMax = region.BoundsMin + regionSize;
+        region.Probes = probes.Data();
+        region.NumProbes = probesPerRegion;
+    }
+
+    WriteSHProbeFile(filePath, regionData.Data(), numRegions);
+
+    ProbeStreamer streamer;
+    streamer.Initialize(filePath, settings);
+
+    const Float3 center = Float3(regionsPerAxis * regionSize * 0.5f);
+    const Float3 extent = center * 0.9f;
+    const float step = 4.0f * Pi / numFrames;
+
+    Timer timer;
+    for(uint32 frame = 0; frame < numFrames; ++frame)
+    {
+        const Float3 position = FlythroughPosition(frame * step, center, extent);
+        streamer.Prefetch(FlythroughPosition((frame + 10) * step, center, extent));
+
+        // Wait for the region around the camera and its neighbors
+        const int32 cx = int32(position.x / regionSize);
+        const int32 cy = int32(position.y / regionSize);
+        const int32 cz = int32(position.z / regionSize);
+        for(int32 z = Max(cz - 1, 0); z <= Min(cz + 1, int32(regionsPerAxis) - 1); ++z)
+            for(int32 y = Max(cy - 1, 0); y <= Min(cy + 1, int32(regionsPerAxis) - 1); ++y)
+                for(int32 x = Max(cx - 1, 0); x <= Min(cx + 1, int32(regionsPerAxis) - 1); ++x)
+                    streamer.WaitForRegion(uint32(x + y * regionsPerAxis + z * regionsPerAxis * regionsPerAxis));
+
+        streamer.Update();
+
+        if(frameMilliseconds > 0)
+            Sleep(frameMilliseconds);
+    }
+    timer.Update();
+
+    ProbeStreamingBenchmark benchmark;
+    benchmark.NumFrames = numFrames;
+    benchmark.ElapsedSeconds = timer.ElapsedSecondsD();
+    benchmark.Stats = streamer.Stats();
+
+    streamer.Shutdown();
+
+    return benchmark;
+}
+
+std::string ProbeStreamingBenchmarkToString(const ProbeStreamingBenchmark& benchmark)
+{
+    const ProbeStreamingStats& stats = benchmark.Stats;
+    return MakeString("Probe streaming: %u frames in %.2f s\n"
+                      "Requests: %llu, hit rate %.1f%%, stalls: %llu\n"
+                      "Prefetches: %llu, evictions: %llu\n"
+                      "Read %.2f MB (%.2f MB/s), %.2f MB resident\n",
+                      benchmark.NumFrames, benchmark.ElapsedSeconds,
+                      stats.NumRequests, stats.HitRate() * 100.0f, stats.NumStalls,
+                      stats.NumPrefetches, stats.NumEvictions,
+                      BytesToMB(stats.BytesRead), benchmark.BytesReadPerSecond() / (1024.0 * 1024.0),
+                      BytesToMB(stats.ResidentBytes));
+}
+
+}
@@ -0,0 +1,162 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "SHProbeFile.h"
+
+#include <functional>
+#include <thread>
+#include <deque>
+
+namespace SampleFramework12
+{
+
+struct ProbeStreamingSettings
+{
+    // Maximum size of the decoded regions kept in memory. Each resident region costs NumProbes * sizeof(SH9Color)
+    // regardless of the LOD that was loaded.
+    uint64 CacheBudget = 64 * 1024 * 1024;
+
+    uint32 NumIOThreads = 2;
+
+    // LOD chunk loaded for each region. Missing bands are set to 0 in the decoded probes.
+    SHProbeLOD LOD = SHProbeLOD::L2;
+
+    // Prefetch() requests every region whose bounds are within this distance of the camera hint
+    float PrefetchRadius = 0.0f;
+};
+
+struct ProbeStreamingStats
+{
+    uint64 NumRequests = 0;
+    uint64 NumHits = 0;
+    uint64 NumStalls = 0;
+    uint64 NumPrefetches = 0;
+    uint64 NumEvictions = 0;
+    uint64 BytesRead = 0;
+    uint64 ResidentBytes = 0;
+
+    float HitRate() const { return NumRequests > 0 ? float(double(NumHits) / double(NumRequests)) : 0.0f; }
+};
+
+typedef std::function<void(uint32 regionIdx, const SH9Color* probes, uint64 numProbes)> ProbeRegionResidentCallback;
+typedef std::function<void(uint32 regionIdx)> ProbeRegionEvictedCallback;
+
+// Streams the regions of a .shprobe file in and out of a fixed memory budget. Requests are serviced by a pool
+// of background I/O threads that decode the requested chunk out of the file mapping, and the least recently
+// used regions are evicted when the budget is exceeded.
+//
+// Pointers returned by RequestRegion/WaitForRegion stay valid until the next call to Update(), which is also
+// where the residency callbacks are called from, on the calling thread.
+class ProbeStreamer
+{
+
+public:
+
+    ProbeStreamer() = default;
+    ~ProbeStreamer();
+
+    ProbeStreamer(const ProbeStreamer&) = delete;
+    ProbeStreamer& operator=(const ProbeStreamer&) = delete;
+
+    void Initialize(const wchar* filePath, const ProbeStreamingSettings& settings = ProbeStreamingSettings());
+    void Shutdown();
+
+    void SetCallbacks(const ProbeRegionResidentCallback& onResident, const ProbeRegionEvictedCallback& onEvicted);
+
+    // Returns the region's probes if it's resident, otherwise queues it for loading and returns null
+    const SH9Color* RequestRegion(uint32 regionIdx);
+
+    // Like RequestRegion, but blocks until the region is resident. Counts as a stall if it had to wait.
+    const SH9Color* WaitForRegion(uint32 regionIdx);
+
+    // Queues every non-resident region near the position at a lower priority than RequestRegion, and replaces
+    // any prefetches from the previous call that haven't started loading yet
+    void Prefetch(const Float3& cameraPosition);
+
+    // Calls the residency callbacks for everything that was loaded or evicted since the last update, and frees
+    // the memory of evicted regions
+    void Update();
+
+    const SHProbeFile& ProbeFile() const { return probeFile; }
+    ProbeStreamingStats Stats() const;
+
+private:
+
+    enum class RegionState : uint32
+    {
+        NotResident = 0,
+        Queued,
+        Loading,
+        Resident,
+    };
+
+    struct RegionEntry
+    {
+        RegionState State = RegionState::NotResident;
+        bool Prefetched = false;
+        uint64 LastUsed = 0;
+        Array<SH9Color> Probes;
+    };
+
+    struct ResidencyEvent
+    {
+        uint32 RegionIdx = 0;
+        bool Resident = false;
+        const SH9Color* Probes = nullptr;
+        uint64 NumProbes = 0;
+    };
+
+    void IOThreadMain();
+    const SH9Color* RequestRegionLocked(uint32 regionIdx, bool countStats);
+    void EvictUntilFits(uint64 newBytes);
+
+    SHProbeFile probeFile;
+    ProbeStreamingSettings settings;
+    ProbeRegionResidentCallback onResident;
+    ProbeRegionEvictedCallback onEvicted;
+
+    mutable SRWLOCK lock = SRWLOCK_INIT;
+    CONDITION_VARIABLE requestAvailable = CONDITION_VARIABLE_INIT;
+    CONDITION_VARIABLE regionLoaded = CONDITION_VARIABLE_INIT;
+    bool shuttingDown = false;
+
+    Array<RegionEntry> regions;
+    std::deque<uint32> demandQueue;
+    std::deque<uint32> prefetchQueue;
+    std::vector<ResidencyEvent> events;
+    std::vector<Array<SH9Color>> pendingFrees;
+    std::vector<std::thread> ioThreads;
+    uint64 useCounter = 0;
+    ProbeStreamingStats stats;
+};
+
+struct ProbeStreamingBenchmark
+{
+    uint32 NumFrames = 0;
+    double ElapsedSeconds = 0.0;
+    ProbeStreamingStats Stats;
+
+    double BytesReadPerSecond() const { return ElapsedSeconds > 0.0 ? Stats.BytesRead / ElapsedSeconds : 0.0; }
+};
+
+// Writes a synthetic .shprobe file with regionsPerAxis^3 regions of probesPerRegion probes, then flies a camera
+// through it for numFrames frames. Each frame prefetches around a point ahead of the camera, waits for the
+// regions within one region of the camera, and sleeps for frameMilliseconds to stand in for the rest of the frame.
+ProbeStreamingBenchmark RunProbeStreamingFlythrough(const wchar* filePath, uint32 regionsPerAxis, uint32 probesPerRegion,
+                                                    uint32 numFrames, uint32 frameMilliseconds,
+                                                    const ProbeStreamingSettings& settings = ProbeStreamingSettings());
+
+std::string ProbeStreamingBenchmarkToString(const ProbeStreamingBenchmark& benchmark);
+
+}
@@ -0,0 +1,299 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbeVQ.h"
+#include "..\\Utility.h"
+#include "TaskHelpers.h"
+
+#include <atomic>
+
+namespace SampleFramework12
+{
+
+// The 27 coefficients of an SH9Color are padded to 7 SIMD vectors for the distance computations
+static const uint64 ProbeDimension = SH9ColorNumFloats;
+static const uint64 VectorsPerProbe = 7;
+
+static void StoreProbeVector(const SH9Color& sh, float scale, DirectX::XMFLOAT4A* dst)
+{
+    float padded[VectorsPerProbe * 4] = { };
+    memcpy(padded, &sh.Coefficients[0].x, sizeof(SH9Color));
+    for(uint64 i = 0; i < VectorsPerProbe; ++i)
+        dst[i] = DirectX::XMFLOAT4A(padded[i * 4 + 0] * scale, padded[i * 4 + 1] * scale,
+                                    padded[i * 4 + 2] * scale, padded[i * 4 + 3] * scale);
+}
+
+static float DistanceSq(const DirectX::XMFLOAT4A* a, const DirectX::XMFLOAT4A* b)
+{
+    DirectX::XMVECTOR sum = DirectX::XMVectorZero();
+    for(uint64 i = 0; i < VectorsPerProbe; ++i)
+    {
+        const DirectX::XMVECTOR diff = DirectX::XMVectorSubtract(DirectX::XMLoadFloat4A(&a[i]), DirectX::XMLoadFloat4A(&b[i]));
+        sum = DirectX::XMVectorMultiplyAdd(diff, diff, sum);
+    }
+
+    return DirectX::XMVectorGetX(DirectX::XMVector4Dot(sum, DirectX::XMVectorSplatOne()));
+}
+
+struct KMeansContext
+{
+    uint64 NumProbes = 0;
+    uint32 NumCenters = 0;
+    Array<DirectX::XMFLOAT4A> Vectors;
+    Array<DirectX::XMFLOAT4A> Centers;
+    Array<uint32> Assignments;
+
+    // Squared distance from each probe to its assigned center
+    Array<float> Distances;
+};
+
+// Moves each center to the mean of its probes. Centers that lost all of their probes are moved to the
+// probe that's currently the furthest from its own center.
+static void UpdateCenters(KMeansContext& context)
+{
+    Array<double> sums(uint64(context.NumCenters) * VectorsPerProbe * 4, 0.0);
+    Array<uint64> counts(context.NumCenters, 0);
+    for(uint64 p = 0; p < context.NumProbes; ++p)
+    {
+        const uint32 center = context.Assignments[p];
+        const float* src = &context.Vectors[p * VectorsPerProbe].x;
+        double* dst = &sums[center * VectorsPerProbe * 4];
+        for(uint64 i = 0; i < VectorsPerProbe * 4; ++i)
+            dst[i] += src[i];
+        ++counts[center];
+    }
+
+    for(uint32 c = 0; c < context.NumCenters; ++c)
+    {
+        DirectX::XMFLOAT4A* center = &context.Centers[c * VectorsPerProbe];
+        if(counts[c] > 0)
+        {
+            const double* src = &sums[c * VectorsPerProbe * 4];
+            float* dst = &center[0].x;
+            for(uint64 i = 0; i < VectorsPerProbe * 4; ++i)
+                dst[i] = float(src[i] / double(counts[c]));
+        }
+        else
+        {
+            uint64 furthest = 0;
+            for(uint64 p = 1; p < context.NumProbes; ++p)
+                if(context.Distances[p] > context.Distances[furthest])
+                    furthest = p;
+
+            memcpy(center, &context.Vectors[furthest * VectorsPerProbe], VectorsPerProbe * sizeof(DirectX::XMFLOAT4A));
+            context.Distances[furthest] = 0.0f;
+        }
+    }
+}
+
+// Assigns each probe to its nearest center, and returns the number of probes that changed centers
+static uint64 AssignProbes(KMeansContext& context, enki::TaskScheduler* taskScheduler)
+{
+    std::atomic<uint64> numChanged(0);
+    enki::TaskSet taskSet(uint32(context.NumProbes), [&](enki::TaskSetPartition range, uint32)
+    {
+        uint64 rangeChanged = 0;
+        for(uint64 p = range.start; p < range.end; ++p)
+        {
+            const DirectX::XMFLOAT4A* probe = &context.Vectors[p * VectorsPerProbe];
+            uint32 nearest = 0;
+            float nearestDistance = FloatMax;
+            for(uint32 c = 0; c < context.NumCenters; ++c)
+            {
+                const float distance = DistanceSq(probe, &context.Centers[c * VectorsPerProbe]);
+                if(distance < nearestDistance)
+                {
+                    nearest = c;
+                    nearestDistance = distance;
+                }
+            }
+
+            if(nearest != context.Assignments[p])
+                ++rangeChanged;
+
+            context.Assignments[p] = nearest;
+            context.Distances[p] = nearestDistance;
+        }
+
+        numChanged += rangeChanged;
+    });
+
+    taskScheduler->AddTaskSetToPipe(&taskSet);
+    taskScheduler->WaitforTask(&taskSet);
+
+    return numChanged;
+}
+
+// k-means++ seeding: each new center is a probe picked with probability proportional to its squared
+// distance from the closest existing center
+static void SeedCenters(KMeansContext& context, enki::TaskScheduler* taskScheduler)
+{
+    Random random;
+    uint64 pick = random.RandomUint() % context.NumProbes;
+
+    for(uint32 c = 0; c < context.NumCenters; ++c)
+    {
+        DirectX::XMFLOAT4A* center = &context.Centers[c * VectorsPerProbe];
+        memcpy(center, &context.Vectors[pick * VectorsPerProbe], VectorsPerProbe * sizeof(DirectX::XMFLOAT4A));
+
+        enki::TaskSet taskSet(uint32(context.NumProbes), [&](enki::TaskSetPartition range, uint32)
+        {
+            for(uint64 p = range.start; p < range.end; ++p)
+            {
+                const float distance = DistanceSq(&context.Vectors[p * VectorsPerProbe], center);
+                if(c == 0 || distance < context.Distances[p])
+                {
+                    context.Distances[p] = distance;
+                    context.Assignments[p] = c;
+                }
+            }
+        });
+
+        taskScheduler->AddTaskSetToPipe(&taskSet);
+        taskScheduler->WaitforTask(&taskSet);
+
+        double total = 0.0;
+        for(uint64 p = 0; p < context.NumProbes; ++p)
+            total += context.Distances[p];
+
+        // Every probe already matches a center exactly, so more centers wouldn't be used
+        if(total <= 0.0)
+        {
+            context.NumCenters = c + 1;
+            break;
+        }
+
+        const double target = random.RandomFloat() * total;
+        double cumulative = 0.0;
+        pick = context.NumProbes - 1;
+        for(uint64 p = 0; p < context.NumProbes; ++p)
+        {
+            cumulative += context.Distances[p];
+            if(cumulative > target)
+            {
+                pick = p;
+                break;
+            }
+        }
+    }
+}
+
+VQPaletteStats BuildProbePalette(const SH9Color* probes, uint64 numProbes, VQCompressedProbes& output,
+                                 const VQPaletteSettings& settings, enki::TaskScheduler* taskScheduler)
+{
+    Assert_(probes != nullptr && numProbes > 0 && numProbes <= UINT32_MAX);
+    Assert_(settings.PaletteSize > 0);
+    Assert_(settings.L0Scale == false || settings.PaletteSize <= 65536);
+
+    ScopedTaskScheduler scheduler(taskScheduler);
+    taskScheduler = scheduler.Scheduler();
+
+    KMeansContext context;
+    context.NumProbes = numProbes;
+    context.NumCenters = uint32(Min<uint64>(settings.PaletteSize, numProbes));
+    context.Vectors.Init(numProbes * VectorsPerProbe);
+    context.Centers.Init(uint64(context.NumCenters) * VectorsPerProbe);
+    context.Assignments.Init(numProbes, 0);
+    context.Distances.Init(numProbes, 0.0f);
+
+    for(uint64 p = 0; p < numProbes; ++p)
+    {
+        float scale = 1.0f;
+        if(settings.L0Scale)
+        {
+            const float luminance = ComputeLuminance(probes[p].Coefficients[0]);
+            scale = luminance > 1e-6f ? 1.0f / luminance : 1.0f;
+        }
+
+        StoreProbeVector(probes[p], scale, &context.Vectors[p * VectorsPerProbe]);
+    }
+
+    VQPaletteStats stats;
+    SeedCenters(context, taskScheduler);
+    for(uint32 i = 0; i < settings.MaxIterations; ++i)
+    {
+        UpdateCenters(context);
+        ++stats.NumIterations;
+        if(AssignProbes(context, taskScheduler) == 0)
+            break;
+    }
+
+    output.NumProbes = uint32(numProbes);
+    output.L0Scale = settings.L0Scale;
+    output.Palette.Init(context.NumCenters);
+    output.Indices.Init(numProbes);
+
+    for(uint32 c = 0; c < context.NumCenters; ++c)
+        memcpy(&output.Palette[c], &context.Centers[c * VectorsPerProbe], sizeof(SH9Color));
+
+    for(uint64 p = 0; p < numProbes; ++p)
+    {
+        const uint32 center = context.Assignments[p];
+        if(settings.L0Scale)
+        {
+            const float paletteLuminance = ComputeLuminance(output.Palette[center].Coefficients[0]);
+            const float luminance = ComputeLuminance(probes[p].Coefficients[0]);
+            // A very dark palette entry can need a scale past the fp16 range, which would decode as infinity
+            const float scale = paletteLuminance > 1e-6f ? Min(luminance / paletteLuminance, FP16Max) : 0.0f;
+            output.Indices[p] = center | (uint32(DirectX::PackedVector::XMConvertFloatToHalf(scale)) << 16);
+        }
+        else
+        {
+            output.Indices[p] = center;
+        }
+    }
+
+    double errorSum = 0.0;
+    for(uint64 p = 0; p < numProbes; ++p)
+    {
+        const SH9Color diff = probes[p] - output.Decode(p);
+        const Float3 distSq = SH9Color::Dot(diff, diff);
+        const float error = std::sqrt(distSq.x + distSq.y + distSq.z);
+        errorSum += error;
+        stats.MaxError = Max(stats.MaxError, error);
+    }
+
+    stats.AvgError = float(errorSum / double(numProbes));
+    stats.UncompressedSize = numProbes * sizeof(SH9Color);
+    stats.CompressedSize = output.MemorySize();
+    stats.CompressionRatio = float(double(stats.UncompressedSize) / double(stats.CompressedSize));
+    stats.UncompressedBytesPerFetch = sizeof(SH9Color);
+    stats.CompressedBytesPerFetch = sizeof(uint32);
+
+    return stats;
+}
+
+uint64 VQCompressedProbes::MemorySize() const
+{
+    return Palette.MemorySize() + Indices.MemorySize();
+}
+
+SH9Color VQCompressedProbes::Decode(uint64 probeIdx) const
+{
+    Assert_(probeIdx < NumProbes);
+
+    const uint32 packed = Indices[probeIdx];
+    if(L0Scale == false)
+        return Palette[packed];
+
+    const float scale = DirectX::PackedVector::XMConvertHalfToFloat(uint16(packed >> 16));
+    return Palette[packed & 0xFFFF] * Float3(scale);
+}
+
+std::string VQPaletteStatsToString(const VQPaletteStats& stats)
+{
+    return MakeString("Probe palette: %s after %u iterations\n"
+                      "Bytes per probe fetch: %llu -> %llu\n"
+                      "Coefficient error: avg %f, max %f\n",
+                      SizeReductionString(stats.UncompressedSize, stats.CompressedSize).c_str(), stats.NumIterations,
+                      stats.UncompressedBytesPerFetch, stats.CompressedBytesPerFetch, stats.AvgError, stats.MaxError);
+}
+
+}
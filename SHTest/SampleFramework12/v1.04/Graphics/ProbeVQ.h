@@ -0,0 +1,92 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace SampleFramework12
+{
+
+struct VQPaletteSettings
+{
+    // Number of palette entries. Limited to 65536 when L0Scale is enabled, since the index shares a uint32
+    // with the scale.
+    uint32 PaletteSize = 256;
+
+    // Lloyd iterations after k-means++ seeding, stopping early once no probe changes its palette entry
+    uint32 MaxIterations = 16;
+
+    // Clusters probes by their normalized shape and stores a per-probe scale that restores the luminance of
+    // the probe's L0 coefficient. Probes that only differ in brightness can then share a palette entry.
+    bool L0Scale = false;
+};
+
+// A set of L2 RGB probes replaced by indices into a palette of representative probes. The arrays are
+// meant to be uploaded as-is and decoded with SH::LookupProbePalette from SH.hlsli:
+//
+//  Palette:    the palette entries. SH9Color matches SH::L2_RGB in a structured buffer.
+//  Indices:    one uint32 per probe. With L0Scale the low 16 bits are the palette index and the high 16
+//              bits are the fp16 scale, otherwise the whole value is the palette index.
+struct VQCompressedProbes
+{
+    uint32 NumProbes = 0;
+    bool L0Scale = false;
+    Array<SH9Color> Palette;
+    Array<uint32> Indices;
+
+    uint64 MemorySize() const;
+
+    // CPU version of the shader lookup
+    SH9Color Decode(uint64 probeIdx) const;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, NumProbes);
+        SerializeItem(serializer, L0Scale);
+        BulkSerializeItem(serializer, Palette);
+        BulkSerializeItem(serializer, Indices);
+    }
+};
+
+struct VQPaletteStats
+{
+    uint64 UncompressedSize = 0;
+    uint64 CompressedSize = 0;
+    float CompressionRatio = 0.0f;
+
+    // Bytes read per probe fetch, not counting the palette itself which is small enough to stay in cache
+    uint64 UncompressedBytesPerFetch = 0;
+    uint64 CompressedBytesPerFetch = 0;
+
+    // L2 norm of the coefficient difference between the original and decoded probes
+    float AvgError = 0.0f;
+    float MaxError = 0.0f;
+
+    uint32 NumIterations = 0;
+};
+
+// Runs k-means over the probes' 27 coefficients, in parallel using the given task scheduler
+VQPaletteStats BuildProbePalette(const SH9Color* probes, uint64 numProbes, VQCompressedProbes& output,
+                                 const VQPaletteSettings& settings = VQPaletteSettings(),
+                                 enki::TaskScheduler* taskScheduler = nullptr);
+
+std::string VQPaletteStatsToString(const VQPaletteStats& stats);
+
+}
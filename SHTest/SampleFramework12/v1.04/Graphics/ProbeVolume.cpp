@@ -0,0 +1,108 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "ProbeVolume.h"
+#include "..\\Utility.h"
+
+namespace SampleFramework12
+{
+
+// ProbeVolume is header-only, so the probe types with typedefs in ProbeVolume.h are instantiated here to make
+// sure that every member is compiled along with the framework
+template class ProbeVolume<SH9Color>;
+template class ProbeVolume<SH4Color>;
+
+static float ProbeDistance(const SH9Color& a, const SH9Color& b)
+{
+    const SH9Color diff = a - b;
+    const Float3 distSq = SH9Color::Dot(diff, diff);
+    return std::sqrt(distSq.x + distSq.y + distSq.z);
+}
+
+ProbeGradientStats CompareGradientSampling(const SH9ColorProbeVolume& reference, uint32 sparseFactor, uint64 numSamples)
+{
+    Assert_(reference.HasGradients());
+    Assert_(sparseFactor > 0 && numSamples > 0);
+
+    const Uint3 referenceCount = reference.NumProbes();
+    Assert_((referenceCount.x - 1) % sparseFactor == 0 && (referenceCount.y - 1) % sparseFactor == 0 &&
+            (referenceCount.z - 1) % sparseFactor == 0);
+
+    const Uint3 sparseCount = Uint3((referenceCount.x - 1) / sparseFactor + 1, (referenceCount.y - 1) / sparseFactor + 1,
+                                    (referenceCount.z - 1) / sparseFactor + 1);
+
+    SH9ColorProbeVolume sparse;
+    sparse.Init(reference.BoundsMin(), reference.BoundsMax(), sparseCount);
+    sparse.InitGradients();
+    for(uint64 z = 0; z < sparseCount.z; ++z)
+    {
+        for(uint64 y = 0; y < sparseCount.y; ++y)
+        {
+            for(uint64 x = 0; x < sparseCount.x; ++x)
+            {
+                sparse.Probe(x, y, z) = reference.Probe(x * sparseFactor, y * sparseFactor, z * sparseFactor);
+                for(uint64 axis = 0; axis < 3; ++axis)
+                    sparse.Gradient(x, y, z, axis) = reference.Gradient(x * sparseFactor, y * sparseFactor, z * sparseFactor, axis);
+            }
+        }
+    }
+
+    ProbeGradientStats stats;
+    stats.SparseFactor = sparseFactor;
+    stats.NumSamples = numSamples;
+    stats.ReferenceMemorySize = uint64(referenceCount.x) * referenceCount.y * referenceCount.z * sizeof(SH9Color);
+    stats.SparseMemorySize = uint64(sparseCount.x) * sparseCount.y * sparseCount.z * sizeof(SH9Color);
+    stats.SparseWithGradientsMemorySize = stats.SparseMemorySize * 4;
+
+    const Float3 boundsMin = reference.BoundsMin();
+    const Float3 extents = reference.BoundsMax() - boundsMin;
+
+    Random random;
+    double trilinearErrorSum = 0.0;
+    double gradientErrorSum = 0.0;
+    double trilinearGradientErrorSum = 0.0;
+    for(uint64 i = 0; i < numSamples; ++i)
+    {
+        const Float3 position = boundsMin + extents * Float3(random.RandomFloat(), random.RandomFloat(), random.RandomFloat());
+        const SH9Color expected = reference.SampleTrilinear(position);
+
+        const float trilinearError = ProbeDistance(sparse.SampleTrilinear(position), expected);
+        trilinearErrorSum += trilinearError;
+        stats.TrilinearMaxError = Max(stats.TrilinearMaxError, trilinearError);
+
+        const float gradientError = ProbeDistance(sparse.SampleNearestWithGradient(position), expected);
+        gradientErrorSum += gradientError;
+        stats.GradientMaxError = Max(stats.GradientMaxError, gradientError);
+
+        const float trilinearGradientError = ProbeDistance(sparse.SampleTrilinearWithGradient(position), expected);
+        trilinearGradientErrorSum += trilinearGradientError;
+        stats.TrilinearGradientMaxError = Max(stats.TrilinearGradientMaxError, trilinearGradientError);
+    }
+
+    stats.TrilinearAvgError = float(trilinearErrorSum / double(numSamples));
+    stats.GradientAvgError = float(gradientErrorSum / double(numSamples));
+    stats.TrilinearGradientAvgError = float(trilinearGradientErrorSum / double(numSamples));
+
+    return stats;
+}
+
+std::string ProbeGradientStatsToString(const ProbeGradientStats& stats)
+{
+    return MakeString("Probe gradients: reference %.2f MB, 1/%u sparse grid %.2f MB, with gradients %.2f MB\n"
+                      "Sparse trilinear error: avg %f, max %f\n"
+                      "Sparse nearest + gradient error: avg %f, max %f\n"
+                      "Sparse trilinear + gradient error: avg %f, max %f\n",
+                      BytesToMB(stats.ReferenceMemorySize), stats.SparseFactor,
+                      BytesToMB(stats.SparseMemorySize), BytesToMB(stats.SparseWithGradientsMemorySize),
+                      stats.TrilinearAvgError, stats.TrilinearMaxError, stats.GradientAvgError, stats.GradientMaxError,
+                      stats.TrilinearGradientAvgError, stats.TrilinearGradientMaxError);
+}
+
+}
@@ -0,0 +1,561 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+namespace SampleFramework12
+{
+
+// A regular 3D grid of SH probes spanning an axis-aligned box, with a probe on each corner of the box.
+// Probes are stored in 4x4x4 bricks so that the 8 probes touched by a trilinear lookup are almost always
+// in the same 64-probe block of memory, instead of being spread across 4 rows and 2 slices of a linear
+// grid. TSH can be any of the SH/H-basis types from SH.h (SH9Color, SH4, SH9ColorPlanar, etc.), or any
+// other type that's made up of nothing but floats.
+template<typename TSH> class ProbeVolume
+{
+
+public:
+
+    static const uint64 BrickSize = 4;
+    static const uint64 ProbesPerBrick = BrickSize * BrickSize * BrickSize;
+
+    static_assert(std::is_trivially_copyable<TSH>::value && sizeof(TSH) % sizeof(float) == 0,
+                  "ProbeVolume requires a probe type that's made up of floats");
+
+    void Init(const Float3& boundsMin_, const Float3& boundsMax_, const Uint3& numProbes_)
+    {
+        Assert_(numProbes_.x > 0 && numProbes_.y > 0 && numProbes_.z > 0);
+
+        boundsMin = boundsMin_;
+        boundsMax = boundsMax_;
+        numProbes = numProbes_;
+        UpdateLayout();
+
+        probes.Init(uint64(numBricks.x) * numBricks.y * numBricks.z * ProbesPerBrick, TSH());
+        gradients.Shutdown();
+    }
+
+    void Shutdown()
+    {
+        probes.Shutdown();
+        gradients.Shutdown();
+        numProbes = Uint3(0, 0, 0);
+        numBricks = Uint3(0, 0, 0);
+    }
+
+    Uint3 NumProbes() const { return numProbes; }
+    Float3 BoundsMin() const { return boundsMin; }
+    Float3 BoundsMax() const { return boundsMax; }
+    uint64 MemorySize() const { return probes.MemorySize() + gradients.MemorySize(); }
+
+    TSH& Probe(uint64 x, uint64 y, uint64 z)
+    {
+        return probes[ProbeIndex(x, y, z)];
+    }
+
+    const TSH& Probe(uint64 x, uint64 y, uint64 z) const
+    {
+        return probes[ProbeIndex(x, y, z)];
+    }
+
+    Float3 ProbePosition(uint64 x, uint64 y, uint64 z) const
+    {
+        return boundsMin + Float3(float(x), float(y), float(z)) * probeSpacing;
+    }
+
+    // Returns the probe closest to a position, clamping positions outside of the volume to its bounds
+    TSH SampleNearest(const Float3& position) const
+    {
+        const DirectX::XMVECTOR gridPos = GridPosition(position.ToSIMD());
+        const DirectX::XMVECTOR rounded = DirectX::XMVectorRound(gridPos);
+        return probes[ProbeIndex(uint64(DirectX::XMVectorGetX(rounded)),
+                                 uint64(DirectX::XMVectorGetY(rounded)),
+                                 uint64(DirectX::XMVectorGetZ(rounded)))];
+    }
+
+    // Blends the 8 probes surrounding a position with trilinear weights, clamping positions outside
+    // of the volume to its bounds
+    TSH SampleTrilinear(const Float3& position) const
+    {
+        uint64 indices[8] = { };
+        float weights[8] = { };
+        TrilinearFootprint(GridPosition(position.ToSIMD()), indices, weights);
+
+        TSH result;
+        BlendProbes(indices, weights, result);
+        return result;
+    }
+
+    // Batch versions for sampling many points at once. Grid coordinates are computed for 4 positions
+    // at a time in SoA form, and the probe coefficients are blended 4 floats at a time.
+    void SampleNearest(const Float3* positions, uint64 numPositions, TSH* results) const
+    {
+        uint64 posIdx = 0;
+        for(; posIdx + 4 <= numPositions; posIdx += 4)
+        {
+            DirectX::XMVECTOR gridX, gridY, gridZ;
+            GridPosition4(positions + posIdx, gridX, gridY, gridZ);
+
+            __declspec(align(16)) float x[4];
+            __declspec(align(16)) float y[4];
+            __declspec(align(16)) float z[4];
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(x), DirectX::XMVectorRound(gridX));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(y), DirectX::XMVectorRound(gridY));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(z), DirectX::XMVectorRound(gridZ));
+
+            for(uint64 i = 0; i < 4; ++i)
+                results[posIdx + i] = probes[ProbeIndex(uint64(x[i]), uint64(y[i]), uint64(z[i]))];
+        }
+
+        for(; posIdx < numPositions; ++posIdx)
+            results[posIdx] = SampleNearest(positions[posIdx]);
+    }
+
+    void SampleTrilinear(const Float3* positions, uint64 numPositions, TSH* results) const
+    {
+        uint64 posIdx = 0;
+        for(; posIdx + 4 <= numPositions; posIdx += 4)
+        {
+            DirectX::XMVECTOR gridX, gridY, gridZ;
+            GridPosition4(positions + posIdx, gridX, gridY, gridZ);
+
+            const DirectX::XMVECTOR baseX = DirectX::XMVectorFloor(gridX);
+            const DirectX::XMVECTOR baseY = DirectX::XMVectorFloor(gridY);
+            const DirectX::XMVECTOR baseZ = DirectX::XMVectorFloor(gridZ);
+
+            __declspec(align(16)) float x[4];
+            __declspec(align(16)) float y[4];
+            __declspec(align(16)) float z[4];
+            __declspec(align(16)) float fx[4];
+            __declspec(align(16)) float fy[4];
+            __declspec(align(16)) float fz[4];
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(x), baseX);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(y), baseY);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(z), baseZ);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fx), DirectX::XMVectorSubtract(gridX, baseX));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fy), DirectX::XMVectorSubtract(gridY, baseY));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fz), DirectX::XMVectorSubtract(gridZ, baseZ));
+
+            for(uint64 i = 0; i < 4; ++i)
+            {
+                uint64 indices[8] = { };
+                float weights[8] = { };
+                TrilinearFootprint(uint64(x[i]), uint64(y[i]), uint64(z[i]), fx[i], fy[i], fz[i], indices, weights);
+                BlendProbes(indices, weights, results[posIdx + i]);
+            }
+        }
+
+        for(; posIdx < numPositions; ++posIdx)
+            results[posIdx] = SampleTrilinear(positions[posIdx]);
+    }
+
+    // Optional per-probe spatial gradients, stored as 3 probes per probe holding the derivatives along X, Y and Z
+    // (the same layout as an SHGradient from SH.h). They can either be written directly with Gradient(), for
+    // example from ProjectOntoSH9ColorGradient during the bake, or computed from the probes with ComputeGradients().
+    void InitGradients()
+    {
+        gradients.Init(probes.Size() * 3, TSH());
+    }
+
+    bool HasGradients() const { return gradients.Size() > 0; }
+
+    TSH& Gradient(uint64 x, uint64 y, uint64 z, uint64 axis)
+    {
+        Assert_(axis < 3);
+        return gradients[ProbeIndex(x, y, z) * 3 + axis];
+    }
+
+    const TSH& Gradient(uint64 x, uint64 y, uint64 z, uint64 axis) const
+    {
+        Assert_(axis < 3);
+        return gradients[ProbeIndex(x, y, z) * 3 + axis];
+    }
+
+    // Fills in the gradients with central differences between neighboring probes, or one-sided differences
+    // on the edges of the volume. Axes with a single probe get a gradient of 0.
+    void ComputeGradients()
+    {
+        InitGradients();
+
+        const float spacing[3] = { probeSpacing.x, probeSpacing.y, probeSpacing.z };
+        const uint64 counts[3] = { numProbes.x, numProbes.y, numProbes.z };
+        for(uint64 z = 0; z < numProbes.z; ++z)
+        {
+            for(uint64 y = 0; y < numProbes.y; ++y)
+            {
+                for(uint64 x = 0; x < numProbes.x; ++x)
+                {
+                    const uint64 coord[3] = { x, y, z };
+                    for(uint64 axis = 0; axis < 3; ++axis)
+                    {
+                        if(counts[axis] == 1 || spacing[axis] <= 0.0f)
+                            continue;
+
+                        uint64 prev[3] = { x, y, z };
+                        uint64 next[3] = { x, y, z };
+                        prev[axis] = coord[axis] > 0 ? coord[axis] - 1 : 0;
+                        next[axis] = Min<uint64>(coord[axis] + 1, counts[axis] - 1);
+
+                        const float* src0 = reinterpret_cast<const float*>(&Probe(prev[0], prev[1], prev[2]));
+                        const float* src1 = reinterpret_cast<const float*>(&Probe(next[0], next[1], next[2]));
+                        float* dst = reinterpret_cast<float*>(&Gradient(x, y, z, axis));
+                        const float scale = 1.0f / ((next[axis] - prev[axis]) * spacing[axis]);
+                        for(uint64 i = 0; i < NumFloats; ++i)
+                            dst[i] = (src1[i] - src0[i]) * scale;
+                    }
+                }
+            }
+        }
+    }
+
+    // Returns the probe closest to a position, extrapolated to the position with its gradient. Positions outside
+    // of the volume are clamped to its bounds. Requires gradients.
+    TSH SampleNearestWithGradient(const Float3& position) const
+    {
+        Assert_(HasGradients());
+
+        const DirectX::XMVECTOR gridPos = GridPosition(position.ToSIMD());
+        const DirectX::XMVECTOR rounded = DirectX::XMVectorRound(gridPos);
+        const Float3 offset = Float3(DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(gridPos, rounded), probeSpacing.ToSIMD()));
+
+        TSH result;
+        ExtrapolateProbe(ProbeIndex(uint64(DirectX::XMVectorGetX(rounded)),
+                                    uint64(DirectX::XMVectorGetY(rounded)),
+                                    uint64(DirectX::XMVectorGetZ(rounded))), offset, result);
+        return result;
+    }
+
+    void SampleNearestWithGradient(const Float3* positions, uint64 numPositions, TSH* results) const
+    {
+        Assert_(HasGradients());
+
+        uint64 posIdx = 0;
+        for(; posIdx + 4 <= numPositions; posIdx += 4)
+        {
+            DirectX::XMVECTOR gridX, gridY, gridZ;
+            GridPosition4(positions + posIdx, gridX, gridY, gridZ);
+
+            const DirectX::XMVECTOR roundedX = DirectX::XMVectorRound(gridX);
+            const DirectX::XMVECTOR roundedY = DirectX::XMVectorRound(gridY);
+            const DirectX::XMVECTOR roundedZ = DirectX::XMVectorRound(gridZ);
+
+            __declspec(align(16)) float x[4];
+            __declspec(align(16)) float y[4];
+            __declspec(align(16)) float z[4];
+            __declspec(align(16)) float ox[4];
+            __declspec(align(16)) float oy[4];
+            __declspec(align(16)) float oz[4];
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(x), roundedX);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(y), roundedY);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(z), roundedZ);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(ox), DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(gridX, roundedX), DirectX::XMVectorReplicate(probeSpacing.x)));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(oy), DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(gridY, roundedY), DirectX::XMVectorReplicate(probeSpacing.y)));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(oz), DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(gridZ, roundedZ), DirectX::XMVectorReplicate(probeSpacing.z)));
+
+            for(uint64 i = 0; i < 4; ++i)
+                ExtrapolateProbe(ProbeIndex(uint64(x[i]), uint64(y[i]), uint64(z[i])), Float3(ox[i], oy[i], oz[i]), results[posIdx + i]);
+        }
+
+        for(; posIdx < numPositions; ++posIdx)
+            results[posIdx] = SampleNearestWithGradient(positions[posIdx]);
+    }
+
+    // Gradient-corrected trilinear sampling: extrapolates each of the 8 probes surrounding a position towards
+    // the position with its gradient, and blends them with trilinear weights. Positions outside of the volume are clamped to its bounds. Requires gradients.
+    TSH SampleTrilinearWithGradient(const Float3& position) const
+    {
+        Assert_(HasGradients());
+
+        const DirectX::XMVECTOR gridPos = GridPosition(position.ToSIMD());
+        const DirectX::XMVECTOR base = DirectX::XMVectorFloor(gridPos);
+        const Float3 baseCoord = Float3(base);
+        const Float3 frac = Float3(DirectX::XMVectorSubtract(gridPos, base));
+
+        TSH result;
+        BlendExtrapolatedProbes(uint64(baseCoord.x), uint64(baseCoord.y), uint64(baseCoord.z), frac.x, frac.y, frac.z, result);
+        return result;
+    }
+
+    void SampleTrilinearWithGradient(const Float3* positions, uint64 numPositions, TSH* results) const
+    {
+        Assert_(HasGradients());
+
+        uint64 posIdx = 0;
+        for(; posIdx + 4 <= numPositions; posIdx += 4)
+        {
+            DirectX::XMVECTOR gridX, gridY, gridZ;
+            GridPosition4(positions + posIdx, gridX, gridY, gridZ);
+
+            const DirectX::XMVECTOR baseX = DirectX::XMVectorFloor(gridX);
+            const DirectX::XMVECTOR baseY = DirectX::XMVectorFloor(gridY);
+            const DirectX::XMVECTOR baseZ = DirectX::XMVectorFloor(gridZ);
+
+            __declspec(align(16)) float x[4];
+            __declspec(align(16)) float y[4];
+            __declspec(align(16)) float z[4];
+            __declspec(align(16)) float fx[4];
+            __declspec(align(16)) float fy[4];
+            __declspec(align(16)) float fz[4];
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(x), baseX);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(y), baseY);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(z), baseZ);
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fx), DirectX::XMVectorSubtract(gridX, baseX));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fy), DirectX::XMVectorSubtract(gridY, baseY));
+            DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(fz), DirectX::XMVectorSubtract(gridZ, baseZ));
+
+            for(uint64 i = 0; i < 4; ++i)
+                BlendExtrapolatedProbes(uint64(x[i]), uint64(y[i]), uint64(z[i]), fx[i], fy[i], fz[i], results[posIdx + i]);
+        }
+
+        for(; posIdx < numPositions; ++posIdx)
+            results[posIdx] = SampleTrilinearWithGradient(positions[posIdx]);
+    }
+
+    // Serialization
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, boundsMin);
+        SerializeItem(serializer, boundsMax);
+        SerializeItem(serializer, numProbes.x);
+        SerializeItem(serializer, numProbes.y);
+        SerializeItem(serializer, numProbes.z);
+        BulkSerializeItem(serializer, probes);
+        BulkSerializeItem(serializer, gradients);
+
+        if(TSerializer::IsReadSerializer())
+        {
+            if(numProbes.x == 0 || numProbes.y == 0 || numProbes.z == 0)
+                throw Exception(L"Probe volume has a serialized probe count of 0");
+            UpdateLayout();
+            if(probes.Size() != uint64(numBricks.x) * numBricks.y * numBricks.z * ProbesPerBrick)
+                throw Exception(L"Probe volume data doesn't match the serialized probe counts");
+            if(gradients.Size() != 0 && gradients.Size() != probes.Size() * 3)
+                throw Exception(L"Probe volume gradients don't match the serialized probe counts");
+        }
+    }
+
+protected:
+
+    static const uint64 NumFloats = sizeof(TSH) / sizeof(float);
+
+    void UpdateLayout()
+    {
+        numBricks.x = uint32((numProbes.x + BrickSize - 1) / BrickSize);
+        numBricks.y = uint32((numProbes.y + BrickSize - 1) / BrickSize);
+        numBricks.z = uint32((numProbes.z + BrickSize - 1) / BrickSize);
+
+        // A single probe along an axis covers the whole axis, so positions along it always map to 0
+        const Float3 numCells = Float3(float(numProbes.x - 1), float(numProbes.y - 1), float(numProbes.z - 1));
+        const Float3 extents = boundsMax - boundsMin;
+        probeSpacing = Float3(numCells.x > 0.0f ? extents.x / numCells.x : 0.0f,
+                              numCells.y > 0.0f ? extents.y / numCells.y : 0.0f,
+                              numCells.z > 0.0f ? extents.z / numCells.z : 0.0f);
+        invProbeSpacing = Float3(probeSpacing.x > 0.0f ? 1.0f / probeSpacing.x : 0.0f,
+                                 probeSpacing.y > 0.0f ? 1.0f / probeSpacing.y : 0.0f,
+                                 probeSpacing.z > 0.0f ? 1.0f / probeSpacing.z : 0.0f);
+        maxGridPosition = numCells;
+    }
+
+    uint64 ProbeIndex(uint64 x, uint64 y, uint64 z) const
+    {
+        Assert_(x < numProbes.x && y < numProbes.y && z < numProbes.z);
+
+        const uint64 brickIdx = ((z / BrickSize) * numBricks.y + (y / BrickSize)) * numBricks.x + (x / BrickSize);
+        const uint64 localIdx = ((z % BrickSize) * BrickSize + (y % BrickSize)) * BrickSize + (x % BrickSize);
+        return brickIdx * ProbesPerBrick + localIdx;
+    }
+
+    // Converts a world-space position to continuous grid coordinates, clamped to the volume
+    DirectX::XMVECTOR GridPosition(DirectX::FXMVECTOR position) const
+    {
+        const DirectX::XMVECTOR gridPos = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(position, boundsMin.ToSIMD()),
+                                                                    invProbeSpacing.ToSIMD());
+        return DirectX::XMVectorClamp(gridPos, DirectX::XMVectorZero(), maxGridPosition.ToSIMD());
+    }
+
+    // Converts 4 world-space positions to continuous grid coordinates in SoA form, clamped to the volume
+    void GridPosition4(const Float3* positions, DirectX::XMVECTOR& gridX, DirectX::XMVECTOR& gridY, DirectX::XMVECTOR& gridZ) const
+    {
+        const DirectX::XMVECTOR px = DirectX::XMVectorSet(positions[0].x, positions[1].x, positions[2].x, positions[3].x);
+        const DirectX::XMVECTOR py = DirectX::XMVectorSet(positions[0].y, positions[1].y, positions[2].y, positions[3].y);
+        const DirectX::XMVECTOR pz = DirectX::XMVectorSet(positions[0].z, positions[1].z, positions[2].z, positions[3].z);
+
+        gridX = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(px, DirectX::XMVectorReplicate(boundsMin.x)), DirectX::XMVectorReplicate(invProbeSpacing.x));
+        gridY = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(py, DirectX::XMVectorReplicate(boundsMin.y)), DirectX::XMVectorReplicate(invProbeSpacing.y));
+        gridZ = DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(pz, DirectX::XMVectorReplicate(boundsMin.z)), DirectX::XMVectorReplicate(invProbeSpacing.z));
+
+        gridX = DirectX::XMVectorClamp(gridX, DirectX::XMVectorZero(), DirectX::XMVectorReplicate(maxGridPosition.x));
+        gridY = DirectX::XMVectorClamp(gridY, DirectX::XMVectorZero(), DirectX::XMVectorReplicate(maxGridPosition.y));
+        gridZ = DirectX::XMVectorClamp(gridZ, DirectX::XMVectorZero(), DirectX::XMVectorReplicate(maxGridPosition.z));
+    }
+
+    void TrilinearFootprint(DirectX::FXMVECTOR gridPos, uint64* indices, float* weights) const
+    {
+        const DirectX::XMVECTOR base = DirectX::XMVectorFloor(gridPos);
+        const Float3 baseCoord = Float3(base);
+        const Float3 frac = Float3(DirectX::XMVectorSubtract(gridPos, base));
+        TrilinearFootprint(uint64(baseCoord.x), uint64(baseCoord.y), uint64(baseCoord.z), frac.x, frac.y, frac.z, indices, weights);
+    }
+
+    void TrilinearFootprint(uint64 x0, uint64 y0, uint64 z0, float fx, float fy, float fz, uint64* indices, float* weights) const
+    {
+        const uint64 x1 = Min<uint64>(x0 + 1, numProbes.x - 1);
+        const uint64 y1 = Min<uint64>(y0 + 1, numProbes.y - 1);
+        const uint64 z1 = Min<uint64>(z0 + 1, numProbes.z - 1);
+
+        indices[0] = ProbeIndex(x0, y0, z0);
+        indices[1] = ProbeIndex(x1, y0, z0);
+        indices[2] = ProbeIndex(x0, y1, z0);
+        indices[3] = ProbeIndex(x1, y1, z0);
+        indices[4] = ProbeIndex(x0, y0, z1);
+        indices[5] = ProbeIndex(x1, y0, z1);
+        indices[6] = ProbeIndex(x0, y1, z1);
+        indices[7] = ProbeIndex(x1, y1, z1);
+
+        const float wx[2] = { 1.0f - fx, fx };
+        const float wy[2] = { 1.0f - fy, fy };
+        const float wz[2] = { 1.0f - fz, fz };
+        for(uint64 i = 0; i < 8; ++i)
+            weights[i] = wx[i & 1] * wy[(i >> 1) & 1] * wz[i >> 2];
+    }
+
+    // Computes the weighted sum of 8 probes, treating each probe as a flat array of floats
+    void BlendProbes(const uint64* indices, const float* weights, TSH& result) const
+    {
+        const float* src[8] = { };
+        for(uint64 i = 0; i < 8; ++i)
+            src[i] = reinterpret_cast<const float*>(&probes[indices[i]]);
+
+        WeightedSum(src, weights, result);
+    }
+
+    // Extrapolates the 8 probes of a trilinear footprint with their gradients, and then blends them with the
+    // trilinear weights. Each probe is only moved halfway to the sampled position: a full step flips the sign of
+    // trilinear filtering's error on quadratic lighting instead of removing it, while a half step makes the result
+    // exact for quadratic lighting.
+    void BlendExtrapolatedProbes(uint64 x0, uint64 y0, uint64 z0, float fx, float fy, float fz, TSH& result) const
+    {
+        uint64 indices[8] = { };
+        float weights[8] = { };
+        TrilinearFootprint(x0, y0, z0, fx, fy, fz, indices, weights);
+
+        TSH corners[8];
+        const float* src[8] = { };
+        for(uint64 i = 0; i < 8; ++i)
+        {
+            const Float3 offset = Float3(fx - float(i & 1), fy - float((i >> 1) & 1), fz - float(i >> 2)) * probeSpacing * 0.5f;
+            ExtrapolateProbe(indices[i], offset, corners[i]);
+            src[i] = reinterpret_cast<const float*>(&corners[i]);
+        }
+
+        WeightedSum(src, weights, result);
+    }
+
+    static void WeightedSum(const float* const* src, const float* weights, TSH& result)
+    {
+        DirectX::XMVECTOR simdWeights[8];
+        for(uint64 i = 0; i < 8; ++i)
+            simdWeights[i] = DirectX::XMVectorReplicate(weights[i]);
+
+        float* dst = reinterpret_cast<float*>(&result);
+
+        uint64 floatIdx = 0;
+        for(; floatIdx + 4 <= NumFloats; floatIdx += 4)
+        {
+            DirectX::XMVECTOR sum = DirectX::XMVectorMultiply(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(src[0] + floatIdx)), simdWeights[0]);
+            for(uint64 i = 1; i < 8; ++i)
+                sum = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(src[i] + floatIdx)), simdWeights[i], sum);
+            DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(dst + floatIdx), sum);
+        }
+
+        for(; floatIdx < NumFloats; ++floatIdx)
+        {
+            float sum = src[0][floatIdx] * weights[0];
+            for(uint64 i = 1; i < 8; ++i)
+                sum += src[i][floatIdx] * weights[i];
+            dst[floatIdx] = sum;
+        }
+    }
+
+    // Adds the probe's gradients scaled by the offset along each axis to the probe, as flat arrays of floats
+    void ExtrapolateProbe(uint64 probeIdx, const Float3& offset, TSH& result) const
+    {
+        const float* src = reinterpret_cast<const float*>(&probes[probeIdx]);
+        const float* grad[3] = { };
+        for(uint64 axis = 0; axis < 3; ++axis)
+            grad[axis] = reinterpret_cast<const float*>(&gradients[probeIdx * 3 + axis]);
+
+        const DirectX::XMVECTOR ox = DirectX::XMVectorReplicate(offset.x);
+        const DirectX::XMVECTOR oy = DirectX::XMVectorReplicate(offset.y);
+        const DirectX::XMVECTOR oz = DirectX::XMVectorReplicate(offset.z);
+
+        float* dst = reinterpret_cast<float*>(&result);
+
+        uint64 floatIdx = 0;
+        for(; floatIdx + 4 <= NumFloats; floatIdx += 4)
+        {
+            DirectX::XMVECTOR sum = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(src + floatIdx));
+            sum = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(grad[0] + floatIdx)), ox, sum);
+            sum = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(grad[1] + floatIdx)), oy, sum);
+            sum = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(grad[2] + floatIdx)), oz, sum);
+            DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(dst + floatIdx), sum);
+        }
+
+        for(; floatIdx < NumFloats; ++floatIdx)
+            dst[floatIdx] = src[floatIdx] + grad[0][floatIdx] * offset.x + grad[1][floatIdx] * offset.y + grad[2][floatIdx] * offset.z;
+    }
+
+    Float3 boundsMin;
+    Float3 boundsMax;
+    Float3 probeSpacing;
+    Float3 invProbeSpacing;
+    Float3 maxGridPosition;
+    Uint3 numProbes;
+    Uint3 numBricks;
+    Array<TSH> probes;
+    Array<TSH> gradients;
+};
+
+typedef ProbeVolume<SH9Color> SH9ColorProbeVolume;
+typedef ProbeVolume<SH4Color> SH4ColorProbeVolume;
+
+struct ProbeGradientStats
+{
+    uint32 SparseFactor = 0;
+    uint64 NumSamples = 0;
+
+    uint64 ReferenceMemorySize = 0;
+    uint64 SparseMemorySize = 0;
+    uint64 SparseWithGradientsMemorySize = 0;
+
+    // L2 norm of the coefficient difference from the reference volume
+    float TrilinearAvgError = 0.0f;
+    float TrilinearMaxError = 0.0f;
+    float GradientAvgError = 0.0f;
+    float GradientMaxError = 0.0f;
+    float TrilinearGradientAvgError = 0.0f;
+    float TrilinearGradientMaxError = 0.0f;
+};
+
+// Measures whether gradients can make up for a sparser grid. The reference volume needs gradients, either from
+// the bake or from ComputeGradients(). A sparse volume keeps every sparseFactor-th probe of the reference along
+// each axis, along with its gradients. Trilinear sampling of the sparse volume, nearest-probe extrapolation with
+// SampleNearestWithGradient() and gradient-corrected trilinear sampling with SampleTrilinearWithGradient() are
+// then compared against trilinear sampling of the reference at random positions. The reference's probe count minus one has to be divisible by sparseFactor along each axis.
+ProbeGradientStats CompareGradientSampling(const SH9ColorProbeVolume& reference, uint32 sparseFactor, uint64 numSamples = 4096);
+std::string ProbeGradientStatsToString(const ProbeGradientStats& stats);
+
+}
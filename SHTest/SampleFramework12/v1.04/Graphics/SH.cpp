@@ -10,8 +10,10 @@
 #include "PCH.h"
 #include "SH.h"
 #include "..\\Utility.h"
+#include "..\\Timer.h"
 #include "ShaderCompilation.h"
 #include "Textures.h"
+#include "Sampling.h"
 
 namespace SampleFramework12
 {
@@ -47,6 +49,114 @@ SH9Color ProjectOntoSH9Color(const Float3& dir, const Float3& color)
     return shColor;
 }
 
+SH9ColorGradient ProjectOntoSH9ColorGradient(const Float3& dir, const Float3& color, float hitDistance)
+{
+    Assert_(hitDistance > 0.0f);
+
+    SH9ColorGradient gradient;
+    if(std::isinf(hitDistance))
+        return gradient;
+
+    // Cartesian gradients of the basis functions, for the polynomial forms used in ProjectOntoSH9
+    const Float3 basisGradients[9] =
+    {
+        Float3(0.0f, 0.0f, 0.0f),
+        Float3(0.0f, 0.488603f, 0.0f),
+        Float3(0.0f, 0.0f, 0.488603f),
+        Float3(0.488603f, 0.0f, 0.0f),
+        Float3(1.092548f * dir.y, 1.092548f * dir.x, 0.0f),
+        Float3(0.0f, 1.092548f * dir.z, 1.092548f * dir.y),
+        Float3(0.0f, 0.0f, 0.315392f * 6.0f * dir.z),
+        Float3(1.092548f * dir.z, 0.0f, 1.092548f * dir.x),
+        Float3(0.546274f * 2.0f * dir.x, -0.546274f * 2.0f * dir.y, 0.0f),
+    };
+
+    // Moving the projection point by d changes the direction to the hit point by -(I - dir * dir^T) * d / hitDistance,
+    // so each basis function changes by its gradient projected onto the plane perpendicular to the direction
+    for(uint64 i = 0; i < 9; ++i)
+    {
+        const Float3 tangentGradient = basisGradients[i] - dir * Float3::Dot(basisGradients[i], dir);
+        const Float3 derivative = tangentGradient * (-1.0f / hitDistance);
+        gradient.D[0].Coefficients[i] = color * derivative.x;
+        gradient.D[1].Coefficients[i] = color * derivative.y;
+        gradient.D[2].Coefficients[i] = color * derivative.z;
+    }
+
+    return gradient;
+}
+
+SH9 ProjectPolygonOntoSH9(const Float3* vertices, uint64 numVertices)
+{
+    Assert_(numVertices >= 3);
+
+    // Exact projection of a spherical polygon, computed from the solid angle along with the first and
+    // second moments of the polygon which can all be expressed as sums over the edges (see Arvo 1995,
+    // "Applications of Irradiance Tensors to the Simulation of Non-Lambertian Phenomena")
+    float solidAngle = 0.0f;
+    Float3 firstMoment;
+    Float3 secondMomentDiag;
+    Float3 secondMomentOffDiag;
+
+    const Float3 v0 = Float3::Normalize(vertices[0]);
+    Float3 vi = v0;
+    for(uint64 i = 0; i < numVertices; ++i)
+    {
+        const Float3 vj = (i + 1 < numVertices) ? Float3::Normalize(vertices[i + 1]) : v0;
+
+        const Float3 edgeCross = Float3::Cross(vi, vj);
+        const float cosTheta = Float3::Dot(vi, vj);
+        const float sinTheta = Float3::Length(edgeCross);
+
+        // Signed solid angle of the triangle fan (v0, vi, vj), from van Oosterom and Strackee
+        solidAngle += 2.0f * std::atan2(Float3::Dot(v0, edgeCross), 1.0f + Float3::Dot(v0, vi) + cosTheta + Float3::Dot(vj, v0));
+
+        firstMoment += edgeCross * (std::atan2(sinTheta, cosTheta) / std::max(sinTheta, 0.0001f));
+
+        const Float3 arc = (vi + vj) / (1.0f + cosTheta);
+        secondMomentDiag += arc * edgeCross;
+        secondMomentOffDiag += Float3(arc.x * edgeCross.y + arc.y * edgeCross.x,
+                                      arc.y * edgeCross.z + arc.z * edgeCross.y,
+                                      arc.x * edgeCross.z + arc.z * edgeCross.x);
+
+        vi = vj;
+    }
+
+    // The edge sums flip sign with the winding order
+    const float windingSign = solidAngle < 0.0f ? -1.0f : 1.0f;
+    solidAngle = std::abs(solidAngle);
+    firstMoment *= 0.5f * windingSign;
+    secondMomentDiag = (Float3(solidAngle) + secondMomentDiag * windingSign) / 3.0f;
+    secondMomentOffDiag *= windingSign / 6.0f;
+
+    SH9 sh;
+
+    // Band 0
+    sh.Coefficients[0] = 0.282095f * solidAngle;
+
+    // Band 1
+    sh.Coefficients[1] = 0.488603f * firstMoment.y;
+    sh.Coefficients[2] = 0.488603f * firstMoment.z;
+    sh.Coefficients[3] = 0.488603f * firstMoment.x;
+
+    // Band 2
+    sh.Coefficients[4] = 1.092548f * secondMomentOffDiag.x;
+    sh.Coefficients[5] = 1.092548f * secondMomentOffDiag.y;
+    sh.Coefficients[6] = 0.315392f * (3.0f * secondMomentDiag.z - solidAngle);
+    sh.Coefficients[7] = 1.092548f * secondMomentOffDiag.z;
+    sh.Coefficients[8] = 0.546274f * (secondMomentDiag.x - secondMomentDiag.y);
+
+    return sh;
+}
+
+SH9Color ProjectPolygonOntoSH9Color(const Float3* vertices, uint64 numVertices, const Float3& radiance)
+{
+    SH9 sh = ProjectPolygonOntoSH9(vertices, numVertices);
+    SH9Color shColor;
+    for(uint64 i = 0; i < 9; ++i)
+        shColor.Coefficients[i] = radiance * sh.Coefficients[i];
+    return shColor;
+}
+
 Float3 EvalSH9Irradiance(const Float3& dir, const SH9Color& sh)
 {
     SH9 dirSH = ProjectOntoSH9(dir);
@@ -67,6 +177,141 @@ Float3 EvalSH9Irradiance(const Float3& dir, const SH9Color& sh)
     return result;
 }
 
+Float3 EvalSH9Irradiance(const Float3& dir, const SH9ColorPlanar& sh)
+{
+    SH9 dirSH = ProjectOntoSH9(dir);
+    dirSH.ConvolveWithCosineKernel();
+    return sh.Dot(dirSH);
+}
+
+Float3 HannWindowSH9(float width)
+{
+    return Float3(1.0f, 0.5f + 0.5f * std::cos(Pi / width), 0.5f + 0.5f * std::cos(2.0f * Pi / width));
+}
+
+Float3 LanczosWindowSH9(float width)
+{
+    const float x1 = Pi / width;
+    const float x2 = 2.0f * Pi / width;
+    return Float3(1.0f, std::sin(x1) / x1, std::sin(x2) / x2);
+}
+
+Float3 DeringingWindowSH9(float strength)
+{
+    // Sloan's deringing window: 1 / (1 + strength * l^2 * (l + 1)^2)
+    return Float3(1.0f, 1.0f / (1.0f + 4.0f * strength), 1.0f / (1.0f + 36.0f * strength));
+}
+
+// Generated by FitGGXZonalHarmonics with nDotV = 1.000000, max error per band = (0.001880, 0.004740, 0.007640, 0.010170)
+static const float GGXZHFitTable[4][4] =
+{
+    { 1.28078655f, 6.31756943f, 1.53288419f, 11.1736787f },
+    { 0.945101731f, 0.970247081f, 1.64343249f, 13.5192486f },
+    { 0.320913301f, -2.48382357f, 1.57508101f, 18.2017438f },
+    { -0.984520576f, -1.57792174f, 0.901643281f, 24.9344885f },
+};
+
+float ApproximateGGXZH(float ggxAlpha, uint64 band)
+{
+    Assert_(band <= 4);
+    if(band == 0)
+        return 1.0f;
+
+    const float* c = GGXZHFitTable[band - 1];
+    return (1.0f + ggxAlpha * (c[0] + ggxAlpha * c[1])) / (1.0f + ggxAlpha * (c[2] + ggxAlpha * c[3]));
+}
+
+// Returns the minimum irradiance over a fixed set of directions, for each color channel
+static Float3 MinWindowedIrradiance(const SH9Color& radiance, const Float3& window, const Array<SH9>& dirSH)
+{
+    const float zh[3] = { CosineA0 * window.x, CosineA1 * window.y, CosineA2 * window.z };
+    const uint64 bands[9] = { 0, 1, 1, 1, 2, 2, 2, 2, 2 };
+
+    SH9Color convolved = radiance;
+    for(uint64 i = 0; i < 9; ++i)
+        convolved.Coefficients[i] *= zh[bands[i]];
+
+    Float3 minIrradiance = Float3(FloatMax);
+    for(uint64 dirIdx = 0; dirIdx < dirSH.Size(); ++dirIdx)
+    {
+        Float3 irradiance;
+        for(uint64 i = 0; i < 9; ++i)
+            irradiance += convolved.Coefficients[i] * dirSH[dirIdx].Coefficients[i];
+        minIrradiance = Min(minIrradiance, irradiance);
+    }
+
+    return minIrradiance;
+}
+
+float CalculateDeringingStrength(const SH9Color& radiance)
+{
+    // Evaluate on a Fibonacci sphere, which is dense enough to find the minimum of an L2 function
+    const uint64 NumDirections = 1024;
+    Array<SH9> dirSH(NumDirections);
+    for(uint64 i = 0; i < NumDirections; ++i)
+    {
+        const float z = 1.0f - (2.0f * i + 1.0f) / NumDirections;
+        const float r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+        const float phi = i * Pi * (3.0f - std::sqrt(5.0f));
+        dirSH[i] = ProjectOntoSH9(Float3(r * std::cos(phi), r * std::sin(phi), z));
+    }
+
+    auto isNonNegative = [&](float strength)
+    {
+        const Float3 minIrradiance = MinWindowedIrradiance(radiance, DeringingWindowSH9(strength), dirSH);
+        return minIrradiance.x >= 0.0f && minIrradiance.y >= 0.0f && minIrradiance.z >= 0.0f;
+    };
+
+    if(isNonNegative(0.0f))
+        return 0.0f;
+
+    // Find an upper bound, and then binary search for the smallest strength that works. A negative
+    // L0 coefficient can't be fixed by windowing, in which case this returns the largest strength tried.
+    float upper = 0.001f;
+    const float maxStrength = 1000.0f;
+    while(upper < maxStrength && isNonNegative(upper) == false)
+        upper *= 2.0f;
+
+    float lower = 0.0f;
+    for(uint64 i = 0; i < 24; ++i)
+    {
+        const float mid = (lower + upper) * 0.5f;
+        if(isNonNegative(mid))
+            upper = mid;
+        else
+            lower = mid;
+    }
+
+    return upper;
+}
+
+// Conversion from L2 SH to the H-basis, see "Efficient Irradiance Normal Mapping" by
+// Ralf Habel and Michael Wimmer for the derivations
+static const float HBasisConversion[6][9] =
+{
+    { 0.707107f, 0.0f, 0.612372f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 0.707107f, 0.0f, 0.0f, 0.0f, 0.592927f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, 0.353553f, 0.0f, 0.0f, 0.0f, 0.684653f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 0.707107f, 0.0f, 0.0f, 0.0f, 0.592927f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 0.0f, 0.707107f, 0.0f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.707107f },
+};
+
+template<typename TH, typename TSH> static TH ConvertToHBasis(const TSH& sh, uint64 numCoefficients)
+{
+    TH hBasis;
+
+    for(uint64 row = 0; row < numCoefficients; ++row)
+    {
+        hBasis.Coefficients[row] = 0.0f;
+
+        for(uint64 col = 0; col < 9; ++col)
+            hBasis.Coefficients[row] += sh.Coefficients[col] * HBasisConversion[row][col];
+    }
+
+    return hBasis;
+}
+
 H4 ProjectOntoH4(const Float3& dir)
 {
     H4 result;
@@ -81,37 +326,115 @@ H4 ProjectOntoH4(const Float3& dir)
     return result;
 }
 
+H6 ProjectOntoH6(const Float3& dir)
+{
+    H6 result;
+
+    // Band 0
+    result[0] = 0.398942f;
+
+    // Band 1
+    result[1] = 0.690988f * dir.y;
+    result[2] = 0.690988f * (2.0f * dir.z - 1.0f);
+    result[3] = 0.690988f * dir.x;
+
+    // Band 2
+    result[4] = 1.545097f * dir.x * dir.y;
+    result[5] = 0.772548f * (dir.x * dir.x - dir.y * dir.y);
+
+    return result;
+}
+
+H4Color ProjectOntoH4Color(const Float3& dir, const Float3& color)
+{
+    H4 h = ProjectOntoH4(dir);
+    H4Color result;
+    for(uint64 i = 0; i < 4; ++i)
+        result[i] = color * h[i];
+    return result;
+}
+
+H6Color ProjectOntoH6Color(const Float3& dir, const Float3& color)
+{
+    H6 h = ProjectOntoH6(dir);
+    H6Color result;
+    for(uint64 i = 0; i < 6; ++i)
+        result[i] = color * h[i];
+    return result;
+}
+
 float EvalH4(const H4& h, const Float3& dir)
 {
     H4 b = ProjectOntoH4(dir);
     return H4::Dot(h, b);
 }
 
+Float3 EvalH4(const H4Color& h, const Float3& dir)
+{
+    H4 b = ProjectOntoH4(dir);
+    Float3 result;
+    for(uint64 i = 0; i < 4; ++i)
+        result += h[i] * b[i];
+    return result;
+}
+
+float EvalH6(const H6& h, const Float3& dir)
+{
+    H6 b = ProjectOntoH6(dir);
+    return H6::Dot(h, b);
+}
+
+Float3 EvalH6(const H6Color& h, const Float3& dir)
+{
+    H6 b = ProjectOntoH6(dir);
+    Float3 result;
+    for(uint64 i = 0; i < 6; ++i)
+        result += h[i] * b[i];
+    return result;
+}
+
 H4 ConvertToH4(const SH9& sh)
 {
-    const float rt2 = sqrt(2.0f);
-    const float rt32 = sqrt(3.0f / 2.0f);
-    const float rt52 = sqrt(5.0f / 2.0f);
-    const float rt152 = sqrt(15.0f / 2.0f);
-    const float convMatrix[4][9] =
-    {
-        { 1.0f / rt2, 0, 0.5f * rt32, 0, 0, 0, 0, 0, 0 },
-        { 0, 1.0f / rt2, 0, 0, 0, (3.0f / 8.0f) * rt52, 0, 0, 0 },
-        { 0, 0, 1.0f / (2.0f * rt2), 0, 0, 0, 0.25f * rt152, 0, 0 },
-        { 0, 0, 0, 1.0f / rt2, 0, 0, 0, (3.0f / 8.0f) * rt52, 0 }
-    };
+    return ConvertToHBasis<H4>(sh, 4);
+}
+
+H4Color ConvertToH4(const SH9Color& sh)
+{
+    return ConvertToHBasis<H4Color>(sh, 4);
+}
 
-    H4 hBasis;
+H6 ConvertToH6(const SH9& sh)
+{
+    return ConvertToHBasis<H6>(sh, 6);
+}
 
-    for(uint64 row = 0; row < 4; ++row)
-    {
-        hBasis.Coefficients[row] = 0.0f;
+H6Color ConvertToH6(const SH9Color& sh)
+{
+    return ConvertToHBasis<H6Color>(sh, 6);
+}
 
-        for(uint64 col = 0; col < 9; ++col)
-            hBasis.Coefficients[row] += convMatrix[row][col] * sh.Coefficients[col];
+void EncodeH4Lightmap(const SH9Color* radiance, uint64 numTexels, H4Color* output)
+{
+    Assert_(radiance != nullptr && output != nullptr);
+
+    for(uint64 i = 0; i < numTexels; ++i)
+    {
+        SH9Color irradiance = radiance[i];
+        irradiance.ConvolveWithCosineKernel();
+        output[i] = ConvertToH4(irradiance);
     }
+}
 
-    return hBasis;
+void EncodeH6Lightmap(const SH9Color* radiance, uint64 numTexels, H6Color* output)
+{
+    Assert_(radiance != nullptr && output != nullptr);
+
+    for(uint64 i = 0; i < numTexels; ++i)
+    {
+        SH9Color irradiance = radiance[i];
+        irradiance.ConvolveWithCosineKernel();
+        output[i] = ConvertToH6(irradiance);
+    }
 }
 
 SH9Color ProjectCubemapToSH(const Texture& texture)
@@ -155,4 +478,202 @@ SH9Color ProjectCubemapToSH(const Texture& texture)
     return result;
 }
 
+// Area-samples a parallelogram with the given corner and edges, converting the area measure to solid angle
+template<typename TSampleFunc> static SH9 AreaSampleParallelogram(const Float3& corner, const Float3& edge0, const Float3& edge1,
+                                                                uint64 numSamples, TSampleFunc&& sampleFunc)
+{
+    const Float3 areaNormal = Float3::Cross(edge0, edge1);
+    const float area = Float3::Length(areaNormal);
+    const Float3 normal = areaNormal / area;
+
+    SH9 sh;
+    for(uint64 i = 0; i < numSamples; ++i)
+    {
+        const Float2 uv = sampleFunc(i);
+        const Float3 pos = corner + edge0 * uv.x + edge1 * uv.y;
+        const float distSq = Float3::Dot(pos, pos);
+        const Float3 dir = pos / std::sqrt(distSq);
+        sh += ProjectOntoSH9(dir) * (std::abs(Float3::Dot(normal, dir)) / distSq);
+    }
+
+    sh *= area / numSamples;
+    return sh;
+}
+
+PolygonProjectionStats CompareProjectPolygonOntoSH9(uint64 numPolygons, uint64 numMonteCarloSamples, uint64 numReferenceSamples)
+{
+    Assert_(numPolygons > 0 && numMonteCarloSamples > 0 && numReferenceSamples > 0);
+
+    // Random parallelograms 1.5-3.5 units from the origin, with planes that stay clear of the origin
+    Random random;
+    Array<Float3> vertices(numPolygons * 4);
+    for(uint64 polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+    {
+        Float3 center;
+        Float3 edge0;
+        Float3 edge1;
+        do
+        {
+            center = SampleDirectionSphere(random.RandomFloat(), random.RandomFloat()) * (1.5f + 2.0f * random.RandomFloat());
+            edge0 = SampleDirectionSphere(random.RandomFloat(), random.RandomFloat()) * (0.25f + random.RandomFloat());
+            edge1 = SampleDirectionSphere(random.RandomFloat(), random.RandomFloat()) * (0.25f + random.RandomFloat());
+        }
+        while(Float3::Length(Float3::Cross(edge0, edge1)) < 0.05f ||
+              std::abs(Float3::Dot(Float3::Normalize(Float3::Cross(edge0, edge1)), center)) < 0.25f);
+
+        Float3* polygon = &vertices[polyIdx * 4];
+        polygon[0] = center - (edge0 + edge1) * 0.5f;
+        polygon[1] = polygon[0] + edge0;
+        polygon[2] = polygon[1] + edge1;
+        polygon[3] = polygon[0] + edge1;
+    }
+
+    PolygonProjectionStats stats;
+    stats.NumPolygons = numPolygons;
+    stats.NumMonteCarloSamples = numMonteCarloSamples;
+    stats.NumReferenceSamples = numReferenceSamples;
+
+    Array<SH9> analytic(numPolygons);
+    Timer timer;
+    for(uint64 polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+        analytic[polyIdx] = ProjectPolygonOntoSH9(&vertices[polyIdx * 4], 4);
+    timer.Update();
+    stats.AnalyticNanoseconds = timer.ElapsedMicrosecondsD() * 1000.0 / numPolygons;
+
+    Array<SH9> monteCarlo(numPolygons);
+    timer.Update();
+    for(uint64 polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+    {
+        const Float3* polygon = &vertices[polyIdx * 4];
+        monteCarlo[polyIdx] = AreaSampleParallelogram(polygon[0], polygon[1] - polygon[0], polygon[3] - polygon[0], numMonteCarloSamples,
+                                                      [&](uint64) { return random.RandomFloat2(); });
+    }
+    timer.Update();
+    stats.MonteCarloNanoseconds = timer.DeltaMicrosecondsD() * 1000.0 / numPolygons;
+
+    double referenceSqSum = 0.0;
+    double analyticErrorSqSum = 0.0;
+    double monteCarloErrorSqSum = 0.0;
+    for(uint64 polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+    {
+        const Float3* polygon = &vertices[polyIdx * 4];
+        const SH9 reference = AreaSampleParallelogram(polygon[0], polygon[1] - polygon[0], polygon[3] - polygon[0], numReferenceSamples,
+                                                      [&](uint64 i) { return Hammersley2D(i, numReferenceSamples); });
+        for(uint64 i = 0; i < 9; ++i)
+        {
+            referenceSqSum += Square(double(reference.Coefficients[i]));
+            analyticErrorSqSum += Square(double(analytic[polyIdx].Coefficients[i] - reference.Coefficients[i]));
+            monteCarloErrorSqSum += Square(double(monteCarlo[polyIdx].Coefficients[i] - reference.Coefficients[i]));
+        }
+    }
+
+    stats.AnalyticRelativeRMSError = float(std::sqrt(analyticErrorSqSum / referenceSqSum));
+    stats.MonteCarloRelativeRMSError = float(std::sqrt(monteCarloErrorSqSum / referenceSqSum));
+
+    return stats;
+}
+
+std::string PolygonProjectionStatsToString(const PolygonProjectionStats& stats)
+{
+    return MakeString("Polygon projection: %llu random quads, reference with %llu samples each\n"
+                      "Analytic: %.1f ns per quad, relative RMS error %.3f%%\n"
+                      "Monte Carlo with %llu samples: %.1f ns per quad, relative RMS error %.3f%%\n",
+                      stats.NumPolygons, stats.NumReferenceSamples,
+                      stats.AnalyticNanoseconds, stats.AnalyticRelativeRMSError * 100.0f,
+                      stats.NumMonteCarloSamples, stats.MonteCarloNanoseconds, stats.MonteCarloRelativeRMSError * 100.0f);
+}
+
+SHMultiplyErrorStats ValidateSHMultiply(uint64 numTrials, uint64 numRings)
+{
+    Assert_(numTrials > 0 && numRings > 0);
+
+    // Midpoint rule over theta and phi, with each sample weighted by its solid angle
+    const uint64 numSegments = numRings * 2;
+    Array<SH9> basis(numRings * numSegments);
+    Array<float> sampleWeights(numRings * numSegments);
+    for(uint64 ring = 0; ring < numRings; ++ring)
+    {
+        const float theta = (ring + 0.5f) * Pi / numRings;
+        for(uint64 segment = 0; segment < numSegments; ++segment)
+        {
+            const float phi = (segment + 0.5f) * Pi2 / numSegments;
+            const Float3 dir = Float3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            basis[ring * numSegments + segment] = ProjectOntoSH9(dir);
+            sampleWeights[ring * numSegments + segment] = std::sin(theta) * (Pi / numRings) * (Pi2 / numSegments);
+        }
+    }
+
+    SHMultiplyErrorStats stats;
+    stats.NumTrials = numTrials;
+    stats.NumQuadratureSamples = basis.Size();
+
+    Random random;
+    for(uint64 trialIdx = 0; trialIdx < numTrials; ++trialIdx)
+    {
+        SH9 a;
+        SH9 b;
+        for(uint64 i = 0; i < 9; ++i)
+        {
+            a[i] = random.RandomFloat() * 2.0f - 1.0f;
+            b[i] = random.RandomFloat() * 2.0f - 1.0f;
+        }
+
+        SH4 a4;
+        SH4 b4;
+        for(uint64 i = 0; i < 4; ++i)
+        {
+            a4[i] = a[i];
+            b4[i] = b[i];
+        }
+
+        double l1Reference[4] = { };
+        double l2Reference[9] = { };
+        for(uint64 sampleIdx = 0; sampleIdx < basis.Size(); ++sampleIdx)
+        {
+            const SH9& y = basis[sampleIdx];
+            double aL1 = 0.0;
+            double bL1 = 0.0;
+            for(uint64 i = 0; i < 4; ++i)
+            {
+                aL1 += a[i] * y[i];
+                bL1 += b[i] * y[i];
+            }
+
+            const double l1Weighted = aL1 * bL1 * sampleWeights[sampleIdx];
+            const double l2Weighted = double(SH9::Dot(a, y)) * SH9::Dot(b, y) * sampleWeights[sampleIdx];
+            for(uint64 i = 0; i < 4; ++i)
+                l1Reference[i] += l1Weighted * y[i];
+            for(uint64 i = 0; i < 9; ++i)
+                l2Reference[i] += l2Weighted * y[i];
+        }
+
+        const SH4 l1Product = SHMultiply(a4, b4);
+        for(uint64 i = 0; i < 4; ++i)
+            stats.L1MaxError = Max(stats.L1MaxError, float(std::abs(l1Product[i] - l1Reference[i])));
+
+        const SH9 l2Product = SHMultiply(a, b);
+        for(uint64 i = 0; i < 9; ++i)
+            stats.L2MaxError = Max(stats.L2MaxError, float(std::abs(l2Product[i] - l2Reference[i])));
+
+        const Float3 zonal = Float3(b[0], b[2], b[6]);
+        SH9 zonalSH;
+        zonalSH[0] = zonal.x;
+        zonalSH[2] = zonal.y;
+        zonalSH[6] = zonal.z;
+        const SH9 zonalProduct = SHMultiplyZonal(a, zonal);
+        const SH9 fullProduct = SHMultiply(a, zonalSH);
+        for(uint64 i = 0; i < 9; ++i)
+            stats.ZonalMaxError = Max(stats.ZonalMaxError, std::abs(zonalProduct[i] - fullProduct[i]));
+    }
+
+    return stats;
+}
+
+std::string SHMultiplyErrorStatsToString(const SHMultiplyErrorStats& stats)
+{
+    return MakeString("SH multiply: %llu random pairs, reference integrated over %llu directions\n"
+                      "Max error: L1 %e, L2 %e, zonal vs full L2 %e\n",
+                      stats.NumTrials, stats.NumQuadratureSamples, stats.L1MaxError, stats.L2MaxError, stats.ZonalMaxError);
+}
+
 }
\ No newline at end of file
@@ -164,7 +164,7 @@ public:
     template<typename TSerializer>
     void Serialize(TSerializer& serializer)
     {
-        SerializeRawArray(serializer, Coefficients, N);
+        BulkSerializeArray(serializer, Coefficients, N);
     }
 };
 
@@ -174,6 +174,10 @@ typedef SH<Float3, 4> SH4Color;
 typedef SH<float, 9> SH9;
 typedef SH<Float3, 9> SH9Color;
 
+// Number of floats in an SH9Color, for code that treats probes as flat vectors of their coefficients
+static const uint64 SH9ColorNumFloats = 27;
+static_assert(sizeof(SH9Color) == SH9ColorNumFloats * sizeof(float), "SH9Color is expected to be 27 contiguous floats");
+
 // H-basis
 class H4 : public SH<float, 4>
 {
@@ -199,6 +203,187 @@ public:
 };
 
 typedef SH<Float3, 4> H4Color;
+typedef SH<float, 6> H6;
+typedef SH<Float3, 6> H6Color;
+
+// Converts a set of SH coefficients to a different coefficient type, for example SH<float, 9> to SH<double, 9>
+template<typename TDst, typename T, uint64 N> SH<TDst, N> SHCast(const SH<T, N>& sh)
+{
+    SH<TDst, N> result;
+    for(uint64 i = 0; i < N; ++i)
+        result.Coefficients[i] = TDst(sh.Coefficients[i]);
+    return result;
+}
+
+// First-order spatial gradient of a set of SH coefficients, holding the derivative of every coefficient along
+// world-space X, Y and Z. Matches SH::SHGradient in SH.hlsli.
+template<typename T, uint64 N> class SHGradient
+{
+
+public:
+
+    SH<T, N> D[3];
+
+    SHGradient& operator+=(const SHGradient& other)
+    {
+        for(uint64 axis = 0; axis < 3; ++axis)
+            D[axis] += other.D[axis];
+        return *this;
+    }
+
+    SHGradient operator*(float scale) const
+    {
+        SHGradient result;
+        for(uint64 axis = 0; axis < 3; ++axis)
+            result.D[axis] = D[axis] * T(scale);
+        return result;
+    }
+
+    // Extrapolates SH coefficients by a world-space offset from the point where they were computed
+    SH<T, N> Extrapolate(const SH<T, N>& sh, const Float3& offset) const
+    {
+        SH<T, N> result;
+        for(uint64 i = 0; i < N; ++i)
+            result.Coefficients[i] = sh.Coefficients[i] + D[0].Coefficients[i] * offset.x +
+                                     D[1].Coefficients[i] * offset.y + D[2].Coefficients[i] * offset.z;
+        return result;
+    }
+};
+
+typedef SHGradient<Float3, 4> SH4ColorGradient;
+typedef SHGradient<Float3, 9> SH9ColorGradient;
+
+// Sums projected SH samples, optionally using Kahan summation to reduce the error that builds up
+// when adding many small samples to a large running sum
+template<typename T, uint64 N, bool Compensated = false> class SHAccumulator
+{
+
+public:
+
+    SH<T, N> Sum;
+    SH<T, N> Compensation;
+
+    void Add(const SH<T, N>& sh)
+    {
+        if constexpr(Compensated)
+        {
+            for(uint64 i = 0; i < N; ++i)
+            {
+                const T y = sh.Coefficients[i] - Compensation.Coefficients[i];
+                const T t = Sum.Coefficients[i] + y;
+                Compensation.Coefficients[i] = (t - Sum.Coefficients[i]) - y;
+                Sum.Coefficients[i] = t;
+            }
+        }
+        else
+        {
+            Sum += sh;
+        }
+    }
+
+    SH<T, N> Result() const
+    {
+        return Sum;
+    }
+
+    SH<T, N> Result(float scale) const
+    {
+        return Sum * T(scale);
+    }
+};
+
+// Triple products: multiplies two SH functions and projects the result back onto the same number of bands,
+// using only the non-zero Clebsch-Gordan (Gaunt) coefficients of the real SH basis. The zonal variants
+// take the m = 0 coefficients of a function that's rotationally symmetric around +Z.
+template<typename T> SH<T, 4> SHMultiply(const SH<T, 4>& a, const SH<T, 4>& b)
+{
+    SH<T, 4> result;
+    result[0] = 0.282094792f * (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+    result[1] = 0.282094792f * (a[0] * b[1] + a[1] * b[0]);
+    result[2] = 0.282094792f * (a[0] * b[2] + a[2] * b[0]);
+    result[3] = 0.282094792f * (a[0] * b[3] + a[3] * b[0]);
+    return result;
+}
+
+template<typename T> SH<T, 9> SHMultiply(const SH<T, 9>& a, const SH<T, 9>& b)
+{
+    SH<T, 9> result;
+    result[0] = 0.282094792f * (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] + a[4] * b[4] + a[5] * b[5] + a[6] * b[6] + a[7] * b[7] + a[8] * b[8]);
+    result[1] = 0.282094792f * (a[0] * b[1] + a[1] * b[0]) +
+                -0.126156626f * (a[1] * b[6] + a[6] * b[1]) +
+                -0.218509686f * (a[1] * b[8] + a[8] * b[1]) +
+                0.218509686f * (a[2] * b[5] + a[5] * b[2] + a[3] * b[4] + a[4] * b[3]);
+    result[2] = 0.282094792f * (a[0] * b[2] + a[2] * b[0]) +
+                0.218509686f * (a[1] * b[5] + a[5] * b[1] + a[3] * b[7] + a[7] * b[3]) +
+                0.252313252f * (a[2] * b[6] + a[6] * b[2]);
+    result[3] = 0.282094792f * (a[0] * b[3] + a[3] * b[0]) +
+                0.218509686f * (a[1] * b[4] + a[4] * b[1] + a[2] * b[7] + a[7] * b[2] + a[3] * b[8] + a[8] * b[3]) +
+                -0.126156626f * (a[3] * b[6] + a[6] * b[3]);
+    result[4] = 0.282094792f * (a[0] * b[4] + a[4] * b[0]) +
+                0.218509686f * (a[1] * b[3] + a[3] * b[1]) +
+                -0.180223752f * (a[4] * b[6] + a[6] * b[4]) +
+                0.156078347f * (a[5] * b[7] + a[7] * b[5]);
+    result[5] = 0.282094792f * (a[0] * b[5] + a[5] * b[0]) +
+                0.218509686f * (a[1] * b[2] + a[2] * b[1]) +
+                0.156078347f * (a[4] * b[7] + a[7] * b[4]) +
+                0.090111876f * (a[5] * b[6] + a[6] * b[5]) +
+                -0.156078347f * (a[5] * b[8] + a[8] * b[5]);
+    result[6] = 0.282094792f * (a[0] * b[6] + a[6] * b[0]) +
+                -0.126156626f * (a[1] * b[1] + a[3] * b[3]) +
+                0.252313252f * (a[2] * b[2]) +
+                -0.180223752f * (a[4] * b[4] + a[8] * b[8]) +
+                0.090111876f * (a[5] * b[5] + a[7] * b[7]) +
+                0.180223752f * (a[6] * b[6]);
+    result[7] = 0.282094792f * (a[0] * b[7] + a[7] * b[0]) +
+                0.218509686f * (a[2] * b[3] + a[3] * b[2]) +
+                0.156078347f * (a[4] * b[5] + a[5] * b[4] + a[7] * b[8] + a[8] * b[7]) +
+                0.090111876f * (a[6] * b[7] + a[7] * b[6]);
+    result[8] = 0.282094792f * (a[0] * b[8] + a[8] * b[0]) +
+                -0.218509686f * (a[1] * b[1]) +
+                0.218509686f * (a[3] * b[3]) +
+                -0.156078347f * (a[5] * b[5]) +
+                -0.180223752f * (a[6] * b[8] + a[8] * b[6]) +
+                0.156078347f * (a[7] * b[7]);
+    return result;
+}
+
+template<typename T> SH<T, 4> SHMultiplyZonal(const SH<T, 4>& sh, const Float2& zonal)
+{
+    SH<T, 4> result;
+    result[0] = 0.282094792f * (sh[0] * zonal.x + sh[2] * zonal.y);
+    result[1] = 0.282094792f * (sh[1] * zonal.x);
+    result[2] = 0.282094792f * (sh[0] * zonal.y + sh[2] * zonal.x);
+    result[3] = 0.282094792f * (sh[3] * zonal.x);
+    return result;
+}
+
+template<typename T> SH<T, 9> SHMultiplyZonal(const SH<T, 9>& sh, const Float3& zonal)
+{
+    SH<T, 9> result;
+    result[0] = 0.282094792f * (sh[0] * zonal.x + sh[2] * zonal.y + sh[6] * zonal.z);
+    result[1] = 0.282094792f * (sh[1] * zonal.x) +
+                -0.126156626f * (sh[1] * zonal.z) +
+                0.218509686f * (sh[5] * zonal.y);
+    result[2] = 0.282094792f * (sh[0] * zonal.y + sh[2] * zonal.x) +
+                0.252313252f * (sh[2] * zonal.z + sh[6] * zonal.y);
+    result[3] = 0.282094792f * (sh[3] * zonal.x) +
+                -0.126156626f * (sh[3] * zonal.z) +
+                0.218509686f * (sh[7] * zonal.y);
+    result[4] = 0.282094792f * (sh[4] * zonal.x) +
+                -0.180223752f * (sh[4] * zonal.z);
+    result[5] = 0.218509686f * (sh[1] * zonal.y) +
+                0.282094792f * (sh[5] * zonal.x) +
+                0.090111876f * (sh[5] * zonal.z);
+    result[6] = 0.282094792f * (sh[0] * zonal.z + sh[6] * zonal.x) +
+                0.252313252f * (sh[2] * zonal.y) +
+                0.180223752f * (sh[6] * zonal.z);
+    result[7] = 0.218509686f * (sh[3] * zonal.y) +
+                0.282094792f * (sh[7] * zonal.x) +
+                0.090111876f * (sh[7] * zonal.z);
+    result[8] = 0.282094792f * (sh[8] * zonal.x) +
+                -0.180223752f * (sh[8] * zonal.z);
+    return result;
+}
 
 // For proper alignment with shader constant buffers
 struct ShaderSH9Color
@@ -216,18 +401,210 @@ struct ShaderSH9Color
     }
 };
 
+// fp16 coefficients for uploading to shaders that use the L1_F16_RGB/L2_F16_RGB types. The
+// conversion should happen once the fp32 sum is complete, see SHAccumulator.
+template<uint64 N> struct ShaderSHColorF16
+{
+    Half4 Coefficients[N];
+
+    ShaderSHColorF16()
+    {
+    }
+
+    ShaderSHColorF16(const SH<Float3, N>& sh)
+    {
+        for(uint64 i = 0; i < N; ++i)
+            Coefficients[i] = Half4(Float4(sh.Coefficients[i], 0.0f));
+    }
+};
+
+// Channel-major storage for RGB SH coefficients. Each channel's coefficients are stored contiguously
+// and padded out to a multiple of 4 so that bakers can compute dot products and evaluate SH with SIMD
+// instead of doing scalar math on every Float3 coefficient.
+template<uint64 N> struct SHColorPlanar
+{
+    static const uint64 NumPadded = (N + 3) & ~3ull;
+
+    __declspec(align(16)) float Channels[3][NumPadded] = { };
+
+    SHColorPlanar()
+    {
+    }
+
+    SHColorPlanar(const SH<Float3, N>& sh)
+    {
+        for(uint64 i = 0; i < N; ++i)
+        {
+            Channels[0][i] = sh.Coefficients[i].x;
+            Channels[1][i] = sh.Coefficients[i].y;
+            Channels[2][i] = sh.Coefficients[i].z;
+        }
+    }
+
+    SH<Float3, N> ToSH() const
+    {
+        SH<Float3, N> result;
+        for(uint64 i = 0; i < N; ++i)
+            result.Coefficients[i] = Float3(Channels[0][i], Channels[1][i], Channels[2][i]);
+        return result;
+    }
+
+    SHColorPlanar& operator+=(const SHColorPlanar& other)
+    {
+        for(uint64 c = 0; c < 3; ++c)
+            for(uint64 i = 0; i < NumPadded; i += 4)
+                DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(&Channels[c][i]),
+                                        DirectX::XMVectorAdd(LoadChannel(c, i), other.LoadChannel(c, i)));
+        return *this;
+    }
+
+    SHColorPlanar& operator*=(float scale)
+    {
+        for(uint64 c = 0; c < 3; ++c)
+            for(uint64 i = 0; i < NumPadded; i += 4)
+                DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(&Channels[c][i]),
+                                        DirectX::XMVectorScale(LoadChannel(c, i), scale));
+        return *this;
+    }
+
+    // Per-channel dot product with another set of planar coefficients
+    static Float3 Dot(const SHColorPlanar& a, const SHColorPlanar& b)
+    {
+        float result[3] = { };
+        for(uint64 c = 0; c < 3; ++c)
+        {
+            DirectX::XMVECTOR sum = DirectX::XMVectorZero();
+            for(uint64 i = 0; i < NumPadded; i += 4)
+                sum = DirectX::XMVectorMultiplyAdd(a.LoadChannel(c, i), b.LoadChannel(c, i), sum);
+            result[c] = DirectX::XMVectorGetX(DirectX::XMVectorSum(sum));
+        }
+        return Float3(result[0], result[1], result[2]);
+    }
+
+    // Dot product of every channel with a single set of scalar coefficients, such as a projected direction
+    Float3 Dot(const SH<float, N>& weights) const
+    {
+        __declspec(align(16)) float paddedWeights[NumPadded] = { };
+        for(uint64 i = 0; i < N; ++i)
+            paddedWeights[i] = weights.Coefficients[i];
+
+        float result[3] = { };
+        for(uint64 c = 0; c < 3; ++c)
+        {
+            DirectX::XMVECTOR sum = DirectX::XMVectorZero();
+            for(uint64 i = 0; i < NumPadded; i += 4)
+                sum = DirectX::XMVectorMultiplyAdd(LoadChannel(c, i), DirectX::XMLoadFloat4A(reinterpret_cast<const DirectX::XMFLOAT4A*>(&paddedWeights[i])), sum);
+            result[c] = DirectX::XMVectorGetX(DirectX::XMVectorSum(sum));
+        }
+        return Float3(result[0], result[1], result[2]);
+    }
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        BulkSerializeArray(serializer, &Channels[0][0], 3 * NumPadded);
+    }
+
+protected:
+
+    DirectX::XMVECTOR LoadChannel(uint64 channel, uint64 idx) const
+    {
+        return DirectX::XMLoadFloat4A(reinterpret_cast<const DirectX::XMFLOAT4A*>(&Channels[channel][idx]));
+    }
+};
+
+typedef SHColorPlanar<4> SH4ColorPlanar;
+typedef SHColorPlanar<9> SH9ColorPlanar;
+
 SH9 ProjectOntoSH9(const Float3& dir);
 SH9Color ProjectOntoSH9Color(const Float3& dir, const Float3& color);
+
+// Gradient of ProjectOntoSH9Color with respect to moving the projection point, for a radiance sample that was found
+// by tracing a ray in the given direction and hitting a surface at hitDistance. Only the parallax of the hit point
+// is accounted for (the hit radiance and occlusion are assumed to stay the same), and misses with an infinite
+// hit distance contribute nothing. Scale and accumulate the results the same way as the projected samples.
+SH9ColorGradient ProjectOntoSH9ColorGradient(const Float3& dir, const Float3& color, float hitDistance);
+
+// Exact projection of a polygonal area light, with vertices relative to the shading point in either winding order
+SH9 ProjectPolygonOntoSH9(const Float3* vertices, uint64 numVertices);
+SH9Color ProjectPolygonOntoSH9Color(const Float3* vertices, uint64 numVertices, const Float3& radiance);
 Float3 EvalSH9Irradiance(const Float3& dir, const SH9Color& sh);
+Float3 EvalSH9Irradiance(const Float3& dir, const SH9ColorPlanar& sh);
+
+// Windowing functions for reducing ringing, returned as per-band scale factors for L0, L1, and L2
+Float3 HannWindowSH9(float width = 3.0f);
+Float3 LanczosWindowSH9(float width = 3.0f);
+Float3 DeringingWindowSH9(float strength);
+
+// Approximates a GGX lobe at normal incidence as zonal harmonics for bands 1 through 4 (band 0 is always 1),
+// using the fits from FitGGXZonalHarmonics
+float ApproximateGGXZH(float ggxAlpha, uint64 band);
 
-// H-basis functions
+// Finds the minimal strength for DeringingWindowSH9 that makes the irradiance from a probe non-negative in all directions
+float CalculateDeringingStrength(const SH9Color& radiance);
+
+// H-basis functions. Directions are in tangent space, with Z along the surface normal.
 H4 ProjectOntoH4(const Float3& dir);
+H6 ProjectOntoH6(const Float3& dir);
+H4Color ProjectOntoH4Color(const Float3& dir, const Float3& color);
+H6Color ProjectOntoH6Color(const Float3& dir, const Float3& color);
 float EvalH4(const H4& h, const Float3& dir);
+Float3 EvalH4(const H4Color& h, const Float3& dir);
+float EvalH6(const H6& h, const Float3& dir);
+Float3 EvalH6(const H6Color& h, const Float3& dir);
 H4 ConvertToH4(const SH9& sh);
+H4Color ConvertToH4(const SH9Color& sh);
+H6 ConvertToH6(const SH9& sh);
+H6Color ConvertToH6(const SH9Color& sh);
+
+// Lightmap encoders: converts per-texel tangent-space SH radiance to H-basis irradiance
+void EncodeH4Lightmap(const SH9Color* radiance, uint64 numTexels, H4Color* output);
+void EncodeH6Lightmap(const SH9Color* radiance, uint64 numTexels, H6Color* output);
 
 // Lighting environment generation functions
 SH9Color ProjectCubemapToSH(const Texture& texture);
 
+struct PolygonProjectionStats
+{
+    uint64 NumPolygons = 0;
+    uint64 NumMonteCarloSamples = 0;
+    uint64 NumReferenceSamples = 0;
+
+    // Average time per polygon
+    double AnalyticNanoseconds = 0.0;
+    double MonteCarloNanoseconds = 0.0;
+
+    // RMS of the coefficient error over all polygons, relative to the RMS of the reference coefficients
+    float AnalyticRelativeRMSError = 0.0f;
+    float MonteCarloRelativeRMSError = 0.0f;
+};
+
+// Compares ProjectPolygonOntoSH9 against Monte Carlo projection with numMonteCarloSamples random points on the
+// polygon's area, for random parallelograms around the origin. Both are measured against a reference computed from
+// numReferenceSamples Hammersley points on each polygon.
+PolygonProjectionStats CompareProjectPolygonOntoSH9(uint64 numPolygons = 1000, uint64 numMonteCarloSamples = 256,
+                                                    uint64 numReferenceSamples = 65536);
+std::string PolygonProjectionStatsToString(const PolygonProjectionStats& stats);
+
+struct SHMultiplyErrorStats
+{
+    uint64 NumTrials = 0;
+    uint64 NumQuadratureSamples = 0;
+
+    // Largest absolute coefficient error of SHMultiply against numerical integration of the product
+    float L1MaxError = 0.0f;
+    float L2MaxError = 0.0f;
+
+    // Largest absolute difference between SHMultiplyZonal and SHMultiply with the zonal function expanded to SH9
+    float ZonalMaxError = 0.0f;
+};
+
+// Validates SHMultiply and SHMultiplyZonal for random pairs of functions with coefficients in [-1, 1]. The reference
+// product is integrated on a lat-long grid with the given number of rings (and twice as many segments per ring),
+// and projected back onto the same bands.
+SHMultiplyErrorStats ValidateSHMultiply(uint64 numTrials = 32, uint64 numRings = 400);
+std::string SHMultiplyErrorStatsToString(const SHMultiplyErrorStats& stats);
+
 // Constants
 static const H4 H4Identity = H4(std::sqrt(2.0f * 3.14159f), 0.0f, 0.0f, 0.0f);
 
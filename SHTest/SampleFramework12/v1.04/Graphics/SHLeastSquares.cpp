@@ -0,0 +1,349 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "SHLeastSquares.h"
+#include "..\\Exceptions.h"
+#include "..\\Utility.h"
+
+namespace SampleFramework12
+{
+
+// Inverts a small dense matrix in place with Gauss-Jordan elimination and partial pivoting
+static bool InvertMatrix(double* matrix, uint64 size)
+{
+    Array<double> inverse(size * size, 0.0);
+    for(uint64 i = 0; i < size; ++i)
+        inverse[i * size + i] = 1.0;
+
+    for(uint64 col = 0; col < size; ++col)
+    {
+        uint64 pivot = col;
+        for(uint64 row = col + 1; row < size; ++row)
+            if(std::abs(matrix[row * size + col]) > std::abs(matrix[pivot * size + col]))
+                pivot = row;
+
+        if(std::abs(matrix[pivot * size + col]) < 1e-12)
+            return false;
+
+        if(pivot != col)
+        {
+            for(uint64 i = 0; i < size; ++i)
+            {
+                std::swap(matrix[pivot * size + i], matrix[col * size + i]);
+                std::swap(inverse[pivot * size + i], inverse[col * size + i]);
+            }
+        }
+
+        const double invPivot = 1.0 / matrix[col * size + col];
+        for(uint64 i = 0; i < size; ++i)
+        {
+            matrix[col * size + i] *= invPivot;
+            inverse[col * size + i] *= invPivot;
+        }
+
+        for(uint64 row = 0; row < size; ++row)
+        {
+            if(row == col)
+                continue;
+
+            const double factor = matrix[row * size + col];
+            for(uint64 i = 0; i < size; ++i)
+            {
+                matrix[row * size + i] -= factor * matrix[col * size + i];
+                inverse[row * size + i] -= factor * inverse[col * size + i];
+            }
+        }
+    }
+
+    memcpy(matrix, inverse.Data(), size * size * sizeof(double));
+    return true;
+}
+
+void BuildSHLeastSquaresPattern(const Float3* directions, uint64 numDirections, uint64 numCoefficients, float lambda,
+                                SHLeastSquaresPattern& pattern)
+{
+    Assert_(directions != nullptr && numDirections > 0);
+    Assert_(numCoefficients == 4 || numCoefficients == 9);
+    Assert_(lambda >= 0.0f);
+    lambda = Max(lambda, SHLeastSquaresMinLambda);
+
+    const uint64 M = numCoefficients;
+    const uint64 K = numDirections;
+    const double sampleWeight = 4.0 * double(Pi) / double(K);
+
+    // Basis functions evaluated for each direction, K x M
+    Array<double> basis(K * M);
+    for(uint64 k = 0; k < K; ++k)
+    {
+        const SH9 sh = ProjectOntoSH9(directions[k]);
+        for(uint64 i = 0; i < M; ++i)
+            basis[k * M + i] = sh.Coefficients[i];
+    }
+
+    Array<double> normalMatrix(M * M, 0.0);
+    for(uint64 i = 0; i < M; ++i)
+    {
+        for(uint64 j = 0; j < M; ++j)
+        {
+            double sum = 0.0;
+            for(uint64 k = 0; k < K; ++k)
+                sum += basis[k * M + i] * basis[k * M + j];
+            normalMatrix[i * M + j] = sum * sampleWeight;
+        }
+
+        normalMatrix[i * M + i] += lambda;
+    }
+
+    if(InvertMatrix(normalMatrix.Data(), M) == false)
+        throw Exception(L"The least-squares system for the SH ray pattern is singular");
+
+    pattern.NumDirections = K;
+    pattern.NumCoefficients = M;
+    pattern.Lambda = lambda;
+    pattern.Projection.Init(M * K);
+    pattern.Prior.Init(M * M);
+
+    for(uint64 i = 0; i < M; ++i)
+    {
+        for(uint64 k = 0; k < K; ++k)
+        {
+            double sum = 0.0;
+            for(uint64 j = 0; j < M; ++j)
+                sum += normalMatrix[i * M + j] * basis[k * M + j];
+            pattern.Projection[i * K + k] = float(sum * sampleWeight);
+        }
+
+        for(uint64 j = 0; j < M; ++j)
+            pattern.Prior[i * M + j] = float(normalMatrix[i * M + j] * lambda);
+    }
+}
+
+void PackSHLeastSquaresPatterns(const SHLeastSquaresPattern* patterns, uint64 numPatterns, Array<float>& output)
+{
+    Assert_(patterns != nullptr && numPatterns > 0);
+
+    const uint64 patternSize = patterns[0].Projection.Size() + patterns[0].Prior.Size();
+    output.Init(patternSize * numPatterns);
+
+    float* dst = output.Data();
+    for(uint64 p = 0; p < numPatterns; ++p)
+    {
+        Assert_(patterns[p].NumDirections == patterns[0].NumDirections && patterns[p].NumCoefficients == patterns[0].NumCoefficients);
+
+        memcpy(dst, patterns[p].Projection.Data(), patterns[p].Projection.MemorySize());
+        dst += patterns[p].Projection.Size();
+        memcpy(dst, patterns[p].Prior.Data(), patterns[p].Prior.MemorySize());
+        dst += patterns[p].Prior.Size();
+    }
+}
+
+template<uint64 N> static SH<Float3, N> ApplyPattern(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH<Float3, N>& prevSH)
+{
+    Assert_(pattern.NumCoefficients == N);
+
+    const uint64 K = pattern.NumDirections;
+    SH<Float3, N> result;
+    for(uint64 i = 0; i < N; ++i)
+    {
+        Float3 sum;
+        for(uint64 k = 0; k < K; ++k)
+            sum += samples[k] * pattern.Projection[i * K + k];
+        for(uint64 j = 0; j < N; ++j)
+            sum += prevSH.Coefficients[j] * pattern.Prior[i * N + j];
+        result.Coefficients[i] = sum;
+    }
+
+    return result;
+}
+
+template<uint64 N> static void ApplyPatternBatch(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH<Float3, N>* prevSH,
+                                                 uint64 numProbes, SH<Float3, N>* output)
+{
+    using namespace DirectX;
+
+    Assert_(pattern.NumCoefficients == N);
+    Assert_(samples != nullptr && prevSH != nullptr && output != nullptr);
+
+    const uint64 K = pattern.NumDirections;
+
+    // SoA samples for 4 probes: [sample][channel]
+    Array<XMVECTOR> soaSamples(K * 3);
+    XMVECTOR soaPrev[N * 3];
+
+    uint64 probeIdx = 0;
+    for(; probeIdx + 4 <= numProbes; probeIdx += 4)
+    {
+        const Float3* probeSamples[4] = { samples + probeIdx * K, samples + (probeIdx + 1) * K,
+                                          samples + (probeIdx + 2) * K, samples + (probeIdx + 3) * K };
+        for(uint64 k = 0; k < K; ++k)
+        {
+            soaSamples[k * 3 + 0] = XMVectorSet(probeSamples[0][k].x, probeSamples[1][k].x, probeSamples[2][k].x, probeSamples[3][k].x);
+            soaSamples[k * 3 + 1] = XMVectorSet(probeSamples[0][k].y, probeSamples[1][k].y, probeSamples[2][k].y, probeSamples[3][k].y);
+            soaSamples[k * 3 + 2] = XMVectorSet(probeSamples[0][k].z, probeSamples[1][k].z, probeSamples[2][k].z, probeSamples[3][k].z);
+        }
+
+        const SH<Float3, N>* prev = prevSH + probeIdx;
+        for(uint64 j = 0; j < N; ++j)
+        {
+            soaPrev[j * 3 + 0] = XMVectorSet(prev[0][j].x, prev[1][j].x, prev[2][j].x, prev[3][j].x);
+            soaPrev[j * 3 + 1] = XMVectorSet(prev[0][j].y, prev[1][j].y, prev[2][j].y, prev[3][j].y);
+            soaPrev[j * 3 + 2] = XMVectorSet(prev[0][j].z, prev[1][j].z, prev[2][j].z, prev[3][j].z);
+        }
+
+        for(uint64 i = 0; i < N; ++i)
+        {
+            XMVECTOR sumR = XMVectorZero();
+            XMVECTOR sumG = XMVectorZero();
+            XMVECTOR sumB = XMVectorZero();
+
+            const float* projectionRow = &pattern.Projection[i * K];
+            for(uint64 k = 0; k < K; ++k)
+            {
+                const XMVECTOR weight = XMVectorReplicate(projectionRow[k]);
+                sumR = XMVectorMultiplyAdd(soaSamples[k * 3 + 0], weight, sumR);
+                sumG = XMVectorMultiplyAdd(soaSamples[k * 3 + 1], weight, sumG);
+                sumB = XMVectorMultiplyAdd(soaSamples[k * 3 + 2], weight, sumB);
+            }
+
+            const float* priorRow = &pattern.Prior[i * N];
+            for(uint64 j = 0; j < N; ++j)
+            {
+                const XMVECTOR weight = XMVectorReplicate(priorRow[j]);
+                sumR = XMVectorMultiplyAdd(soaPrev[j * 3 + 0], weight, sumR);
+                sumG = XMVectorMultiplyAdd(soaPrev[j * 3 + 1], weight, sumG);
+                sumB = XMVectorMultiplyAdd(soaPrev[j * 3 + 2], weight, sumB);
+            }
+
+            __declspec(align(16)) float r[4];
+            __declspec(align(16)) float g[4];
+            __declspec(align(16)) float b[4];
+            XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(r), sumR);
+            XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(g), sumG);
+            XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(b), sumB);
+            for(uint64 p = 0; p < 4; ++p)
+                output[probeIdx + p].Coefficients[i] = Float3(r[p], g[p], b[p]);
+        }
+    }
+
+    for(; probeIdx < numProbes; ++probeIdx)
+        output[probeIdx] = ApplyPattern(pattern, samples + probeIdx * K, prevSH[probeIdx]);
+}
+
+SH4Color LeastSquaresProjectL1(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH4Color& prevSH)
+{
+    return ApplyPattern(pattern, samples, prevSH);
+}
+
+SH9Color LeastSquaresProjectL2(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH9Color& prevSH)
+{
+    return ApplyPattern(pattern, samples, prevSH);
+}
+
+void LeastSquaresProjectL1(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH4Color* prevSH,
+                           uint64 numProbes, SH4Color* output)
+{
+    ApplyPatternBatch(pattern, samples, prevSH, numProbes, output);
+}
+
+void LeastSquaresProjectL2(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH9Color* prevSH,
+                           uint64 numProbes, SH9Color* output)
+{
+    ApplyPatternBatch(pattern, samples, prevSH, numProbes, output);
+}
+
+static float RelativeError(const SH9Color& sh, const SH9Color& expected)
+{
+    const SH9Color diff = sh - expected;
+    const Float3 diffSq = SH9Color::Dot(diff, diff);
+    const Float3 expectedSq = SH9Color::Dot(expected, expected);
+    return std::sqrt((diffSq.x + diffSq.y + diffSq.z) / (expectedSq.x + expectedSq.y + expectedSq.z));
+}
+
+SHLeastSquaresErrorStats CompareSHLeastSquaresProjection(uint64 numDirections, float lambda, uint64 numTrials)
+{
+    Assert_(numDirections > 0 && numTrials > 0);
+
+    const uint64 K = numDirections;
+    Array<Float3> directions(K);
+    for(uint64 k = 0; k < K; ++k)
+    {
+        const float z = 1.0f - (2.0f * k + 1.0f) / K;
+        const float r = std::sqrt(Max(1.0f - z * z, 0.0f));
+        const float phi = k * Pi * (3.0f - std::sqrt(5.0f));
+        directions[k] = Float3(r * std::cos(phi), r * std::sin(phi), z);
+    }
+
+    SHLeastSquaresPattern pattern;
+    BuildSHLeastSquaresPattern(directions.Data(), K, 9, lambda, pattern);
+
+    // Random lighting with a positive L0 term, sampled along each direction
+    Random random;
+    Array<SH9Color> lighting(numTrials);
+    Array<Float3> samples(numTrials * K);
+    for(uint64 trialIdx = 0; trialIdx < numTrials; ++trialIdx)
+    {
+        SH9Color& sh = lighting[trialIdx];
+        sh.Coefficients[0] = Float3(1.0f + random.RandomFloat(), 1.0f + random.RandomFloat(), 1.0f + random.RandomFloat());
+        for(uint64 i = 1; i < 9; ++i)
+            sh.Coefficients[i] = Float3(random.RandomFloat(), random.RandomFloat(), random.RandomFloat()) * 2.0f - 1.0f;
+
+        for(uint64 k = 0; k < K; ++k)
+        {
+            const SH9 directionSH = ProjectOntoSH9(directions[k]);
+            Float3 sample;
+            for(uint64 i = 0; i < 9; ++i)
+                sample += sh.Coefficients[i] * directionSH.Coefficients[i];
+            samples[trialIdx * K + k] = sample;
+        }
+    }
+
+    Array<SH9Color> prevSH(numTrials);
+    Array<SH9Color> leastSquares(numTrials);
+    LeastSquaresProjectL2(pattern, samples.Data(), prevSH.Data(), numTrials, leastSquares.Data());
+
+    SHLeastSquaresErrorStats stats;
+    stats.NumDirections = K;
+    stats.NumTrials = numTrials;
+    stats.Lambda = lambda;
+
+    double leastSquaresErrorSum = 0.0;
+    double monteCarloErrorSum = 0.0;
+    for(uint64 trialIdx = 0; trialIdx < numTrials; ++trialIdx)
+    {
+        SH9Color monteCarlo;
+        for(uint64 k = 0; k < K; ++k)
+            monteCarlo += ProjectOntoSH9Color(directions[k], samples[trialIdx * K + k]);
+        monteCarlo *= 4.0f * Pi / K;
+
+        const float leastSquaresError = RelativeError(leastSquares[trialIdx], lighting[trialIdx]);
+        leastSquaresErrorSum += leastSquaresError;
+        stats.LeastSquaresMaxError = Max(stats.LeastSquaresMaxError, leastSquaresError);
+
+        const float monteCarloError = RelativeError(monteCarlo, lighting[trialIdx]);
+        monteCarloErrorSum += monteCarloError;
+        stats.MonteCarloMaxError = Max(stats.MonteCarloMaxError, monteCarloError);
+    }
+
+    stats.LeastSquaresAvgError = float(leastSquaresErrorSum / double(numTrials));
+    stats.MonteCarloAvgError = float(monteCarloErrorSum / double(numTrials));
+
+    return stats;
+}
+
+std::string SHLeastSquaresErrorStatsToString(const SHLeastSquaresErrorStats& stats)
+{
+    return MakeString("SH least-squares projection: %llu directions, lambda %.3f, %llu random L2 lighting environments\n"
+                      "Least-squares relative error: avg %e, max %e\n"
+                      "Monte Carlo relative error: avg %e, max %e\n",
+                      stats.NumDirections, stats.Lambda, stats.NumTrials,
+                      stats.LeastSquaresAvgError, stats.LeastSquaresMaxError, stats.MonteCarloAvgError, stats.MonteCarloMaxError);
+}
+
+}
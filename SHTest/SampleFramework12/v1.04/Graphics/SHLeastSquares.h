@@ -0,0 +1,96 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\Containers.h"
+#include "..\\Serialization.h"
+#include "SH.h"
+
+namespace SampleFramework12
+{
+
+// Precomputed regularized least-squares projection for a fixed set of ray directions. The projection minimizes
+//
+//   (4 * Pi / K) * sum_k (Evaluate(sh, directions[k]) - samples[k])^2 + lambda * |sh - prevSH|^2
+//
+// which for K directions and M coefficients has the solution sh = Projection * samples + Prior * prevSH, where
+// Projection = (4 * Pi / K) * inverse(N) * B^T, Prior = lambda * inverse(N), B is the K x M matrix of basis
+// functions evaluated for each direction and N = (4 * Pi / K) * B^T * B + lambda * I. This matches
+// SH::LeastSquaresProjectL1/L2 from SH.hlsli, which can either solve the system directly or use these matrices.
+// Both clamp lambda to SHLeastSquaresMinLambda, so that the system stays invertible with fewer directions than
+// coefficients and both paths give the same answer for the same inputs.
+static const float SHLeastSquaresMinLambda = 1e-4f;
+
+struct SHLeastSquaresPattern
+{
+    uint64 NumDirections = 0;
+    uint64 NumCoefficients = 0;
+    float Lambda = 0.0f;
+
+    // Row-major, NumCoefficients x NumDirections
+    Array<float> Projection;
+
+    // Row-major, NumCoefficients x NumCoefficients
+    Array<float> Prior;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        SerializeItem(serializer, NumDirections);
+        SerializeItem(serializer, NumCoefficients);
+        SerializeItem(serializer, Lambda);
+        BulkSerializeItem(serializer, Projection);
+        BulkSerializeItem(serializer, Prior);
+    }
+};
+
+// numCoefficients is 4 for L1 and 9 for L2. Lambda is clamped to SHLeastSquaresMinLambda, and the clamped value is
+// stored in the pattern.
+void BuildSHLeastSquaresPattern(const Float3* directions, uint64 numDirections, uint64 numCoefficients, float lambda,
+                                SHLeastSquaresPattern& pattern);
+
+// Concatenates the matrices of one or more patterns with the same direction and coefficient counts, in the layout
+// expected by the StructuredBuffer versions of SH::LeastSquaresProjectL1/L2. The shader addresses a pattern as
+// patternIdx * (M * K + M * M), so L1 and L2 patterns need separate buffers.
+void PackSHLeastSquaresPatterns(const SHLeastSquaresPattern* patterns, uint64 numPatterns, Array<float>& output);
+
+SH4Color LeastSquaresProjectL1(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH4Color& prevSH);
+SH9Color LeastSquaresProjectL2(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH9Color& prevSH);
+
+// Batch versions for updating many probes that share a pattern. Samples are probe-major (NumDirections samples
+// for each probe), and 4 probes are projected at a time with their samples and coefficients in SoA form.
+void LeastSquaresProjectL1(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH4Color* prevSH,
+                           uint64 numProbes, SH4Color* output);
+void LeastSquaresProjectL2(const SHLeastSquaresPattern& pattern, const Float3* samples, const SH9Color* prevSH,
+                           uint64 numProbes, SH9Color* output);
+
+struct SHLeastSquaresErrorStats
+{
+    uint64 NumDirections = 0;
+    uint64 NumTrials = 0;
+    float Lambda = 0.0f;
+
+    // L2 norm of the coefficient difference from the exact L2 lighting, relative to the norm of that lighting
+    float LeastSquaresAvgError = 0.0f;
+    float LeastSquaresMaxError = 0.0f;
+    float MonteCarloAvgError = 0.0f;
+    float MonteCarloMaxError = 0.0f;
+};
+
+// Measures how well numDirections samples on a Fibonacci sphere recover random band-limited L2 lighting, with the
+// batched LeastSquaresProjectL2 (and a previous SH of 0) versus Monte Carlo projection of the same samples.
+// Since the lighting is band-limited, a lambda of 0 (clamped to SHLeastSquaresMinLambda) recovers it almost exactly
+// once there are enough directions.
+SHLeastSquaresErrorStats CompareSHLeastSquaresProjection(uint64 numDirections, float lambda, uint64 numTrials = 256);
+std::string SHLeastSquaresErrorStatsToString(const SHLeastSquaresErrorStats& stats);
+
+}
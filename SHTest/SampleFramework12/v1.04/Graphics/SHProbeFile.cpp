@@ -0,0 +1,508 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#include "PCH.h"
+#include "SHProbeFile.h"
+#include "..\\Utility.h"
+#include "..\\Exceptions.h"
+#include "..\\FileIO.h"
+#include "..\\Serialization.h"
+#include "..\\Timer.h"
+
+namespace SampleFramework12
+{
+
+static_assert(sizeof(SHProbeFileHeader) % 8 == 0, "The tables following the header need to stay 8-byte aligned");
+
+uint64 SHProbeLODNumCoefficients(SHProbeLOD lod)
+{
+    static const uint64 NumCoefficients[] = { 9, 4, 1 };
+    StaticAssert_(ArraySize_(NumCoefficients) == uint64(SHProbeLOD::NumValues));
+    Assert_(lod < SHProbeLOD::NumValues);
+    return NumCoefficients[uint64(lod)];
+}
+
+static uint64 ChunkSize(uint64 numProbes, SHProbeLOD lod, SHProbeEncoding encoding)
+{
+    const uint64 bytesPerFloat = encoding == SHProbeEncoding::Float16 ? sizeof(uint16) : sizeof(float);
+    return numProbes * SHProbeLODNumCoefficients(lod) * 3 * bytesPerFloat;
+}
+
+// Returns true if [offset, offset + size) lies within a file of the given size, without overflowing
+static bool RangeInFile(uint64 offset, uint64 size, uint64 fileSize)
+{
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+// GenerateHash takes a 32-bit length, so large chunks are hashed in pieces
+static Hash ChecksumData(const void* data, uint64 size)
+{
+    static const uint64 PieceSize = 1024 * 1024 * 1024;
+
+    const uint8* bytes = reinterpret_cast<const uint8*>(data);
+    Hash hash = GenerateHash(bytes, int32(Min(size, PieceSize)));
+    for(uint64 offset = PieceSize; offset < size; offset += PieceSize)
+        hash = CombineHashes(hash, GenerateHash(bytes + offset, int32(Min(size - offset, PieceSize))));
+
+    return hash;
+}
+
+// Writes ChunkSize(region.NumProbes, lod, encoding) bytes to output
+static void EncodeChunk(const SHProbeRegionData& region, SHProbeLOD lod, SHProbeEncoding encoding, uint8* output)
+{
+    const uint64 numCoefficients = SHProbeLODNumCoefficients(lod);
+    const uint64 numFloats = region.NumProbes * numCoefficients * 3;
+
+    Array<float> floats(numFloats);
+    for(uint64 probeIdx = 0; probeIdx < region.NumProbes; ++probeIdx)
+        memcpy(&floats[probeIdx * numCoefficients * 3], &region.Probes[probeIdx].Coefficients[0], numCoefficients * sizeof(Float3));
+
+    if(encoding == SHProbeEncoding::Float16)
+        DirectX::PackedVector::XMConvertFloatToHalfStream(reinterpret_cast<DirectX::PackedVector::HALF*>(output), sizeof(uint16),
+                                                          floats.Data(), sizeof(float), numFloats);
+    else
+        memcpy(output, floats.Data(), floats.MemorySize());
+}
+
+void WriteSHProbeFile(const wchar* filePath, const SHProbeRegionData* regions, uint64 numRegions,
+                      SHProbeEncoding encoding, uint32 numLODs)
+{
+    Assert_(regions != nullptr && numRegions > 0 && numRegions <= UINT32_MAX);
+    Assert_(numLODs > 0 && numLODs <= uint32(SHProbeLOD::NumValues));
+
+    SHProbeFileHeader header;
+    header.NumRegions = uint32(numRegions);
+    header.NumChunks = uint32(numRegions * numLODs);
+    header.RegionTableOffset = sizeof(SHProbeFileHeader);
+    header.ChunkTableOffset = AlignTo(header.RegionTableOffset + numRegions * sizeof(SHProbeRegionDesc), uint64(alignof(SHProbeChunkDesc)));
+
+    Array<SHProbeRegionDesc> regionDescs(numRegions);
+    Array<SHProbeChunkDesc> chunkDescs(header.NumChunks);
+
+    // Lay out the chunks first, since their sizes only depend on the probe counts
+    uint64 offset = AlignTo(header.ChunkTableOffset + chunkDescs.MemorySize(), SHProbeChunkAlignment);
+    for(uint64 regionIdx = 0; regionIdx < numRegions; ++regionIdx)
+    {
+        const SHProbeRegionData& region = regions[regionIdx];
+        Assert_(region.NumProbes <= UINT32_MAX);
+
+        SHProbeRegionDesc& regionDesc = regionDescs[regionIdx];
+        regionDesc.BoundsMin = region.BoundsMin;
+        regionDesc.BoundsMax = region.BoundsMax;
+        regionDesc.NumProbes = uint32(region.NumProbes);
+        regionDesc.FirstChunk = uint32(regionIdx * numLODs);
+        regionDesc.NumChunks = numLODs;
+
+        for(uint32 lodIdx = 0; lodIdx < numLODs; ++lodIdx)
+        {
+            SHProbeChunkDesc& chunkDesc = chunkDescs[regionDesc.FirstChunk + lodIdx];
+            chunkDesc.RegionIdx = uint32(regionIdx);
+            chunkDesc.LOD = SHProbeLOD(lodIdx);
+            chunkDesc.Encoding = encoding;
+            chunkDesc.NumProbes = uint32(region.NumProbes);
+            chunkDesc.Offset = offset;
+            chunkDesc.Size = ChunkSize(region.NumProbes, chunkDesc.LOD, encoding);
+
+            offset = AlignTo(offset + chunkDesc.Size, SHProbeChunkAlignment);
+        }
+    }
+
+    header.FileSize = offset;
+
+    // Encode each chunk once, straight into its place in the file, and checksum it there. The tables
+    // are copied in last since they include the chunk checksums.
+    Array<uint8> fileData(header.FileSize, 0);
+    for(uint64 chunkIdx = 0; chunkIdx < chunkDescs.Size(); ++chunkIdx)
+    {
+        SHProbeChunkDesc& chunkDesc = chunkDescs[chunkIdx];
+        uint8* chunkData = fileData.Data() + chunkDesc.Offset;
+        EncodeChunk(regions[chunkDesc.RegionIdx], chunkDesc.LOD, encoding, chunkData);
+        chunkDesc.Checksum = ChecksumData(chunkData, chunkDesc.Size);
+    }
+
+    header.TableChecksum = CombineHashes(ChecksumData(regionDescs.Data(), regionDescs.MemorySize()),
+                                         ChecksumData(chunkDescs.Data(), chunkDescs.MemorySize()));
+
+    memcpy(&fileData[0], &header, sizeof(SHProbeFileHeader));
+    memcpy(&fileData[header.RegionTableOffset], regionDescs.Data(), regionDescs.MemorySize());
+    memcpy(&fileData[header.ChunkTableOffset], chunkDescs.Data(), chunkDescs.MemorySize());
+
+    WriteFileAsByteArray(filePath, fileData);
+}
+
+// == SHProbeFile =================================================================================
+
+SHProbeFile::~SHProbeFile()
+{
+    Close();
+}
+
+void SHProbeFile::Open(const wchar* filePath)
+{
+    Assert_(IsOpen() == false);
+
+    fileHandle = CreateFile(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+    {
+        std::wstring errPrefix = std::wstring(L"Failed to open file ") + filePath + L":\n";
+        throw Win32Exception(GetLastError(), errPrefix.c_str());
+    }
+
+    LARGE_INTEGER size;
+    Win32Call(GetFileSizeEx(fileHandle, &size));
+    fileSize = size.QuadPart;
+
+    mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mappingHandle == nullptr)
+    {
+        std::wstring errPrefix = std::wstring(L"Failed to map file ") + filePath + L":\n";
+        const DWORD errorCode = GetLastError();
+        Close();
+        throw Win32Exception(errorCode, errPrefix.c_str());
+    }
+
+    mappedData = reinterpret_cast<const uint8*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if(mappedData == nullptr)
+    {
+        std::wstring errPrefix = std::wstring(L"Failed to map file ") + filePath + L":\n";
+        const DWORD errorCode = GetLastError();
+        Close();
+        throw Win32Exception(errorCode, errPrefix.c_str());
+    }
+
+    std::wstring error;
+    const SHProbeFileHeader& header = Header();
+    if(fileSize < sizeof(SHProbeFileHeader) || header.Magic != SHProbeFileMagic)
+        error = L"not a .shprobe file";
+    else if(header.Version != SHProbeFileVersion)
+        error = MakeString(L"unsupported version %u (expected %u)", header.Version, SHProbeFileVersion);
+    else if(header.FileSize != fileSize ||
+            RangeInFile(header.ChunkTableOffset, uint64(header.NumChunks) * sizeof(SHProbeChunkDesc), fileSize) == false ||
+            RangeInFile(header.RegionTableOffset, uint64(header.NumRegions) * sizeof(SHProbeRegionDesc), fileSize) == false)
+        error = L"the file is truncated";
+    else if(header.RegionTableOffset % alignof(SHProbeRegionDesc) != 0 || header.ChunkTableOffset % alignof(SHProbeChunkDesc) != 0)
+        error = L"the region and chunk tables are misaligned";
+    else
+    {
+        const Hash tableChecksum = CombineHashes(ChecksumData(mappedData + header.RegionTableOffset, header.NumRegions * sizeof(SHProbeRegionDesc)),
+                                                 ChecksumData(mappedData + header.ChunkTableOffset, header.NumChunks * sizeof(SHProbeChunkDesc)));
+        if(!(tableChecksum == header.TableChecksum))
+            error = L"the region and chunk tables are corrupted";
+    }
+
+    // The checksum only catches accidental corruption, so the table entries are also checked against the
+    // file before any of them are used to index into the mapping
+    if(error.length() == 0)
+    {
+        const SHProbeRegionDesc* regionDescs = reinterpret_cast<const SHProbeRegionDesc*>(mappedData + header.RegionTableOffset);
+        for(uint64 regionIdx = 0; regionIdx < header.NumRegions && error.length() == 0; ++regionIdx)
+        {
+            const SHProbeRegionDesc& region = regionDescs[regionIdx];
+            if(region.NumChunks > uint32(SHProbeLOD::NumValues) || uint64(region.FirstChunk) + region.NumChunks > header.NumChunks)
+                error = MakeString(L"region %llu references chunks outside of the chunk table", regionIdx);
+        }
+
+        const SHProbeChunkDesc* chunkDescs = reinterpret_cast<const SHProbeChunkDesc*>(mappedData + header.ChunkTableOffset);
+        for(uint64 chunkIdx = 0; chunkIdx < header.NumChunks && error.length() == 0; ++chunkIdx)
+        {
+            const SHProbeChunkDesc& chunk = chunkDescs[chunkIdx];
+            if(chunk.RegionIdx >= header.NumRegions || chunk.LOD >= SHProbeLOD::NumValues ||
+               (chunk.Encoding != SHProbeEncoding::Float32 && chunk.Encoding != SHProbeEncoding::Float16))
+                error = MakeString(L"chunk %llu has an invalid region, LOD or encoding", chunkIdx);
+            else if(chunk.Offset % SHProbeChunkAlignment != 0 || chunk.Size != ChunkSize(chunk.NumProbes, chunk.LOD, chunk.Encoding))
+                error = MakeString(L"chunk %llu has an invalid offset or size", chunkIdx);
+            else if(RangeInFile(chunk.Offset, chunk.Size, fileSize) == false)
+                error = MakeString(L"chunk %llu extends past the end of the file", chunkIdx);
+        }
+    }
+
+    if(error.length() > 0)
+    {
+        Close();
+        throw Exception(MakeString(L"Failed to load probe file %ls: %ls", filePath, error.c_str()));
+    }
+}
+
+void SHProbeFile::Close()
+{
+    if(mappedData != nullptr)
+        UnmapViewOfFile(mappedData);
+    if(mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if(fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+
+    mappedData = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+    fileSize = 0;
+}
+
+const SHProbeFileHeader& SHProbeFile::Header() const
+{
+    Assert_(IsOpen());
+    return *reinterpret_cast<const SHProbeFileHeader*>(mappedData);
+}
+
+const SHProbeRegionDesc& SHProbeFile::Region(uint64 regionIdx) const
+{
+    Assert_(regionIdx < NumRegions());
+    return reinterpret_cast<const SHProbeRegionDesc*>(mappedData + Header().RegionTableOffset)[regionIdx];
+}
+
+const SHProbeChunkDesc* SHProbeFile::FindChunk(uint64 regionIdx, SHProbeLOD lod) const
+{
+    const SHProbeRegionDesc& region = Region(regionIdx);
+    const SHProbeChunkDesc* chunks = reinterpret_cast<const SHProbeChunkDesc*>(mappedData + Header().ChunkTableOffset);
+    for(uint64 i = 0; i < region.NumChunks; ++i)
+    {
+        const SHProbeChunkDesc& chunk = chunks[region.FirstChunk + i];
+        if(chunk.LOD == lod)
+            return &chunk;
+    }
+
+    return nullptr;
+}
+
+const void* SHProbeFile::ChunkData(const SHProbeChunkDesc& chunk) const
+{
+    Assert_(IsOpen());
+    Assert_(chunk.Offset + chunk.Size <= fileSize);
+    return mappedData + chunk.Offset;
+}
+
+const SH9Color* SHProbeFile::L2Probes(uint64 regionIdx) const
+{
+    const SHProbeChunkDesc* chunk = FindChunk(regionIdx, SHProbeLOD::L2);
+    if(chunk == nullptr || chunk->Encoding != SHProbeEncoding::Float32)
+        return nullptr;
+
+    return reinterpret_cast<const SH9Color*>(ChunkData(*chunk));
+}
+
+bool SHProbeFile::ValidateChunk(const SHProbeChunkDesc& chunk) const
+{
+    return ChecksumData(ChunkData(chunk), chunk.Size) == chunk.Checksum;
+}
+
+void SHProbeFile::DecodeChunk(const SHProbeChunkDesc& chunk, SH9Color* output) const
+{
+    const uint64 numCoefficients = SHProbeLODNumCoefficients(chunk.LOD);
+    const uint64 numFloats = chunk.NumProbes * numCoefficients * 3;
+    const void* data = ChunkData(chunk);
+
+    Array<float> converted;
+    const float* floats = reinterpret_cast<const float*>(data);
+    if(chunk.Encoding == SHProbeEncoding::Float16)
+    {
+        converted.Init(numFloats);
+        DirectX::PackedVector::XMConvertHalfToFloatStream(converted.Data(), sizeof(float), reinterpret_cast<const DirectX::PackedVector::HALF*>(data),
+                                                          sizeof(uint16), numFloats);
+        floats = converted.Data();
+    }
+
+    for(uint64 probeIdx = 0; probeIdx < chunk.NumProbes; ++probeIdx)
+    {
+        output[probeIdx] = SH9Color();
+        memcpy(&output[probeIdx].Coefficients[0], floats + probeIdx * numCoefficients * 3, numCoefficients * sizeof(Float3));
+    }
+}
+
+// == Benchmark ===================================================================================
+
+struct SerializedProbes
+{
+    Array<SH9Color> Probes;
+
+    template<typename TSerializer>
+    void Serialize(TSerializer& serializer)
+    {
+        BulkSerializeItem(serializer, Probes);
+    }
+};
+
+static double TimeMappedLoad(const wchar* filePath, double& checksum)
+{
+    Timer timer;
+
+    SHProbeFile probeFile;
+    probeFile.Open(filePath);
+    const SH9Color* probes = probeFile.L2Probes(0);
+    const uint64 numProbes = probeFile.Region(0).NumProbes;
+
+    // Touch every probe so that all pages are faulted in
+    for(uint64 i = 0; i < numProbes; ++i)
+        checksum += probes[i].Coefficients[0].x + probes[i].Coefficients[8].z;
+
+    timer.Update();
+    return timer.ElapsedMillisecondsD();
+}
+
+static double TimeSerializerLoad(const wchar* filePath, double& checksum)
+{
+    Timer timer;
+
+    SerializedProbes serialized;
+    FileReadSerializer serializer(filePath);
+    SerializeItem(serializer, serialized);
+
+    for(uint64 i = 0; i < serialized.Probes.Size(); ++i)
+        checksum += serialized.Probes[i].Coefficients[0].x + serialized.Probes[i].Coefficients[8].z;
+
+    timer.Update();
+    return timer.ElapsedMillisecondsD();
+}
+
+// Reads a whole file through a handle opened with FILE_FLAG_NO_BUFFERING, which bypasses the OS file cache
+// so that the data comes from the disk even if the file was just written. Unbuffered reads need a sector-aligned
+// buffer and sizes, so the buffer is allocated with VirtualAlloc and read in 1 MB blocks. Free with VirtualFree.
+static void ReadFileUnbuffered(const wchar* filePath, uint8*& data, uint64& fileSize)
+{
+    static const uint64 BlockSize = 1024 * 1024;
+
+    HANDLE fileHandle = CreateFile(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                   FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+    {
+        std::wstring errPrefix = std::wstring(L"Failed to open file ") + filePath + L":\n";
+        throw Win32Exception(GetLastError(), errPrefix.c_str());
+    }
+
+    LARGE_INTEGER size;
+    Win32Call(GetFileSizeEx(fileHandle, &size));
+    fileSize = size.QuadPart;
+
+    data = reinterpret_cast<uint8*>(VirtualAlloc(nullptr, AlignTo(fileSize, BlockSize), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    if(data == nullptr)
+    {
+        const DWORD errorCode = GetLastError();
+        CloseHandle(fileHandle);
+        throw Win32Exception(errorCode, L"Failed to allocate the unbuffered read buffer:\n");
+    }
+
+    for(uint64 offset = 0; offset < fileSize; offset += BlockSize)
+    {
+        DWORD bytesRead = 0;
+        if(ReadFile(fileHandle, data + offset, DWORD(BlockSize), &bytesRead, nullptr) == false)
+        {
+            const DWORD errorCode = GetLastError();
+            CloseHandle(fileHandle);
+            VirtualFree(data, 0, MEM_RELEASE);
+            throw Win32Exception(errorCode, L"Failed to read the probe benchmark file:\n");
+        }
+    }
+
+    CloseHandle(fileHandle);
+}
+
+// The serialized file is the probe count followed by the probes, as written by BulkSerializeItem
+static double TimeColdSerializerLoad(const wchar* filePath, double& checksum)
+{
+    Timer timer;
+
+    uint8* data = nullptr;
+    uint64 fileSize = 0;
+    ReadFileUnbuffered(filePath, data, fileSize);
+
+    const uint64 numProbes = *reinterpret_cast<const uint64*>(data);
+    Assert_(fileSize >= sizeof(uint64) + numProbes * sizeof(SH9Color));
+
+    SerializedProbes serialized;
+    serialized.Probes.Init(numProbes);
+    memcpy(serialized.Probes.Data(), data + sizeof(uint64), serialized.Probes.MemorySize());
+    VirtualFree(data, 0, MEM_RELEASE);
+
+    for(uint64 i = 0; i < serialized.Probes.Size(); ++i)
+        checksum += serialized.Probes[i].Coefficients[0].x + serialized.Probes[i].Coefficients[8].z;
+
+    timer.Update();
+    return timer.ElapsedMillisecondsD();
+}
+
+// Reads the whole .shprobe file from disk and touches the probes of its first chunk in place, which is the data
+// that a mapped load has to fault in when none of the file is cached
+static double TimeColdMappedLoad(const wchar* filePath, double& checksum)
+{
+    Timer timer;
+
+    uint8* data = nullptr;
+    uint64 fileSize = 0;
+    ReadFileUnbuffered(filePath, data, fileSize);
+
+    const SHProbeFileHeader& header = *reinterpret_cast<const SHProbeFileHeader*>(data);
+    const SHProbeChunkDesc& chunk = *reinterpret_cast<const SHProbeChunkDesc*>(data + header.ChunkTableOffset);
+    Assert_(header.NumChunks > 0 && chunk.LOD == SHProbeLOD::L2 && chunk.Encoding == SHProbeEncoding::Float32);
+    Assert_(RangeInFile(chunk.Offset, chunk.Size, fileSize));
+
+    const SH9Color* probes = reinterpret_cast<const SH9Color*>(data + chunk.Offset);
+    for(uint64 i = 0; i < chunk.NumProbes; ++i)
+        checksum += probes[i].Coefficients[0].x + probes[i].Coefficients[8].z;
+
+    VirtualFree(data, 0, MEM_RELEASE);
+
+    timer.Update();
+    return timer.ElapsedMillisecondsD();
+}
+
+SHProbeLoadBenchmark BenchmarkSHProbeLoad(const SH9Color* probes, uint64 numProbes, const wchar* directory)
+{
+    Assert_(numProbes > 0);
+
+    const std::wstring serializedPath = MakeString(L"%ls\\ProbeBenchmark.probes", directory);
+    const std::wstring mappedPath = MakeString(L"%ls\\ProbeBenchmark.shprobe", directory);
+
+    {
+        SerializedProbes serialized;
+        serialized.Probes.Init(numProbes);
+        memcpy(serialized.Probes.Data(), probes, serialized.Probes.MemorySize());
+        FileWriteSerializer serializer(serializedPath.c_str());
+        SerializeItem(serializer, serialized);
+    }
+
+    SHProbeRegionData region;
+    region.Probes = probes;
+    region.NumProbes = numProbes;
+    WriteSHProbeFile(mappedPath.c_str(), &region, 1, SHProbeEncoding::Float32, 1);
+
+    SHProbeLoadBenchmark benchmark;
+    benchmark.NumProbes = numProbes;
+
+    // Cold loads read both files with unbuffered I/O, so they come from the disk even though the files were just
+    // written. They're done first so that the untimed warm-up loads below don't affect them.
+    static const uint64 NumLoads = 4;
+    for(uint64 i = 0; i < NumLoads; ++i)
+    {
+        benchmark.ColdSerializerMilliseconds += TimeColdSerializerLoad(serializedPath.c_str(), benchmark.Checksum) / NumLoads;
+        benchmark.ColdMappedMilliseconds += TimeColdMappedLoad(mappedPath.c_str(), benchmark.Checksum) / NumLoads;
+    }
+
+    // Both files are in the OS file cache for the warm loads. Each path is loaded once untimed so that they start
+    // out equally warm, and then the timings are averaged over several loads.
+    TimeSerializerLoad(serializedPath.c_str(), benchmark.Checksum);
+    TimeMappedLoad(mappedPath.c_str(), benchmark.Checksum);
+    for(uint64 i = 0; i < NumLoads; ++i)
+    {
+        benchmark.SerializerMilliseconds += TimeSerializerLoad(serializedPath.c_str(), benchmark.Checksum) / NumLoads;
+        benchmark.MappedMilliseconds += TimeMappedLoad(mappedPath.c_str(), benchmark.Checksum) / NumLoads;
+    }
+
+    return benchmark;
+}
+
+std::string SHProbeLoadBenchmarkToString(const SHProbeLoadBenchmark& benchmark)
+{
+    return MakeString("Loading %llu probes (%.2f MB)\n"
+                      "Serializer: %.3f ms cold, %.3f ms from the file cache\n"
+                      "Mapped: %.3f ms cold, %.3f ms from the file cache\n",
+                      benchmark.NumProbes, BytesToMB(benchmark.NumProbes * sizeof(SH9Color)),
+                      benchmark.ColdSerializerMilliseconds, benchmark.SerializerMilliseconds,
+                      benchmark.ColdMappedMilliseconds, benchmark.MappedMilliseconds);
+}
+
+}
@@ -0,0 +1,173 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\SF12_Math.h"
+#include "..\\MurmurHash.h"
+#include "SH.h"
+
+namespace SampleFramework12
+{
+
+// .shprobe is a container for baked probe data that's meant to be memory-mapped and read in place:
+//
+//  [Header][Region table][Chunk table][padding][Chunk 0][Chunk 1]...
+//
+// Probes are grouped into regions, and each region has one chunk per LOD level: L2 (9 coefficients),
+// L1 (4 coefficients) and L0 (1 coefficient). A chunk is a tightly packed array of RGB coefficients
+// (probe-major), stored as either fp32 or fp16. Every chunk starts on a 64-byte boundary so that it can
+// be handed out straight from the mapping, and has its own checksum so that it can be validated when
+// it's first touched instead of when the file is opened.
+
+static const uint32 SHProbeFileMagic = 0x42505348;    // 'SHPB'
+static const uint32 SHProbeFileVersion = 1;
+static const uint64 SHProbeChunkAlignment = 64;
+
+enum class SHProbeLOD : uint32
+{
+    L2 = 0,
+    L1 = 1,
+    L0 = 2,
+
+    NumValues
+};
+
+enum class SHProbeEncoding : uint32
+{
+    Float32 = 0,
+    Float16 = 1,
+};
+
+uint64 SHProbeLODNumCoefficients(SHProbeLOD lod);
+
+struct SHProbeFileHeader
+{
+    uint32 Magic = SHProbeFileMagic;
+    uint32 Version = SHProbeFileVersion;
+    uint32 NumRegions = 0;
+    uint32 NumChunks = 0;
+    uint64 RegionTableOffset = 0;
+    uint64 ChunkTableOffset = 0;
+    uint64 FileSize = 0;
+
+    // Checksum of the region and chunk tables
+    Hash TableChecksum;
+};
+
+struct SHProbeRegionDesc
+{
+    Float3 BoundsMin;
+    Float3 BoundsMax;
+    uint32 NumProbes = 0;
+
+    // The region's chunks are contiguous in the chunk table, ordered from L2 to L0
+    uint32 FirstChunk = 0;
+    uint32 NumChunks = 0;
+};
+
+struct SHProbeChunkDesc
+{
+    uint32 RegionIdx = 0;
+    SHProbeLOD LOD = SHProbeLOD::L2;
+    SHProbeEncoding Encoding = SHProbeEncoding::Float32;
+    uint32 NumProbes = 0;
+    uint64 Offset = 0;
+    uint64 Size = 0;
+    Hash Checksum;
+};
+
+// Input for WriteSHProbeFile
+struct SHProbeRegionData
+{
+    Float3 BoundsMin;
+    Float3 BoundsMax;
+    const SH9Color* Probes = nullptr;
+    uint64 NumProbes = 0;
+};
+
+// Writes chunks for the first numLODs LOD levels of every region, truncating the L2 probes for lower LODs
+void WriteSHProbeFile(const wchar* filePath, const SHProbeRegionData* regions, uint64 numRegions,
+                      SHProbeEncoding encoding = SHProbeEncoding::Float32, uint32 numLODs = uint32(SHProbeLOD::NumValues));
+
+// Read-only memory mapping of a .shprobe file. The header and tables are validated when the file is opened,
+// and all pointers returned by this class point directly into the mapping and stay valid until Close().
+class SHProbeFile
+{
+
+public:
+
+    SHProbeFile() = default;
+    ~SHProbeFile();
+
+    SHProbeFile(const SHProbeFile&) = delete;
+    SHProbeFile& operator=(const SHProbeFile&) = delete;
+
+    void Open(const wchar* filePath);
+    void Close();
+
+    bool IsOpen() const { return mappedData != nullptr; }
+    uint64 FileSize() const { return fileSize; }
+
+    uint32 NumRegions() const { return Header().NumRegions; }
+    const SHProbeRegionDesc& Region(uint64 regionIdx) const;
+
+    // Returns null if the region doesn't have a chunk for the LOD
+    const SHProbeChunkDesc* FindChunk(uint64 regionIdx, SHProbeLOD lod) const;
+
+    // Raw chunk contents, NumProbes * SHProbeLODNumCoefficients(LOD) RGB triplets in the chunk's encoding
+    const void* ChunkData(const SHProbeChunkDesc& chunk) const;
+
+    // Direct access to fp32 L2 chunks, returns null if the region's L2 chunk is missing or stored as fp16
+    const SH9Color* L2Probes(uint64 regionIdx) const;
+
+    // Re-computes the chunk's checksum. This touches every page of the chunk.
+    bool ValidateChunk(const SHProbeChunkDesc& chunk) const;
+
+    // Converts a chunk of any LOD and encoding to L2 probes, with the missing bands set to 0
+    void DecodeChunk(const SHProbeChunkDesc& chunk, SH9Color* output) const;
+
+private:
+
+    const SHProbeFileHeader& Header() const;
+
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+    const uint8* mappedData = nullptr;
+    uint64 fileSize = 0;
+};
+
+struct SHProbeLoadBenchmark
+{
+    uint64 NumProbes = 0;
+
+    // Reading the probes into a fresh allocation with FileReadSerializer/BulkSerializeItem
+    double SerializerMilliseconds = 0.0;
+
+    // Mapping the .shprobe file and touching every probe through the returned pointer
+    double MappedMilliseconds = 0.0;
+
+    // The same loads with the files read from disk through unbuffered handles instead of from the file cache
+    double ColdSerializerMilliseconds = 0.0;
+    double ColdMappedMilliseconds = 0.0;
+
+    // Sum of coefficients read through both paths, so that the reads can't be optimized out
+    double Checksum = 0.0;
+};
+
+// Writes the probes to a serialized file and a .shprobe file in the given directory, and times loading both, cold
+// and warm. Cold loads read each file with FILE_FLAG_NO_BUFFERING, which bypasses the OS file cache, and then
+// deserialize or touch the probes in memory. A mapping can't be made to skip the file cache, so the cold mapped time
+// is the time to read the whole file from disk, which is what faulting it in costs with nothing cached. Warm loads
+// read the files from the file cache, so they measure the cost of copying and deserializing the probes.
+SHProbeLoadBenchmark BenchmarkSHProbeLoad(const SH9Color* probes, uint64 numProbes, const wchar* directory);
+std::string SHProbeLoadBenchmarkToString(const SHProbeLoadBenchmark& benchmark);
+
+}
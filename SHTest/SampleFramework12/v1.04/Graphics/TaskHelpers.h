@@ -0,0 +1,47 @@
+//=================================================================================================
+//
+//  MJP's DX12 Sample Framework
+//  https://therealmjp.github.io/
+//
+//  All code licensed under the MIT license
+//
+//=================================================================================================
+
+#pragma once
+
+#include "..\\PCH.h"
+#include "..\\EnkiTS\\TaskScheduler.h"
+
+namespace SampleFramework12
+{
+
+// The CPU precomputation functions in the framework take an optional enki::TaskScheduler to run their
+// parallel loops on. This resolves that argument: the caller's scheduler is used if there is one, and
+// otherwise a temporary scheduler with a thread per core is started and then shut down when this goes
+// out of scope. Passing a scheduler avoids spinning up threads on every call.
+class ScopedTaskScheduler
+{
+
+public:
+
+    explicit ScopedTaskScheduler(enki::TaskScheduler* taskScheduler) : scheduler(taskScheduler)
+    {
+        if(scheduler == nullptr)
+        {
+            localScheduler.Initialize();
+            scheduler = &localScheduler;
+        }
+    }
+
+    enki::TaskScheduler* Scheduler() const { return scheduler; }
+
+private:
+
+    ScopedTaskScheduler(const ScopedTaskScheduler& other) = delete;
+    ScopedTaskScheduler& operator=(const ScopedTaskScheduler& other) = delete;
+
+    enki::TaskScheduler localScheduler;
+    enki::TaskScheduler* scheduler = nullptr;
+};
+
+}
@@ -62,6 +62,12 @@ std::string MakeString(const char* format, ...)
     return std::string(buffer);
 }
 
+std::string SizeReductionString(uint64 originalSize, uint64 reducedSize)
+{
+    const double ratio = reducedSize > 0 ? double(originalSize) / double(reducedSize) : 0.0;
+    return MakeString("%.2f MB -> %.2f MB (%.1f:1)", BytesToMB(originalSize), BytesToMB(reducedSize), ratio);
+}
+
 std::wstring SampleFrameworkDir()
 {
     return std::wstring(SampleFrameworkDir_);
@@ -101,6 +101,10 @@ void WriteLog(const char* format, ...);
 std::wstring MakeString(const wchar* format, ...);
 std::string MakeString(const char* format, ...);
 
+// Helpers for formatting memory sizes in stats reports. SizeReductionString returns "<before> MB -> <after> MB (<ratio>:1)".
+inline double BytesToMB(uint64 numBytes) { return double(numBytes) / (1024.0 * 1024.0); }
+std::string SizeReductionString(uint64 originalSize, uint64 reducedSize);
+
 std::wstring SampleFrameworkDir();
 
 // Outputs a string to the debugger output and stdout
@@ -282,6 +282,61 @@ SH_L2_RGB SH_Mix(SH_L2_RGB x, SH_L2_RGB y, float s)
     return SH_Add(SH_Multiply(x, vec3(1.0 - s)), SH_Multiply(y, s.xxx));
 }
 
+// Blends 8 sets of SH coefficients with per-set weights in a single pass, for example the 8 probes
+// surrounding a point in a probe grid with trilinear weights. The weights are used as-is, so they
+// should already sum to 1 if the result needs to be normalized.
+SH_L1 SH_WeightedSum(SH_L1 sh[8], float weights[8])
+{
+    SH_L1 result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L1_RGB SH_WeightedSum(SH_L1_RGB sh[8], float weights[8])
+{
+    SH_L1_RGB result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L2 SH_WeightedSum(SH_L2 sh[8], float weights[8])
+{
+    SH_L2 result;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L2_RGB SH_WeightedSum(SH_L2_RGB sh[8], float weights[8])
+{
+    SH_L2_RGB result;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
 // Projects a value in a single direction onto a set of SH_L1 SH coefficients
 SH_L1 SH_ProjectOntoL1(vec3 direction, float value)
 {
@@ -424,6 +479,49 @@ vec3 SH_Evaluate(SH_L2_RGB sh, vec3 direction)
     return SH_DotProduct(projectedDelta, sh);
 }
 
+// Evaluates the weighted blend of 8 sets of SH coefficients in a direction, without blending the
+// coefficients themselves. The basis for the direction is projected once and each set then costs a
+// single weighted dot product.
+float SH_WeightedEvaluate(SH_L1 sh[8], float weights[8], vec3 direction)
+{
+    const SH_L1 projectedDelta = SH_ProjectOntoL1(direction, 1.0);
+    float result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+vec3 SH_WeightedEvaluate(SH_L1_RGB sh[8], float weights[8], vec3 direction)
+{
+    const SH_L1_RGB projectedDelta = SH_ProjectOntoL1_RGB(direction, 1.0.xxx);
+    vec3 result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+float SH_WeightedEvaluate(SH_L2 sh[8], float weights[8], vec3 direction)
+{
+    const SH_L2 projectedDelta = SH_ProjectOntoL2(direction, 1.0);
+    float result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+vec3 SH_WeightedEvaluate(SH_L2_RGB sh[8], float weights[8], vec3 direction)
+{
+    const SH_L2_RGB projectedDelta = SH_ProjectOntoL2_RGB(direction, 1.0.xxx);
+    vec3 result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
 // Convolves a set of SH_L1 SH coefficients with a set of SH_L1 zonal harmonics
 SH_L1 SH_ConvolveWithZH(SH_L1 sh, vec2 zh)
 {
@@ -684,6 +782,184 @@ SH_L2_RGB SH_ConvolveWithGGX(SH_L2_RGB sh, float ggxAlpha)
     return SH_ConvolveWithZH(sh, SH_ApproximateGGXAsL2ZH(ggxAlpha));
 }
 
+// Computes the zonal harmonics for a cone of constant unit radiance with the given half-angle, including the
+// sqrt(4 * Pi / (2l + 1)) factor for rotating ZH. The result can be passed to SH_ConvolveWithZH along with
+// the radiance projected in the direction of the cone's axis. See [0]
+vec2 SH_ConeAsL1ZH(float cosHalfAngle, float sinSqHalfAngle)
+{
+    const float oneMinusCos = sinSqHalfAngle / (1.0 + cosHalfAngle);
+    return vec2((2.0 * M_PI) * oneMinusCos, M_PI * sinSqHalfAngle);
+}
+
+vec2 SH_ConeAsL1ZH(float cosHalfAngle)
+{
+    return SH_ConeAsL1ZH(cosHalfAngle, clamp(1.0 - cosHalfAngle * cosHalfAngle, 0.0, 1.0));
+}
+
+vec3 SH_ConeAsL2ZH(float cosHalfAngle, float sinSqHalfAngle)
+{
+    const float oneMinusCos = sinSqHalfAngle / (1.0 + cosHalfAngle);
+    return vec3((2.0 * M_PI) * oneMinusCos, M_PI * sinSqHalfAngle, M_PI * cosHalfAngle * sinSqHalfAngle);
+}
+
+vec3 SH_ConeAsL2ZH(float cosHalfAngle)
+{
+    return SH_ConeAsL2ZH(cosHalfAngle, clamp(1.0 - cosHalfAngle * cosHalfAngle, 0.0, 1.0));
+}
+
+// Computes a windowed falloff factor that smoothly reaches zero at the given range
+float SH_DistanceFalloffWindow(float distanceSq, float falloffRange)
+{
+    const float ratio = distanceSq / (falloffRange * falloffRange);
+    const float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    return window * window;
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of SH_L1 SH coefficients
+SH_L1 SH_ProjectConeOntoL1(vec3 axis, float cosHalfAngle, float radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL1(axis, radiance), SH_ConeAsL1ZH(cosHalfAngle));
+}
+
+SH_L1_RGB SH_ProjectConeOntoL1_RGB(vec3 axis, float cosHalfAngle, vec3 radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_RGB(axis, radiance), SH_ConeAsL1ZH(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of SH_L1 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies SH_DistanceFalloffWindow.
+SH_L1 SH_ProjectSphereOntoL1(vec3 offset, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    return SH_ConvolveWithZH(SH_ProjectOntoL1(offset * inversesqrt(distanceSq), radiance), SH_ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+SH_L1 SH_ProjectSphereOntoL1(vec3 offset, float radius, float radiance, float falloffRange)
+{
+    return SH_ProjectSphereOntoL1(offset, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+SH_L1_RGB SH_ProjectSphereOntoL1_RGB(vec3 offset, float radius, vec3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_RGB(offset * inversesqrt(distanceSq), radiance), SH_ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+SH_L1_RGB SH_ProjectSphereOntoL1_RGB(vec3 offset, float radius, vec3 radiance, float falloffRange)
+{
+    return SH_ProjectSphereOntoL1_RGB(offset, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of SH_L1 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+SH_L1 SH_ProjectDiskOntoL1(vec3 offset, vec3 diskNormal, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const vec3 axis = offset * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, diskNormal), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return SH_ProjectConeOntoL1(axis, 1.0 - oneMinusCos, radiance);
+}
+
+SH_L1 SH_ProjectDiskOntoL1(vec3 offset, vec3 diskNormal, float radius, float radiance, float falloffRange)
+{
+    return SH_ProjectDiskOntoL1(offset, diskNormal, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+SH_L1_RGB SH_ProjectDiskOntoL1_RGB(vec3 offset, vec3 diskNormal, float radius, vec3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const vec3 axis = offset * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, diskNormal), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return SH_ProjectConeOntoL1_RGB(axis, 1.0 - oneMinusCos, radiance);
+}
+
+SH_L1_RGB SH_ProjectDiskOntoL1_RGB(vec3 offset, vec3 diskNormal, float radius, vec3 radiance, float falloffRange)
+{
+    return SH_ProjectDiskOntoL1_RGB(offset, diskNormal, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of SH_L2 SH coefficients
+SH_L2 SH_ProjectConeOntoL2(vec3 axis, float cosHalfAngle, float radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL2(axis, radiance), SH_ConeAsL2ZH(cosHalfAngle));
+}
+
+SH_L2_RGB SH_ProjectConeOntoL2_RGB(vec3 axis, float cosHalfAngle, vec3 radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_RGB(axis, radiance), SH_ConeAsL2ZH(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of SH_L2 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies SH_DistanceFalloffWindow.
+SH_L2 SH_ProjectSphereOntoL2(vec3 offset, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    return SH_ConvolveWithZH(SH_ProjectOntoL2(offset * inversesqrt(distanceSq), radiance), SH_ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+SH_L2 SH_ProjectSphereOntoL2(vec3 offset, float radius, float radiance, float falloffRange)
+{
+    return SH_ProjectSphereOntoL2(offset, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+SH_L2_RGB SH_ProjectSphereOntoL2_RGB(vec3 offset, float radius, vec3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_RGB(offset * inversesqrt(distanceSq), radiance), SH_ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+SH_L2_RGB SH_ProjectSphereOntoL2_RGB(vec3 offset, float radius, vec3 radiance, float falloffRange)
+{
+    return SH_ProjectSphereOntoL2_RGB(offset, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of SH_L2 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+SH_L2 SH_ProjectDiskOntoL2(vec3 offset, vec3 diskNormal, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const vec3 axis = offset * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, diskNormal), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return SH_ProjectConeOntoL2(axis, 1.0 - oneMinusCos, radiance);
+}
+
+SH_L2 SH_ProjectDiskOntoL2(vec3 offset, vec3 diskNormal, float radius, float radiance, float falloffRange)
+{
+    return SH_ProjectDiskOntoL2(offset, diskNormal, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+SH_L2_RGB SH_ProjectDiskOntoL2_RGB(vec3 offset, vec3 diskNormal, float radius, vec3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const vec3 axis = offset * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, diskNormal), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return SH_ProjectConeOntoL2_RGB(axis, 1.0 - oneMinusCos, radiance);
+}
+
+SH_L2_RGB SH_ProjectDiskOntoL2_RGB(vec3 offset, vec3 diskNormal, float radius, vec3 radiance, float falloffRange)
+{
+    return SH_ProjectDiskOntoL2_RGB(offset, diskNormal, radius, radiance * SH_DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+
 // Given a set of SH_L1 SH coefficients represnting incoming radiance, determines a directional light
 // direction, color, and modified roughness value that can be used to compute an approximate specular term. See [5]
 void SH_ExtractSpecularDirLight(SH_L1 shRadiance, float sqrtRoughness, out vec3 lightDir, out float lightIntensity, out float modifiedSqrtRoughness)
@@ -950,6 +1226,1334 @@ SH_L2_RGB SH_Rotate(mat3 rotation, SH_L2_RGB sh)
     return SH_Rotate(sh, transpose(rotation));
 }
 
+// Converts a unit quaternion (xyz = axis * sin(angle / 2), w = cos(angle / 2)) to a rotation matrix
+// that rotates column vectors, suitable for passing as the first argument of SH_Rotate
+mat3 SH_QuaternionToRotationMatrix(vec4 quaternion)
+{
+    const vec3 q2 = quaternion.xyz * 2.0;
+    const float xx = quaternion.x * q2.x;
+    const float yy = quaternion.y * q2.y;
+    const float zz = quaternion.z * q2.z;
+    const float xy = quaternion.x * q2.y;
+    const float xz = quaternion.x * q2.z;
+    const float yz = quaternion.y * q2.z;
+    const float wx = quaternion.w * q2.x;
+    const float wy = quaternion.w * q2.y;
+    const float wz = quaternion.w * q2.z;
+
+    return mat3(1.0 - yy - zz, xy + wz, xz - wy,
+                xy - wz, 1.0 - xx - zz, yz + wx,
+                xz + wy, yz - wx, 1.0 - xx - yy);
+}
+
+// Rotates a set of SH_L1 coefficients by a unit quaternion. Band 1 rotates like a vector, so the
+// quaternion is applied directly without expanding it to a matrix.
+SH_L1 SH_Rotate(SH_L1 sh, vec4 quaternion)
+{
+    SH_L1 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    vec3 dir = vec3(sh.C[3], sh.C[1], sh.C[2]);
+    const vec3 t = 2.0 * cross(quaternion.xyz, dir);
+    dir += quaternion.w * t + cross(quaternion.xyz, t);
+    result.C[3] = dir.x;
+    result.C[1] = dir.y;
+    result.C[2] = dir.z;
+
+    return result;
+}
+
+SH_L1_RGB SH_Rotate(SH_L1_RGB sh, vec4 quaternion)
+{
+    SH_L1_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    for(uint i = 0; i < 3; ++i)
+    {
+        vec3 dir = vec3(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        const vec3 t = 2.0 * cross(quaternion.xyz, dir);
+        dir += quaternion.w * t + cross(quaternion.xyz, t);
+        result.C[3][i] = dir.x;
+        result.C[1][i] = dir.y;
+        result.C[2][i] = dir.z;
+    }
+
+    return result;
+}
+
+// Rotates a set of SH_L2 coefficients by a unit quaternion. Band 2 needs the quadratic terms of the
+// rotation matrix, so the matrix is built once directly from the quaternion.
+SH_L2 SH_Rotate(SH_L2 sh, vec4 quaternion)
+{
+    return SH_Rotate(SH_QuaternionToRotationMatrix(quaternion), sh);
+}
+
+SH_L2_RGB SH_Rotate(SH_L2_RGB sh, vec4 quaternion)
+{
+    return SH_Rotate(SH_QuaternionToRotationMatrix(quaternion), sh);
+}
+
+// == Explicit fp16 types ========================================================================
+//
+// Half-precision versions of all SH types and functions, using the explicit float16_t types
+// from GL_EXT_shader_explicit_arithmetic_types_float16. These are opt-in since glslang defines
+// the extension macro whenever the extension is supported, not just when it's enabled. To use
+// them, enable the extension and define SH_ENABLE_F16 before including this file:
+//
+// #extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+// #define SH_ENABLE_F16 1
+// #include "SH_Lite.glsl"
+//
+// Functions that don't take an SH type as an argument have an _F16 suffix for the fp16 variant,
+// for example SH_ProjectOntoL2_F16_RGB.
+//
+// ===============================================================================================
+
+#if defined(SH_ENABLE_F16) && defined(GL_EXT_shader_explicit_arithmetic_types_float16)
+
+const float16_t SH_CosineA0_F16 = float16_t(SH_CosineA0);
+const float16_t SH_CosineA1_F16 = float16_t(SH_CosineA1);
+const float16_t SH_CosineA2_F16 = float16_t(SH_CosineA2);
+
+const float16_t SH_BasisL0_F16 = float16_t(SH_BasisL0);
+const float16_t SH_BasisL1_F16 = float16_t(SH_BasisL1);
+const float16_t SH_BasisL2_MN2_F16 = float16_t(SH_BasisL2_MN2);
+const float16_t SH_BasisL2_MN1_F16 = float16_t(SH_BasisL2_MN1);
+const float16_t SH_BasisL2_M0_F16 = float16_t(SH_BasisL2_M0);
+const float16_t SH_BasisL2_M1_F16 = float16_t(SH_BasisL2_M1);
+const float16_t SH_BasisL2_M2_F16 = float16_t(SH_BasisL2_M2);
+
+// Core fp16 SH types containing the coefficients
+struct SH_L1_F16
+{
+    float16_t C[SH_L1_NumCoefficients];
+};
+SH_L1_F16 SH_L1_F16_Zero()
+{
+    return SH_L1_F16(
+        float16_t[SH_L1_NumCoefficients](0.0hf, 0.0hf, 0.0hf, 0.0hf)
+    );
+}
+
+struct SH_L1_F16_RGB
+{
+    f16vec3 C[SH_L1_NumCoefficients];
+};
+SH_L1_F16_RGB SH_L1_F16_RGB_Zero()
+{
+    return SH_L1_F16_RGB(
+        f16vec3[4](f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf))
+    );
+}
+
+struct SH_L2_F16
+{
+    float16_t C[SH_L2_NumCoefficients];
+};
+SH_L2_F16 SH_L2_F16_Zero()
+{
+    return SH_L2_F16(
+        float16_t[9](0.0hf, 0.0hf, 0.0hf, 0.0hf, 0.0hf, 0.0hf, 0.0hf, 0.0hf, 0.0hf)
+    );
+}
+
+struct SH_L2_F16_RGB
+{
+    f16vec3 C[SH_L2_NumCoefficients];
+};
+SH_L2_F16_RGB SH_L2_F16_RGB_Zero()
+{
+    return SH_L2_F16_RGB(
+        f16vec3[9](f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf), f16vec3(0.0hf))
+    );
+}
+
+// Sum two sets of SH coefficients
+SH_L1_F16 SH_Add(SH_L1_F16 a, SH_L1_F16 b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+SH_L1_F16_RGB SH_Add(SH_L1_F16_RGB a, SH_L1_F16_RGB b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+SH_L2_F16 SH_Add(SH_L2_F16 a, SH_L2_F16 b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+SH_L2_F16_RGB SH_Add(SH_L2_F16_RGB a, SH_L2_F16_RGB b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+// Substract two sets of SH coefficients
+SH_L1_F16 SH_Subtract(SH_L1_F16 a, SH_L1_F16 b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+SH_L1_F16_RGB SH_Subtract(SH_L1_F16_RGB a, SH_L1_F16_RGB b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+SH_L2_F16 SH_Subtract(SH_L2_F16 a, SH_L2_F16 b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+SH_L2_F16_RGB SH_Subtract(SH_L2_F16_RGB a, SH_L2_F16_RGB b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+// Multiply a set of SH coefficients by a single value
+SH_L1_F16 SH_Multiply(SH_L1_F16 a, float16_t b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+SH_L1_F16_RGB SH_Multiply(SH_L1_F16_RGB a, f16vec3 b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+SH_L2_F16 SH_Multiply(SH_L2_F16 a, float16_t b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+SH_L2_F16_RGB SH_Multiply(SH_L2_F16_RGB a, f16vec3 b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+// Divide a set of SH coefficients by a single value
+SH_L1_F16 SH_Divide(SH_L1_F16 a, float16_t b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+SH_L1_F16_RGB SH_Divide(SH_L1_F16_RGB a, f16vec3 b)
+{
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+SH_L2_F16 SH_Divide(SH_L2_F16 a, float16_t b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+SH_L2_F16_RGB SH_Divide(SH_L2_F16_RGB a, f16vec3 b)
+{
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+// Truncates a set of SH_L2_F16 coefficients to produce a set of SH_L1_F16 coefficients
+SH_L1_F16 SH_L2toL1(SH_L2_F16 sh)
+{
+    SH_L1_F16 result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
+SH_L1_F16_RGB SH_L2toL1(SH_L2_F16_RGB sh)
+{
+    SH_L1_F16_RGB result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
+// Converts from scalar to RGB SH coefficients
+SH_L1_F16_RGB SH_ToRGB(SH_L1_F16 sh)
+{
+    SH_L1_F16_RGB result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        result.C[i] = sh.C[i].xxx;
+    return result;
+}
+
+SH_L2_F16_RGB SH_ToRGB(SH_L2_F16 sh)
+{
+    SH_L2_F16_RGB result;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        result.C[i] = sh.C[i].xxx;
+    return result;
+}
+
+// Linear interpolation
+SH_L1_F16 SH_Mix(SH_L1_F16 x, SH_L1_F16 y, float16_t s)
+{
+    return SH_Add(SH_Multiply(x, 1.0hf - s), SH_Multiply(y, s));
+}
+
+SH_L1_F16_RGB SH_Mix(SH_L1_F16_RGB x, SH_L1_F16_RGB y, float16_t s)
+{
+    return SH_Add(SH_Multiply(x, f16vec3(1.0hf - s)), SH_Multiply(y, f16vec3(s)));
+}
+
+SH_L2_F16 SH_Mix(SH_L2_F16 x, SH_L2_F16 y, float16_t s)
+{
+    return SH_Add(SH_Multiply(x, 1.0hf - s), SH_Multiply(y, s));
+}
+
+SH_L2_F16_RGB SH_Mix(SH_L2_F16_RGB x, SH_L2_F16_RGB y, float16_t s)
+{
+    return SH_Add(SH_Multiply(x, f16vec3(1.0hf - s)), SH_Multiply(y, f16vec3(s)));
+}
+
+// Blends 8 sets of SH_L1_F16/SH_L2_F16 coefficients with per-set weights in a single pass
+SH_L1_F16 SH_WeightedSum(SH_L1_F16 sh[8], float16_t weights[8])
+{
+    SH_L1_F16 result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L1_F16_RGB SH_WeightedSum(SH_L1_F16_RGB sh[8], float16_t weights[8])
+{
+    SH_L1_F16_RGB result;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L2_F16 SH_WeightedSum(SH_L2_F16 sh[8], float16_t weights[8])
+{
+    SH_L2_F16 result;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+SH_L2_F16_RGB SH_WeightedSum(SH_L2_F16_RGB sh[8], float16_t weights[8])
+{
+    SH_L2_F16_RGB result;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+// Projects a value in a single direction onto a set of SH_L1_F16 SH coefficients
+SH_L1_F16 SH_ProjectOntoL1_F16(f16vec3 direction, float16_t value)
+{
+    SH_L1_F16 sh;
+
+    // L0
+    sh.C[0] = SH_BasisL0_F16 * value;
+
+    // SH_L1
+    sh.C[1] = SH_BasisL1_F16 * direction.y * value;
+    sh.C[2] = SH_BasisL1_F16 * direction.z * value;
+    sh.C[3] = SH_BasisL1_F16 * direction.x * value;
+
+    return sh;
+}
+
+SH_L1_F16_RGB SH_ProjectOntoL1_F16_RGB(f16vec3 direction, f16vec3 value)
+{
+    SH_L1_F16_RGB sh;
+
+    // L0
+    sh.C[0] = SH_BasisL0_F16 * value;
+
+    // SH_L1
+    sh.C[1] = SH_BasisL1_F16 * direction.y * value;
+    sh.C[2] = SH_BasisL1_F16 * direction.z * value;
+    sh.C[3] = SH_BasisL1_F16 * direction.x * value;
+
+    return sh;
+}
+
+// Projects a value in a single direction onto a set of SH_L2_F16 SH coefficients
+SH_L2_F16 SH_ProjectOntoL2_F16(f16vec3 direction, float16_t value)
+{
+    SH_L2_F16 sh;
+
+    // L0
+    sh.C[0] = SH_BasisL0_F16 * value;
+
+    // SH_L1
+    sh.C[1] = SH_BasisL1_F16 * direction.y * value;
+    sh.C[2] = SH_BasisL1_F16 * direction.z * value;
+    sh.C[3] = SH_BasisL1_F16 * direction.x * value;
+
+    // SH_L2
+    sh.C[4] = SH_BasisL2_MN2_F16 * direction.x * direction.y * value;
+    sh.C[5] = SH_BasisL2_MN1_F16 * direction.y * direction.z * value;
+    sh.C[6] = SH_BasisL2_M0_F16 * (3.0hf * direction.z * direction.z - 1.0hf) * value;
+    sh.C[7] = SH_BasisL2_M1_F16 * direction.x * direction.z * value;
+    sh.C[8] = SH_BasisL2_M2_F16 * (direction.x * direction.x - direction.y * direction.y) * value;
+
+    return sh;
+}
+
+SH_L2_F16_RGB SH_ProjectOntoL2_F16_RGB(f16vec3 direction, f16vec3 value)
+{
+    SH_L2_F16_RGB sh;
+
+    // L0
+    sh.C[0] = SH_BasisL0_F16 * value;
+
+    // SH_L1
+    sh.C[1] = SH_BasisL1_F16 * direction.y * value;
+    sh.C[2] = SH_BasisL1_F16 * direction.z * value;
+    sh.C[3] = SH_BasisL1_F16 * direction.x * value;
+
+    // SH_L2
+    sh.C[4] = SH_BasisL2_MN2_F16 * direction.x * direction.y * value;
+    sh.C[5] = SH_BasisL2_MN1_F16 * direction.y * direction.z * value;
+    sh.C[6] = SH_BasisL2_M0_F16 * (3.0hf * direction.z * direction.z - 1.0hf) * value;
+    sh.C[7] = SH_BasisL2_M1_F16 * direction.x * direction.z * value;
+    sh.C[8] = SH_BasisL2_M2_F16 * (direction.x * direction.x - direction.y * direction.y) * value;
+
+    return sh;
+}
+
+// Calculates the dot product of two sets of SH_L1_F16 SH coefficients
+float16_t SH_DotProduct(SH_L1_F16 a, SH_L1_F16 b)
+{
+    float16_t result = 0.0hf;
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+f16vec3 SH_DotProduct(SH_L1_F16_RGB a, SH_L1_F16_RGB b)
+{
+    f16vec3 result = f16vec3(0.0hf);
+    for(uint i = 0; i < SH_L1_NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+// Calculates the dot product of two sets of SH_L2_F16 SH coefficients
+float16_t SH_DotProduct(SH_L2_F16 a, SH_L2_F16 b)
+{
+    float16_t result = 0.0hf;
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+f16vec3 SH_DotProduct(SH_L2_F16_RGB a, SH_L2_F16_RGB b)
+{
+    f16vec3 result = f16vec3(0.0hf);
+    for(uint i = 0; i < SH_L2_NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+// Projects a delta in a direction onto SH and calculates the dot product with a set of SH_L1_F16 SH coefficients.
+// Can be used to "look up" a value from SH coefficients in a particular direction.
+float16_t SH_Evaluate(SH_L1_F16 sh, f16vec3 direction)
+{
+    SH_L1_F16 projectedDelta = SH_ProjectOntoL1_F16(direction, 1.0hf);
+    return SH_DotProduct(projectedDelta, sh);
+}
+
+f16vec3 SH_Evaluate(SH_L1_F16_RGB sh, f16vec3 direction)
+{
+    SH_L1_F16_RGB projectedDelta = SH_ProjectOntoL1_F16_RGB(direction, f16vec3(1.0hf));
+    return SH_DotProduct(projectedDelta, sh);
+}
+
+// Projects a delta in a direction onto SH and calculates the dot product with a set of SH_L2_F16 SH coefficients.
+// Can be used to "look up" a value from SH coefficients in a particular direction.
+float16_t SH_Evaluate(SH_L2_F16 sh, f16vec3 direction)
+{
+    SH_L2_F16 projectedDelta = SH_ProjectOntoL2_F16(direction, 1.0hf);
+    return SH_DotProduct(projectedDelta, sh);
+}
+
+f16vec3 SH_Evaluate(SH_L2_F16_RGB sh, f16vec3 direction)
+{
+    SH_L2_F16_RGB projectedDelta = SH_ProjectOntoL2_F16_RGB(direction, f16vec3(1.0hf));
+    return SH_DotProduct(projectedDelta, sh);
+}
+
+// Evaluates the weighted blend of 8 sets of SH_L1_F16/SH_L2_F16 coefficients in a direction, without
+// blending the coefficients themselves
+float16_t SH_WeightedEvaluate(SH_L1_F16 sh[8], float16_t weights[8], f16vec3 direction)
+{
+    const SH_L1_F16 projectedDelta = SH_ProjectOntoL1_F16(direction, 1.0hf);
+    float16_t result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+f16vec3 SH_WeightedEvaluate(SH_L1_F16_RGB sh[8], float16_t weights[8], f16vec3 direction)
+{
+    const SH_L1_F16_RGB projectedDelta = SH_ProjectOntoL1_F16_RGB(direction, f16vec3(1.0hf));
+    f16vec3 result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+float16_t SH_WeightedEvaluate(SH_L2_F16 sh[8], float16_t weights[8], f16vec3 direction)
+{
+    const SH_L2_F16 projectedDelta = SH_ProjectOntoL2_F16(direction, 1.0hf);
+    float16_t result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+f16vec3 SH_WeightedEvaluate(SH_L2_F16_RGB sh[8], float16_t weights[8], f16vec3 direction)
+{
+    const SH_L2_F16_RGB projectedDelta = SH_ProjectOntoL2_F16_RGB(direction, f16vec3(1.0hf));
+    f16vec3 result = SH_DotProduct(projectedDelta, sh[0]) * weights[0];
+    for(uint k = 1; k < 8; ++k)
+        result += SH_DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+// Convolves a set of SH_L1_F16 SH coefficients with a set of SH_L1_F16 zonal harmonics
+SH_L1_F16 SH_ConvolveWithZH(SH_L1_F16 sh, f16vec2 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // SH_L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    return sh;
+}
+
+SH_L1_F16_RGB SH_ConvolveWithZH(SH_L1_F16_RGB sh, f16vec2 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // SH_L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    return sh;
+}
+
+// Convolves a set of SH_L2_F16 SH coefficients with a set of SH_L2_F16 zonal harmonics
+SH_L2_F16 SH_ConvolveWithZH(SH_L2_F16 sh, f16vec3 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // SH_L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    // SH_L2
+    sh.C[4] *= zh.z;
+    sh.C[5] *= zh.z;
+    sh.C[6] *= zh.z;
+    sh.C[7] *= zh.z;
+    sh.C[8] *= zh.z;
+
+    return sh;
+}
+
+SH_L2_F16_RGB SH_ConvolveWithZH(SH_L2_F16_RGB sh, f16vec3 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // SH_L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    // SH_L2
+    sh.C[4] *= zh.z;
+    sh.C[5] *= zh.z;
+    sh.C[6] *= zh.z;
+    sh.C[7] *= zh.z;
+    sh.C[8] *= zh.z;
+
+    return sh;
+}
+
+// Convolves a set of SH_L1_F16 SH coefficients with a cosine lobe. See [2]
+SH_L1_F16 SH_ConvolveWithCosineLobe(SH_L1_F16 sh)
+{
+    return SH_ConvolveWithZH(sh, f16vec2(SH_CosineA0_F16, SH_CosineA1_F16));
+}
+
+SH_L1_F16_RGB SH_ConvolveWithCosineLobe(SH_L1_F16_RGB sh)
+{
+    return SH_ConvolveWithZH(sh, f16vec2(SH_CosineA0_F16, SH_CosineA1_F16));
+}
+
+// Convolves a set of SH_L2_F16 SH coefficients with a cosine lobe. See [2]
+SH_L2_F16 SH_ConvolveWithCosineLobe(SH_L2_F16 sh)
+{
+    return SH_ConvolveWithZH(sh, f16vec3(SH_CosineA0_F16, SH_CosineA1_F16, SH_CosineA2_F16));
+}
+
+SH_L2_F16_RGB SH_ConvolveWithCosineLobe(SH_L2_F16_RGB sh)
+{
+    return SH_ConvolveWithZH(sh, f16vec3(SH_CosineA0_F16, SH_CosineA1_F16, SH_CosineA2_F16));
+}
+
+// Computes the "optimal linear direction" for a set of SH coefficients, AKA the "dominant" direction. See [0].
+f16vec3 SH_OptimalLinearDirection(SH_L1_F16 sh)
+{
+    return normalize(f16vec3(sh.C[3], sh.C[1], sh.C[2]));
+}
+
+f16vec3 SH_OptimalLinearDirection(SH_L1_F16_RGB sh)
+{
+    f16vec3 direction = f16vec3(0.0hf);
+    for(uint i = 0; i < 3; ++i)
+    {
+        direction.x += sh.C[3][i];
+        direction.y += sh.C[1][i];
+        direction.z += sh.C[2][i];
+    }
+    return normalize(direction);
+}
+
+// Computes the direction and color of a directional light that approximates a set of SH_L1_F16 SH coefficients. See [0].
+void SH_ApproximateDirectionalLight(SH_L1_F16 sh, out f16vec3 direction, out float16_t intensity)
+{
+    direction = SH_OptimalLinearDirection(sh);
+    SH_L1_F16 dirSH = SH_ProjectOntoL1_F16(direction, 1.0hf);
+    dirSH.C[0] = 0.0hf;
+    intensity = SH_DotProduct(dirSH, sh) * (867.0hf / (316.0hf * float16_t(M_PI)));
+}
+
+void SH_ApproximateDirectionalLight(SH_L1_F16_RGB sh, out f16vec3 direction, out f16vec3 color)
+{
+    direction = SH_OptimalLinearDirection(sh);
+    SH_L1_F16_RGB dirSH = SH_ProjectOntoL1_F16_RGB(direction, f16vec3(1.0hf));
+    dirSH.C[0] = f16vec3(0.0hf);
+    color = SH_DotProduct(dirSH, sh) * (867.0hf / (316.0hf * float16_t(M_PI)));
+}
+
+// Calculates the irradiance from a set of SH coefficients containing projected radiance.
+// Convolves the radiance with a cosine lobe, and then evaluates the result in the given normal direction.
+// Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
+// you will want to include the divide-by-pi that's part of the Lambertian BRDF.
+// For example: vec3 diffuse = CalculateIrradiance(sh, normal) * diffuseAlbedo / Pi;
+float16_t SH_CalculateIrradiance(SH_L1_F16 sh, f16vec3 normal)
+{
+    SH_L1_F16 convolved = SH_ConvolveWithCosineLobe(sh);
+    return SH_Evaluate(convolved, normal);
+}
+
+f16vec3 SH_CalculateIrradiance(SH_L1_F16_RGB sh, f16vec3 normal)
+{
+    SH_L1_F16_RGB convolved = SH_ConvolveWithCosineLobe(sh);
+    return SH_Evaluate(convolved, normal);
+}
+
+// Calculates the irradiance from a set of SH coefficients containing projected radiance.
+// Convolves the radiance with a cosine lobe, and then evaluates the result in the given normal direction.
+// Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
+// you will want to include the divide-by-pi that's part of the Lambertian BRDF.
+// For example: vec3 diffuse = CalculateIrradiance(sh, normal) * diffuseAlbedo / Pi;
+float16_t SH_CalculateIrradiance(SH_L2_F16 sh, f16vec3 normal)
+{
+    SH_L2_F16 convolved = SH_ConvolveWithCosineLobe(sh);
+    return SH_Evaluate(convolved, normal);
+}
+
+f16vec3 SH_CalculateIrradiance(SH_L2_F16_RGB sh, f16vec3 normal)
+{
+    SH_L2_F16_RGB convolved = SH_ConvolveWithCosineLobe(sh);
+    return SH_Evaluate(convolved, normal);
+}
+
+// Calculates the irradiance from a set of SH_L1_F16 SH coeffecients using the non-linear fit from [1]
+// Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
+// you will want to include the divide-by-pi that's part of the Lambertian BRDF.
+// For example: vec3 diffuse = CalculateIrradianceGeomerics(sh, normal) * diffuseAlbedo / Pi;
+float16_t SH_CalculateIrradianceGeomerics(SH_L1_F16 sh, f16vec3 normal)
+{
+    float16_t R0 = max(sh.C[0], 0.00001hf);
+
+    f16vec3 R1 = 0.5hf * f16vec3(sh.C[3], sh.C[1], sh.C[2]);
+    float16_t lenR1 = max(length(R1), 0.00001hf);
+
+    float16_t q = 0.5hf * (1.0hf + dot(R1 / lenR1, normal));
+
+    float16_t p = 1.0hf + 2.0hf * lenR1 / R0;
+    float16_t a = (1.0hf - lenR1 / R0) / (1.0hf + lenR1 / R0);
+
+    return R0 * (a + (1.0hf - a) * (p + 1.0hf) * pow(abs(q), p));
+}
+
+f16vec3 SH_CalculateIrradianceGeomerics(SH_L1_F16_RGB sh, f16vec3 normal)
+{
+    SH_L1_F16 shr = { { sh.C[0].x, sh.C[1].x, sh.C[2].x, sh.C[3].x } };
+    SH_L1_F16 shg = { { sh.C[0].y, sh.C[1].y, sh.C[2].y, sh.C[3].y } };
+    SH_L1_F16 shb = { { sh.C[0].z, sh.C[1].z, sh.C[2].z, sh.C[3].z } };
+
+    return f16vec3(SH_CalculateIrradianceGeomerics(shr, normal), SH_CalculateIrradianceGeomerics(shg, normal), SH_CalculateIrradianceGeomerics(shb, normal));
+}
+
+// Calculates the irradiance from a set of SH_L1_F16 SH coefficientions by 'hallucinating" L3 zonal harmonics. See [4].
+float16_t SH_CalculateIrradianceL1ZH3Hallucinate(SH_L1_F16 sh, f16vec3 normal)
+{
+    const f16vec3 zonalAxis = normalize(f16vec3(sh.C[3], sh.C[1], sh.C[2]));
+
+    float16_t ratio = abs(dot(f16vec3(sh.C[3], sh.C[1], sh.C[2]), zonalAxis)) / sh.C[0];
+
+    const float16_t zonalL2Coeff = sh.C[0] * (0.08hf * ratio + 0.6hf * ratio * ratio);
+
+    const float16_t fZ = dot(zonalAxis, normal);
+    const float16_t zhDir = sqrt(5.0hf / (16.0hf * float16_t(M_PI))) * (3.0hf * fZ * fZ - 1.0hf);
+
+    const float16_t baseIrradiance = SH_CalculateIrradiance(sh, normal);
+
+    return baseIrradiance + ((float16_t(M_PI) * 0.25hf) * zonalL2Coeff * zhDir);
+}
+
+f16vec3 SH_CalculateIrradianceL1ZH3Hallucinate(SH_L1_F16_RGB sh, f16vec3 normal)
+{
+    const f16vec3 lumCoefficients = f16vec3(0.2126hf, 0.7152hf, 0.0722hf);
+    const f16vec3 zonalAxis = normalize(f16vec3(dot(sh.C[3], lumCoefficients), dot(sh.C[1], lumCoefficients), dot(sh.C[2], lumCoefficients)));
+
+    f16vec3 ratio;
+    for(uint i = 0; i < 3; ++i)
+        ratio[i] = abs(dot(f16vec3(sh.C[3][i], sh.C[1][i], sh.C[2][i]), zonalAxis)) / sh.C[0][i];
+
+    const f16vec3 zonalL2Coeff = sh.C[0] * (0.08hf * ratio + 0.6hf * ratio * ratio);
+
+    const float16_t fZ = dot(zonalAxis, normal);
+    const float16_t zhDir = sqrt(5.0hf / (16.0hf * float16_t(M_PI))) * (3.0hf * fZ * fZ - 1.0hf);
+
+    const f16vec3 baseIrradiance = SH_CalculateIrradiance(sh, normal);
+
+    return baseIrradiance + ((float16_t(M_PI) * 0.25hf) * zonalL2Coeff * zhDir);
+}
+
+// Approximates a GGX lobe with a given roughness/alpha as SH_L1_F16 zonal harmonics, using a fitted curve
+f16vec2 SH_ApproximateGGXAsL1ZH_F16(float16_t ggxAlpha)
+{
+    const float16_t l1Scale = 1.66711256633276hf / (1.65715038133932hf + ggxAlpha);
+    return f16vec2(1.0hf, l1Scale);
+}
+
+// Approximates a GGX lobe with a given roughness/alpha as SH_L2_F16 zonal harmonics, using a fitted curve
+f16vec3 SH_ApproximateGGXAsL2ZH_F16(float16_t ggxAlpha)
+{
+    const float16_t l1Scale = 1.66711256633276hf / (1.65715038133932hf + ggxAlpha);
+    const float16_t l2Scale = 1.56127990596116hf / (0.96989757593282hf + ggxAlpha) - 0.599972342361123hf;
+    return f16vec3(1.0hf, l1Scale, l2Scale);
+}
+
+// Convolves a set of SH_L1_F16 SH coefficients with a GGX lobe for a given roughness/alpha
+SH_L1_F16 SH_ConvolveWithGGX(SH_L1_F16 sh, float16_t ggxAlpha)
+{
+    return SH_ConvolveWithZH(sh, SH_ApproximateGGXAsL1ZH_F16(ggxAlpha));
+}
+
+SH_L1_F16_RGB SH_ConvolveWithGGX(SH_L1_F16_RGB sh, float16_t ggxAlpha)
+{
+    return SH_ConvolveWithZH(sh, SH_ApproximateGGXAsL1ZH_F16(ggxAlpha));
+}
+
+// Convolves a set of SH_L2_F16 SH coefficients with a GGX lobe for a given roughness/alpha
+SH_L2_F16 SH_ConvolveWithGGX(SH_L2_F16 sh, float16_t ggxAlpha)
+{
+    return SH_ConvolveWithZH(sh, SH_ApproximateGGXAsL2ZH_F16(ggxAlpha));
+}
+
+SH_L2_F16_RGB SH_ConvolveWithGGX(SH_L2_F16_RGB sh, float16_t ggxAlpha)
+{
+    return SH_ConvolveWithZH(sh, SH_ApproximateGGXAsL2ZH_F16(ggxAlpha));
+}
+
+// Computes the zonal harmonics for a cone of constant unit radiance with the given half-angle, including the
+// sqrt(4 * Pi / (2l + 1)) factor for rotating ZH. The result can be passed to SH_ConvolveWithZH along with
+// the radiance projected in the direction of the cone's axis. See [0]
+f16vec2 SH_ConeAsL1ZH_F16(float16_t cosHalfAngle, float16_t sinSqHalfAngle)
+{
+    const float16_t oneMinusCos = sinSqHalfAngle / (1.0hf + cosHalfAngle);
+    return f16vec2(float16_t(2.0 * M_PI) * oneMinusCos, float16_t(M_PI) * sinSqHalfAngle);
+}
+
+f16vec2 SH_ConeAsL1ZH_F16(float16_t cosHalfAngle)
+{
+    return SH_ConeAsL1ZH_F16(cosHalfAngle, clamp(1.0hf - cosHalfAngle * cosHalfAngle, 0.0hf, 1.0hf));
+}
+
+f16vec3 SH_ConeAsL2ZH_F16(float16_t cosHalfAngle, float16_t sinSqHalfAngle)
+{
+    const float16_t oneMinusCos = sinSqHalfAngle / (1.0hf + cosHalfAngle);
+    return f16vec3(float16_t(2.0 * M_PI) * oneMinusCos, float16_t(M_PI) * sinSqHalfAngle, float16_t(M_PI) * cosHalfAngle * sinSqHalfAngle);
+}
+
+f16vec3 SH_ConeAsL2ZH_F16(float16_t cosHalfAngle)
+{
+    return SH_ConeAsL2ZH_F16(cosHalfAngle, clamp(1.0hf - cosHalfAngle * cosHalfAngle, 0.0hf, 1.0hf));
+}
+
+// Computes a windowed falloff factor that smoothly reaches zero at the given range. The squared falloff range
+// overflows fp16 past 256 units, so the window is computed in fp32.
+float16_t SH_DistanceFalloffWindow_F16(float16_t distanceSq, float16_t falloffRange)
+{
+    return float16_t(SH_DistanceFalloffWindow(float(distanceSq), float(falloffRange)));
+}
+
+// Squared distances overflow fp16 past 256 units, so the _F16 light projections below compute them, and the
+// ratios derived from them, in fp32 and only convert the resulting direction and ZH back to fp16
+float SH_DistanceSquaredF32(f16vec3 offset)
+{
+    const vec3 offsetF32 = vec3(offset);
+    return dot(offsetF32, offsetF32);
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of SH_L1_F16 SH coefficients
+SH_L1_F16 SH_ProjectConeOntoL1_F16(f16vec3 axis, float16_t cosHalfAngle, float16_t radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_F16(axis, radiance), SH_ConeAsL1ZH_F16(cosHalfAngle));
+}
+
+SH_L1_F16_RGB SH_ProjectConeOntoL1_F16_RGB(f16vec3 axis, float16_t cosHalfAngle, f16vec3 radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_F16_RGB(axis, radiance), SH_ConeAsL1ZH_F16(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of SH_L1_F16 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies SH_DistanceFalloffWindow_F16.
+SH_L1_F16 SH_ProjectSphereOntoL1_F16(f16vec3 offset, float16_t radius, float16_t radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    const f16vec3 axis = f16vec3(vec3(offset) * inversesqrt(distanceSq));
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_F16(axis, radiance), f16vec2(SH_ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+SH_L1_F16 SH_ProjectSphereOntoL1_F16(f16vec3 offset, float16_t radius, float16_t radiance, float16_t falloffRange)
+{
+    return SH_ProjectSphereOntoL1_F16(offset, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+SH_L1_F16_RGB SH_ProjectSphereOntoL1_F16_RGB(f16vec3 offset, float16_t radius, f16vec3 radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    const f16vec3 axis = f16vec3(vec3(offset) * inversesqrt(distanceSq));
+    return SH_ConvolveWithZH(SH_ProjectOntoL1_F16_RGB(axis, radiance), f16vec2(SH_ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+SH_L1_F16_RGB SH_ProjectSphereOntoL1_F16_RGB(f16vec3 offset, float16_t radius, f16vec3 radiance, float16_t falloffRange)
+{
+    return SH_ProjectSphereOntoL1_F16_RGB(offset, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of SH_L1_F16 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+SH_L1_F16 SH_ProjectDiskOntoL1_F16(f16vec3 offset, f16vec3 diskNormal, float16_t radius, float16_t radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const vec3 axis = vec3(offset) * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, vec3(diskNormal)), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return SH_ProjectConeOntoL1_F16(f16vec3(axis), float16_t(1.0 - oneMinusCos), radiance);
+}
+
+SH_L1_F16 SH_ProjectDiskOntoL1_F16(f16vec3 offset, f16vec3 diskNormal, float16_t radius, float16_t radiance, float16_t falloffRange)
+{
+    return SH_ProjectDiskOntoL1_F16(offset, diskNormal, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+SH_L1_F16_RGB SH_ProjectDiskOntoL1_F16_RGB(f16vec3 offset, f16vec3 diskNormal, float16_t radius, f16vec3 radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const vec3 axis = vec3(offset) * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, vec3(diskNormal)), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return SH_ProjectConeOntoL1_F16_RGB(f16vec3(axis), float16_t(1.0 - oneMinusCos), radiance);
+}
+
+SH_L1_F16_RGB SH_ProjectDiskOntoL1_F16_RGB(f16vec3 offset, f16vec3 diskNormal, float16_t radius, f16vec3 radiance, float16_t falloffRange)
+{
+    return SH_ProjectDiskOntoL1_F16_RGB(offset, diskNormal, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of SH_L2_F16 SH coefficients
+SH_L2_F16 SH_ProjectConeOntoL2_F16(f16vec3 axis, float16_t cosHalfAngle, float16_t radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_F16(axis, radiance), SH_ConeAsL2ZH_F16(cosHalfAngle));
+}
+
+SH_L2_F16_RGB SH_ProjectConeOntoL2_F16_RGB(f16vec3 axis, float16_t cosHalfAngle, f16vec3 radiance)
+{
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_F16_RGB(axis, radiance), SH_ConeAsL2ZH_F16(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of SH_L2_F16 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies SH_DistanceFalloffWindow_F16.
+SH_L2_F16 SH_ProjectSphereOntoL2_F16(f16vec3 offset, float16_t radius, float16_t radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    const f16vec3 axis = f16vec3(vec3(offset) * inversesqrt(distanceSq));
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_F16(axis, radiance), f16vec3(SH_ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+SH_L2_F16 SH_ProjectSphereOntoL2_F16(f16vec3 offset, float16_t radius, float16_t radiance, float16_t falloffRange)
+{
+    return SH_ProjectSphereOntoL2_F16(offset, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+SH_L2_F16_RGB SH_ProjectSphereOntoL2_F16_RGB(f16vec3 offset, float16_t radius, f16vec3 radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0);
+    const float cosHalfAngle = sqrt(1.0 - sinSqHalfAngle);
+    const f16vec3 axis = f16vec3(vec3(offset) * inversesqrt(distanceSq));
+    return SH_ConvolveWithZH(SH_ProjectOntoL2_F16_RGB(axis, radiance), f16vec3(SH_ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+SH_L2_F16_RGB SH_ProjectSphereOntoL2_F16_RGB(f16vec3 offset, float16_t radius, f16vec3 radiance, float16_t falloffRange)
+{
+    return SH_ProjectSphereOntoL2_F16_RGB(offset, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of SH_L2_F16 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+SH_L2_F16 SH_ProjectDiskOntoL2_F16(f16vec3 offset, f16vec3 diskNormal, float16_t radius, float16_t radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const vec3 axis = vec3(offset) * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, vec3(diskNormal)), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return SH_ProjectConeOntoL2_F16(f16vec3(axis), float16_t(1.0 - oneMinusCos), radiance);
+}
+
+SH_L2_F16 SH_ProjectDiskOntoL2_F16(f16vec3 offset, f16vec3 diskNormal, float16_t radius, float16_t radiance, float16_t falloffRange)
+{
+    return SH_ProjectDiskOntoL2_F16(offset, diskNormal, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+SH_L2_F16_RGB SH_ProjectDiskOntoL2_F16_RGB(f16vec3 offset, f16vec3 diskNormal, float16_t radius, f16vec3 radiance)
+{
+    const float distanceSq = SH_DistanceSquaredF32(offset);
+    const vec3 axis = vec3(offset) * inversesqrt(distanceSq);
+    const float cosTheta = clamp(-dot(axis, vec3(diskNormal)), 0.0, 1.0);
+    const float oneMinusCos = (1.0 - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return SH_ProjectConeOntoL2_F16_RGB(f16vec3(axis), float16_t(1.0 - oneMinusCos), radiance);
+}
+
+SH_L2_F16_RGB SH_ProjectDiskOntoL2_F16_RGB(f16vec3 offset, f16vec3 diskNormal, float16_t radius, f16vec3 radiance, float16_t falloffRange)
+{
+    return SH_ProjectDiskOntoL2_F16_RGB(offset, diskNormal, radius, radiance * float16_t(SH_DistanceFalloffWindow(SH_DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+
+// Given a set of SH_L1_F16 SH coefficients represnting incoming radiance, determines a directional light
+// direction, color, and modified roughness value that can be used to compute an approximate specular term. See [5]
+void SH_ExtractSpecularDirLight(SH_L1_F16 shRadiance, float16_t sqrtRoughness, out f16vec3 lightDir, out float16_t lightIntensity, out float16_t modifiedSqrtRoughness)
+{
+    f16vec3 avgL1 = f16vec3(shRadiance.C[3], shRadiance.C[1], shRadiance.C[2]);
+    avgL1 *= 0.5hf;
+    float16_t avgL1len = length(avgL1);
+
+    lightDir = avgL1 / avgL1len;
+    lightIntensity = SH_Evaluate(shRadiance, lightDir) * float16_t(M_PI);
+    modifiedSqrtRoughness = clamp(sqrtRoughness / sqrt(avgL1len), 0.0hf, 1.0hf);
+}
+
+void SH_ExtractSpecularDirLight(SH_L1_F16_RGB shRadiance, float16_t sqrtRoughness, out f16vec3 lightDir, out f16vec3 lightColor, out float16_t modifiedSqrtRoughness)
+{
+    f16vec3 avgL1 = f16vec3(dot(shRadiance.C[3] / shRadiance.C[0], f16vec3(0.33333333hf)), dot(shRadiance.C[1] / shRadiance.C[0], f16vec3(0.33333333hf)), dot(shRadiance.C[2] / shRadiance.C[0], f16vec3(0.33333333hf)));
+    avgL1 *= 0.5hf;
+    float16_t avgL1len = length(avgL1);
+
+    lightDir = avgL1 / avgL1len;
+    lightColor = SH_Evaluate(shRadiance, lightDir) * float16_t(M_PI);
+    modifiedSqrtRoughness = clamp(sqrtRoughness / sqrt(avgL1len), 0.0hf, 1.0hf);
+}
+
+// Rotates a set of SH_L1_F16 coefficients by a rotation matrix. The rotation is computed in fp32, and the
+// results are converted back to fp16. Adapted from DirectX::XMSHRotate [3]
+SH_L1_F16 SH_Rotate(SH_L1_F16 sh, mat3 rotation)
+{
+    const float r00 = rotation[0][0];
+    const float r10 = rotation[1][0];
+    const float r20 = -rotation[2][0];
+
+    const float r01 = rotation[0][1];
+    const float r11 = rotation[1][1];
+    const float r21 = -rotation[2][1];
+
+    const float r02 = -rotation[0][2];
+    const float r12 = -rotation[1][2];
+    const float r22 = rotation[2][2];
+
+    SH_L1_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = float16_t(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = float16_t(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = float16_t(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    return result;
+}
+SH_L1_F16 SH_Rotate(mat3 rotation, SH_L1_F16 sh)
+{
+    return SH_Rotate(sh, transpose(rotation));
+}
+
+SH_L1_F16_RGB SH_Rotate(SH_L1_F16_RGB sh, mat3 rotation)
+{
+    const float r00 = rotation[0][0];
+    const float r10 = rotation[1][0];
+    const float r20 = -rotation[2][0];
+
+    const float r01 = rotation[0][1];
+    const float r11 = rotation[1][1];
+    const float r21 = -rotation[2][1];
+
+    const float r02 = -rotation[0][2];
+    const float r12 = -rotation[1][2];
+    const float r22 = rotation[2][2];
+
+    SH_L1_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = f16vec3(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = f16vec3(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = f16vec3(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    return result;
+}
+SH_L1_F16_RGB SH_Rotate(mat3 rotation, SH_L1_F16_RGB sh)
+{
+    return SH_Rotate(sh, transpose(rotation));
+}
+
+// Rotates a set of SH_L2_F16 coefficients by a rotation matrix. The rotation is computed in fp32, and the
+// results are converted back to fp16. Adapted from DirectX::XMSHRotate [3]
+SH_L2_F16 SH_Rotate(SH_L2_F16 sh, mat3 rotation)
+{
+    const float r00 = rotation[0][0];
+    const float r10 = rotation[1][0];
+    const float r20 = -rotation[2][0];
+
+    const float r01 = rotation[0][1];
+    const float r11 = rotation[1][1];
+    const float r21 = -rotation[2][1];
+
+    const float r02 = -rotation[0][2];
+    const float r12 = -rotation[1][2];
+    const float r22 = rotation[2][2];
+
+    SH_L2_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // SH_L1
+    result.C[1] = float16_t(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = float16_t(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = float16_t(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // SH_L2
+    const float t41 = r01 * r00;
+    const float t43 = r11 * r10;
+    const float t48 = r11 * r12;
+    const float t50 = r01 * r02;
+    const float t55 = r02 * r02;
+    const float t57 = r22 * r22;
+    const float t58 = r12 * r12;
+    const float t61 = r00 * r02;
+    const float t63 = r10 * r12;
+    const float t68 = r10 * r10;
+    const float t70 = r01 * r01;
+    const float t72 = r11 * r11;
+    const float t74 = r00 * r00;
+    const float t76 = r21 * r21;
+    const float t78 = r20 * r20;
+
+    const float v173 = 0.1732050808e1;
+    const float v577 = 0.5773502693e0;
+    const float v115 = 0.1154700539e1;
+    const float v288 = 0.2886751347e0;
+    const float v866 = 0.8660254040e0;
+
+    float r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = -0.5 * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = 0.5 * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = float16_t(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                                    r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                                    r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+SH_L2_F16 SH_Rotate(mat3 rotation, SH_L2_F16 sh)
+{
+    return SH_Rotate(sh, transpose(rotation));
+}
+
+SH_L2_F16_RGB SH_Rotate(SH_L2_F16_RGB sh, mat3 rotation)
+{
+    const float r00 = rotation[0][0];
+    const float r10 = rotation[1][0];
+    const float r20 = -rotation[2][0];
+
+    const float r01 = rotation[0][1];
+    const float r11 = rotation[1][1];
+    const float r21 = -rotation[2][1];
+
+    const float r02 = -rotation[0][2];
+    const float r12 = -rotation[1][2];
+    const float r22 = rotation[2][2];
+
+    SH_L2_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // SH_L1
+    result.C[1] = f16vec3(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = f16vec3(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = f16vec3(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // SH_L2_F16_RGB
+    const float t41 = r01 * r00;
+    const float t43 = r11 * r10;
+    const float t48 = r11 * r12;
+    const float t50 = r01 * r02;
+    const float t55 = r02 * r02;
+    const float t57 = r22 * r22;
+    const float t58 = r12 * r12;
+    const float t61 = r00 * r02;
+    const float t63 = r10 * r12;
+    const float t68 = r10 * r10;
+    const float t70 = r01 * r01;
+    const float t72 = r11 * r11;
+    const float t74 = r00 * r00;
+    const float t76 = r21 * r21;
+    const float t78 = r20 * r20;
+
+    const float v173 = 0.1732050808e1;
+    const float v577 = 0.5773502693e0;
+    const float v115 = 0.1154700539e1;
+    const float v288 = 0.2886751347e0;
+    const float v866 = 0.8660254040e0;
+
+    float r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = -0.5 * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = 0.5 * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = f16vec3(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                                  r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                                  r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+SH_L2_F16_RGB SH_Rotate(mat3 rotation, SH_L2_F16_RGB sh)
+{
+    return SH_Rotate(sh, transpose(rotation));
+}
+
+// Rotates a set of SH_L1_F16 coefficients by a unit quaternion, performing the rotation in fp16
+SH_L1_F16 SH_Rotate(SH_L1_F16 sh, f16vec4 quaternion)
+{
+    SH_L1_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    f16vec3 dir = f16vec3(sh.C[3], sh.C[1], sh.C[2]);
+    const f16vec3 t = 2.0hf * cross(quaternion.xyz, dir);
+    dir += quaternion.w * t + cross(quaternion.xyz, t);
+    result.C[3] = dir.x;
+    result.C[1] = dir.y;
+    result.C[2] = dir.z;
+
+    return result;
+}
+
+SH_L1_F16_RGB SH_Rotate(SH_L1_F16_RGB sh, f16vec4 quaternion)
+{
+    SH_L1_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    for(uint i = 0; i < 3; ++i)
+    {
+        f16vec3 dir = f16vec3(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        const f16vec3 t = 2.0hf * cross(quaternion.xyz, dir);
+        dir += quaternion.w * t + cross(quaternion.xyz, t);
+        result.C[3][i] = dir.x;
+        result.C[1][i] = dir.y;
+        result.C[2][i] = dir.z;
+    }
+
+    return result;
+}
+
+// Rotates a set of SH_L2_F16 coefficients by a unit quaternion. Like the matrix versions, the band 2
+// rotation is computed in fp32 and the results are converted back to fp16.
+SH_L2_F16 SH_Rotate(SH_L2_F16 sh, f16vec4 quaternion)
+{
+    return SH_Rotate(SH_QuaternionToRotationMatrix(vec4(quaternion)), sh);
+}
+
+SH_L2_F16_RGB SH_Rotate(SH_L2_F16_RGB sh, f16vec4 quaternion)
+{
+    return SH_Rotate(SH_QuaternionToRotationMatrix(vec4(quaternion)), sh);
+}
+
+
+#endif // SH_ENABLE_F16
+
 // References:
 //
 // [0] Stupid SH Tricks by Peter-Pike Sloan - https://www.ppsloan.org/publications/StupidSH36.pdf
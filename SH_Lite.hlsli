@@ -23,7 +23,11 @@
 // L2 for clarity.
 //
 // The core SH types all use 32-bit floats for storing coefficients, with either 1 scalar or 3
-// floats for separate RGB coefficients.
+// floats for separate RGB coefficients. Half-precision variants of each type are also available
+// with an _F16 suffix (L1_F16, L1_F16_RGB, L2_F16, and L2_F16_RGB). These use float16_t when
+// compiling with -enable-16bit-types, and otherwise fall back to min16float so that they still
+// work with FXC and older shader models. The functions that don't take an SH type as an argument
+// have an _F16 suffix for the half-precision variant, for example ProjectOntoL2_F16_RGB.
 //
 // Example #1: integrating and projecting radiance onto L2 SH
 //
@@ -66,6 +70,21 @@ static const float BasisL2_M0 = sqrt(5) / (4 * SqrtPi);
 static const float BasisL2_M1 = sqrt(15) / (2 * SqrtPi);
 static const float BasisL2_M2 = sqrt(15) / (4 * SqrtPi);
 
+// Half-precision scalar and vector types used by the _F16 SH types
+#if defined(__HLSL_ENABLE_16_BIT) && __HLSL_ENABLE_16_BIT
+typedef float16_t Half;
+typedef float16_t2 Half2;
+typedef float16_t3 Half3;
+typedef float16_t4 Half4;
+typedef float16_t3x3 Half3x3;
+#else
+typedef min16float Half;
+typedef min16float2 Half2;
+typedef min16float3 Half3;
+typedef min16float4 Half4;
+typedef min16float3x3 Half3x3;
+#endif
+
 // Core SH types containing the coefficients
 struct L1
 {
@@ -115,6 +134,54 @@ struct L2_RGB
     }
 };
 
+struct L1_F16
+{
+    static const uint NumCoefficients = 4;
+
+    Half C[NumCoefficients];
+
+    static L1_F16 Zero()
+    {
+        return (L1_F16)0;
+    }
+};
+
+struct L1_F16_RGB
+{
+    static const uint NumCoefficients = 4;
+
+    Half3 C[NumCoefficients];
+
+    static L1_F16_RGB Zero()
+    {
+        return (L1_F16_RGB)0;
+    }
+};
+
+struct L2_F16
+{
+    static const uint NumCoefficients = 9;
+
+    Half C[NumCoefficients];
+
+    static L2_F16 Zero()
+    {
+        return (L2_F16)0;
+    }
+};
+
+struct L2_F16_RGB
+{
+    static const uint NumCoefficients = 9;
+
+    Half3 C[NumCoefficients];
+
+    static L2_F16_RGB Zero()
+    {
+        return (L2_F16_RGB)0;
+    }
+};
+
 // Sum two sets of SH coefficients
 L1 Add(L1 a, L1 b)
 {
@@ -148,6 +215,38 @@ L2_RGB Add(L2_RGB a, L2_RGB b)
     return a;
 }
 
+L1_F16 Add(L1_F16 a, L1_F16 b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+L1_F16_RGB Add(L1_F16_RGB a, L1_F16_RGB b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+L2_F16 Add(L2_F16 a, L2_F16 b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
+L2_F16_RGB Add(L2_F16_RGB a, L2_F16_RGB b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+        a.C[i] += b.C[i];
+    return a;
+}
+
 // Substract two sets of SH coefficients
 L1 Subtract(L1 a, L1 b)
 {
@@ -181,6 +280,38 @@ L2_RGB Subtract(L2_RGB a, L2_RGB b)
     return a;
 }
 
+L1_F16 Subtract(L1_F16 a, L1_F16 b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+L1_F16_RGB Subtract(L1_F16_RGB a, L1_F16_RGB b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+L2_F16 Subtract(L2_F16 a, L2_F16 b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
+L2_F16_RGB Subtract(L2_F16_RGB a, L2_F16_RGB b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+        a.C[i] -= b.C[i];
+    return a;
+}
+
 // Multiply a set of SH coefficients by a single value
 L1 Multiply(L1 a, float b)
 {
@@ -214,6 +345,38 @@ L2_RGB Multiply(L2_RGB a, float3 b)
     return a;
 }
 
+L1_F16 Multiply(L1_F16 a, Half b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+L1_F16_RGB Multiply(L1_F16_RGB a, Half3 b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+L2_F16 Multiply(L2_F16 a, Half b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
+L2_F16_RGB Multiply(L2_F16_RGB a, Half3 b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+        a.C[i] *= b;
+    return a;
+}
+
 // Divide a set of SH coefficients by a single value
 L1 Divide(L1 a, float b)
 {
@@ -247,6 +410,38 @@ L2_RGB Divide(L2_RGB a, float3 b)
     return a;
 }
 
+L1_F16 Divide(L1_F16 a, Half b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+L1_F16_RGB Divide(L1_F16_RGB a, Half3 b)
+{
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+L2_F16 Divide(L2_F16 a, Half b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
+L2_F16_RGB Divide(L2_F16_RGB a, Half3 b)
+{
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+        a.C[i] /= b;
+    return a;
+}
+
 // Truncates a set of L2 coefficients to produce a set of L1 coefficients
 L1 L2toL1(L2 sh)
 {
@@ -266,6 +461,24 @@ L1_RGB L2toL1(L2_RGB sh)
     return result;
 }
 
+L1_F16 L2toL1(L2_F16 sh)
+{
+    L1_F16 result;
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
+L1_F16_RGB L2toL1(L2_F16_RGB sh)
+{
+    L1_F16_RGB result;
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
 // Converts from scalar to RGB SH coefficients
 L1_RGB ToRGB(L1 sh)
 {
@@ -285,6 +498,24 @@ L2_RGB ToRGB(L2 sh)
     return result;
 }
 
+L1_F16_RGB ToRGB(L1_F16 sh)
+{
+    L1_F16_RGB result;
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
+L2_F16_RGB ToRGB(L2_F16 sh)
+{
+    L2_F16_RGB result;
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        result.C[i] = sh.C[i];
+    return result;
+}
+
 // Linear interpolation
 L1 Lerp(L1 x, L1 y, float s)
 {
@@ -306,6 +537,150 @@ L2_RGB Lerp(L2_RGB x, L2_RGB y, float s)
     return Add(Multiply(x, 1.0f - s), Multiply(y, s));
 }
 
+L1_F16 Lerp(L1_F16 x, L1_F16 y, Half s)
+{
+    return Add(Multiply(x, Half(1.0f) - s), Multiply(y, s));
+}
+
+L1_F16_RGB Lerp(L1_F16_RGB x, L1_F16_RGB y, Half s)
+{
+    return Add(Multiply(x, Half(1.0f) - s), Multiply(y, s));
+}
+
+L2_F16 Lerp(L2_F16 x, L2_F16 y, Half s)
+{
+    return Add(Multiply(x, Half(1.0f) - s), Multiply(y, s));
+}
+
+L2_F16_RGB Lerp(L2_F16_RGB x, L2_F16_RGB y, Half s)
+{
+    return Add(Multiply(x, Half(1.0f) - s), Multiply(y, s));
+}
+
+// Blends 8 sets of SH coefficients with per-set weights in a single pass, for example the 8 probes
+// surrounding a point in a probe grid with trilinear weights. Each coefficient is accumulated with
+// one multiply-add per set instead of chaining Lerp calls through temporaries. The weights are used
+// as-is, so they should already sum to 1 if the result needs to be normalized.
+L1 WeightedSum(L1 sh[8], float weights[8])
+{
+    L1 result;
+    [unroll]
+    for(uint i = 0; i < L1::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L1_RGB WeightedSum(L1_RGB sh[8], float weights[8])
+{
+    L1_RGB result;
+    [unroll]
+    for(uint i = 0; i < L1_RGB::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L2 WeightedSum(L2 sh[8], float weights[8])
+{
+    L2 result;
+    [unroll]
+    for(uint i = 0; i < L2::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L2_RGB WeightedSum(L2_RGB sh[8], float weights[8])
+{
+    L2_RGB result;
+    [unroll]
+    for(uint i = 0; i < L2_RGB::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L1_F16 WeightedSum(L1_F16 sh[8], Half weights[8])
+{
+    L1_F16 result;
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L1_F16_RGB WeightedSum(L1_F16_RGB sh[8], Half weights[8])
+{
+    L1_F16_RGB result;
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L2_F16 WeightedSum(L2_F16 sh[8], Half weights[8])
+{
+    L2_F16 result;
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
+L2_F16_RGB WeightedSum(L2_F16_RGB sh[8], Half weights[8])
+{
+    L2_F16_RGB result;
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+    {
+        result.C[i] = sh[0].C[i] * weights[0];
+        [unroll]
+        for(uint k = 1; k < 8; ++k)
+            result.C[i] += sh[k].C[i] * weights[k];
+    }
+
+    return result;
+}
+
 // Projects a value in a single direction onto a set of L1 SH coefficients
 L1 ProjectOntoL1(float3 direction, float value)
 {
@@ -337,6 +712,36 @@ L1_RGB ProjectOntoL1_RGB(float3 direction, float3 value)
     return sh;
 }
 
+L1_F16 ProjectOntoL1_F16(Half3 direction, Half value)
+{
+    L1_F16 sh;
+
+    // L0
+    sh.C[0] = Half(BasisL0) * value;
+
+    // L1
+    sh.C[1] = Half(BasisL1) * direction.y * value;
+    sh.C[2] = Half(BasisL1) * direction.z * value;
+    sh.C[3] = Half(BasisL1) * direction.x * value;
+
+    return sh;
+}
+
+L1_F16_RGB ProjectOntoL1_F16_RGB(Half3 direction, Half3 value)
+{
+    L1_F16_RGB sh;
+
+    // L0
+    sh.C[0] = Half(BasisL0) * value;
+
+    // L1
+    sh.C[1] = Half(BasisL1) * direction.y * value;
+    sh.C[2] = Half(BasisL1) * direction.z * value;
+    sh.C[3] = Half(BasisL1) * direction.x * value;
+
+    return sh;
+}
+
 // Projects a value in a single direction onto a set of L2 SH coefficients
 L2 ProjectOntoL2(float3 direction, float value)
 {
@@ -382,7 +787,51 @@ L2_RGB ProjectOntoL2_RGB(float3 direction, float3 value)
     return sh;
 }
 
-// Calculates the dot product of two sets of L1 SH coefficients
+L2_F16 ProjectOntoL2_F16(Half3 direction, Half value)
+{
+    L2_F16 sh;
+
+    // L0
+    sh.C[0] = Half(BasisL0) * value;
+
+    // L1
+    sh.C[1] = Half(BasisL1) * direction.y * value;
+    sh.C[2] = Half(BasisL1) * direction.z * value;
+    sh.C[3] = Half(BasisL1) * direction.x * value;
+
+    // L2
+    sh.C[4] = Half(BasisL2_MN2) * direction.x * direction.y * value;
+    sh.C[5] = Half(BasisL2_MN1) * direction.y * direction.z * value;
+    sh.C[6] = Half(BasisL2_M0) * (Half(3.0f) * direction.z * direction.z - Half(1.0f)) * value;
+    sh.C[7] = Half(BasisL2_M1) * direction.x * direction.z * value;
+    sh.C[8] = Half(BasisL2_M2) * (direction.x * direction.x - direction.y * direction.y) * value;
+
+    return sh;
+}
+
+L2_F16_RGB ProjectOntoL2_F16_RGB(Half3 direction, Half3 value)
+{
+    L2_F16_RGB sh;
+
+    // L0
+    sh.C[0] = Half(BasisL0) * value;
+
+    // L1
+    sh.C[1] = Half(BasisL1) * direction.y * value;
+    sh.C[2] = Half(BasisL1) * direction.z * value;
+    sh.C[3] = Half(BasisL1) * direction.x * value;
+
+    // L2
+    sh.C[4] = Half(BasisL2_MN2) * direction.x * direction.y * value;
+    sh.C[5] = Half(BasisL2_MN1) * direction.y * direction.z * value;
+    sh.C[6] = Half(BasisL2_M0) * (Half(3.0f) * direction.z * direction.z - Half(1.0f)) * value;
+    sh.C[7] = Half(BasisL2_M1) * direction.x * direction.z * value;
+    sh.C[8] = Half(BasisL2_M2) * (direction.x * direction.x - direction.y * direction.y) * value;
+
+    return sh;
+}
+
+// Calculates the dot product of two sets of L1 SH coefficients
 float DotProduct(L1 a, L1 b)
 {
     float result = 0.0f;
@@ -403,6 +852,26 @@ float3 DotProduct(L1_RGB a, L1_RGB b)
     return result;
 }
 
+Half DotProduct(L1_F16 a, L1_F16 b)
+{
+    Half result = Half(0.0f);
+    [unroll]
+    for(uint i = 0; i < L1_F16::NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+Half3 DotProduct(L1_F16_RGB a, L1_F16_RGB b)
+{
+    Half3 result = Half(0.0f);
+    [unroll]
+    for(uint i = 0; i < L1_F16_RGB::NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
 // Calculates the dot product of two sets of L2 SH coefficients
 float DotProduct(L2 a, L2 b)
 {
@@ -424,6 +893,26 @@ float3 DotProduct(L2_RGB a, L2_RGB b)
     return result;
 }
 
+Half DotProduct(L2_F16 a, L2_F16 b)
+{
+    Half result = Half(0.0f);
+    [unroll]
+    for(uint i = 0; i < L2_F16::NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
+Half3 DotProduct(L2_F16_RGB a, L2_F16_RGB b)
+{
+    Half3 result = Half(0.0f);
+    [unroll]
+    for(uint i = 0; i < L2_F16_RGB::NumCoefficients; ++i)
+        result += a.C[i] * b.C[i];
+
+    return result;
+}
+
 // Projects a delta in a direction onto SH and calculates the dot product with a set of L1 SH coefficients.
 // Can be used to "look up" a value from SH coefficients in a particular direction.
 float Evaluate(L1 sh, float3 direction)
@@ -438,6 +927,18 @@ float3 Evaluate(L1_RGB sh, float3 direction)
     return DotProduct(projectedDelta, sh);
 }
 
+Half Evaluate(L1_F16 sh, Half3 direction)
+{
+    L1_F16 projectedDelta = ProjectOntoL1_F16(direction, Half(1.0f));
+    return DotProduct(projectedDelta, sh);
+}
+
+Half3 Evaluate(L1_F16_RGB sh, Half3 direction)
+{
+    L1_F16_RGB projectedDelta = ProjectOntoL1_F16_RGB(direction, Half(1.0f));
+    return DotProduct(projectedDelta, sh);
+}
+
 // Projects a delta in a direction onto SH and calculates the dot product with a set of L2 SH coefficients.
 // Can be used to "look up" a value from SH coefficients in a particular direction.
 float Evaluate(L2 sh, float3 direction)
@@ -452,6 +953,110 @@ float3 Evaluate(L2_RGB sh, float3 direction)
     return DotProduct(projectedDelta, sh);
 }
 
+Half Evaluate(L2_F16 sh, Half3 direction)
+{
+    L2_F16 projectedDelta = ProjectOntoL2_F16(direction, Half(1.0f));
+    return DotProduct(projectedDelta, sh);
+}
+
+Half3 Evaluate(L2_F16_RGB sh, Half3 direction)
+{
+    L2_F16_RGB projectedDelta = ProjectOntoL2_F16_RGB(direction, Half(1.0f));
+    return DotProduct(projectedDelta, sh);
+}
+
+// Evaluates the weighted blend of 8 sets of SH coefficients in a direction, without blending the
+// coefficients themselves. The basis for the direction is projected once and each set then costs a
+// single weighted dot product, which is cheaper than WeightedSum followed by Evaluate when the blended
+// coefficients aren't needed for anything else.
+float WeightedEvaluate(L1 sh[8], float weights[8], float3 direction)
+{
+    const L1 projectedDelta = ProjectOntoL1(direction, 1.0f);
+    float result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+float3 WeightedEvaluate(L1_RGB sh[8], float weights[8], float3 direction)
+{
+    const L1_RGB projectedDelta = ProjectOntoL1_RGB(direction, 1.0f);
+    float3 result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+float WeightedEvaluate(L2 sh[8], float weights[8], float3 direction)
+{
+    const L2 projectedDelta = ProjectOntoL2(direction, 1.0f);
+    float result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+float3 WeightedEvaluate(L2_RGB sh[8], float weights[8], float3 direction)
+{
+    const L2_RGB projectedDelta = ProjectOntoL2_RGB(direction, 1.0f);
+    float3 result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+Half WeightedEvaluate(L1_F16 sh[8], Half weights[8], Half3 direction)
+{
+    const L1_F16 projectedDelta = ProjectOntoL1_F16(direction, Half(1.0f));
+    Half result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+Half3 WeightedEvaluate(L1_F16_RGB sh[8], Half weights[8], Half3 direction)
+{
+    const L1_F16_RGB projectedDelta = ProjectOntoL1_F16_RGB(direction, Half(1.0f));
+    Half3 result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+Half WeightedEvaluate(L2_F16 sh[8], Half weights[8], Half3 direction)
+{
+    const L2_F16 projectedDelta = ProjectOntoL2_F16(direction, Half(1.0f));
+    Half result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
+Half3 WeightedEvaluate(L2_F16_RGB sh[8], Half weights[8], Half3 direction)
+{
+    const L2_F16_RGB projectedDelta = ProjectOntoL2_F16_RGB(direction, Half(1.0f));
+    Half3 result = DotProduct(projectedDelta, sh[0]) * weights[0];
+    [unroll]
+    for(uint k = 1; k < 8; ++k)
+        result += DotProduct(projectedDelta, sh[k]) * weights[k];
+
+    return result;
+}
+
 // Convolves a set of L1 SH coefficients with a set of L1 zonal harmonics
 L1 ConvolveWithZH(L1 sh, float2 zh)
 {
@@ -479,6 +1084,32 @@ L1_RGB ConvolveWithZH(L1_RGB sh, float2 zh)
     return sh;
 }
 
+L1_F16 ConvolveWithZH(L1_F16 sh, Half2 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    return sh;
+}
+
+L1_F16_RGB ConvolveWithZH(L1_F16_RGB sh, Half2 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    return sh;
+}
+
 // Convolves a set of L2 SH coefficients with a set of L2 zonal harmonics
 L2 ConvolveWithZH(L2 sh, float3 zh)
 {
@@ -520,6 +1151,46 @@ L2_RGB ConvolveWithZH(L2_RGB sh, float3 zh)
     return sh;
 }
 
+L2_F16 ConvolveWithZH(L2_F16 sh, Half3 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    // L2
+    sh.C[4] *= zh.z;
+    sh.C[5] *= zh.z;
+    sh.C[6] *= zh.z;
+    sh.C[7] *= zh.z;
+    sh.C[8] *= zh.z;
+
+    return sh;
+}
+
+L2_F16_RGB ConvolveWithZH(L2_F16_RGB sh, Half3 zh)
+{
+    // L0
+    sh.C[0] *= zh.x;
+
+    // L1
+    sh.C[1] *= zh.y;
+    sh.C[2] *= zh.y;
+    sh.C[3] *= zh.y;
+
+    // L2
+    sh.C[4] *= zh.z;
+    sh.C[5] *= zh.z;
+    sh.C[6] *= zh.z;
+    sh.C[7] *= zh.z;
+    sh.C[8] *= zh.z;
+
+    return sh;
+}
+
 // Convolves a set of L1 SH coefficients with a cosine lobe. See [2]
 L1 ConvolveWithCosineLobe(L1 sh)
 {
@@ -531,6 +1202,16 @@ L1_RGB ConvolveWithCosineLobe(L1_RGB sh)
     return ConvolveWithZH(sh, float2(CosineA0, CosineA1));
 }
 
+L1_F16 ConvolveWithCosineLobe(L1_F16 sh)
+{
+    return ConvolveWithZH(sh, Half2(CosineA0, CosineA1));
+}
+
+L1_F16_RGB ConvolveWithCosineLobe(L1_F16_RGB sh)
+{
+    return ConvolveWithZH(sh, Half2(CosineA0, CosineA1));
+}
+
 // Convolves a set of L2 SH coefficients with a cosine lobe. See [2]
 L2 ConvolveWithCosineLobe(L2 sh)
 {
@@ -542,6 +1223,16 @@ L2_RGB ConvolveWithCosineLobe(L2_RGB sh)
     return ConvolveWithZH(sh, float3(CosineA0, CosineA1, CosineA2));
 }
 
+L2_F16 ConvolveWithCosineLobe(L2_F16 sh)
+{
+    return ConvolveWithZH(sh, Half3(CosineA0, CosineA1, CosineA2));
+}
+
+L2_F16_RGB ConvolveWithCosineLobe(L2_F16_RGB sh)
+{
+    return ConvolveWithZH(sh, Half3(CosineA0, CosineA1, CosineA2));
+}
+
 // Computes the "optimal linear direction" for a set of SH coefficients, AKA the "dominant" direction. See [0].
 float3 OptimalLinearDirection(L1 sh)
 {
@@ -560,6 +1251,23 @@ float3 OptimalLinearDirection(L1_RGB sh)
     return normalize(direction);
 }
 
+Half3 OptimalLinearDirection(L1_F16 sh)
+{
+    return normalize(Half3(sh.C[3], sh.C[1], sh.C[2]));
+}
+
+Half3 OptimalLinearDirection(L1_F16_RGB sh)
+{
+    Half3 direction = Half(0.0f);
+    for(uint i = 0; i < 3; ++i)
+    {
+        direction.x += sh.C[3][i];
+        direction.y += sh.C[1][i];
+        direction.z += sh.C[2][i];
+    }
+    return normalize(direction);
+}
+
 // Computes the direction and color of a directional light that approximates a set of L1 SH coefficients. See [0].
 void ApproximateDirectionalLight(L1 sh, out float3 direction, out float intensity)
 {
@@ -577,6 +1285,22 @@ void ApproximateDirectionalLight(L1_RGB sh, out float3 direction, out float3 col
     color = DotProduct(dirSH, sh) * (867.0f / (316.0f * Pi));
 }
 
+void ApproximateDirectionalLight(L1_F16 sh, out Half3 direction, out Half intensity)
+{
+    direction = OptimalLinearDirection(sh);
+    L1_F16 dirSH = ProjectOntoL1_F16(direction, Half(1.0f));
+    dirSH.C[0] = Half(0.0f);
+    intensity = DotProduct(dirSH, sh) * Half(867.0f / (316.0f * Pi));
+}
+
+void ApproximateDirectionalLight(L1_F16_RGB sh, out Half3 direction, out Half3 color)
+{
+    direction = OptimalLinearDirection(sh);
+    L1_F16_RGB dirSH = ProjectOntoL1_F16_RGB(direction, Half(1.0f));
+    dirSH.C[0] = Half(0.0f);
+    color = DotProduct(dirSH, sh) * Half(867.0f / (316.0f * Pi));
+}
+
 // Calculates the irradiance from a set of SH coefficients containing projected radiance.
 // Convolves the radiance with a cosine lobe, and then evaluates the result in the given normal direction.
 // Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
@@ -594,6 +1318,18 @@ float3 CalculateIrradiance(L1_RGB sh, float3 normal)
     return Evaluate(convolved, normal);
 }
 
+Half CalculateIrradiance(L1_F16 sh, Half3 normal)
+{
+    L1_F16 convolved = ConvolveWithCosineLobe(sh);
+    return Evaluate(convolved, normal);
+}
+
+Half3 CalculateIrradiance(L1_F16_RGB sh, Half3 normal)
+{
+    L1_F16_RGB convolved = ConvolveWithCosineLobe(sh);
+    return Evaluate(convolved, normal);
+}
+
 // Calculates the irradiance from a set of SH coefficients containing projected radiance.
 // Convolves the radiance with a cosine lobe, and then evaluates the result in the given normal direction.
 // Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
@@ -611,6 +1347,18 @@ float3 CalculateIrradiance(L2_RGB sh, float3 normal)
     return Evaluate(convolved, normal);
 }
 
+Half CalculateIrradiance(L2_F16 sh, Half3 normal)
+{
+    L2_F16 convolved = ConvolveWithCosineLobe(sh);
+    return Evaluate(convolved, normal);
+}
+
+Half3 CalculateIrradiance(L2_F16_RGB sh, Half3 normal)
+{
+    L2_F16_RGB convolved = ConvolveWithCosineLobe(sh);
+    return Evaluate(convolved, normal);
+}
+
 // Calculates the irradiance from a set of L1 SH coeffecients using the non-linear fit from [1]
 // Note that this does not scale the irradiance by 1 / Pi: if using this result for Lambertian diffuse,
 // you will want to include the divide-by-pi that's part of the Lambertian BRDF.
@@ -639,6 +1387,30 @@ float3 CalculateIrradianceGeomerics(L1_RGB sh, float3 normal)
     return float3(CalculateIrradianceGeomerics(shr, normal), CalculateIrradianceGeomerics(shg, normal), CalculateIrradianceGeomerics(shb, normal));
 }
 
+Half CalculateIrradianceGeomerics(L1_F16 sh, Half3 normal)
+{
+    Half R0 = max(sh.C[0], Half(0.00001f));
+
+    Half3 R1 = Half(0.5f) * Half3(sh.C[3], sh.C[1], sh.C[2]);
+    Half lenR1 = max(length(R1), Half(0.00001f));
+
+    Half q = Half(0.5f) * (Half(1.0f) + dot(R1 / lenR1, normal));
+
+    Half p = Half(1.0f) + Half(2.0f) * lenR1 / R0;
+    Half a = (Half(1.0f) - lenR1 / R0) / (Half(1.0f) + lenR1 / R0);
+
+    return R0 * (a + (Half(1.0f) - a) * (p + Half(1.0f)) * pow(abs(q), p));
+}
+
+Half3 CalculateIrradianceGeomerics(L1_F16_RGB sh, Half3 normal)
+{
+    L1_F16 shr = { sh.C[0].x, sh.C[1].x, sh.C[2].x, sh.C[3].x };
+    L1_F16 shg = { sh.C[0].y, sh.C[1].y, sh.C[2].y, sh.C[3].y };
+    L1_F16 shb = { sh.C[0].z, sh.C[1].z, sh.C[2].z, sh.C[3].z };
+
+    return Half3(CalculateIrradianceGeomerics(shr, normal), CalculateIrradianceGeomerics(shg, normal), CalculateIrradianceGeomerics(shb, normal));
+}
+
 // Calculates the irradiance from a set of L1 SH coefficientions by 'hallucinating" L3 zonal harmonics. See [4].
 float CalculateIrradianceL1ZH3Hallucinate(L1 sh, float3 normal)
 {
@@ -675,6 +1447,41 @@ float3 CalculateIrradianceL1ZH3Hallucinate(L1_RGB sh, float3 normal)
     return baseIrradiance + ((Pi * 0.25f) * zonalL2Coeff * zhDir);
 }
 
+Half CalculateIrradianceL1ZH3Hallucinate(L1_F16 sh, Half3 normal)
+{
+    const Half3 zonalAxis = normalize(Half3(sh.C[3], sh.C[1], sh.C[2]));
+
+    Half ratio = abs(dot(Half3(sh.C[3], sh.C[1], sh.C[2]), zonalAxis)) / sh.C[0];
+
+    const Half zonalL2Coeff = sh.C[0] * (Half(0.08f) * ratio + Half(0.6f) * ratio * ratio);
+
+    const Half fZ = dot(zonalAxis, normal);
+    const Half zhDir = Half(sqrt(5.0f / (16.0f * Pi))) * (Half(3.0f) * fZ * fZ - Half(1.0f));
+
+    const Half baseIrradiance = CalculateIrradiance(sh, normal);
+
+    return baseIrradiance + (Half(Pi * 0.25f) * zonalL2Coeff * zhDir);
+}
+
+Half3 CalculateIrradianceL1ZH3Hallucinate(L1_F16_RGB sh, Half3 normal)
+{
+    const Half3 lumCoefficients = Half3(0.2126f, 0.7152f, 0.0722f);
+    const Half3 zonalAxis = normalize(Half3(dot(sh.C[3], lumCoefficients), dot(sh.C[1], lumCoefficients), dot(sh.C[2], lumCoefficients)));
+
+    Half3 ratio;
+    for(uint i = 0; i < 3; ++i)
+        ratio[i] = abs(dot(Half3(sh.C[3][i], sh.C[1][i], sh.C[2][i]), zonalAxis)) / sh.C[0][i];
+
+    const Half3 zonalL2Coeff = sh.C[0] * (Half(0.08f) * ratio + Half(0.6f) * ratio * ratio);
+
+    const Half fZ = dot(zonalAxis, normal);
+    const Half zhDir = Half(sqrt(5.0f / (16.0f * Pi))) * (Half(3.0f) * fZ * fZ - Half(1.0f));
+
+    const Half3 baseIrradiance = CalculateIrradiance(sh, normal);
+
+    return baseIrradiance + (Half(Pi * 0.25f) * zonalL2Coeff * zhDir);
+}
+
 // Approximates a GGX lobe with a given roughness/alpha as L1 zonal harmonics, using a fitted curve
 float2 ApproximateGGXAsL1ZH(float ggxAlpha)
 {
@@ -682,14 +1489,27 @@ float2 ApproximateGGXAsL1ZH(float ggxAlpha)
     return float2(1.0f, l1Scale);
 }
 
-// Approximates a GGX lobe with a given roughness/alpha as L2 zonal harmonics, using a fitted curve
-float3 ApproximateGGXAsL2ZH(float ggxAlpha)
+Half2 ApproximateGGXAsL1ZH_F16(Half ggxAlpha)
+{
+    const Half l1Scale = Half(1.66711256633276f) / (Half(1.65715038133932f) + ggxAlpha);
+    return Half2(1.0f, l1Scale);
+}
+
+// Approximates a GGX lobe with a given roughness/alpha as L2 zonal harmonics, using a fitted curve
+float3 ApproximateGGXAsL2ZH(float ggxAlpha)
 {
     const float l1Scale = 1.66711256633276f / (1.65715038133932f + ggxAlpha);
     const float l2Scale = 1.56127990596116f / (0.96989757593282f + ggxAlpha) - 0.599972342361123f;
     return float3(1.0f, l1Scale, l2Scale);
 }
 
+Half3 ApproximateGGXAsL2ZH_F16(Half ggxAlpha)
+{
+    const Half l1Scale = Half(1.66711256633276f) / (Half(1.65715038133932f) + ggxAlpha);
+    const Half l2Scale = Half(1.56127990596116f) / (Half(0.96989757593282f) + ggxAlpha) - Half(0.599972342361123f);
+    return Half3(1.0f, l1Scale, l2Scale);
+}
+
 // Convolves a set of L1 SH coefficients with a GGX lobe for a given roughness/alpha
 L1 ConvolveWithGGX(L1 sh, float ggxAlpha)
 {
@@ -701,6 +1521,16 @@ L1_RGB ConvolveWithGGX(L1_RGB sh, float ggxAlpha)
     return ConvolveWithZH(sh, ApproximateGGXAsL1ZH(ggxAlpha));
 }
 
+L1_F16 ConvolveWithGGX(L1_F16 sh, Half ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL1ZH_F16(ggxAlpha));
+}
+
+L1_F16_RGB ConvolveWithGGX(L1_F16_RGB sh, Half ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL1ZH_F16(ggxAlpha));
+}
+
 // Convolves a set of L2 SH coefficients with a GGX lobe for a given roughness/alpha
 L2 ConvolveWithGGX(L2 sh, float ggxAlpha)
 {
@@ -712,6 +1542,362 @@ L2_RGB ConvolveWithGGX(L2_RGB sh, float ggxAlpha)
     return ConvolveWithZH(sh, ApproximateGGXAsL2ZH(ggxAlpha));
 }
 
+L2_F16 ConvolveWithGGX(L2_F16 sh, Half ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL2ZH_F16(ggxAlpha));
+}
+
+L2_F16_RGB ConvolveWithGGX(L2_F16_RGB sh, Half ggxAlpha)
+{
+    return ConvolveWithZH(sh, ApproximateGGXAsL2ZH_F16(ggxAlpha));
+}
+
+// Computes the zonal harmonics for a cone of constant unit radiance with the given half-angle, including the
+// sqrt(4 * Pi / (2l + 1)) factor for rotating ZH. The result can be passed to ConvolveWithZH along with
+// the radiance projected in the direction of the cone's axis. See [0]
+float2 ConeAsL1ZH(float cosHalfAngle, float sinSqHalfAngle)
+{
+    const float oneMinusCos = sinSqHalfAngle / (1.0f + cosHalfAngle);
+    return float2((2.0f * Pi) * oneMinusCos, Pi * sinSqHalfAngle);
+}
+
+float2 ConeAsL1ZH(float cosHalfAngle)
+{
+    return ConeAsL1ZH(cosHalfAngle, saturate(1.0f - cosHalfAngle * cosHalfAngle));
+}
+
+Half2 ConeAsL1ZH_F16(Half cosHalfAngle, Half sinSqHalfAngle)
+{
+    const Half oneMinusCos = sinSqHalfAngle / (Half(1.0f) + cosHalfAngle);
+    return Half2(Half(2.0f * Pi) * oneMinusCos, Half(Pi) * sinSqHalfAngle);
+}
+
+Half2 ConeAsL1ZH_F16(Half cosHalfAngle)
+{
+    return ConeAsL1ZH_F16(cosHalfAngle, saturate(Half(1.0f) - cosHalfAngle * cosHalfAngle));
+}
+
+float3 ConeAsL2ZH(float cosHalfAngle, float sinSqHalfAngle)
+{
+    const float oneMinusCos = sinSqHalfAngle / (1.0f + cosHalfAngle);
+    return float3((2.0f * Pi) * oneMinusCos, Pi * sinSqHalfAngle, Pi * cosHalfAngle * sinSqHalfAngle);
+}
+
+float3 ConeAsL2ZH(float cosHalfAngle)
+{
+    return ConeAsL2ZH(cosHalfAngle, saturate(1.0f - cosHalfAngle * cosHalfAngle));
+}
+
+Half3 ConeAsL2ZH_F16(Half cosHalfAngle, Half sinSqHalfAngle)
+{
+    const Half oneMinusCos = sinSqHalfAngle / (Half(1.0f) + cosHalfAngle);
+    return Half3(Half(2.0f * Pi) * oneMinusCos, Half(Pi) * sinSqHalfAngle, Half(Pi) * cosHalfAngle * sinSqHalfAngle);
+}
+
+Half3 ConeAsL2ZH_F16(Half cosHalfAngle)
+{
+    return ConeAsL2ZH_F16(cosHalfAngle, saturate(Half(1.0f) - cosHalfAngle * cosHalfAngle));
+}
+
+// Computes a windowed falloff factor that smoothly reaches zero at the given range
+float DistanceFalloffWindow(float distanceSq, float falloffRange)
+{
+    const float ratio = distanceSq / (falloffRange * falloffRange);
+    const float window = saturate(1.0f - ratio * ratio);
+    return window * window;
+}
+
+// The squared falloff range overflows fp16 past 256 units, so the window is computed in fp32
+Half DistanceFalloffWindow_F16(Half distanceSq, Half falloffRange)
+{
+    return Half(DistanceFalloffWindow(float(distanceSq), float(falloffRange)));
+}
+
+// Squared distances overflow fp16 past 256 units, so the _F16 light projections below compute them, and the
+// ratios derived from them, in fp32 and only convert the resulting direction and ZH back to fp16
+float DistanceSquaredF32(Half3 offset)
+{
+    const float3 offsetF32 = float3(offset);
+    return dot(offsetF32, offsetF32);
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of L1 SH coefficients
+L1 ProjectConeOntoL1(float3 axis, float cosHalfAngle, float radiance)
+{
+    return ConvolveWithZH(ProjectOntoL1(axis, radiance), ConeAsL1ZH(cosHalfAngle));
+}
+
+L1_RGB ProjectConeOntoL1_RGB(float3 axis, float cosHalfAngle, float3 radiance)
+{
+    return ConvolveWithZH(ProjectOntoL1_RGB(axis, radiance), ConeAsL1ZH(cosHalfAngle));
+}
+
+L1_F16 ProjectConeOntoL1_F16(Half3 axis, Half cosHalfAngle, Half radiance)
+{
+    return ConvolveWithZH(ProjectOntoL1_F16(axis, radiance), ConeAsL1ZH_F16(cosHalfAngle));
+}
+
+L1_F16_RGB ProjectConeOntoL1_F16_RGB(Half3 axis, Half cosHalfAngle, Half3 radiance)
+{
+    return ConvolveWithZH(ProjectOntoL1_F16_RGB(axis, radiance), ConeAsL1ZH_F16(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of L1 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies DistanceFalloffWindow.
+L1 ProjectSphereOntoL1(float3 offset, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    return ConvolveWithZH(ProjectOntoL1(offset * rsqrt(distanceSq), radiance), ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+L1 ProjectSphereOntoL1(float3 offset, float radius, float radiance, float falloffRange)
+{
+    return ProjectSphereOntoL1(offset, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L1_RGB ProjectSphereOntoL1_RGB(float3 offset, float radius, float3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    return ConvolveWithZH(ProjectOntoL1_RGB(offset * rsqrt(distanceSq), radiance), ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+L1_RGB ProjectSphereOntoL1_RGB(float3 offset, float radius, float3 radiance, float falloffRange)
+{
+    return ProjectSphereOntoL1_RGB(offset, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L1_F16 ProjectSphereOntoL1_F16(Half3 offset, Half radius, Half radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const Half3 axis = Half3(float3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL1_F16(axis, radiance), Half2(ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+L1_F16 ProjectSphereOntoL1_F16(Half3 offset, Half radius, Half radiance, Half falloffRange)
+{
+    return ProjectSphereOntoL1_F16(offset, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+L1_F16_RGB ProjectSphereOntoL1_F16_RGB(Half3 offset, Half radius, Half3 radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const Half3 axis = Half3(float3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL1_F16_RGB(axis, radiance), Half2(ConeAsL1ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+L1_F16_RGB ProjectSphereOntoL1_F16_RGB(Half3 offset, Half radius, Half3 radiance, Half falloffRange)
+{
+    return ProjectSphereOntoL1_F16_RGB(offset, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of L1 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+L1 ProjectDiskOntoL1(float3 offset, float3 diskNormal, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float3 axis = offset * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, diskNormal));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return ProjectConeOntoL1(axis, 1.0f - oneMinusCos, radiance);
+}
+
+L1 ProjectDiskOntoL1(float3 offset, float3 diskNormal, float radius, float radiance, float falloffRange)
+{
+    return ProjectDiskOntoL1(offset, diskNormal, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L1_RGB ProjectDiskOntoL1_RGB(float3 offset, float3 diskNormal, float radius, float3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float3 axis = offset * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, diskNormal));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return ProjectConeOntoL1_RGB(axis, 1.0f - oneMinusCos, radiance);
+}
+
+L1_RGB ProjectDiskOntoL1_RGB(float3 offset, float3 diskNormal, float radius, float3 radiance, float falloffRange)
+{
+    return ProjectDiskOntoL1_RGB(offset, diskNormal, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L1_F16 ProjectDiskOntoL1_F16(Half3 offset, Half3 diskNormal, Half radius, Half radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float3 axis = float3(offset) * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, float3(diskNormal)));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return ProjectConeOntoL1_F16(Half3(axis), Half(1.0f - oneMinusCos), radiance);
+}
+
+L1_F16 ProjectDiskOntoL1_F16(Half3 offset, Half3 diskNormal, Half radius, Half radiance, Half falloffRange)
+{
+    return ProjectDiskOntoL1_F16(offset, diskNormal, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+L1_F16_RGB ProjectDiskOntoL1_F16_RGB(Half3 offset, Half3 diskNormal, Half radius, Half3 radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float3 axis = float3(offset) * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, float3(diskNormal)));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return ProjectConeOntoL1_F16_RGB(Half3(axis), Half(1.0f - oneMinusCos), radiance);
+}
+
+L1_F16_RGB ProjectDiskOntoL1_F16_RGB(Half3 offset, Half3 diskNormal, Half radius, Half3 radiance, Half falloffRange)
+{
+    return ProjectDiskOntoL1_F16_RGB(offset, diskNormal, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a cone of constant radiance around the given axis onto a set of L2 SH coefficients
+L2 ProjectConeOntoL2(float3 axis, float cosHalfAngle, float radiance)
+{
+    return ConvolveWithZH(ProjectOntoL2(axis, radiance), ConeAsL2ZH(cosHalfAngle));
+}
+
+L2_RGB ProjectConeOntoL2_RGB(float3 axis, float cosHalfAngle, float3 radiance)
+{
+    return ConvolveWithZH(ProjectOntoL2_RGB(axis, radiance), ConeAsL2ZH(cosHalfAngle));
+}
+
+L2_F16 ProjectConeOntoL2_F16(Half3 axis, Half cosHalfAngle, Half radiance)
+{
+    return ConvolveWithZH(ProjectOntoL2_F16(axis, radiance), ConeAsL2ZH_F16(cosHalfAngle));
+}
+
+L2_F16_RGB ProjectConeOntoL2_F16_RGB(Half3 axis, Half cosHalfAngle, Half3 radiance)
+{
+    return ConvolveWithZH(ProjectOntoL2_F16_RGB(axis, radiance), ConeAsL2ZH_F16(cosHalfAngle));
+}
+
+// Projects a sphere light with constant radiance onto a set of L2 SH coefficients, where offset is the vector
+// from the shading point to the center of the sphere. The sphere is treated as the cone that it subtends,
+// which is exact for a uniformly-emitting sphere. An optional falloff range applies DistanceFalloffWindow.
+L2 ProjectSphereOntoL2(float3 offset, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    return ConvolveWithZH(ProjectOntoL2(offset * rsqrt(distanceSq), radiance), ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+L2 ProjectSphereOntoL2(float3 offset, float radius, float radiance, float falloffRange)
+{
+    return ProjectSphereOntoL2(offset, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L2_RGB ProjectSphereOntoL2_RGB(float3 offset, float radius, float3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float sinSqHalfAngle = min(radius * radius / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    return ConvolveWithZH(ProjectOntoL2_RGB(offset * rsqrt(distanceSq), radiance), ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle));
+}
+
+L2_RGB ProjectSphereOntoL2_RGB(float3 offset, float radius, float3 radiance, float falloffRange)
+{
+    return ProjectSphereOntoL2_RGB(offset, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L2_F16 ProjectSphereOntoL2_F16(Half3 offset, Half radius, Half radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const Half3 axis = Half3(float3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL2_F16(axis, radiance), Half3(ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+L2_F16 ProjectSphereOntoL2_F16(Half3 offset, Half radius, Half radiance, Half falloffRange)
+{
+    return ProjectSphereOntoL2_F16(offset, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+L2_F16_RGB ProjectSphereOntoL2_F16_RGB(Half3 offset, Half radius, Half3 radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float sinSqHalfAngle = min(float(radius) * float(radius) / distanceSq, 1.0f);
+    const float cosHalfAngle = sqrt(1.0f - sinSqHalfAngle);
+    const Half3 axis = Half3(float3(offset) * rsqrt(distanceSq));
+    return ConvolveWithZH(ProjectOntoL2_F16_RGB(axis, radiance), Half3(ConeAsL2ZH(cosHalfAngle, sinSqHalfAngle)));
+}
+
+L2_F16_RGB ProjectSphereOntoL2_F16_RGB(Half3 offset, Half radius, Half3 radiance, Half falloffRange)
+{
+    return ProjectSphereOntoL2_F16_RGB(offset, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+// Projects a one-sided disk light with constant radiance onto a set of L2 SH coefficients, where offset is the
+// vector from the shading point to the center of the disk and diskNormal is the direction that the disk emits
+// towards. The disk is approximated as a cone with the same solid angle as the foreshortened disk, which
+// is exact when the shading point lies on the disk's axis.
+L2 ProjectDiskOntoL2(float3 offset, float3 diskNormal, float radius, float radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float3 axis = offset * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, diskNormal));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return ProjectConeOntoL2(axis, 1.0f - oneMinusCos, radiance);
+}
+
+L2 ProjectDiskOntoL2(float3 offset, float3 diskNormal, float radius, float radiance, float falloffRange)
+{
+    return ProjectDiskOntoL2(offset, diskNormal, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L2_RGB ProjectDiskOntoL2_RGB(float3 offset, float3 diskNormal, float radius, float3 radiance)
+{
+    const float distanceSq = dot(offset, offset);
+    const float3 axis = offset * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, diskNormal));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + radius * radius))) * cosTheta;
+    return ProjectConeOntoL2_RGB(axis, 1.0f - oneMinusCos, radiance);
+}
+
+L2_RGB ProjectDiskOntoL2_RGB(float3 offset, float3 diskNormal, float radius, float3 radiance, float falloffRange)
+{
+    return ProjectDiskOntoL2_RGB(offset, diskNormal, radius, radiance * DistanceFalloffWindow(dot(offset, offset), falloffRange));
+}
+
+L2_F16 ProjectDiskOntoL2_F16(Half3 offset, Half3 diskNormal, Half radius, Half radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float3 axis = float3(offset) * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, float3(diskNormal)));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return ProjectConeOntoL2_F16(Half3(axis), Half(1.0f - oneMinusCos), radiance);
+}
+
+L2_F16 ProjectDiskOntoL2_F16(Half3 offset, Half3 diskNormal, Half radius, Half radiance, Half falloffRange)
+{
+    return ProjectDiskOntoL2_F16(offset, diskNormal, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+L2_F16_RGB ProjectDiskOntoL2_F16_RGB(Half3 offset, Half3 diskNormal, Half radius, Half3 radiance)
+{
+    const float distanceSq = DistanceSquaredF32(offset);
+    const float3 axis = float3(offset) * rsqrt(distanceSq);
+    const float cosTheta = saturate(-dot(axis, float3(diskNormal)));
+    const float oneMinusCos = (1.0f - sqrt(distanceSq / (distanceSq + float(radius) * float(radius)))) * cosTheta;
+    return ProjectConeOntoL2_F16_RGB(Half3(axis), Half(1.0f - oneMinusCos), radiance);
+}
+
+L2_F16_RGB ProjectDiskOntoL2_F16_RGB(Half3 offset, Half3 diskNormal, Half radius, Half3 radiance, Half falloffRange)
+{
+    return ProjectDiskOntoL2_F16_RGB(offset, diskNormal, radius, radiance * Half(DistanceFalloffWindow(DistanceSquaredF32(offset), float(falloffRange))));
+}
+
+
 // Given a set of L1 SH coefficients represnting incoming radiance, determines a directional light
 // direction, color, and modified roughness value that can be used to compute an approximate specular term. See [5]
 void ExtractSpecularDirLight(L1 shRadiance, float sqrtRoughness, out float3 lightDir, out float lightIntensity, out float modifiedSqrtRoughness)
@@ -736,6 +1922,28 @@ void ExtractSpecularDirLight(L1_RGB shRadiance, float sqrtRoughness, out float3
     modifiedSqrtRoughness = saturate(sqrtRoughness / sqrt(avgL1len));
 }
 
+void ExtractSpecularDirLight(L1_F16 shRadiance, Half sqrtRoughness, out Half3 lightDir, out Half lightIntensity, out Half modifiedSqrtRoughness)
+{
+    Half3 avgL1 = Half3(shRadiance.C[3], shRadiance.C[1], shRadiance.C[2]);
+    avgL1 *= Half(0.5f);
+    Half avgL1len = length(avgL1);
+
+    lightDir = avgL1 / avgL1len;
+    lightIntensity = Evaluate(shRadiance, lightDir) * Half(Pi);
+    modifiedSqrtRoughness = saturate(sqrtRoughness / sqrt(avgL1len));
+}
+
+void ExtractSpecularDirLight(L1_F16_RGB shRadiance, Half sqrtRoughness, out Half3 lightDir, out Half3 lightColor, out Half modifiedSqrtRoughness)
+{
+    Half3 avgL1 = Half3(dot(shRadiance.C[3] / shRadiance.C[0], Half(0.333f)), dot(shRadiance.C[1] / shRadiance.C[0], Half(0.333f)), dot(shRadiance.C[2] / shRadiance.C[0], Half(0.333f)));
+    avgL1 *= Half(0.5f);
+    Half avgL1len = length(avgL1);
+
+    lightDir = avgL1 / avgL1len;
+    lightColor = Evaluate(shRadiance, lightDir) * Half(Pi);
+    modifiedSqrtRoughness = saturate(sqrtRoughness / sqrt(avgL1len));
+}
+
 // Rotates a set of L1 coefficients by a rotation matrix. Adapted from DirectX::XMSHRotate [3]
 L1 Rotate(L1 sh, float3x3 rotation)
 {
@@ -776,6 +1984,44 @@ L1_RGB Rotate(L1_RGB sh, float3x3 rotation)
     return result;
 }
 
+L1_F16 Rotate(L1_F16 sh, float3x3 rotation)
+{
+    L1_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    float3 dir = float3(sh.C[3], sh.C[1], sh.C[2]);
+    dir = mul(dir, rotation);
+    result.C[3] = Half(dir.x);
+    result.C[1] = Half(dir.y);
+    result.C[2] = Half(dir.z);
+
+    return result;
+}
+
+L1_F16_RGB Rotate(L1_F16_RGB sh, float3x3 rotation)
+{
+    L1_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    [unroll]
+    for(uint i = 0; i < 3; ++i)
+    {
+        float3 dir = float3(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        dir = mul(dir, rotation);
+        result.C[3][i] = Half(dir.x);
+        result.C[1][i] = Half(dir.y);
+        result.C[2][i] = Half(dir.z);
+    }
+
+    return result;
+}
+
 // Rotates a set of L2 coefficients by a rotation matrix. Adapted from DirectX::XMSHRotate [3]
 L2 Rotate(L2 sh, float3x3 rotation)
 {
@@ -953,6 +2199,502 @@ L2_RGB Rotate(L2_RGB sh, float3x3 rotation)
     return result;
 }
 
+L2_F16 Rotate(L2_F16 sh, float3x3 rotation)
+{
+    // The basis vectors used in DXSH are slightly different than ours,
+    // the X and Z are flipped relative to what's used above in ProjectOntoL1/L2.
+    // Hence there are several negations here to adapt the code work for us.
+    const float r00 = rotation._m00;
+    const float r10 = rotation._m01;
+    const float r20 = -rotation._m02;
+
+    const float r01 = rotation._m10;
+    const float r11 = rotation._m11;
+    const float r21 = -rotation._m12;
+
+    const float r02 = -rotation._m20;
+    const float r12 = -rotation._m21;
+    const float r22 = rotation._m22;
+
+    L2_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = Half(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = Half(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = Half(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // L2
+    const float t41 = r01 * r00;
+    const float t43 = r11 * r10;
+    const float t48 = r11 * r12;
+    const float t50 = r01 * r02;
+    const float t55 = r02 * r02;
+    const float t57 = r22 * r22;
+    const float t58 = r12 * r12;
+    const float t61 = r00 * r02;
+    const float t63 = r10 * r12;
+    const float t68 = r10 * r10;
+    const float t70 = r01 * r01;
+    const float t72 = r11 * r11;
+    const float t74 = r00 * r00;
+    const float t76 = r21 * r21;
+    const float t78 = r20 * r20;
+
+    const float v173 = 0.1732050808e1f;
+    const float v577 = 0.5773502693e0f;
+    const float v115 = 0.1154700539e1f;
+    const float v288 = 0.2886751347e0f;
+    const float v866 = 0.8660254040e0f;
+
+    float r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = -0.5f * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = 0.5f * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = Half(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                               r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                               r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+
+L2_F16_RGB Rotate(L2_F16_RGB sh, float3x3 rotation)
+{
+    // The basis vectors used in DXSH are slightly different than ours,
+    // the X and Z are flipped relative to what's used above in ProjectOntoL1/L2.
+    // Hence there are several negations here to adapt the code work for us.
+    const float r00 = rotation._m00;
+    const float r10 = rotation._m01;
+    const float r20 = -rotation._m02;
+
+    const float r01 = rotation._m10;
+    const float r11 = rotation._m11;
+    const float r21 = -rotation._m12;
+
+    const float r02 = -rotation._m20;
+    const float r12 = -rotation._m21;
+    const float r22 = rotation._m22;
+
+    L2_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = Half3(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = Half3(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = Half3(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // L2
+    const float t41 = r01 * r00;
+    const float t43 = r11 * r10;
+    const float t48 = r11 * r12;
+    const float t50 = r01 * r02;
+    const float t55 = r02 * r02;
+    const float t57 = r22 * r22;
+    const float t58 = r12 * r12;
+    const float t61 = r00 * r02;
+    const float t63 = r10 * r12;
+    const float t68 = r10 * r10;
+    const float t70 = r01 * r01;
+    const float t72 = r11 * r11;
+    const float t74 = r00 * r00;
+    const float t76 = r21 * r21;
+    const float t78 = r20 * r20;
+
+    const float v173 = 0.1732050808e1f;
+    const float v577 = 0.5773502693e0f;
+    const float v115 = 0.1154700539e1f;
+    const float v288 = 0.2886751347e0f;
+    const float v866 = 0.8660254040e0f;
+
+    float r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = -0.5f * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = 0.5f * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = Half3(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                                r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                                r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+
+// Converts a unit quaternion (xyz = axis * sin(angle / 2), w = cos(angle / 2)) to a rotation matrix in the
+// convention used by Rotate, matching QuatTo3x3 from SampleFramework12's Quaternion.hlsl
+float3x3 QuaternionToRotationMatrix(float4 quaternion)
+{
+    const float3 q2 = quaternion.xyz * 2.0f;
+    const float xx = quaternion.x * q2.x;
+    const float yy = quaternion.y * q2.y;
+    const float zz = quaternion.z * q2.z;
+    const float xy = quaternion.x * q2.y;
+    const float xz = quaternion.x * q2.z;
+    const float yz = quaternion.y * q2.z;
+    const float wx = quaternion.w * q2.x;
+    const float wy = quaternion.w * q2.y;
+    const float wz = quaternion.w * q2.z;
+
+    return float3x3(1.0f - yy - zz, xy + wz, xz - wy,
+                    xy - wz, 1.0f - xx - zz, yz + wx,
+                    xz + wy, yz - wx, 1.0f - xx - yy);
+}
+
+Half3x3 QuaternionToRotationMatrix_F16(Half4 quaternion)
+{
+    const Half3 q2 = quaternion.xyz * Half(2.0);
+    const Half xx = quaternion.x * q2.x;
+    const Half yy = quaternion.y * q2.y;
+    const Half zz = quaternion.z * q2.z;
+    const Half xy = quaternion.x * q2.y;
+    const Half xz = quaternion.x * q2.z;
+    const Half yz = quaternion.y * q2.z;
+    const Half wx = quaternion.w * q2.x;
+    const Half wy = quaternion.w * q2.y;
+    const Half wz = quaternion.w * q2.z;
+
+    return Half3x3(Half(1.0) - yy - zz, xy + wz, xz - wy,
+                   xy - wz, Half(1.0) - xx - zz, yz + wx,
+                   xz + wy, yz - wx, Half(1.0) - xx - yy);
+}
+
+// Rotates a set of L1 coefficients by a unit quaternion. Band 1 rotates like a vector, so the quaternion is
+// applied directly without expanding it to a matrix. The fp16 versions perform the rotation in fp16.
+L1 Rotate(L1 sh, float4 quaternion)
+{
+    L1 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    float3 dir = float3(sh.C[3], sh.C[1], sh.C[2]);
+    const float3 t = 2.0f * cross(quaternion.xyz, dir);
+    dir += quaternion.w * t + cross(quaternion.xyz, t);
+    result.C[3] = dir.x;
+    result.C[1] = dir.y;
+    result.C[2] = dir.z;
+
+    return result;
+}
+
+L1_RGB Rotate(L1_RGB sh, float4 quaternion)
+{
+    L1_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    [unroll]
+    for(uint i = 0; i < 3; ++i)
+    {
+        float3 dir = float3(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        const float3 t = 2.0f * cross(quaternion.xyz, dir);
+        dir += quaternion.w * t + cross(quaternion.xyz, t);
+        result.C[3][i] = dir.x;
+        result.C[1][i] = dir.y;
+        result.C[2][i] = dir.z;
+    }
+
+    return result;
+}
+
+L1_F16 Rotate(L1_F16 sh, Half4 quaternion)
+{
+    L1_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    Half3 dir = Half3(sh.C[3], sh.C[1], sh.C[2]);
+    const Half3 t = Half(2.0) * cross(quaternion.xyz, dir);
+    dir += quaternion.w * t + cross(quaternion.xyz, t);
+    result.C[3] = dir.x;
+    result.C[1] = dir.y;
+    result.C[2] = dir.z;
+
+    return result;
+}
+
+L1_F16_RGB Rotate(L1_F16_RGB sh, Half4 quaternion)
+{
+    L1_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    [unroll]
+    for(uint i = 0; i < 3; ++i)
+    {
+        Half3 dir = Half3(sh.C[3][i], sh.C[1][i], sh.C[2][i]);
+        const Half3 t = Half(2.0) * cross(quaternion.xyz, dir);
+        dir += quaternion.w * t + cross(quaternion.xyz, t);
+        result.C[3][i] = dir.x;
+        result.C[1][i] = dir.y;
+        result.C[2][i] = dir.z;
+    }
+
+    return result;
+}
+
+// Rotates a set of fp16 L2 coefficients by an fp16 rotation matrix, performing all of the rotation math in fp16
+L2_F16 Rotate(L2_F16 sh, Half3x3 rotation)
+{
+    // The basis vectors used in DXSH are slightly different than ours,
+    // the X and Z are flipped relative to what's used above in ProjectOntoL1/L2.
+    // Hence there are several negations here to adapt the code work for us.
+    const Half r00 = rotation._m00;
+    const Half r10 = rotation._m01;
+    const Half r20 = -rotation._m02;
+
+    const Half r01 = rotation._m10;
+    const Half r11 = rotation._m11;
+    const Half r21 = -rotation._m12;
+
+    const Half r02 = -rotation._m20;
+    const Half r12 = -rotation._m21;
+    const Half r22 = rotation._m22;
+
+    L2_F16 result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = Half(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = Half(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = Half(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // L2
+    const Half t41 = r01 * r00;
+    const Half t43 = r11 * r10;
+    const Half t48 = r11 * r12;
+    const Half t50 = r01 * r02;
+    const Half t55 = r02 * r02;
+    const Half t57 = r22 * r22;
+    const Half t58 = r12 * r12;
+    const Half t61 = r00 * r02;
+    const Half t63 = r10 * r12;
+    const Half t68 = r10 * r10;
+    const Half t70 = r01 * r01;
+    const Half t72 = r11 * r11;
+    const Half t74 = r00 * r00;
+    const Half t76 = r21 * r21;
+    const Half t78 = r20 * r20;
+
+    const Half v173 = Half(0.1732050808e1);
+    const Half v577 = Half(0.5773502693e0);
+    const Half v115 = Half(0.1154700539e1);
+    const Half v288 = Half(0.2886751347e0);
+    const Half v866 = Half(0.8660254040e0);
+
+    Half r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = Half(-0.5) * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = Half(0.5) * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = Half(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                               r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                               r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+
+L2_F16_RGB Rotate(L2_F16_RGB sh, Half3x3 rotation)
+{
+    // The basis vectors used in DXSH are slightly different than ours,
+    // the X and Z are flipped relative to what's used above in ProjectOntoL1/L2.
+    // Hence there are several negations here to adapt the code work for us.
+    const Half r00 = rotation._m00;
+    const Half r10 = rotation._m01;
+    const Half r20 = -rotation._m02;
+
+    const Half r01 = rotation._m10;
+    const Half r11 = rotation._m11;
+    const Half r21 = -rotation._m12;
+
+    const Half r02 = -rotation._m20;
+    const Half r12 = -rotation._m21;
+    const Half r22 = rotation._m22;
+
+    L2_F16_RGB result;
+
+    // L0
+    result.C[0] = sh.C[0];
+
+    // L1
+    result.C[1] = Half3(r11 * sh.C[1] - r12 * sh.C[2] + r10 * sh.C[3]);
+    result.C[2] = Half3(-r21 * sh.C[1] + r22 * sh.C[2] - r20 * sh.C[3]);
+    result.C[3] = Half3(r01 * sh.C[1] - r02 * sh.C[2] + r00 * sh.C[3]);
+
+    // L2
+    const Half t41 = r01 * r00;
+    const Half t43 = r11 * r10;
+    const Half t48 = r11 * r12;
+    const Half t50 = r01 * r02;
+    const Half t55 = r02 * r02;
+    const Half t57 = r22 * r22;
+    const Half t58 = r12 * r12;
+    const Half t61 = r00 * r02;
+    const Half t63 = r10 * r12;
+    const Half t68 = r10 * r10;
+    const Half t70 = r01 * r01;
+    const Half t72 = r11 * r11;
+    const Half t74 = r00 * r00;
+    const Half t76 = r21 * r21;
+    const Half t78 = r20 * r20;
+
+    const Half v173 = Half(0.1732050808e1);
+    const Half v577 = Half(0.5773502693e0);
+    const Half v115 = Half(0.1154700539e1);
+    const Half v288 = Half(0.2886751347e0);
+    const Half v866 = Half(0.8660254040e0);
+
+    Half r[25];
+    r[0] = r11 * r00 + r01 * r10;
+    r[1] = -r01 * r12 - r11 * r02;
+    r[2] =  v173 * r02 * r12;
+    r[3] = -r10 * r02 - r00 * r12;
+    r[4] = r00 * r10 - r01 * r11;
+    r[5] = - r11 * r20 - r21 * r10;
+    r[6] = r11 * r22 + r21 * r12;
+    r[7] = -v173 * r22 * r12;
+    r[8] = r20 * r12 + r10 * r22;
+    r[9] = -r10 * r20 + r11 * r21;
+    r[10] = -v577 * (t41 + t43) + v115 * r21 * r20;
+    r[11] = v577 * (t48 + t50) - v115 * r21 * r22;
+    r[12] = Half(-0.5) * (t55 + t58) + t57;
+    r[13] = v577 * (t61 + t63) - v115 * r20 * r22;
+    r[14] =  v288 * (t70 - t68 + t72 - t74) - v577 * (t76 - t78);
+    r[15] = -r01 * r20 -  r21 * r00;
+    r[16] = r01 * r22 + r21 * r02;
+    r[17] = -v173 * r22 * r02;
+    r[18] = r00 * r22 + r20 * r02;
+    r[19] = -r00 * r20 + r01 * r21;
+    r[20] = t41 - t43;
+    r[21] = -t50 + t48;
+    r[22] =  v866 * (t55 - t58);
+    r[23] = t63 - t61;
+    r[24] = Half(0.5) * (t74 - t68 - t70 +  t72);
+
+    for(uint i = 0; i < 5; ++i)
+    {
+        const uint base = i * 5;
+        result.C[4 + i] = Half3(r[base + 0] * sh.C[4] + r[base + 1] * sh.C[5] +
+                                r[base + 2] * sh.C[6] + r[base + 3] * sh.C[7] +
+                                r[base + 4] * sh.C[8]);
+    }
+
+    return result;
+}
+
+// Rotates a set of L2 coefficients by a unit quaternion. Unlike band 1, band 2 needs the quadratic terms of
+// the rotation matrix, so the matrix is built once directly from the quaternion. The fp16 versions build
+// the matrix and rotate in fp16.
+L2 Rotate(L2 sh, float4 quaternion)
+{
+    return Rotate(sh, QuaternionToRotationMatrix(quaternion));
+}
+
+L2_RGB Rotate(L2_RGB sh, float4 quaternion)
+{
+    return Rotate(sh, QuaternionToRotationMatrix(quaternion));
+}
+
+L2_F16 Rotate(L2_F16 sh, Half4 quaternion)
+{
+    return Rotate(sh, QuaternionToRotationMatrix_F16(quaternion));
+}
+
+L2_F16_RGB Rotate(L2_F16_RGB sh, Half4 quaternion)
+{
+    return Rotate(sh, QuaternionToRotationMatrix_F16(quaternion));
+}
+
 } // namespace SH
 
 // References: